@@ -0,0 +1,52 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/AssetBundle.hh"
+#include "core/Logging.hh"
+
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("asset_bundler",
+        "Packs asset files into a .spdata bundle. File paths are relative to the current directory.");
+    options.positional_help("<output_file> <asset_paths...>");
+    options.add_options()("output-file", "", cxxopts::value<std::string>())(
+        "asset-paths",
+        "",
+        cxxopts::value<std::vector<std::string>>());
+    options.parse_positional({"output-file", "asset-paths"});
+
+    auto optionsResult = options.parse(argc, argv);
+
+    if (!optionsResult.count("output-file") || !optionsResult.count("asset-paths")) {
+        std::cout << options.help() << std::endl;
+        return 1;
+    }
+
+    std::vector<sp::AssetBundle::SourceFile> files;
+    for (auto &path : optionsResult["asset-paths"].as<std::vector<std::string>>()) {
+        auto &file = files.emplace_back();
+        // Bundle paths always use forward slashes to match AssetManager::Load
+        file.path = std::filesystem::path(path).generic_string();
+        file.source = path;
+    }
+
+    auto outputPath = optionsResult["output-file"].as<std::string>();
+    if (!sp::AssetBundle::Write(outputPath, files)) return 1;
+
+    // Make sure the output can be read back
+    auto bundle = sp::AssetBundle::Open(outputPath);
+    if (!bundle) {
+        Errorf("asset_bundler generated an invalid bundle: %s", outputPath);
+        return 1;
+    }
+    Logf("Wrote %u assets to %s", bundle->Entries().size(), outputPath);
+    return 0;
+}
@@ -19,10 +19,10 @@ if [ -n "$CI_CACHE_DIRECTORY" ]; then
     echo -e "~~~ Restoring assets cache"
     ./assets/cache-assets.py --restore
     
-    if [ -d "$CI_CACHE_DIRECTORY/sp-physics-cache" ]; then
+    if [ -f "$CI_CACHE_DIRECTORY/sp-physics-cache/collision.sphulls" ]; then
         echo -e "~~~ Restoring physics collision cache"
         mkdir -p ./assets/cache
-        cp -r "$CI_CACHE_DIRECTORY/sp-physics-cache/collision" ./assets/cache/
+        cp "$CI_CACHE_DIRECTORY/sp-physics-cache/collision.sphulls" ./assets/cache/
     fi
 fi
 
@@ -83,6 +83,35 @@ if ! [ "$CI_PACKAGE_RELEASE" = "1" ]; then
         echo -e "\033[32mTest successful\033[0m"
     fi
 
+    echo -e "--- Running \033[33mbenchmarks\033[0m :stopwatch:"
+    ./sp-bench --json bench-results.json --csv bench-results.csv --label "${BUILDKITE_COMMIT:-local}"
+    result=$?
+    if [ $result -ne 0 ]; then
+        echo -e "\n^^^ +++"
+        echo -e "\033[31mBenchmark failed with response code: $result\033[0m"
+        success=$result
+    else
+        echo -e "\033[32mBenchmark successful\033[0m"
+        [ -n "$BUILDKITE_BRANCH" ] && buildkite-agent artifact upload "bench-results.*"
+    fi
+
+    echo -e "--- Running \033[33mVulkan benchmarks\033[0m :stopwatch:"
+    # Set CI_VULKAN_BENCHMARKS=1 to force these on agents where vulkaninfo isn't installed
+    if [ "$CI_VULKAN_BENCHMARKS" != "1" ] && ! vulkaninfo --summary > /dev/null 2>&1; then
+        echo -e "\033[33mNo Vulkan device found, skipping Vulkan benchmarks\033[0m"
+    else
+        ./sp-bench-vulkan --json vulkan-bench-results.json --csv vulkan-bench-results.csv --label "${BUILDKITE_COMMIT:-local}"
+        result=$?
+        if [ $result -ne 0 ]; then
+            echo -e "\n^^^ +++"
+            echo -e "\033[31mBenchmark failed with response code: $result\033[0m"
+            success=$result
+        else
+            echo -e "\033[32mBenchmark successful\033[0m"
+            [ -n "$BUILDKITE_BRANCH" ] && buildkite-agent artifact upload "vulkan-bench-results.*"
+        fi
+    fi
+
     echo -e "--- Running \033[33mtest scripts\033[0m :camera_with_flash:"
     rm -rf screenshots/*.png
 
@@ -139,9 +168,8 @@ if [ $success -eq 0 ] && [ -n "$CI_CACHE_DIRECTORY" ]; then
     echo -e "~~~ Saving physics collision cache"
     mkdir -p "$CI_CACHE_DIRECTORY/sp-physics-cache"
 
-    # Delete cache files older than 30 days so any removed models don't stick around forever
-    find "$CI_CACHE_DIRECTORY/sp-physics-cache" -type f -mtime 30 -delete
-    cp -r ../assets/cache/collision "$CI_CACHE_DIRECTORY/sp-physics-cache/"
+    # hull_compiler rewrites the pack with only the current models, so removed models don't stick around
+    cp ../assets/cache/collision.sphulls "$CI_CACHE_DIRECTORY/sp-physics-cache/"
 fi
 
 if [ "$CI_PACKAGE_RELEASE" = "1" ]; then
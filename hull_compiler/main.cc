@@ -11,41 +11,73 @@
 #include "assets/Gltf.hh"
 #include "assets/PhysicsInfo.hh"
 #include "cooking/ConvexHull.hh"
+#include "cooking/HullCachePack.hh"
+#include "core/DispatchQueue.hh"
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
 
 #include <PxPhysicsAPI.h>
+#include <atomic>
 #include <cxxopts.hpp>
 #include <extensions/PxDefaultAllocator.h>
 #include <extensions/PxDefaultErrorCallback.h>
 #include <filesystem>
 #include <fstream>
+#include <set>
+#include <thread>
+
+// Reads the existing pack into memory so it can be replaced without holding a mapping of it open
+static std::shared_ptr<const sp::HullCachePack> readExistingPack(const std::filesystem::path &packPath) {
+    std::ifstream in(packPath, std::ios::in | std::ios::binary);
+    if (!in) return nullptr;
+    in.seekg(0, std::ios::end);
+    auto buffer = std::make_shared<std::vector<uint8_t>>((size_t)in.tellg());
+    in.seekg(0, std::ios::beg);
+    if (!in.read((char *)buffer->data(), buffer->size())) return nullptr;
+    return sp::HullCachePack::Open(buffer, buffer->data(), buffer->size());
+}
 
 int main(int argc, char **argv) {
-    cxxopts::Options options("hull_compiler", "");
-    options.positional_help("<model_name>");
-    options.add_options()("model-name", "", cxxopts::value<std::string>());
-    options.parse_positional({"model-name"});
+    cxxopts::Options options("hull_compiler",
+        "Cooks the convex hulls of each model and writes them to the collision cache pack. "
+        "The pack is replaced with one containing only the hulls of the listed models.");
+    options.positional_help("<model_names...>");
+    options.add_options()("model-names", "", cxxopts::value<std::vector<std::string>>());
+    options.add_options()("all", "Compile every model in the assets/models directory");
+    options.add_options()("pack",
+        "Output collision cache pack path",
+        cxxopts::value<std::string>()->default_value(std::string("../assets/") + sp::hull_cache::PACK_PATH));
+    options.add_options()("threads",
+        "Number of threads used for cooking, defaults to the number of CPU cores",
+        cxxopts::value<uint32_t>()->default_value("0"));
+    options.parse_positional({"model-names"});
 
     auto optionsResult = options.parse(argc, argv);
 
-    if (!optionsResult.count("model-name")) {
+    std::set<std::string> modelNames;
+    if (optionsResult.count("model-names")) {
+        for (auto &name : optionsResult["model-names"].as<std::vector<std::string>>()) {
+            modelNames.emplace(name);
+        }
+    }
+    if (optionsResult.count("all")) {
+        std::error_code ec;
+        for (auto &entry : std::filesystem::recursive_directory_iterator("../assets/models", ec)) {
+            auto extension = entry.path().extension();
+            if (!entry.is_regular_file() || (extension != ".glb" && extension != ".gltf")) continue;
+            modelNames.emplace(entry.path().stem().string());
+        }
+    }
+    if (modelNames.empty()) {
         std::cout << options.help() << std::endl;
         return 1;
     }
 
-    std::string modelName = optionsResult["model-name"].as<std::string>();
-
     sp::logging::SetLogLevel(sp::logging::Level::Warn);
 
-    auto modelPtr = sp::Assets().LoadGltf(modelName);
-    auto model = modelPtr->Get();
-    if (!model) {
-        Errorf("hull_compiler could not load Gltf model: %s", modelName);
-        return 1;
-    }
-
-    auto physicsInfo = sp::Assets().LoadPhysicsInfo(modelName)->Get();
+    auto startTime = chrono_clock::now();
+    std::filesystem::path packPath = optionsResult["pack"].as<std::string>();
+    auto existingPack = readExistingPack(packPath);
 
     physx::PxDefaultErrorCallback defaultErrorCallback;
     physx::PxDefaultAllocator defaultAllocatorCallback;
@@ -61,42 +93,98 @@ int main(int argc, char **argv) {
     auto pxSerialization = physx::PxSerialization::createSerializationRegistry(*pxPhysics);
     Assert(pxSerialization, "PxSerialization::createSerializationRegistry");
 
-    bool updated = false;
-    if (physicsInfo) {
-        for (auto &[meshName, settings] : physicsInfo->GetHulls()) {
-            auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
-
-            auto set = sp::hullgen::LoadCollisionCache(*pxSerialization, modelPtr, settingsPtr);
-            if (set) continue;
-
-            Logf("Updating physics collision cache: %s.%s", modelName, meshName);
-
-            set = sp::hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, modelPtr, settingsPtr);
-            sp::hullgen::SaveCollisionCache(*pxSerialization, modelPtr, settingsPtr, *set);
+    uint32_t threadCount = optionsResult["threads"].as<uint32_t>();
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    // Hull sets and their primitives are cooked on separate queues, since hull set work items block on primitives
+    sp::DispatchQueue hullQueue("HullCompiler", threadCount, std::chrono::milliseconds(5));
+    sp::DispatchQueue cookingQueue("HullCooking",
+        threadCount,
+        std::chrono::milliseconds(5),
+        sp::DispatchScheduler::WorkStealing);
+
+    std::atomic_size_t cookedCount = 0;
+    std::vector<std::pair<std::string, sp::AsyncPtr<sp::HullCachePack::SourceEntry>>> results;
+    bool failed = false;
+    for (auto &modelName : modelNames) {
+        auto modelPtr = sp::Assets().LoadGltf(modelName);
+        auto model = modelPtr->Get();
+        if (!model || !model->asset) {
+            Errorf("hull_compiler could not load Gltf model: %s", modelName);
+            failed = true;
+            continue;
+        }
+        auto modelHash = model->asset->Hash();
+
+        std::vector<std::string> meshNames;
+        auto physicsInfo = sp::Assets().LoadPhysicsInfo(modelName)->Get();
+        if (physicsInfo) {
+            for (auto &[meshName, settings] : physicsInfo->GetHulls()) {
+                meshNames.emplace_back(meshName);
+            }
+        }
+        for (size_t i = 0; i < model->meshes.size(); i++) {
+            meshNames.emplace_back("convex" + std::to_string(i));
+        }
 
-            updated = true;
+        for (auto &meshName : meshNames) {
+            auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
+            auto result = hullQueue.Dispatch<sp::HullCachePack::SourceEntry>(
+                [&, modelPtr, modelHash, settingsPtr]() -> std::shared_ptr<sp::HullCachePack::SourceEntry> {
+                    auto settings = settingsPtr->Get();
+                    if (!settings) return nullptr;
+                    auto entry = std::make_shared<sp::HullCachePack::SourceEntry>();
+                    entry->modelHash = modelHash;
+                    entry->settingsHash = sp::hullgen::HashHullSettings(*settings);
+
+                    auto cached = existingPack ? existingPack->Find(entry->modelHash, entry->settingsHash)
+                                               : std::span<const uint8_t>();
+                    if (!cached.empty()) {
+                        entry->data.assign(cached.begin(), cached.end());
+                        return entry;
+                    }
+
+                    Logf("Updating physics collision cache: %s", settings->name);
+                    auto set = sp::hullgen::BuildConvexHulls(*pxCooking,
+                        *pxPhysics,
+                        modelPtr,
+                        settingsPtr,
+                        &cookingQueue);
+                    if (!set) return nullptr;
+                    entry->data = sp::hullgen::SerializeConvexHulls(*pxSerialization, *set, settings->name);
+                    if (entry->data.empty()) return nullptr;
+                    cookedCount++;
+                    return entry;
+                });
+            results.emplace_back(modelName + "." + meshName, result);
         }
     }
 
-    for (size_t i = 0; i < model->meshes.size(); i++) {
-        std::string meshName("convex" + std::to_string(i));
-        auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
+    std::vector<sp::HullCachePack::SourceEntry> entries;
+    entries.reserve(results.size());
+    for (auto &[name, result] : results) {
+        auto entry = result->Get();
+        if (!entry) {
+            Errorf("hull_compiler failed to build convex hulls: %s", name);
+            failed = true;
+            continue;
+        }
+        entries.emplace_back(std::move(*entry));
+    }
+    hullQueue.Shutdown();
+    cookingQueue.Shutdown();
 
-        auto set = sp::hullgen::LoadCollisionCache(*pxSerialization, modelPtr, settingsPtr);
-        if (set) continue;
+    pxSerialization->release();
+    pxCooking->release();
+    pxPhysics->release();
+    pxFoundation->release();
 
-        Logf("Updating physics collision cache: %s.%s", modelName, meshName);
+    if (failed) return 1;
 
-        set = sp::hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, modelPtr, settingsPtr);
-        sp::hullgen::SaveCollisionCache(*pxSerialization, modelPtr, settingsPtr, *set);
+    if (!sp::HullCachePack::Write(packPath, entries)) return 1;
 
-        updated = true;
-    }
-
-    std::filesystem::path markerPath("../assets/cache/collision/" + modelName);
-    if (updated || !std::filesystem::exists(markerPath)) {
-        std::filesystem::create_directories(markerPath.parent_path());
-        std::ofstream(markerPath).close(); // Create or touch the marker file
-    }
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(chrono_clock::now() - startTime).count();
+    size_t cachedCount = entries.size() - cookedCount;
+    std::cout << "hull_compiler: " << entries.size() << " hull sets from " << modelNames.size() << " models ("
+              << cookedCount.load() << " cooked, " << cachedCount << " cached) in " << seconds << "s" << std::endl;
     return 0;
 }
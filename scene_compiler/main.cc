@@ -0,0 +1,66 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "game/CompiledScene.hh"
+
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <picojson/picojson.h>
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("scene_compiler", "Compiles scene json files into the binary .spscene format");
+    options.positional_help("<scene_name>");
+    options.add_options()("scene-name", "", cxxopts::value<std::string>());
+    options.parse_positional({"scene-name"});
+
+    auto optionsResult = options.parse(argc, argv);
+
+    if (!optionsResult.count("scene-name")) {
+        std::cout << options.help() << std::endl;
+        return 1;
+    }
+
+    std::string sceneName = optionsResult["scene-name"].as<std::string>();
+
+    sp::logging::SetLogLevel(sp::logging::Level::Warn);
+
+    auto path = "scenes/" + sceneName + ".json";
+    sp::AssetFileInfo sourceInfo;
+    auto asset = sp::Assets().Load(path)->Get();
+    if (!asset || !sp::Assets().GetFileInfo(path, sourceInfo)) {
+        Errorf("scene_compiler could not load scene: %s", sceneName);
+        return 1;
+    }
+
+    picojson::value root;
+    std::string err = picojson::parse(root, asset->String());
+    if (!err.empty()) {
+        Errorf("scene_compiler failed to parse scene (%s): %s", sceneName, err);
+        return 1;
+    }
+
+    // The compiled output is loaded back and compared against the json before being returned
+    auto output = sp::CompileScene(sceneName, root, asset->Hash(), sourceInfo);
+    if (output.empty()) {
+        Errorf("scene_compiler failed to compile scene: %s", sceneName);
+        return 1;
+    }
+
+    std::ofstream out;
+    if (!sp::Assets().OutputStream("cache/scenes/" + sceneName + ".spscene", out)) {
+        Errorf("scene_compiler could not write compiled scene: %s", sceneName);
+        return 1;
+    }
+    out.write((const char *)output.data(), output.size());
+    out.close();
+    return 0;
+}
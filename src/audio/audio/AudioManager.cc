@@ -202,7 +202,11 @@ namespace sp {
                             auto audioBuffer = decoderCache.Load(asset.get());
                             if (!audioBuffer) {
                                 audioBuffer = make_shared<nqr::AudioData>();
-                                loader.Load(audioBuffer.get(), asset->extension, asset->Buffer());
+                                // libnyquist only decodes from a vector, so bundled assets need a copy here
+                                auto buffer = asset->Buffer();
+                                loader.Load(audioBuffer.get(),
+                                    asset->extension,
+                                    std::vector<uint8_t>(buffer.begin(), buffer.end()));
                                 decoderCache.Register(asset.get(), audioBuffer);
                             }
                             return audioBuffer;
@@ -15,12 +15,26 @@ namespace sp {
             return *hash;
         } else {
             Hash128 output;
-            Assert(buffer.size() <= INT_MAX, "Buffer size overflows int");
-            MurmurHash3_x86_128(buffer.data(), (int)buffer.size(), 0, output.data());
+            Assert(size <= INT_MAX, "Buffer size overflows int");
+            MurmurHash3_x86_128(data, (int)size, 0, output.data());
 
             // This isn't really safe, but this cache isn't too important anyway.
             const_cast<Asset *>(this)->hash = output;
             return output;
         }
     }
+
+    void Asset::SetBuffer(std::vector<uint8_t> &&buffer) {
+        this->buffer = std::move(buffer);
+        this->storage.reset();
+        this->data = this->buffer.data();
+        this->size = this->buffer.size();
+    }
+
+    void Asset::SetView(std::shared_ptr<const void> storage, const uint8_t *data, size_t size) {
+        this->buffer.clear();
+        this->storage = storage;
+        this->data = data;
+        this->size = size;
+    }
 } // namespace sp
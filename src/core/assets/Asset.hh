@@ -11,7 +11,9 @@
 
 #include <atomic>
 #include <filesystem>
+#include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace sp {
@@ -23,24 +25,32 @@ namespace sp {
         return to_lower(extension);
     }
 
+    // Identifies a version of an asset file without reading its contents
+    struct AssetFileInfo {
+        uint64_t size = 0;
+        // Nanoseconds since the file clock epoch, or 0 for assets packed in the asset bundle
+        int64_t modifiedTime = 0;
+    };
+
     class Asset : public NonCopyable {
     public:
         Asset(const std::string &path = "") : path(path), extension(parseFileExtension(path)) {}
 
         std::string String() const {
-            return std::string((char *)buffer.data(), buffer.size());
+            return std::string((const char *)data, size);
         }
 
-        const std::vector<uint8_t> &Buffer() const {
-            return buffer;
+        // The returned view is only valid for the lifetime of this Asset.
+        std::span<const uint8_t> Buffer() const {
+            return {data, size};
         }
 
         const uint8_t *BufferPtr() const {
-            return buffer.data();
+            return data;
         }
 
         const size_t BufferSize() const {
-            return buffer.size();
+            return size;
         }
 
         Hash128 Hash() const;
@@ -49,7 +59,14 @@ namespace sp {
         const std::string extension;
 
     private:
+        void SetBuffer(std::vector<uint8_t> &&buffer);
+        // Points the asset at memory owned by storage, such as a view into the mapped asset bundle.
+        void SetView(std::shared_ptr<const void> storage, const uint8_t *data, size_t size);
+
         std::vector<uint8_t> buffer;
+        std::shared_ptr<const void> storage;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
         std::optional<Hash128> hash;
 
         friend class AssetManager;
@@ -0,0 +1,184 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "AssetBundle.hh"
+
+#include "assets/MappedFile.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace sp {
+    using namespace asset_bundle;
+
+    static uint64_t alignOffset(uint64_t offset, uint64_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static bool entryLess(const Entry &a, std::string_view aPath, const Entry &b, std::string_view bPath) {
+        if (a.pathHash != b.pathHash) return a.pathHash < b.pathHash;
+        return aPath < bPath;
+    }
+
+    std::shared_ptr<const AssetBundle> AssetBundle::Open(const std::string &path) {
+        ZoneScoped;
+        auto mapping = MappedFile::Open(path);
+        if (!mapping) return nullptr;
+
+        if (mapping->Size() < sizeof(Header)) {
+            Errorf("Asset bundle is truncated: %s", path);
+            return nullptr;
+        }
+
+        std::shared_ptr<AssetBundle> bundle(new AssetBundle(path));
+        bundle->mapping = mapping;
+        bundle->header = reinterpret_cast<const Header *>(mapping->Data());
+        if (bundle->header->magic != MAGIC) {
+            Errorf("Asset bundle has invalid header: %s", path);
+            return nullptr;
+        } else if (bundle->header->version != VERSION) {
+            Errorf("Asset bundle has version %u, expected %u: %s", bundle->header->version, VERSION, path);
+            return nullptr;
+        }
+        if (!bundle->validate()) {
+            Errorf("Asset bundle is corrupt: %s", path);
+            return nullptr;
+        }
+        return bundle;
+    }
+
+    bool AssetBundle::validate() {
+        size_t size = mapping->Size();
+        if (header->entriesOffset % alignof(Entry) != 0) return false;
+        if (header->entriesOffset + (uint64_t)header->entryCount * sizeof(Entry) > size) return false;
+        if (header->pathDataOffset + header->pathDataSize > size) return false;
+        entries = reinterpret_cast<const Entry *>(mapping->Data() + header->entriesOffset);
+        pathData = reinterpret_cast<const char *>(mapping->Data() + header->pathDataOffset);
+
+        for (uint32_t i = 0; i < header->entryCount; i++) {
+            auto &entry = entries[i];
+            if ((uint64_t)entry.pathOffset + entry.pathLength > header->pathDataSize) return false;
+            if (entry.offset % PAYLOAD_ALIGNMENT != 0) return false;
+            if (entry.offset > size || entry.size > size - entry.offset) return false;
+            if (entry.pathHash != HashPath(Path(entry))) return false;
+            // Lookups binary search the index, so it must be strictly sorted
+            if (i > 0 && !entryLess(entries[i - 1], Path(entries[i - 1]), entry, Path(entry))) return false;
+        }
+        return true;
+    }
+
+    const Entry *AssetBundle::Find(std::string_view path) const {
+        Entry key = {};
+        key.pathHash = HashPath(path);
+        auto end = entries + header->entryCount;
+        auto it = std::lower_bound(entries, end, key, [](const Entry &a, const Entry &b) {
+            return a.pathHash < b.pathHash;
+        });
+        for (; it != end && it->pathHash == key.pathHash; it++) {
+            if (Path(*it) == path) return it;
+        }
+        return nullptr;
+    }
+
+    std::span<const uint8_t> AssetBundle::Data(const Entry &entry) const {
+        return {mapping->Data() + entry.offset, entry.size};
+    }
+
+    std::string_view AssetBundle::Path(const Entry &entry) const {
+        return {pathData + entry.pathOffset, entry.pathLength};
+    }
+
+    bool AssetBundle::Write(const std::string &outputPath, const std::vector<SourceFile> &files) {
+        ZoneScoped;
+        std::vector<Entry> entries(files.size());
+        std::string pathData;
+        for (size_t i = 0; i < files.size(); i++) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(files[i].source, ec);
+            if (ec) {
+                Errorf("Failed to read asset bundle source file %s: %s", files[i].source.string(), ec.message());
+                return false;
+            }
+            auto &entry = entries[i];
+            entry.pathHash = HashPath(files[i].path);
+            entry.size = size;
+            entry.pathOffset = pathData.size();
+            entry.pathLength = files[i].path.size();
+            pathData += files[i].path;
+        }
+
+        std::vector<size_t> order(files.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return entryLess(entries[a], files[a].path, entries[b], files[b].path);
+        });
+        for (size_t i = 1; i < order.size(); i++) {
+            if (files[order[i - 1]].path == files[order[i]].path) {
+                Errorf("Duplicate asset bundle path: %s", files[order[i]].path);
+                return false;
+            }
+        }
+
+        Header header = {};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.entryCount = entries.size();
+        header.entriesOffset = sizeof(Header);
+        header.pathDataSize = pathData.size();
+        header.pathDataOffset = header.entriesOffset + sizeof(Entry) * entries.size();
+
+        // Payloads are laid out in the order they were listed so related files stay close together on disk
+        uint64_t offset = header.pathDataOffset + header.pathDataSize;
+        for (auto &entry : entries) {
+            offset = alignOffset(offset, PAYLOAD_ALIGNMENT);
+            entry.offset = offset;
+            offset += entry.size;
+        }
+
+        std::vector<Entry> sortedEntries;
+        sortedEntries.reserve(entries.size());
+        for (auto i : order) {
+            sortedEntries.emplace_back(entries[i]);
+        }
+
+        std::ofstream out(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Errorf("Failed to open asset bundle for writing: %s", outputPath);
+            return false;
+        }
+        out.write((const char *)&header, sizeof(header));
+        out.write((const char *)sortedEntries.data(), sizeof(Entry) * sortedEntries.size());
+        out.write(pathData.data(), pathData.size());
+
+        std::vector<char> buffer;
+        uint64_t written = header.pathDataOffset + header.pathDataSize;
+        for (size_t i = 0; i < files.size(); i++) {
+            static const char padding[PAYLOAD_ALIGNMENT] = {};
+            out.write(padding, entries[i].offset - written);
+
+            std::ifstream in(files[i].source, std::ios::in | std::ios::binary);
+            buffer.resize(entries[i].size);
+            if (!in.read(buffer.data(), buffer.size())) {
+                Errorf("Failed to read asset bundle source file: %s", files[i].source.string());
+                return false;
+            }
+            out.write(buffer.data(), buffer.size());
+            written = entries[i].offset + entries[i].size;
+        }
+        out.close();
+        if (!out) {
+            Errorf("Failed to write asset bundle: %s", outputPath);
+            return false;
+        }
+        return true;
+    }
+} // namespace sp
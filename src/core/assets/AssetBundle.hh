@@ -0,0 +1,103 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sp {
+    class MappedFile;
+
+    /**
+     * Asset bundles (assets.spdata) pack the bundled assets of a release build into a single file that is mapped
+     * into memory once at startup. Assets loaded from the bundle are views into the mapping and are never copied.
+     *
+     * Layout (all offsets are in bytes from the start of the file, little endian):
+     *   Header
+     *   Entry[entryCount]      Sorted by path hash, then by path
+     *   char[pathDataSize]     Path strings, not null terminated
+     *   File payloads          Each payload starts on a PAYLOAD_ALIGNMENT boundary
+     */
+    namespace asset_bundle {
+        static const uint32_t MAGIC = 0x42415053; // "SPAB"
+        static const uint32_t VERSION = 1;
+        static const size_t PAYLOAD_ALIGNMENT = 64;
+
+        struct Header {
+            uint32_t magic, version;
+            uint32_t entryCount, pathDataSize;
+            uint64_t entriesOffset, pathDataOffset;
+        };
+
+        struct Entry {
+            uint64_t pathHash;
+            uint64_t offset, size;
+            uint32_t pathOffset, pathLength;
+        };
+
+        // FNV-1a, stable across platforms and builds so the index can be generated offline
+        inline uint64_t HashPath(std::string_view path) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (char ch : path) {
+                hash ^= (uint8_t)ch;
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        static_assert(sizeof(Header) % 8 == 0, "Asset bundle header must be 8 byte aligned");
+        static_assert(sizeof(Entry) == 32, "Unexpected asset bundle entry size");
+    } // namespace asset_bundle
+
+    class AssetBundle : public NonCopyable {
+    public:
+        struct SourceFile {
+            std::string path; // Path inside the bundle, relative to the assets directory
+            std::filesystem::path source;
+        };
+
+        // Validates the index, returning nullptr if the bundle is missing or anything is out of bounds.
+        static std::shared_ptr<const AssetBundle> Open(const std::string &path);
+
+        // Writes a new bundle containing the source files. Returns false if any file can't be read.
+        static bool Write(const std::string &outputPath, const std::vector<SourceFile> &files);
+
+        // Returns nullptr if the path isn't in the bundle.
+        const asset_bundle::Entry *Find(std::string_view path) const;
+
+        bool Contains(std::string_view path) const {
+            return Find(path) != nullptr;
+        }
+
+        std::span<const uint8_t> Data(const asset_bundle::Entry &entry) const;
+        std::string_view Path(const asset_bundle::Entry &entry) const;
+
+        std::span<const asset_bundle::Entry> Entries() const {
+            return {entries, header->entryCount};
+        }
+
+        const std::string path;
+
+    private:
+        AssetBundle(const std::string &path) : path(path) {}
+
+        bool validate();
+
+        std::shared_ptr<const MappedFile> mapping;
+        const asset_bundle::Header *header = nullptr;
+        const asset_bundle::Entry *entries = nullptr;
+        const char *pathData = nullptr;
+    };
+} // namespace sp
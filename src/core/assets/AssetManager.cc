@@ -7,13 +7,11 @@
 
 #include "AssetManager.hh"
 
-extern "C" {
-#include <microtar.h>
-}
-
 #include "assets/Asset.hh"
+#include "assets/AssetBundle.hh"
 #include "assets/Gltf.hh"
 #include "assets/Image.hh"
+#include "assets/MappedFile.hh"
 #include "assets/PhysicsInfo.hh"
 #include "core/Tracing.hh"
 #include "ecs/Components.hh"
@@ -49,11 +47,14 @@ namespace sp {
     }
 
     const char *ASSETS_DIR = "../assets/";
-    const char *ASSETS_TAR = "./assets.spdata";
+    const char *ASSETS_BUNDLE = "./assets.spdata";
 
-    AssetManager::AssetManager() : RegisteredThread("AssetCleanup", 10.0), workQueue("AssetWorker", 4) {
+    AssetManager::AssetManager()
+        : RegisteredThread("AssetCleanup", 10.0),
+          workQueue("AssetWorker", 4, std::chrono::milliseconds(5), DispatchScheduler::WorkStealing) {
 #ifdef SP_PACKAGE_RELEASE
-        UpdateTarIndex();
+        bundle = AssetBundle::Open(ASSETS_BUNDLE);
+        if (!bundle) Warnf("Failed to open asset bundle at: %s", ASSETS_BUNDLE);
 #endif
         StartThread();
     }
@@ -77,23 +78,6 @@ namespace sp {
         }
     }
 
-    void AssetManager::UpdateTarIndex() {
-        mtar_t tar;
-        if (mtar_open(&tar, ASSETS_TAR, "r") != MTAR_ESUCCESS) {
-            Warnf("Failed to open asset bundle at: %s", ASSETS_TAR);
-            return;
-        }
-
-        mtar_header_t h;
-        while (mtar_read_header(&tar, &h) != MTAR_ENULLRECORD) {
-            size_t offset = tar.pos + 512 * sizeof(unsigned char);
-            tarIndex[h.name] = std::make_pair(offset, h.size);
-            mtar_next(&tar);
-        }
-
-        mtar_close(&tar);
-    }
-
     bool AssetManager::InputStream(const std::string &path, AssetType type, std::ifstream &stream, size_t *size) {
         switch (type) {
         case AssetType::Bundled: {
@@ -111,16 +95,15 @@ namespace sp {
                 }
             }
 
-#ifdef SP_PACKAGE_RELEASE
-            stream.open(ASSETS_TAR, std::ios::in | std::ios::binary);
-
-            if (stream && tarIndex.count(path)) {
-                auto indexData = tarIndex[path];
-                if (size) *size = indexData.second;
-                stream.seekg(indexData.first, std::ios::beg);
-                return true;
+            const asset_bundle::Entry *entry = bundle ? bundle->Find(path) : nullptr;
+            if (entry) {
+                stream.open(bundle->path, std::ios::in | std::ios::binary);
+                if (stream) {
+                    if (size) *size = entry->size;
+                    stream.seekg(entry->offset, std::ios::beg);
+                    return true;
+                }
             }
-#endif
 
             return false;
         }
@@ -148,6 +131,34 @@ namespace sp {
         return !!stream;
     }
 
+    bool AssetManager::GetFileInfo(const std::string &path, AssetFileInfo &info) {
+        std::string filename = ASSETS_DIR + path;
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(filename, ec)) {
+            auto size = std::filesystem::file_size(filename, ec);
+            if (ec) return false;
+            auto modifiedTime = std::filesystem::last_write_time(filename, ec);
+            if (ec) return false;
+            info.size = size;
+            info.modifiedTime =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(modifiedTime.time_since_epoch()).count();
+            return true;
+        }
+
+        const asset_bundle::Entry *entry = bundle ? bundle->Find(path) : nullptr;
+        if (entry) {
+            info.size = entry->size;
+            info.modifiedTime = 0;
+            return true;
+        }
+        return false;
+    }
+
+    std::shared_ptr<const MappedFile> AssetManager::MapFile(const std::string &path) {
+        Assert(!path.empty(), "AssetManager::MapFile called with empty path");
+        return MappedFile::Open(ASSETS_DIR + path);
+    }
+
     AsyncPtr<Asset> AssetManager::Load(const std::string &path, AssetType type, bool reload) {
         Assert(!path.empty(), "AssetManager::Load called with empty path");
 
@@ -163,16 +174,30 @@ namespace sp {
             asset = workQueue.Dispatch<Asset>([this, path, type] {
                 ZoneScopedN("LoadAsset");
                 ZoneStr(path);
+                if (type == AssetType::Bundled && bundle) {
+                    std::error_code ec;
+                    if (!std::filesystem::is_regular_file(ASSETS_DIR + path, ec)) {
+                        // Reference the bundle directly instead of copying the file contents out of the mapping
+                        auto *entry = bundle->Find(path);
+                        if (entry) {
+                            auto asset = std::make_shared<Asset>(path);
+                            auto data = bundle->Data(*entry);
+                            asset->SetView(bundle, data.data(), data.size());
+                            return asset;
+                        }
+                    }
+                }
+
                 std::ifstream in;
                 size_t size;
-
                 if (InputStream(path, type, in, &size)) {
                     auto asset = std::make_shared<Asset>(path);
-                    asset->buffer.resize(size);
-                    in.read((char *)asset->buffer.data(), size);
+                    std::vector<uint8_t> buffer(size);
+                    in.read((char *)buffer.data(), size);
                     Assertf(in.good(), "Failed to read whole asset file: %s", path);
                     in.close();
 
+                    asset->SetBuffer(std::move(buffer));
                     return asset;
                 } else {
                     Warnf("Asset does not exist: %s", path);
@@ -196,16 +221,16 @@ namespace sp {
         if (std::filesystem::is_regular_file(ASSETS_DIR + path, ec)) return path;
         path = "models/" + name + ".gltf";
         if (std::filesystem::is_regular_file(ASSETS_DIR + path, ec)) return path;
-#ifdef SP_PACKAGE_RELEASE
-        path = "models/" + name + "/" + name + ".glb";
-        if (tarIndex.count(path) > 0) return path;
-        path = "models/" + name + ".glb";
-        if (tarIndex.count(path) > 0) return path;
-        path = "models/" + name + "/" + name + ".gltf";
-        if (tarIndex.count(path) > 0) return path;
-        path = "models/" + name + ".gltf";
-        if (tarIndex.count(path) > 0) return path;
-#endif
+        if (bundle) {
+            path = "models/" + name + "/" + name + ".glb";
+            if (bundle->Contains(path)) return path;
+            path = "models/" + name + ".glb";
+            if (bundle->Contains(path)) return path;
+            path = "models/" + name + "/" + name + ".gltf";
+            if (bundle->Contains(path)) return path;
+            path = "models/" + name + ".gltf";
+            if (bundle->Contains(path)) return path;
+        }
         return "";
     }
 
@@ -258,14 +283,14 @@ namespace sp {
         if (std::filesystem::is_regular_file(ASSETS_DIR + path, ec)) return path;
         path = "models/" + name + ".physics.json";
         if (std::filesystem::is_regular_file(ASSETS_DIR + path, ec)) return path;
-#ifdef SP_PACKAGE_RELEASE
-        path = "models/" + name + "/" + name + ".physics.json";
-        if (tarIndex.count(path) > 0) return path;
-        path = "models/" + name + "/physics.json";
-        if (tarIndex.count(path) > 0) return path;
-        path = "models/" + name + ".physics.json";
-        if (tarIndex.count(path) > 0) return path;
-#endif
+        if (bundle) {
+            path = "models/" + name + "/" + name + ".physics.json";
+            if (bundle->Contains(path)) return path;
+            path = "models/" + name + "/physics.json";
+            if (bundle->Contains(path)) return path;
+            path = "models/" + name + ".physics.json";
+            if (bundle->Contains(path)) return path;
+        }
         return "";
     }
 
@@ -301,7 +326,9 @@ namespace sp {
 
         auto physicsInfo = LoadPhysicsInfo(modelName);
 
-        return workQueue.Dispatch<HullSettings>(physicsInfo,
+        // Hull settings only feed physics hull cooking, which shouldn't hold up models and textures
+        return workQueue.Dispatch<HullSettings>(DispatchOptions{DispatchPriority::Background},
+            physicsInfo,
             [modelName, meshName](std::shared_ptr<const PhysicsInfo> physicsInfo) {
                 if (!physicsInfo) {
                     Logf("PhysicsInfo not found: %s", modelName);
@@ -24,8 +24,11 @@
 
 namespace sp {
     class Asset;
+    class AssetBundle;
+    struct AssetFileInfo;
     class Gltf;
     class Image;
+    class MappedFile;
     class PhysicsInfo;
     struct HullSettings;
 
@@ -51,11 +54,18 @@ namespace sp {
 
         bool InputStream(const std::string &path, AssetType type, std::ifstream &stream, size_t *size = nullptr);
         bool OutputStream(const std::string &path, std::ofstream &stream);
+        // Looks up the size and modified time of a bundled asset without reading it.
+        // Loose files take precedence over the asset bundle, matching InputStream().
+        bool GetFileInfo(const std::string &path, AssetFileInfo &info);
+
+        // Maps a bundled asset directly into memory without copying it.
+        // Returns nullptr if the asset is not a loose file. Assets packed in the asset bundle are always loaded
+        // without copying, so Load() should be used for those instead.
+        std::shared_ptr<const MappedFile> MapFile(const std::string &path);
 
     private:
         void Frame() override;
 
-        void UpdateTarIndex();
         std::string FindGltfByName(const std::string &name);
         std::string FindPhysicsByName(const std::string &name);
 
@@ -75,7 +85,8 @@ namespace sp {
         std::mutex externalGltfMutex;
         robin_hood::unordered_flat_map<std::string, std::string> externalGltfPaths;
 
-        robin_hood::unordered_flat_map<std::string, std::pair<size_t, size_t>> tarIndex;
+        // Only opened in SP_PACKAGE_RELEASE builds, loose files in the assets directory take priority
+        std::shared_ptr<const AssetBundle> bundle;
     };
 
     AssetManager &Assets();
@@ -0,0 +1,467 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+#include "core/EnumTypes.hh"
+#include "core/Logging.hh"
+#include "ecs/EntityRef.hh"
+#include "ecs/SignalRef.hh"
+#include "ecs/StructMetadata.hh"
+
+#include <cstring>
+#include <glm/glm.hpp>
+#include <optional>
+#include <robin_hood.h>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/**
+ * A compact binary encoding generated from the same StructMetadata as the JSON serializer in JsonHelpers.hh.
+ *
+ * Values are written in native little-endian byte order with no field names or default-value elision, so every
+ * field of a struct is always present. Types with custom StructMetadata::SaveBinary/LoadBinary hooks append their
+ * extra data after their fields. Readers validate sizes, enum values, and bools, and return false on bad input.
+ *
+ * SchemaHash<T>() identifies the encoded layout of a type, and changes whenever a field is added, removed, renamed,
+ * or changes type. VERSION must be incremented if any custom hook changes its encoding.
+ */
+namespace sp::binary {
+    static const uint32_t MAGIC = 0x4e425053; // "SPBN"
+    static const uint32_t VERSION = 1;
+
+    class Writer {
+    public:
+        Writer(std::vector<uint8_t> &buffer) : buffer(buffer) {}
+
+        void Write(const void *data, size_t size) {
+            auto *bytes = static_cast<const uint8_t *>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+
+        template<typename T>
+        void WriteRaw(const T &value) {
+            static_assert(std::is_trivially_copyable<T>(), "WriteRaw values must be trivially copyable");
+            Write(&value, sizeof(T));
+        }
+
+        // Overwrites a value previously written at offset, e.g. to fill in a size once it is known
+        template<typename T>
+        void Patch(size_t offset, const T &value) {
+            static_assert(std::is_trivially_copyable<T>(), "Patch values must be trivially copyable");
+            Assertf(offset + sizeof(T) <= buffer.size(), "Binary patch out of range: %u", offset);
+            std::memcpy(buffer.data() + offset, &value, sizeof(T));
+        }
+
+        void WriteVarint(uint64_t value) {
+            while (value >= 0x80) {
+                buffer.push_back((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back((uint8_t)value);
+        }
+
+        void WriteString(std::string_view str) {
+            WriteVarint(str.size());
+            Write(str.data(), str.size());
+        }
+
+        void WriteHeader() {
+            WriteRaw(MAGIC);
+            WriteRaw(VERSION);
+        }
+
+        size_t Size() const {
+            return buffer.size();
+        }
+
+    private:
+        std::vector<uint8_t> &buffer;
+    };
+
+    class Reader {
+    public:
+        Reader() {}
+        Reader(const uint8_t *data, size_t size) : data(data), size(size) {}
+        Reader(const std::vector<uint8_t> &buffer) : Reader(buffer.data(), buffer.size()) {}
+
+        bool Read(void *dst, size_t count) {
+            if (count > Remaining()) return false;
+            if (count > 0) std::memcpy(dst, data + offset, count);
+            offset += count;
+            return true;
+        }
+
+        template<typename T>
+        bool ReadRaw(T &value) {
+            static_assert(std::is_trivially_copyable<T>(), "ReadRaw values must be trivially copyable");
+            return Read(&value, sizeof(T));
+        }
+
+        bool ReadVarint(uint64_t &value) {
+            value = 0;
+            for (size_t shift = 0; shift < 64; shift += 7) {
+                if (offset >= size) return false;
+                uint8_t byte = data[offset++];
+                value |= (uint64_t)(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+            return false;
+        }
+
+        bool ReadString(std::string &str) {
+            uint64_t length;
+            if (!ReadVarint(length) || length > Remaining()) return false;
+            str.assign(reinterpret_cast<const char *>(data + offset), length);
+            offset += length;
+            return true;
+        }
+
+        bool Skip(size_t count) {
+            if (count > Remaining()) return false;
+            offset += count;
+            return true;
+        }
+
+        // Splits the next count bytes off into their own Reader, and skips past them
+        bool Slice(size_t count, Reader &slice) {
+            if (count > Remaining()) return false;
+            slice = Reader(data + offset, count);
+            offset += count;
+            return true;
+        }
+
+        bool ReadHeader() {
+            uint32_t magic = 0, version = 0;
+            if (!ReadRaw(magic) || magic != MAGIC) {
+                Errorf("Invalid binary data header");
+                return false;
+            } else if (!ReadRaw(version) || version != VERSION) {
+                Errorf("Unsupported binary data version: %u, expected %u", version, VERSION);
+                return false;
+            }
+            return true;
+        }
+
+        size_t Remaining() const {
+            return size - offset;
+        }
+
+    private:
+        const uint8_t *data = nullptr;
+        size_t size = 0, offset = 0;
+    };
+
+    namespace detail {
+        template<typename T>
+        struct is_optional : std::false_type {};
+        template<typename T>
+        struct is_optional<std::optional<T>> : std::true_type {};
+
+        template<typename T>
+        struct is_unordered_map : std::false_type {};
+        template<typename K, typename V>
+        struct is_unordered_map<robin_hood::unordered_flat_map<K, V>> : std::true_type {};
+        template<typename K, typename V>
+        struct is_unordered_map<robin_hood::unordered_node_map<K, V>> : std::true_type {};
+
+        template<typename T>
+        struct is_variant : std::false_type {};
+        template<typename... Tn>
+        struct is_variant<std::variant<Tn...>> : std::true_type {};
+
+        template<typename T>
+        inline bool IsValidEnum(T value) {
+            if constexpr (is_flags_enum<T>()) {
+                magic_enum::underlying_type_t<T> mask = 0;
+                for (auto &flag : magic_enum::enum_values<T>()) {
+                    mask |= static_cast<magic_enum::underlying_type_t<T>>(flag);
+                }
+                return (static_cast<magic_enum::underlying_type_t<T>>(value) & ~mask) == 0;
+            } else {
+                return magic_enum::enum_contains<T>(value);
+            }
+        }
+
+        template<typename V, size_t I = 0>
+        inline bool LoadVariant(V &dst, size_t index, Reader &src);
+    } // namespace detail
+
+    inline Hash64 HashCombine(Hash64 seed, uint64_t value) {
+        return seed ^ (robin_hood::hash_int(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+
+    inline Hash64 HashCombine(Hash64 seed, std::string_view str) {
+        return HashCombine(seed, robin_hood::hash_bytes(str.data(), str.size()));
+    }
+
+    // Default Save handler for structs with StructMetadata, enums, and all integer and float types
+    template<typename T>
+    inline void Save(Writer &dst, const T &src) {
+        if constexpr (std::is_same_v<T, bool>) {
+            dst.WriteRaw<uint8_t>(src ? 1 : 0);
+        } else if constexpr (std::is_enum<T>() || std::is_arithmetic<T>()) {
+            dst.WriteRaw(src);
+        } else if constexpr (is_glm_vec<T>() || std::is_same_v<T, glm::quat> || std::is_same_v<T, glm::mat3>) {
+            dst.WriteRaw(src);
+        } else if constexpr (std::is_same_v<T, Tecs::Entity>) {
+            dst.WriteRaw(src);
+        } else if constexpr (detail::is_optional<T>()) {
+            Save(dst, src.has_value());
+            if (src) Save(dst, *src);
+        } else if constexpr (is_vector<T>()) {
+            dst.WriteVarint(src.size());
+            for (auto &item : src) {
+                Save(dst, item);
+            }
+        } else if constexpr (detail::is_unordered_map<T>()) {
+            dst.WriteVarint(src.size());
+            for (auto &[key, value] : src) {
+                Save(dst, key);
+                Save(dst, value);
+            }
+        } else if constexpr (detail::is_variant<T>()) {
+            dst.WriteVarint(src.index());
+            std::visit(
+                [&](auto &value) {
+                    Save(dst, value);
+                },
+                src);
+        } else {
+            auto &metadata = ecs::StructMetadata::Get<T>();
+            for (auto &field : metadata.fields) {
+                if (field.name.empty() && field.type == metadata.type) continue;
+                field.SaveBinary(dst, &src);
+            }
+            ecs::StructMetadata::SaveBinary(dst, src);
+        }
+    }
+
+    // Save() specializations for native and complex types
+    template<>
+    inline void Save(Writer &dst, const sp::angle_t &src) {
+        dst.WriteRaw(src.radians());
+    }
+    template<>
+    inline void Save(Writer &dst, const sp::color_t &src) {
+        dst.WriteRaw(src.color);
+    }
+    template<>
+    inline void Save(Writer &dst, const sp::color_alpha_t &src) {
+        dst.WriteRaw(src.color);
+    }
+    template<>
+    inline void Save(Writer &dst, const std::string &src) {
+        dst.WriteString(src);
+    }
+    template<>
+    inline void Save(Writer &dst, const ecs::Name &src) {
+        dst.WriteString(src.String());
+    }
+    template<>
+    inline void Save(Writer &dst, const ecs::EntityRef &src) {
+        dst.WriteString(src.Name().String());
+    }
+    template<>
+    inline void Save(Writer &dst, const ecs::SignalRef &src) {
+        dst.WriteString(src.String());
+    }
+
+    // Default Load handler for structs with StructMetadata, enums, and all integer and float types
+    template<typename T>
+    inline bool Load(T &dst, Reader &src) {
+        if constexpr (std::is_same_v<T, bool>) {
+            uint8_t value;
+            if (!src.ReadRaw(value) || value > 1) return false;
+            dst = value != 0;
+            return true;
+        } else if constexpr (std::is_enum<T>()) {
+            T value;
+            if (!src.ReadRaw(value) || !detail::IsValidEnum(value)) return false;
+            dst = value;
+            return true;
+        } else if constexpr (std::is_arithmetic<T>()) {
+            return src.ReadRaw(dst);
+        } else if constexpr (is_glm_vec<T>() || std::is_same_v<T, glm::quat> || std::is_same_v<T, glm::mat3>) {
+            return src.ReadRaw(dst);
+        } else if constexpr (std::is_same_v<T, Tecs::Entity>) {
+            return src.ReadRaw(dst);
+        } else if constexpr (detail::is_optional<T>()) {
+            bool hasValue;
+            if (!Load(hasValue, src)) return false;
+            if (!hasValue) {
+                dst.reset();
+                return true;
+            }
+            typename T::value_type value = {};
+            if (!Load(value, src)) return false;
+            dst = std::move(value);
+            return true;
+        } else if constexpr (is_vector<T>()) {
+            uint64_t count;
+            // Every supported item type encodes to at least 1 byte, so larger counts are corrupt
+            if (!src.ReadVarint(count) || count > src.Remaining()) return false;
+            dst.clear();
+            dst.resize(count);
+            for (auto &item : dst) {
+                if (!Load(item, src)) return false;
+            }
+            return true;
+        } else if constexpr (detail::is_unordered_map<T>()) {
+            uint64_t count;
+            if (!src.ReadVarint(count) || count > src.Remaining()) return false;
+            dst.clear();
+            dst.reserve(count);
+            for (uint64_t i = 0; i < count; i++) {
+                typename T::key_type key = {};
+                typename T::mapped_type value = {};
+                if (!Load(key, src) || !Load(value, src)) return false;
+                dst[std::move(key)] = std::move(value);
+            }
+            return true;
+        } else if constexpr (detail::is_variant<T>()) {
+            uint64_t index;
+            if (!src.ReadVarint(index) || index >= std::variant_size_v<T>) return false;
+            return detail::LoadVariant(dst, index, src);
+        } else {
+            auto &metadata = ecs::StructMetadata::Get<T>();
+            for (auto &field : metadata.fields) {
+                if (field.name.empty() && field.type == metadata.type) continue;
+                if (!field.LoadBinary(&dst, src)) return false;
+            }
+            return ecs::StructMetadata::LoadBinary(dst, src);
+        }
+    }
+
+    // Load() specializations for native and complex types
+    template<>
+    inline bool Load(sp::angle_t &dst, Reader &src) {
+        return src.ReadRaw(dst.radians());
+    }
+    template<>
+    inline bool Load(sp::color_t &dst, Reader &src) {
+        return src.ReadRaw(dst.color);
+    }
+    template<>
+    inline bool Load(sp::color_alpha_t &dst, Reader &src) {
+        return src.ReadRaw(dst.color);
+    }
+    template<>
+    inline bool Load(std::string &dst, Reader &src) {
+        return src.ReadString(dst);
+    }
+    template<>
+    inline bool Load(ecs::Name &dst, Reader &src) {
+        std::string name;
+        if (!src.ReadString(name)) return false;
+        dst = ecs::Name(name, ecs::Name());
+        return name.empty() == !dst;
+    }
+    template<>
+    inline bool Load(ecs::EntityRef &dst, Reader &src) {
+        ecs::Name name;
+        if (!Load(name, src)) return false;
+        dst = name;
+        return true;
+    }
+    template<>
+    inline bool Load(ecs::SignalRef &dst, Reader &src) {
+        std::string signalStr;
+        if (!src.ReadString(signalStr)) return false;
+        dst = ecs::SignalRef(signalStr);
+        return signalStr.empty() == !dst;
+    }
+
+    namespace detail {
+        template<typename V, size_t I>
+        inline bool LoadVariant(V &dst, size_t index, Reader &src) {
+            if constexpr (I < std::variant_size_v<V>) {
+                if (index != I) return LoadVariant<V, I + 1>(dst, index, src);
+                std::variant_alternative_t<I, V> value = {};
+                if (!Load(value, src)) return false;
+                dst = std::move(value);
+                return true;
+            } else {
+                return false;
+            }
+        }
+
+        template<typename T>
+        inline Hash64 TypeSchemaHash();
+
+        template<typename T>
+        struct VariantSchemaHash;
+        template<typename... Tn>
+        struct VariantSchemaHash<std::variant<Tn...>> {
+            static Hash64 Get() {
+                Hash64 hash = HashCombine(0, "variant");
+                ((hash = HashCombine(hash, TypeSchemaHash<Tn>())), ...);
+                return hash;
+            }
+        };
+
+        template<typename T>
+        inline Hash64 TypeSchemaHash() {
+            if constexpr (std::is_same_v<T, bool>) {
+                return HashCombine(0, "bool");
+            } else if constexpr (std::is_enum<T>()) {
+                Hash64 hash = HashCombine(HashCombine(0, "enum"), sizeof(T));
+                for (auto &[value, name] : magic_enum::enum_entries<T>()) {
+                    hash = HashCombine(HashCombine(hash, name), (uint64_t)value);
+                }
+                return hash;
+            } else if constexpr (std::is_arithmetic<T>()) {
+                Hash64 hash = HashCombine(0, std::is_floating_point<T>() ? "float" : "int");
+                return HashCombine(HashCombine(hash, std::is_signed_v<T>), sizeof(T));
+            } else if constexpr (is_glm_vec<T>()) {
+                Hash64 hash = HashCombine(HashCombine(0, "vec"), T::length());
+                return HashCombine(hash, TypeSchemaHash<typename T::value_type>());
+            } else if constexpr (std::is_same_v<T, glm::quat>) {
+                return HashCombine(0, "quat");
+            } else if constexpr (std::is_same_v<T, glm::mat3>) {
+                return HashCombine(0, "mat3");
+            } else if constexpr (std::is_same_v<T, sp::angle_t>) {
+                return HashCombine(0, "angle");
+            } else if constexpr (std::is_same_v<T, sp::color_t>) {
+                return HashCombine(0, "color");
+            } else if constexpr (std::is_same_v<T, sp::color_alpha_t>) {
+                return HashCombine(0, "color_alpha");
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return HashCombine(0, "string");
+            } else if constexpr (std::is_same_v<T, ecs::Name>) {
+                return HashCombine(0, "name");
+            } else if constexpr (std::is_same_v<T, ecs::EntityRef>) {
+                return HashCombine(0, "entity_ref");
+            } else if constexpr (std::is_same_v<T, ecs::SignalRef>) {
+                return HashCombine(0, "signal_ref");
+            } else if constexpr (std::is_same_v<T, Tecs::Entity>) {
+                return HashCombine(HashCombine(0, "entity"), sizeof(T));
+            } else if constexpr (is_optional<T>()) {
+                return HashCombine(HashCombine(0, "optional"), TypeSchemaHash<typename T::value_type>());
+            } else if constexpr (is_vector<T>()) {
+                return HashCombine(HashCombine(0, "vector"), TypeSchemaHash<typename T::value_type>());
+            } else if constexpr (is_unordered_map<T>()) {
+                Hash64 hash = HashCombine(HashCombine(0, "map"), TypeSchemaHash<typename T::key_type>());
+                return HashCombine(hash, TypeSchemaHash<typename T::mapped_type>());
+            } else if constexpr (is_variant<T>()) {
+                return VariantSchemaHash<T>::Get();
+            } else {
+                return ecs::StructMetadata::Get<T>().SchemaHash();
+            }
+        }
+    } // namespace detail
+
+    // Returns a stable hash of the binary layout of T, derived from its field names and types
+    template<typename T>
+    inline Hash64 SchemaHash() {
+        static const Hash64 hash = detail::TypeSchemaHash<T>();
+        return hash;
+    }
+} // namespace sp::binary
@@ -52,9 +52,14 @@ namespace sp {
 
             ReadT Read(size_t i) const;
 
+            // Converts elements [first, first + n) into output, which may be strided to write directly into an
+            // interleaved vertex struct. The element type is resolved once per call rather than once per element.
+            void ReadRange(size_t first, size_t n, ReadT *output, size_t outputStride = sizeof(ReadT)) const;
+
         private:
             const tinygltf::Buffer *buffer = nullptr;
             int typeIndex = -1;
+            bool normalized = false;
             size_t count = 0;
             size_t componentCount = 0;
             size_t byteOffset = 0;
@@ -80,9 +85,9 @@ namespace sp {
                 int materialIndex;
                 Accessor<glm::vec3> positionBuffer;
                 Accessor<glm::vec3> normalBuffer;
-                Accessor<glm::vec2 /*, glm::u16vec2, glm::u8vec2, glm::i16vec2, glm::i8vec2*/> texcoordBuffer;
+                Accessor<glm::vec2, glm::u16vec2, glm::u8vec2, glm::i16vec2, glm::i8vec2> texcoordBuffer;
                 Accessor<glm::u16vec4, glm::u8vec4> jointsBuffer;
-                Accessor<glm::vec4 /*, glm::u16vec4, glm::u8vec4*/> weightsBuffer;
+                Accessor<glm::vec4, glm::u16vec4, glm::u8vec4> weightsBuffer;
             };
 
             Mesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh);
@@ -9,10 +9,18 @@
 
 #include "assets/Gltf.hh"
 
+#include <algorithm>
+#include <cstring>
 #include <glm/glm.hpp>
+#include <limits>
 #include <memory>
 #include <type_traits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SP_GLTF_SSE2
+#endif
+
 // Hacky defines to prevent tinygltf from including windows.h and polluting the namespace
 #ifdef _WIN32
     #define UNDEFINE_WIN32
@@ -79,6 +87,168 @@ namespace sp::gltf {
                 return GltfTypeInfo<I + 1, Tn...>(type, componentType);
             }
         }
+
+        template<typename T>
+        struct gltfComponents {
+            using type = T;
+            static constexpr size_t count = 1;
+        };
+        template<glm::length_t L, typename T, glm::precision P>
+        struct gltfComponents<glm::vec<L, T, P>> {
+            using type = T;
+            static constexpr size_t count = L;
+        };
+        template<glm::length_t C, glm::length_t R, typename T, glm::precision P>
+        struct gltfComponents<glm::mat<C, R, T, P>> {
+            using type = T;
+            static constexpr size_t count = C * R;
+        };
+
+        template<typename DstT, typename SrcT>
+        static inline DstT ConvertComponent(SrcT value, bool normalized) {
+            if constexpr (std::is_floating_point_v<DstT> && std::is_integral_v<SrcT>) {
+                if (normalized) {
+                    // Signed values are clamped so both the minimum and minimum + 1 map to -1.0, as per the glTF spec
+                    constexpr DstT scale = DstT(1) / std::numeric_limits<SrcT>::max();
+                    if constexpr (std::is_signed_v<SrcT>) {
+                        return std::max((DstT)value * scale, DstT(-1));
+                    } else {
+                        return (DstT)value * scale;
+                    }
+                }
+            }
+            return static_cast<DstT>(value);
+        }
+
+#ifdef SP_GLTF_SSE2
+        // Widens tightly packed 8 or 16-bit indices 16 bytes at a time. Returns the number of elements converted.
+        template<typename SrcT>
+        static inline size_t WidenIndicesSse2(const uint8_t *src, uint8_t *dst, size_t n) {
+            const __m128i zero = _mm_setzero_si128();
+            constexpr size_t batch = sizeof(__m128i) / sizeof(SrcT);
+            size_t i = 0;
+            for (; i + batch <= n; i += batch) {
+                __m128i v = _mm_loadu_si128((const __m128i *)(src + i * sizeof(SrcT)));
+                __m128i *out = (__m128i *)(dst + i * sizeof(uint32_t));
+                if constexpr (sizeof(SrcT) == 1) {
+                    __m128i lo = _mm_unpacklo_epi8(v, zero);
+                    __m128i hi = _mm_unpackhi_epi8(v, zero);
+                    _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+                    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+                    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+                    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+                } else {
+                    _mm_storeu_si128(out, _mm_unpacklo_epi16(v, zero));
+                    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(v, zero));
+                }
+            }
+            return i;
+        }
+
+        // Converts up to 4 8 or 16-bit integer components to floats per element, matching ConvertComponent exactly.
+        template<size_t N, typename SrcT>
+        static inline size_t ConvertToFloatSse2(const uint8_t *src,
+            size_t srcStride,
+            uint8_t *dst,
+            size_t dstStride,
+            size_t n,
+            bool normalized) {
+            static_assert(N <= 4 && sizeof(SrcT) <= 2, "Unsupported SSE2 conversion");
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 scale = _mm_set1_ps(normalized ? 1.0f / std::numeric_limits<SrcT>::max() : 1.0f);
+            const __m128 minValue = _mm_set1_ps(normalized ? -1.0f : -std::numeric_limits<float>::max());
+            alignas(16) float result[4];
+            for (size_t i = 0; i < n; i++) {
+                uint64_t raw = 0;
+                std::memcpy(&raw, src + i * srcStride, N * sizeof(SrcT));
+                __m128i v = _mm_loadl_epi64((const __m128i *)&raw);
+                if constexpr (std::is_same_v<SrcT, uint8_t>) {
+                    v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+                } else if constexpr (std::is_same_v<SrcT, int8_t>) {
+                    // SSE2 has no sign extending unpack, so duplicate each byte and arithmetic shift it back down
+                    __m128i bytes = _mm_unpacklo_epi8(v, v);
+                    v = _mm_srai_epi32(_mm_unpacklo_epi16(bytes, bytes), 24);
+                } else if constexpr (std::is_same_v<SrcT, uint16_t>) {
+                    v = _mm_unpacklo_epi16(v, zero);
+                } else {
+                    static_assert(std::is_same_v<SrcT, int16_t>, "Unexpected SSE2 source type");
+                    v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+                }
+                __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(v), scale);
+                if constexpr (std::is_signed_v<SrcT>) f = _mm_max_ps(f, minValue);
+                if constexpr (N == 4) {
+                    _mm_storeu_ps((float *)(dst + i * dstStride), f);
+                } else {
+                    _mm_store_ps(result, f);
+                    std::memcpy(dst + i * dstStride, result, N * sizeof(float));
+                }
+            }
+            return n;
+        }
+#endif
+
+        template<typename DstT, typename SrcT>
+        static inline void ConvertRange(const uint8_t *src,
+            size_t srcStride,
+            uint8_t *dst,
+            size_t dstStride,
+            size_t n,
+            bool normalized) {
+            using DstComponent = typename gltfComponents<DstT>::type;
+            using SrcComponent = typename gltfComponents<SrcT>::type;
+            constexpr size_t N = gltfComponents<DstT>::count;
+            static_assert(N == gltfComponents<SrcT>::count, "gltf::Accessor types must have matching components");
+            static_assert(sizeof(DstT) == N * sizeof(DstComponent), "gltf::Accessor read type must be packed");
+            static_assert(sizeof(SrcT) == N * sizeof(SrcComponent), "gltf::Accessor source type must be packed");
+
+            if constexpr (std::is_same_v<DstT, SrcT>) {
+                if (srcStride == sizeof(DstT) && dstStride == sizeof(DstT)) {
+                    std::memcpy(dst, src, n * sizeof(DstT));
+                } else {
+                    for (size_t i = 0; i < n; i++) {
+                        std::memcpy(dst + i * dstStride, src + i * srcStride, sizeof(DstT));
+                    }
+                }
+                return;
+            }
+
+            size_t i = 0;
+#ifdef SP_GLTF_SSE2
+            if constexpr (N == 1 && std::is_same_v<DstComponent, uint32_t> && std::is_unsigned_v<SrcComponent> &&
+                          sizeof(SrcComponent) <= 2) {
+                if (srcStride == sizeof(SrcT) && dstStride == sizeof(DstT)) {
+                    i = WidenIndicesSse2<SrcComponent>(src, dst, n);
+                }
+            } else if constexpr (N >= 2 && N <= 4 && std::is_same_v<DstComponent, float> &&
+                                 std::is_integral_v<SrcComponent> && sizeof(SrcComponent) <= 2) {
+                i = ConvertToFloatSse2<N, SrcComponent>(src, srcStride, dst, dstStride, n, normalized);
+            }
+#endif
+            for (; i < n; i++) {
+                SrcComponent input[N];
+                DstComponent output[N];
+                std::memcpy(input, src + i * srcStride, sizeof(SrcT));
+                for (size_t c = 0; c < N; c++) {
+                    output[c] = ConvertComponent<DstComponent>(input[c], normalized);
+                }
+                std::memcpy(dst + i * dstStride, output, sizeof(DstT));
+            }
+        }
+
+        template<int I, typename DstT, typename SrcT, typename... Tn>
+        static inline void ConvertRangeByIndex(int typeIndex,
+            const uint8_t *src,
+            size_t srcStride,
+            uint8_t *dst,
+            size_t dstStride,
+            size_t n,
+            bool normalized) {
+            if (typeIndex == I) {
+                ConvertRange<DstT, SrcT>(src, srcStride, dst, dstStride, n, normalized);
+            } else if constexpr (sizeof...(Tn) > 0) {
+                ConvertRangeByIndex<I + 1, DstT, Tn...>(typeIndex, src, srcStride, dst, dstStride, n, normalized);
+            }
+        }
     }; // namespace detail
 
     template<typename ReadT, typename... Tn>
@@ -108,6 +278,7 @@ namespace sp::gltf {
             return;
         }
         typeIndex = index;
+        normalized = accessor.normalized;
 
         int stride = accessor.ByteStride(bufferView);
         if (stride <= 0) {
@@ -139,19 +310,29 @@ namespace sp::gltf {
 
     template<typename ReadT, typename... Tn>
     ReadT Accessor<ReadT, Tn...>::Read(size_t i) const {
+        ReadT result;
+        ReadRange(i, 1, &result);
+        return result;
+    }
+
+    template<typename ReadT, typename... Tn>
+    void Accessor<ReadT, Tn...>::ReadRange(size_t first, size_t n, ReadT *output, size_t outputStride) const {
+        if (n == 0) return;
         Assertf(buffer && typeIndex >= 0 && (size_t)typeIndex <= sizeof...(Tn),
             "Trying to read invalid gltf::Accessor");
-        Assertf(i < count, "Trying to read invalid gltf::Accessor index: %u >= %u", i, count);
-
-        static const std::array<std::function<ReadT(const uint8_t &)>, 1 + sizeof...(Tn)> convertFuncs = {
-            [](const uint8_t &data) {
-                return reinterpret_cast<const ReadT &>(data);
-            },
-            [](const uint8_t &data) {
-                // TODO: Handle normalized int/uint -> float conversion
-                return static_cast<ReadT>(reinterpret_cast<const Tn &>(data));
-            }...};
-        const auto &data = buffer->data[byteOffset + (i * byteStride)];
-        return convertFuncs[typeIndex](data);
+        Assertf(first <= count && n <= count - first,
+            "Trying to read invalid gltf::Accessor range: %u + %u > %u",
+            first,
+            n,
+            count);
+
+        const uint8_t *src = buffer->data.data() + byteOffset + first * byteStride;
+        detail::ConvertRangeByIndex<0, ReadT, ReadT, Tn...>(typeIndex,
+            src,
+            byteStride,
+            (uint8_t *)output,
+            outputStride,
+            n,
+            normalized);
     }
 } // namespace sp::gltf
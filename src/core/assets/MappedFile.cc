@@ -0,0 +1,96 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "MappedFile.hh"
+
+#include "core/Logging.hh"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace sp {
+#ifdef _WIN32
+    std::shared_ptr<const MappedFile> MappedFile::Open(const std::string &path) {
+        HANDLE file = CreateFileA(path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+        std::shared_ptr<MappedFile> result(new MappedFile(path));
+        result->fileHandle = file;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            Errorf("Failed to read file size: %s", path);
+            return nullptr;
+        }
+        result->size = (size_t)fileSize.QuadPart;
+        // Empty files can't be mapped, but are still valid
+        if (result->size == 0) return result;
+
+        result->mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!result->mappingHandle) {
+            Errorf("Failed to create file mapping: %s", path);
+            return nullptr;
+        }
+        result->data = (const uint8_t *)MapViewOfFile(result->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!result->data) {
+            Errorf("Failed to map file: %s", path);
+            return nullptr;
+        }
+        return result;
+    }
+
+    MappedFile::~MappedFile() {
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle) CloseHandle(fileHandle);
+    }
+#else
+    std::shared_ptr<const MappedFile> MappedFile::Open(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+            close(fd);
+            return nullptr;
+        }
+
+        std::shared_ptr<MappedFile> result(new MappedFile(path));
+        result->size = (size_t)fileStat.st_size;
+        if (result->size > 0) {
+            void *ptr = mmap(nullptr, result->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                Errorf("Failed to map file: %s", path);
+                close(fd);
+                return nullptr;
+            }
+            result->data = (const uint8_t *)ptr;
+        }
+        // The mapping stays valid after the descriptor is closed
+        close(fd);
+        return result;
+    }
+
+    MappedFile::~MappedFile() {
+        if (data) munmap((void *)data, size);
+    }
+#endif
+} // namespace sp
@@ -0,0 +1,46 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace sp {
+    // A read-only memory mapping of a whole file. Pages are loaded lazily by the OS on first access.
+    class MappedFile : public NonCopyable {
+    public:
+        // Returns nullptr if the file doesn't exist or can't be mapped
+        static std::shared_ptr<const MappedFile> Open(const std::string &path);
+
+        ~MappedFile();
+
+        const uint8_t *Data() const {
+            return data;
+        }
+
+        size_t Size() const {
+            return size;
+        }
+
+        const std::string path;
+
+    private:
+        MappedFile(const std::string &path) : path(path) {}
+
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+    };
+} // namespace sp
@@ -43,6 +43,9 @@ namespace sp {
     void LinenoiseCompletionCallback(const char *buf, linenoiseCompletions *lc);
 #endif
 
+    // Oldest console lines are discarded beyond this limit, they are still written to stderr
+    const size_t MAX_OUTPUT_LINES = 10000;
+
     namespace logging {
         void GlobalLogOutput(Level lvl, const string &line) {
             GetConsoleManager().AddLog(lvl, line);
@@ -129,6 +132,10 @@ namespace sp {
     void ConsoleManager::AddLog(logging::Level lvl, const string &line) {
         std::lock_guard lock(linesLock);
         outputLines.push_back({lvl, line});
+        if (outputLines.size() > MAX_OUTPUT_LINES) {
+            outputLines.pop_front();
+            evictedLines++;
+        }
     }
 
     void ConsoleManager::StartThread(const ConsoleScript *startupScript) {
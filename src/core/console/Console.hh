@@ -15,6 +15,7 @@
 #include "core/RegisteredThread.hh"
 
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -73,7 +74,13 @@ namespace sp {
 
         const vector<ConsoleLine> Lines() {
             std::lock_guard lock(linesLock);
-            return outputLines;
+            return vector<ConsoleLine>(outputLines.begin(), outputLines.end());
+        }
+
+        // Number of lines removed from the start of the console history to keep it bounded
+        size_t EvictedLineCount() {
+            std::lock_guard lock(linesLock);
+            return evictedLines;
         }
 
         void ParseAndExecute(const string line);
@@ -114,7 +121,8 @@ namespace sp {
         std::queue<std::string> scriptCommands;
 
         std::mutex linesLock;
-        vector<ConsoleLine> outputLines;
+        std::deque<ConsoleLine> outputLines;
+        size_t evictedLines = 0;
 
         std::mutex historyLock;
         vector<string> history;
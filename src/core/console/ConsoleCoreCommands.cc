@@ -8,6 +8,7 @@
 #include "console/Console.hh"
 #include "core/Logging.hh"
 #include "core/RegisteredThread.hh"
+#include "core/ThreadTelemetry.hh"
 #include "ecs/EcsImpl.hh"
 
 #include <fstream>
@@ -76,6 +77,15 @@ void sp::ConsoleManager::RegisterCoreCommands() {
             }
         });
 
+    funcs.Register("logstats", "Print log message and console history counters", [this]() {
+        auto stats = logging::GetLogStats();
+        logging::ConsoleWrite(logging::Level::Log,
+            " > %llu messages written, %llu dropped, %u console lines evicted",
+            (unsigned long long)stats.written,
+            (unsigned long long)stats.dropped,
+            EvictedLineCount());
+    });
+
     funcs.Register("printfocus", "Print the current focus lock state", []() {
         auto lock = ecs::StartTransaction<ecs::Read<ecs::FocusLock>>();
 
@@ -292,4 +302,29 @@ void sp::ConsoleManager::RegisterCoreCommands() {
             tracingStarted = false;
         }).detach();
     });
+
+    funcs.Register<string>("threadstats",
+        "Print frame time percentiles for each registered thread (threadstats [thread_filter])",
+        [](string filter) {
+            PrintThreadTelemetry(filter);
+        });
+
+    funcs.Register<string, size_t>("threadframes",
+        "Print the most recent frames of a registered thread (threadframes <thread> [count])",
+        [](string threadName, size_t count) {
+            PrintThreadFrames(threadName, count > 0 ? count : 16);
+        });
+
+    funcs.Register<string>("savethreadstats",
+        "Save recent frames of every registered thread to a CSV file (savethreadstats [file])",
+        [](string path) {
+            if (path.empty()) path = "thread-telemetry.csv";
+            std::ofstream file(path);
+            if (!file) {
+                Errorf("Failed to open thread telemetry file: %s", path);
+                return;
+            }
+            SaveThreadTelemetryCsv(file);
+            Logf("Saved thread telemetry to %s", path);
+        });
 }
@@ -24,6 +24,8 @@
 namespace sp {
     [[noreturn]] void Abort(const string &message) {
         if (!message.empty()) Errorf("assertion failed: %s", message);
+        // Buffered log messages would be lost if the process stops here
+        logging::Flush();
         os_break();
         throw std::runtime_error(message);
     }
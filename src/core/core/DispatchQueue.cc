@@ -7,7 +7,34 @@
 
 #include "DispatchQueue.hh"
 
+#include <random>
+
 namespace sp {
+    // Used to push work dispatched from inside a work item onto the current worker's own deques.
+    static thread_local DispatchQueue *currentQueue = nullptr;
+    static thread_local size_t currentWorker = 0;
+
+    DispatchQueue::DispatchQueue(std::string name,
+        size_t threadCount,
+        chrono_clock::duration futuresPollInterval,
+        DispatchScheduler scheduler)
+        : name(std::move(name)), scheduler(scheduler), threads(threadCount), flushSleepInterval(futuresPollInterval) {
+        if (scheduler == DispatchScheduler::WorkStealing) {
+            // Queues without threads still need somewhere to store work until Flush() is called
+            workers.resize(std::max<size_t>(1, threadCount));
+            for (auto &worker : workers) {
+                worker = make_unique<WorkerDeques>();
+            }
+            for (size_t i = 0; i < threads.size(); i++) {
+                threads[i] = std::thread(&DispatchQueue::WorkerThreadMain, this, i);
+            }
+        } else {
+            for (auto &thread : threads) {
+                thread = std::thread(&DispatchQueue::ThreadMain, this);
+            }
+        }
+    }
+
     DispatchQueue::~DispatchQueue() {
         dropPendingWork = true;
         Shutdown();
@@ -20,6 +47,9 @@ namespace sp {
         workReady.notify_all();
         lock.unlock();
 
+        workEpoch++;
+        workEpoch.notify_all();
+
         for (auto &thread : threads) {
             if (thread.joinable()) thread.join();
         }
@@ -27,8 +57,43 @@ namespace sp {
 
     void DispatchQueue::Flush(bool blockUntilReady) {
         ZoneScoped;
-        std::unique_lock<std::mutex> lock(mutex);
-        FlushInternal(lock, workQueue.size(), blockUntilReady);
+        if (scheduler == DispatchScheduler::WorkStealing) {
+            size_t workerIndex = currentQueue == this ? currentWorker : 0;
+            FlushWorker(workerIndex, workerPending, blockUntilReady);
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            FlushInternal(lock, workQueueSize, blockUntilReady);
+        }
+    }
+
+    void DispatchQueue::Enqueue(WorkItemPtr &&item) {
+        if (scheduler == DispatchScheduler::WorkStealing) {
+            size_t workerIndex;
+            if (currentQueue == this) {
+                workerIndex = currentWorker;
+            } else {
+                workerIndex = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+            }
+            PushWorker(workerIndex, std::move(item));
+
+            workEpoch++;
+            if (sleepingWorkers > 0) workEpoch.notify_one();
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            workQueues[(size_t)item->options.priority].push(std::move(item));
+            workQueueSize++;
+            workReady.notify_one();
+        }
+    }
+
+    bool DispatchQueue::RunWorkItem(WorkItemPtr &item, bool blockUntilReady) {
+        if (item->Cancelled()) {
+            item->Cancel();
+            return true;
+        }
+        if (!blockUntilReady && !item->Ready()) return false;
+        item->Process();
+        return true;
     }
 
     void DispatchQueue::ThreadMain() {
@@ -36,16 +101,16 @@ namespace sp {
         std::unique_lock<std::mutex> lock(mutex);
 
         while (true) {
-            if (workQueue.empty()) {
+            if (workQueueSize == 0) {
                 if (exit) break;
                 workReady.wait(lock);
             }
             if (exit && dropPendingWork) break;
-            if (workQueue.empty()) continue;
+            if (workQueueSize == 0) continue;
 
             {
                 ZoneScopedN("ThreadFlush");
-                size_t flushCount = workQueue.size();
+                size_t flushCount = workQueueSize;
                 ZoneValue(flushCount);
                 if (FlushInternal(lock, flushCount, false) == 0) {
                     lock.unlock();
@@ -56,24 +121,132 @@ namespace sp {
         }
     }
 
+    DispatchQueue::WorkItemPtr DispatchQueue::PopShared() {
+        for (auto &queue : workQueues) {
+            if (queue.empty()) continue;
+            auto item = std::move(queue.front());
+            queue.pop();
+            workQueueSize--;
+            return item;
+        }
+        return nullptr;
+    }
+
     size_t DispatchQueue::FlushInternal(std::unique_lock<std::mutex> &lock, size_t maxWorkItems, bool blockUntilReady) {
         size_t flushCount = 0;
-        while (maxWorkItems > 0 && !workQueue.empty()) {
-            auto item = std::move(workQueue.front());
-            workQueue.pop();
+        while (maxWorkItems > 0 && workQueueSize > 0) {
+            auto item = PopShared();
 
             lock.unlock();
-            bool ready = blockUntilReady || item->Ready();
+            bool ready = RunWorkItem(item, blockUntilReady);
             if (ready) {
-                item->Process();
                 std::this_thread::yield();
                 flushCount++;
             }
             lock.lock();
 
-            if (!ready) workQueue.push(std::move(item));
+            if (!ready) {
+                workQueues[(size_t)item->options.priority].push(std::move(item));
+                workQueueSize++;
+            }
             maxWorkItems--;
         }
         return flushCount;
     }
+
+    void DispatchQueue::PushWorker(size_t workerIndex, WorkItemPtr &&item, bool requeue) {
+        auto &worker = *workers[workerIndex];
+        auto priority = (size_t)item->options.priority;
+        {
+            std::lock_guard lock(worker.mutex);
+            // Work that wasn't ready goes to the stealing end, so the owner doesn't pop it again right away
+            if (requeue) {
+                worker.deques[priority].push_front(std::move(item));
+            } else {
+                worker.deques[priority].push_back(std::move(item));
+            }
+        }
+        workerPending++;
+    }
+
+    DispatchQueue::WorkItemPtr DispatchQueue::PopWorker(size_t workerIndex) {
+        if (workerPending == 0) return nullptr;
+
+        // The owner takes the newest work from the back of its own deques, highest priority first.
+        {
+            auto &worker = *workers[workerIndex];
+            std::lock_guard lock(worker.mutex);
+            for (auto &deque : worker.deques) {
+                if (deque.empty()) continue;
+                auto item = std::move(deque.back());
+                deque.pop_back();
+                workerPending--;
+                return item;
+            }
+        }
+
+        // Otherwise steal the oldest work from the front of another worker's deques, starting at a random victim
+        // so idle workers don't all contend on the same one.
+        static thread_local std::minstd_rand stealRandom(
+            (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id()));
+        size_t start = stealRandom() % workers.size();
+        for (size_t i = 0; i < workers.size(); i++) {
+            size_t victim = (start + i) % workers.size();
+            if (victim == workerIndex) continue;
+            auto &worker = *workers[victim];
+            std::lock_guard lock(worker.mutex);
+            for (auto &deque : worker.deques) {
+                if (deque.empty()) continue;
+                auto item = std::move(deque.front());
+                deque.pop_front();
+                workerPending--;
+                return item;
+            }
+        }
+        return nullptr;
+    }
+
+    size_t DispatchQueue::FlushWorker(size_t workerIndex, size_t maxWorkItems, bool blockUntilReady) {
+        size_t flushCount = 0;
+        while (maxWorkItems > 0) {
+            auto item = PopWorker(workerIndex);
+            if (!item) break;
+
+            if (RunWorkItem(item, blockUntilReady)) {
+                flushCount++;
+            } else {
+                PushWorker(workerIndex, std::move(item), true);
+            }
+            maxWorkItems--;
+        }
+        return flushCount;
+    }
+
+    void DispatchQueue::WorkerThreadMain(size_t workerIndex) {
+        tracy::SetThreadName(name.c_str());
+        currentQueue = this;
+        currentWorker = workerIndex;
+
+        while (true) {
+            uint32_t epoch = workEpoch;
+            if (exit && (dropPendingWork || workerPending == 0)) break;
+
+            size_t pending = workerPending;
+            if (pending == 0) {
+                sleepingWorkers++;
+                workEpoch.wait(epoch);
+                sleepingWorkers--;
+                continue;
+            }
+
+            ZoneScopedN("ThreadFlush");
+            ZoneValue(pending);
+            if (FlushWorker(workerIndex, pending, false) == 0) {
+                // Only work items waiting on futures are left, poll them again later
+                std::this_thread::sleep_for(flushSleepInterval);
+            }
+        }
+
+        currentQueue = nullptr;
+    }
 } // namespace sp
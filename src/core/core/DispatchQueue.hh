@@ -11,9 +11,12 @@
 #include "core/Common.hh"
 #include "core/Tracing.hh"
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <deque>
 #include <functional>
 #include <future>
 #include <mutex>
@@ -25,9 +28,9 @@
 
 namespace sp {
     namespace detail {
-        template<typename... T, std::size_t... I>
+        template<std::size_t Offset, typename... T, std::size_t... I>
         constexpr auto subtuple(std::tuple<T...> &&t, std::index_sequence<I...>) {
-            return std::forward_as_tuple(std::get<I>(t)...);
+            return std::forward_as_tuple(std::get<Offset + I>(t)...);
         }
 
         template<typename T>
@@ -92,9 +95,61 @@ namespace sp {
         };
     } // namespace detail
 
+    /**
+     * Work items are run in priority order. Lower priority items are only started once
+     * all ready higher priority items in the queue have been started.
+     */
+    enum class DispatchPriority : uint8_t {
+        FrameCritical = 0,
+        Normal,
+        Background,
+    };
+    static constexpr size_t DISPATCH_PRIORITY_COUNT = (size_t)DispatchPriority::Background + 1;
+
+    enum class DispatchScheduler : uint8_t {
+        // All threads pull from a single queue guarded by one mutex.
+        Shared = 0,
+        // Each thread owns its own set of priority deques, and steals from other threads when idle.
+        // Workers run their own newest work first, and steal the oldest work from a random other worker.
+        WorkStealing,
+    };
+
+    /**
+     * A cancelled work item is never run. Its returned future is resolved with nullptr instead.
+     * Cancelling a token has no effect on work items that have already started.
+     */
+    class DispatchCancelToken : public NonCopyable {
+    public:
+        void Cancel() {
+            cancelled.store(true, std::memory_order_release);
+        }
+
+        bool Cancelled() const {
+            return cancelled.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic_bool cancelled = false;
+    };
+
+    struct DispatchOptions {
+        DispatchPriority priority = DispatchPriority::Normal;
+        shared_ptr<DispatchCancelToken> cancelToken;
+    };
+
     struct DispatchQueueWorkItemBase {
+        DispatchQueueWorkItemBase(const DispatchOptions &options) : options(options) {}
+        virtual ~DispatchQueueWorkItemBase() {}
+
         virtual void Process() = 0;
+        virtual void Cancel() = 0;
         virtual bool Ready() = 0;
+
+        bool Cancelled() const {
+            return options.cancelToken && options.cancelToken->Cancelled();
+        }
+
+        DispatchOptions options;
     };
 
     class DispatchQueue;
@@ -105,8 +160,9 @@ namespace sp {
         using ResultTuple = std::tuple<typename detail::Future<Futures>::ReturnType...>;
 
         template<typename... Args>
-        DispatchQueueWorkItem(DispatchQueue &queue, Fn &&func, Args &&...args)
-            : queue(queue), returnValue(std::make_shared<Async<ReturnType>>()), func(std::move(func)),
+        DispatchQueueWorkItem(DispatchQueue &queue, const DispatchOptions &options, Fn &&func, Args &&...args)
+            : DispatchQueueWorkItemBase(options), queue(queue), returnValue(std::make_shared<Async<ReturnType>>()),
+              func(std::move(func)),
               waitForFutures(std::make_tuple(detail::Future<std::remove_cvref_t<Args>>(args)...)) {}
 
         DispatchQueue &queue;
@@ -116,6 +172,10 @@ namespace sp {
 
         void Process();
 
+        void Cancel() {
+            returnValue->Set(nullptr);
+        }
+
         bool Ready() {
             return std::apply(
                 [](auto &&...future) {
@@ -129,12 +189,8 @@ namespace sp {
     public:
         DispatchQueue(std::string name,
             size_t threadCount = 1,
-            chrono_clock::duration futuresPollInterval = std::chrono::milliseconds(5))
-            : name(std::move(name)), threads(threadCount), flushSleepInterval(futuresPollInterval) {
-            for (auto &thread : threads) {
-                thread = std::thread(&DispatchQueue::ThreadMain, this);
-            }
-        }
+            chrono_clock::duration futuresPollInterval = std::chrono::milliseconds(5),
+            DispatchScheduler scheduler = DispatchScheduler::Shared);
 
         ~DispatchQueue();
         void Shutdown();
@@ -153,6 +209,12 @@ namespace sp {
          * Example:
          *  auto image = queue.Dispatch<Image>([]() { return std::make_shared<Image>(); });
          *  queue.Dispatch<void>(image, [](std::shared_ptr<Image> image) { });
+         *
+         * A DispatchOptions may be passed as the first argument to set the work item's priority and cancel token.
+         * Example:
+         *  auto token = make_shared<DispatchCancelToken>();
+         *  queue.Dispatch<Hull>(DispatchOptions{DispatchPriority::Background, token}, model, [](auto model) {...});
+         *  token->Cancel(); // The returned future will be resolved with nullptr if the hull hasn't started yet
          */
         template<typename ReturnType, typename... FuturesAndFn>
         AsyncPtr<ReturnType> Dispatch(FuturesAndFn &&...args) {
@@ -160,53 +222,93 @@ namespace sp {
             const size_t lastArg = sizeof...(FuturesAndFn) - 1;
             auto tupl = std::make_tuple(std::move(args)...);
             auto fn = std::move(std::get<lastArg>(tupl));
-            auto futures = detail::subtuple(std::move(tupl), std::make_index_sequence<lastArg>());
-            return std::apply(
-                [&](auto &&...futures) {
-                    return DispatchInternal<ReturnType>(std::move(fn), std::move(futures)...);
-                },
-                futures);
+            if constexpr (std::is_same<std::tuple_element_t<0, decltype(tupl)>, DispatchOptions>()) {
+                auto options = std::move(std::get<0>(tupl));
+                auto futures = detail::subtuple<1>(std::move(tupl), std::make_index_sequence<lastArg - 1>());
+                return std::apply(
+                    [&](auto &&...futures) {
+                        return DispatchInternal<ReturnType>(options, std::move(fn), std::move(futures)...);
+                    },
+                    futures);
+            } else {
+                auto futures = detail::subtuple<0>(std::move(tupl), std::make_index_sequence<lastArg>());
+                return std::apply(
+                    [&](auto &&...futures) {
+                        return DispatchInternal<ReturnType>(DispatchOptions{}, std::move(fn), std::move(futures)...);
+                    },
+                    futures);
+            }
         }
 
         /**
          * When `from` is ready, its value will be set in `to`
          */
         template<typename FutT, typename T>
-        void ForwardAsync(FutT from, const AsyncPtr<T> &to) {
+        void ForwardAsync(FutT from, const AsyncPtr<T> &to, DispatchPriority priority = DispatchPriority::Normal) {
             if (from->Ready()) {
                 to->Set(from->Get());
             } else {
-                Dispatch<void>(from, [to](auto &fromValue) {
+                Dispatch<void>(DispatchOptions{priority}, from, [to](auto &fromValue) {
                     to->Set(fromValue);
                 });
             }
         }
 
         template<typename ReturnType, typename Fn, typename... Futures>
-        AsyncPtr<ReturnType> DispatchInternal(Fn &&func, Futures &&...futures) {
+        AsyncPtr<ReturnType> DispatchInternal(const DispatchOptions &options, Fn &&func, Futures &&...futures) {
             Assert(!exit, "tried to dispatch to a shut down queue");
-            auto item = make_shared<DispatchQueueWorkItem<ReturnType, Fn, std::remove_cvref_t<Futures>...>>(*this,
+            auto item = make_unique<DispatchQueueWorkItem<ReturnType, Fn, std::remove_cvref_t<Futures>...>>(*this,
+                options,
                 std::move(func),
                 std::move(futures)...);
+            auto returnValue = item->returnValue;
+            Enqueue(std::move(item));
+            return returnValue;
+        }
 
-            std::unique_lock<std::mutex> lock(mutex);
-            workQueue.push(item);
-            workReady.notify_one();
-            return item->returnValue;
+        DispatchScheduler Scheduler() const {
+            return scheduler;
         }
 
     private:
+        using WorkItemPtr = unique_ptr<DispatchQueueWorkItemBase>;
+
+        void Enqueue(WorkItemPtr &&item);
+        bool RunWorkItem(WorkItemPtr &item, bool blockUntilReady);
+
+        // DispatchScheduler::Shared
         size_t FlushInternal(std::unique_lock<std::mutex> &lock, size_t maxWorkItems, bool blockUntilReady);
         void ThreadMain();
+        WorkItemPtr PopShared();
+
+        // DispatchScheduler::WorkStealing
+        size_t FlushWorker(size_t workerIndex, size_t maxWorkItems, bool blockUntilReady);
+        void WorkerThreadMain(size_t workerIndex);
+        void PushWorker(size_t workerIndex, WorkItemPtr &&item, bool requeue = false);
+        WorkItemPtr PopWorker(size_t workerIndex);
 
         std::mutex mutex;
         std::string name;
+        DispatchScheduler scheduler;
         std::vector<std::thread> threads;
         chrono_clock::duration flushSleepInterval;
 
-        std::queue<shared_ptr<DispatchQueueWorkItemBase>> workQueue;
+        std::array<std::queue<WorkItemPtr>, DISPATCH_PRIORITY_COUNT> workQueues;
+        size_t workQueueSize = 0;
         std::condition_variable workReady;
-        bool exit = false, dropPendingWork = false;
+
+        struct WorkerDeques {
+            // Only contended when another thread is stealing from this worker
+            std::mutex mutex;
+            std::array<std::deque<WorkItemPtr>, DISPATCH_PRIORITY_COUNT> deques;
+        };
+        std::vector<unique_ptr<WorkerDeques>> workers;
+        std::atomic_size_t workerPending = 0;
+        std::atomic_size_t nextWorker = 0;
+        std::atomic_uint32_t workEpoch = 0;
+        std::atomic_uint32_t sleepingWorkers = 0;
+
+        std::atomic_bool exit = false, dropPendingWork = false;
     };
 
     template<typename ReturnType, typename Fn, typename... Futures>
@@ -228,7 +330,7 @@ namespace sp {
         } else {
             auto result = std::apply(func, args);
             if constexpr (std::is_constructible<detail::Future<decltype(result)>, decltype(result)>()) {
-                queue.ForwardAsync(result, returnValue);
+                queue.ForwardAsync(result, returnValue, options.priority);
             } else {
                 returnValue->Set(result);
             }
@@ -7,6 +7,13 @@
 
 #include "Logging.hh"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace sp::logging {
 #ifdef SP_PACKAGE_RELEASE
     static Level logLevel = Level::Log;
@@ -26,4 +33,497 @@ namespace sp::logging {
     void SetLogLevel(Level level) {
         logLevel = level;
     }
+
+    using detail::ArgType;
+    using detail::RecordHeader;
+
+    // Each thread that logs gets its own buffer, large enough to absorb a burst of loading messages
+    const size_t LOG_BUFFER_SIZE = 256 * 1024;
+    // Larger messages are formatted and written on the calling thread
+    const size_t MAX_RECORD_SIZE = LOG_BUFFER_SIZE / 4;
+    const auto LOG_SINK_INTERVAL = std::chrono::milliseconds(2);
+
+    static size_t alignRecordSize(size_t size) {
+        return (size + alignof(RecordHeader) - 1) & ~(alignof(RecordHeader) - 1);
+    }
+
+    /**
+     * A single producer, single consumer ring buffer of variable sized records.
+     * Records are always contiguous. If one doesn't fit before the end of the buffer, the remaining space is filled
+     * with a padding record and it is written at the start instead.
+     */
+    struct LogBuffer {
+        std::unique_ptr<char[]> data;
+        alignas(64) std::atomic_size_t head = 0; // Written by the producer thread
+        size_t pendingHead = 0;
+        alignas(64) std::atomic_size_t tail = 0; // Written by the sink thread
+        std::atomic_uint64_t dropped = 0;
+        std::atomic_bool closed = false;
+
+        uint64_t reportedDropped = 0; // Only accessed by the sink thread
+
+        LogBuffer() : data(new char[LOG_BUFFER_SIZE]) {}
+
+        char *Reserve(size_t size) {
+            size_t start = head.load(std::memory_order_relaxed);
+            size_t offset = start % LOG_BUFFER_SIZE;
+            size_t contiguous = LOG_BUFFER_SIZE - offset;
+            size_t needed = contiguous < size ? contiguous + size : size;
+            if (start + needed - tail.load(std::memory_order_acquire) > LOG_BUFFER_SIZE) return nullptr;
+
+            if (contiguous < size) {
+                auto *padding = (RecordHeader *)(data.get() + offset);
+                padding->size = contiguous;
+                padding->padding = true;
+                start += contiguous;
+                offset = 0;
+            }
+            pendingHead = start + size;
+            return data.get() + offset;
+        }
+
+        void Commit() {
+            head.store(pendingHead, std::memory_order_release);
+        }
+
+        size_t Used() const {
+            return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+        }
+    };
+
+    class LogSink {
+    public:
+        LogSink() {
+            running = true;
+            thread = std::thread([this] {
+                tracy::SetThreadName("LogSink");
+                Run();
+            });
+        }
+
+        ~LogSink() {
+            {
+                std::lock_guard lock(mutex);
+                running = false;
+            }
+            wake.notify_all();
+            thread.join();
+        }
+
+        LogBuffer *GetThreadBuffer() {
+            struct ThreadBuffer {
+                std::shared_ptr<LogBuffer> buffer;
+
+                ~ThreadBuffer() {
+                    if (buffer) buffer->closed = true;
+                }
+            };
+            static thread_local ThreadBuffer threadBuffer;
+
+            if (!threadBuffer.buffer) {
+                threadBuffer.buffer = std::make_shared<LogBuffer>();
+                std::lock_guard lock(buffersMutex);
+                buffers.emplace_back(threadBuffer.buffer);
+            }
+            return threadBuffer.buffer.get();
+        }
+
+        void Wake() {
+            if (!wakeRequested.exchange(true)) wake.notify_one();
+        }
+
+        void Flush() {
+            if (!running || std::this_thread::get_id() == thread.get_id()) return;
+
+            std::unique_lock lock(mutex);
+            uint64_t target = ++flushRequested;
+            wake.notify_one();
+            flushed.wait(lock, [&] {
+                return flushCompleted >= target || !running;
+            });
+        }
+
+        // Writes a formatted message, after any messages already buffered by the calling thread
+        void WriteNow(Level lvl, bool print, const std::string &line) {
+            if (!running) {
+                // Logging during shutdown, after the sink has stopped
+                if (print) std::cerr.write(line.data(), line.size());
+                return;
+            }
+            Flush();
+            std::lock_guard lock(outputMutex);
+            Output(lvl, print, line);
+        }
+
+        LogStats GetStats() {
+            LogStats stats;
+            stats.written = written;
+            std::lock_guard lock(buffersMutex);
+            stats.dropped = closedDropped;
+            for (auto &buffer : buffers) {
+                stats.dropped += buffer->dropped;
+            }
+            return stats;
+        }
+
+        std::atomic_bool running;
+
+    private:
+        void Run() {
+            while (true) {
+                uint64_t requested;
+                bool stopping;
+                {
+                    std::unique_lock lock(mutex);
+                    wake.wait_for(lock, LOG_SINK_INTERVAL, [&] {
+                        return !running || wakeRequested || flushRequested > flushCompleted;
+                    });
+                    wakeRequested = false;
+                    requested = flushRequested;
+                    stopping = !running;
+                }
+
+                // The console may already be destroyed while the sink shuts down
+                Drain(!stopping);
+
+                {
+                    std::lock_guard lock(mutex);
+                    flushCompleted = requested;
+                }
+                flushed.notify_all();
+                if (stopping) break;
+            }
+        }
+
+        struct PendingRecord {
+            const RecordHeader *header;
+            LogBuffer *buffer;
+            size_t end;
+        };
+
+        void Drain(bool console) {
+            ZoneScoped;
+            {
+                std::lock_guard lock(buffersMutex);
+                activeBuffers = buffers;
+            }
+
+            // Gather every committed record, then output them in time order across all threads
+            records.clear();
+            for (auto &buffer : activeBuffers) {
+                size_t tail = buffer->tail.load(std::memory_order_relaxed);
+                size_t head = buffer->head.load(std::memory_order_acquire);
+                while (tail < head) {
+                    auto *header = (const RecordHeader *)(buffer->data.get() + tail % LOG_BUFFER_SIZE);
+                    tail += header->size;
+                    if (!header->padding) records.push_back({header, buffer.get(), tail});
+                }
+                if (records.empty() || records.back().buffer != buffer.get()) {
+                    // Release padding records that aren't followed by a message yet
+                    buffer->tail.store(tail, std::memory_order_release);
+                }
+            }
+            std::stable_sort(records.begin(), records.end(), [](auto &a, auto &b) {
+                return a.header->time < b.header->time;
+            });
+
+            output.clear();
+            {
+                std::lock_guard lock(outputMutex);
+                for (auto &record : records) {
+                    auto *header = record.header;
+                    line.clear();
+                    if (header->timestamp) {
+                        auto time = chrono_clock::time_point(chrono_clock::duration(header->time));
+                        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(time - LogEpoch).count();
+                        appendFormat(line, "%.3f ", ms / 1000.0f);
+                    }
+                    if (header->prefix) line += header->prefix;
+                    formatRecord(line, header);
+                    line += '\n';
+
+                    TracyMessage(line.data(), line.size());
+                    if (header->print) {
+                        output += line;
+                        if ((Level)header->level < Level::Debug && console) GlobalLogOutput((Level)header->level, line);
+                    }
+                    written++;
+                }
+
+                for (auto &buffer : activeBuffers) {
+                    uint64_t dropped = buffer->dropped;
+                    if (dropped == buffer->reportedDropped) continue;
+                    line.clear();
+                    appendFormat(line,
+                        "%.3f [warn] %llu log messages dropped, log buffer is full\n",
+                        LogTime(),
+                        (unsigned long long)(dropped - buffer->reportedDropped));
+                    buffer->reportedDropped = dropped;
+                    output += line;
+                    if (console) GlobalLogOutput(Level::Warn, line);
+                }
+
+                if (!output.empty()) std::cerr.write(output.data(), output.size());
+            }
+
+            // Records are only released once formatted, since their strings are read directly from the buffer
+            for (auto &record : records) {
+                record.buffer->tail.store(record.end, std::memory_order_release);
+            }
+
+            std::lock_guard lock(buffersMutex);
+            std::erase_if(buffers, [&](auto &buffer) {
+                if (!buffer->closed || buffer->Used() > 0) return false;
+                closedDropped += buffer->dropped;
+                return true;
+            });
+            activeBuffers.clear();
+        }
+
+        void Output(Level lvl, bool print, const std::string &message) {
+            TracyMessage(message.data(), message.size());
+            if (!print) return;
+            std::cerr.write(message.data(), message.size());
+            if (lvl < Level::Debug) GlobalLogOutput(lvl, message);
+            written++;
+        }
+
+        template<typename... T>
+        static void appendFormat(std::string &out, const char *format, T... args) {
+            char buf[256];
+            int size = std::snprintf(buf, sizeof(buf), format, args...);
+            if (size < 0) return;
+            if ((size_t)size < sizeof(buf)) {
+                out.append(buf, size);
+            } else {
+                size_t offset = out.size();
+                out.resize(offset + size + 1);
+                std::snprintf(out.data() + offset, size + 1, format, args...);
+                out.resize(offset + size);
+            }
+        }
+
+        struct Arg {
+            ArgType type;
+            uint64_t bits;
+            const char *str;
+        };
+
+        static const char *decodeArg(const char *src, Arg &arg) {
+            arg.type = (ArgType)*src++;
+            if (arg.type == ArgType::String) {
+                uint32_t length;
+                std::memcpy(&length, src, sizeof(length));
+                arg.str = src + sizeof(length);
+                return arg.str + length + 1;
+            }
+            std::memcpy(&arg.bits, src, sizeof(arg.bits));
+            return src + sizeof(arg.bits);
+        }
+
+        // Formats a single printf conversion with its argument, plus any * width and precision arguments
+        template<typename... Star>
+        static void appendArg(std::string &out, const char *spec, const Arg &arg, Star... star) {
+            switch (arg.type) {
+            case ArgType::Int32:
+                appendFormat(out, spec, star..., (int32_t)arg.bits);
+                break;
+            case ArgType::Uint32:
+                appendFormat(out, spec, star..., (uint32_t)arg.bits);
+                break;
+            case ArgType::Int64:
+                appendFormat(out, spec, star..., (long long)arg.bits);
+                break;
+            case ArgType::Uint64:
+                appendFormat(out, spec, star..., (unsigned long long)arg.bits);
+                break;
+            case ArgType::Double: {
+                double value;
+                std::memcpy(&value, &arg.bits, sizeof(value));
+                appendFormat(out, spec, star..., value);
+                break;
+            }
+            case ArgType::Pointer: {
+                const void *ptr;
+                std::memcpy(&ptr, &arg.bits, sizeof(ptr));
+                appendFormat(out, spec, star..., ptr);
+                break;
+            }
+            case ArgType::String:
+                if (std::strcmp(spec, "%s") == 0) {
+                    out += arg.str;
+                } else {
+                    appendFormat(out, spec, star..., arg.str);
+                }
+                break;
+            }
+        }
+
+        static void formatRecord(std::string &out, const RecordHeader *header) {
+            const char *fmt = (const char *)(header + 1);
+            const char *fmtEnd = fmt + header->fmtLength;
+            const char *args = fmtEnd + 1;
+            uint32_t argsRemaining = header->argCount;
+
+            auto nextArg = [&](Arg &arg) {
+                if (argsRemaining == 0) return false;
+                args = decodeArg(args, arg);
+                argsRemaining--;
+                return true;
+            };
+
+            const char *literal = fmt;
+            for (const char *c = fmt; c < fmtEnd; c++) {
+                if (*c != '%') continue;
+                out.append(literal, c);
+                if (c + 1 < fmtEnd && c[1] == '%') {
+                    out += '%';
+                    literal = ++c + 1;
+                    continue;
+                }
+
+                // Parse a conversion: %[flags][width][.precision][length]specifier
+                const char *specStart = c++;
+                size_t starCount = 0;
+                while (c < fmtEnd && !std::strchr("diouxXeEfFgGaAcspn", *c)) {
+                    if (*c == '*') starCount++;
+                    c++;
+                }
+                if (c == fmtEnd) {
+                    literal = specStart;
+                    break;
+                }
+                literal = c + 1;
+
+                char spec[32];
+                size_t specLength = std::min<size_t>(c - specStart + 1, sizeof(spec) - 1);
+                std::memcpy(spec, specStart, specLength);
+                spec[specLength] = '\0';
+                if (*c == 'n') continue;
+
+                Arg stars[2], arg;
+                bool valid = starCount <= 2;
+                for (size_t i = 0; valid && i < starCount; i++) {
+                    valid = nextArg(stars[i]);
+                }
+                if (!valid || !nextArg(arg)) {
+                    out.append(specStart, c + 1);
+                    continue;
+                }
+
+                if (starCount == 0) {
+                    appendArg(out, spec, arg);
+                } else if (starCount == 1) {
+                    appendArg(out, spec, arg, (int)stars[0].bits);
+                } else {
+                    appendArg(out, spec, arg, (int)stars[0].bits, (int)stars[1].bits);
+                }
+            }
+            out.append(literal, fmtEnd);
+        }
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake, flushed;
+        std::atomic_bool wakeRequested = false;
+        uint64_t flushRequested = 0, flushCompleted = 0;
+
+        std::mutex buffersMutex;
+        std::vector<std::shared_ptr<LogBuffer>> buffers;
+        std::atomic_uint64_t written = 0, closedDropped = 0;
+
+        // Serializes stderr and console output between the sink and synchronous writes.
+        // Recursive since console output may itself log a message that can't be buffered.
+        std::recursive_mutex outputMutex;
+
+        // Only accessed by the sink thread
+        std::vector<std::shared_ptr<LogBuffer>> activeBuffers;
+        std::vector<PendingRecord> records;
+        std::string output, line;
+    };
+
+    static LogSink &getLogSink() {
+        static LogSink sink;
+        return sink;
+    }
+
+    LogStats GetLogStats() {
+        return getLogSink().GetStats();
+    }
+
+    void Flush() {
+        getLogSink().Flush();
+    }
+
+    namespace detail {
+        static thread_local LogBuffer *currentBuffer = nullptr;
+
+        char *BeginRecord(Level lvl, size_t size, bool &synchronous) {
+            auto &sink = getLogSink();
+            if (!sink.running || size > MAX_RECORD_SIZE) {
+                synchronous = true;
+                return nullptr;
+            }
+
+            auto *buffer = sink.GetThreadBuffer();
+            size = alignRecordSize(size);
+            char *dst = buffer->Reserve(size);
+            while (!dst && lvl <= Level::Warn && sink.running) {
+                // Errors and warnings are never dropped, wait for the sink to make space instead
+                sink.Wake();
+                std::this_thread::yield();
+                dst = buffer->Reserve(size);
+            }
+            if (!dst) {
+                buffer->dropped++;
+                sink.Wake();
+                return nullptr;
+            }
+            if (buffer->Used() + size > LOG_BUFFER_SIZE / 2) sink.Wake();
+
+            ((RecordHeader *)dst)->size = size;
+            currentBuffer = buffer;
+            return dst;
+        }
+
+        void CommitRecord() {
+            currentBuffer->Commit();
+            currentBuffer = nullptr;
+        }
+
+        char *WriteRecordHeader(char *dst,
+            Level lvl,
+            const char *prefix,
+            bool timestamp,
+            bool print,
+            const std::string &fmt,
+            size_t argCount) {
+            auto *header = (RecordHeader *)dst;
+            header->level = (uint8_t)lvl;
+            header->padding = false;
+            header->timestamp = timestamp;
+            header->print = print;
+            header->fmtLength = fmt.size();
+            header->argCount = argCount;
+            header->time = chrono_clock::now().time_since_epoch().count();
+            header->prefix = prefix;
+
+            dst += sizeof(RecordHeader);
+            std::memcpy(dst, fmt.c_str(), fmt.size() + 1);
+            return dst + fmt.size() + 1;
+        }
+
+        void WriteNow(Level lvl, const char *prefix, bool timestamp, bool print, const char *message, size_t size) {
+            std::string line;
+            if (timestamp) {
+                char time[32];
+                int length = std::snprintf(time, sizeof(time), "%.3f ", LogTime());
+                line.append(time, std::max(length, 0));
+            }
+            if (prefix) line += prefix;
+            line.append(message, size);
+            line += '\n';
+            getLogSink().WriteNow(lvl, print, line);
+        }
+    } // namespace detail
 } // namespace sp::logging
@@ -37,6 +37,15 @@ namespace sp::logging {
 
     void GlobalLogOutput(Level lvl, const std::string &line);
 
+    struct LogStats {
+        uint64_t written = 0; // Messages formatted and output by the log sink
+        uint64_t dropped = 0; // Log, debug, and trace messages discarded because a thread's buffer was full
+    };
+    LogStats GetLogStats();
+
+    // Blocks until all messages logged by this thread have been output.
+    void Flush();
+
     inline static const char *basename(const char *file) {
         const char *r;
         if ((r = strrchr(file, '/'))) return r + 1;
@@ -57,6 +66,10 @@ namespace sp::logging {
             if (t.empty()) return "";
             Assert(t.data()[t.size()] == '\0', "string_view is not null terminated");
             return std::forward<T>(t).data();
+        } else if constexpr (requires { std::forward<T>(t).String().c_str(); } &&
+                             std::is_reference_v<decltype(std::forward<T>(t).String())>) {
+            // Types that own stable string storage, such as interned names
+            return std::forward<T>(t).String().c_str();
         } else if constexpr (std::is_enum_v<BaseType>) {
             if (magic_enum::enum_name(std::forward<T>(t)).empty()) return "invalid_enum";
             return magic_enum::enum_name(std::forward<T>(t)).data();
@@ -65,58 +78,163 @@ namespace sp::logging {
         }
     }
 
-    template<typename... T>
-    inline static void writeFormatter(Level lvl, const std::string &fmt, T &&...t) {
-        int size = std::snprintf(nullptr, 0, fmt.c_str(), std::forward<T>(t)...);
-        std::unique_ptr<char[]> buf(new char[size + 1]);
-        std::snprintf(buf.get(), size + 1, fmt.c_str(), std::forward<T>(t)...);
+    namespace detail {
+        /**
+         * Messages are not formatted by the logging thread. The format string and arguments are copied into a
+         * per-thread ring buffer, and formatted later by a sink thread that writes them to stderr and the console.
+         */
+        enum class ArgType : uint8_t { Int32, Uint32, Int64, Uint64, Double, Pointer, String };
+
+        struct RecordHeader {
+            uint32_t size; // Total size of the record, including the header, format string, and arguments
+            uint8_t level;
+            bool padding; // Skips the unused space at the end of the ring buffer
+            bool timestamp;
+            bool print; // False if the message is only sent to the profiler
+            uint32_t fmtLength;
+            uint32_t argCount;
+            int64_t time;
+            const char *prefix; // Must be a string literal
+        };
+
+        template<typename T, typename Char = std::remove_cv_t<std::remove_pointer_t<T>>>
+        constexpr bool isStringArg = std::is_pointer_v<T> &&
+                                     (std::is_same_v<Char, char> || std::is_same_v<Char, signed char> ||
+                                         std::is_same_v<Char, unsigned char> || std::is_same_v<Char, char8_t>);
+
+        template<typename T>
+        constexpr bool isDeferredArg = std::is_pointer_v<T> || std::is_null_pointer_v<T> || std::is_integral_v<T> ||
+                                       std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+        template<typename T>
+        inline size_t encodedSize(const T &arg) {
+            if constexpr (isStringArg<T>) {
+                return 1 + sizeof(uint32_t) + std::strlen(arg ? (const char *)arg : "(null)") + 1;
+            } else {
+                return 1 + sizeof(uint64_t);
+            }
+        }
 
-        TracyMessage(buf.get(), size);
-        if (lvl > GetLogLevel()) return;
-        std::cerr << buf.get();
-        if (lvl < Level::Debug) {
-            GlobalLogOutput(lvl, string(buf.get(), buf.get() + size));
+        template<typename T>
+        inline char *encodeArg(char *dst, const T &arg) {
+            if constexpr (isStringArg<T>) {
+                const char *str = arg ? (const char *)arg : "(null)";
+                uint32_t length = std::strlen(str);
+                *dst++ = (char)ArgType::String;
+                std::memcpy(dst, &length, sizeof(length));
+                std::memcpy(dst + sizeof(length), str, length + 1);
+                return dst + sizeof(length) + length + 1;
+            } else {
+                ArgType type;
+                uint64_t bits = 0;
+                if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+                    type = ArgType::Pointer;
+                    auto ptr = (const void *)arg;
+                    std::memcpy(&bits, &ptr, sizeof(ptr));
+                } else if constexpr (std::is_floating_point_v<T>) {
+                    type = ArgType::Double;
+                    double value = arg;
+                    std::memcpy(&bits, &value, sizeof(value));
+                } else if constexpr (std::is_signed_v<T>) {
+                    // Match printf's argument promotion, so the sink passes the same types to snprintf
+                    type = sizeof(T) <= sizeof(int32_t) ? ArgType::Int32 : ArgType::Int64;
+                    int64_t value = arg;
+                    std::memcpy(&bits, &value, sizeof(value));
+                } else {
+                    type = sizeof(T) <= sizeof(uint32_t) ? ArgType::Uint32 : ArgType::Uint64;
+                    bits = (uint64_t)arg;
+                }
+                *dst++ = (char)type;
+                std::memcpy(dst, &bits, sizeof(bits));
+                return dst + sizeof(bits);
+            }
         }
+
+        /**
+         * Reserves size bytes in the calling thread's log buffer.
+         * Returns nullptr if the message was dropped, or if synchronous is set and it must be written immediately.
+         */
+        char *BeginRecord(Level lvl, size_t size, bool &synchronous);
+        void CommitRecord();
+        char *WriteRecordHeader(char *dst,
+            Level lvl,
+            const char *prefix,
+            bool timestamp,
+            bool print,
+            const std::string &fmt,
+            size_t argCount);
+
+        // Outputs an already formatted message on the calling thread, after any messages it has buffered.
+        void WriteNow(Level lvl, const char *prefix, bool timestamp, bool print, const char *message, size_t size);
+    } // namespace detail
+
+    template<typename... T>
+    inline static void writeFormatter(Level lvl, const char *prefix, bool timestamp, const std::string &fmt, T... t) {
+        bool print = lvl <= GetLogLevel();
+#ifndef TRACY_ENABLE
+        if (!print) return;
+#endif
+
+        if constexpr ((detail::isDeferredArg<T> && ...)) {
+            size_t size = sizeof(detail::RecordHeader) + fmt.size() + 1 + (detail::encodedSize(t) + ... + 0);
+            bool synchronous = false;
+            char *dst = detail::BeginRecord(lvl, size, synchronous);
+            if (dst) {
+                dst = detail::WriteRecordHeader(dst, lvl, prefix, timestamp, print, fmt, sizeof...(T));
+                ((dst = detail::encodeArg(dst, t)), ...);
+                detail::CommitRecord();
+                return;
+            } else if (!synchronous) {
+                return;
+            }
+        }
+
+        // Arguments that can't be copied into the log buffer are formatted on the calling thread
+        int size = std::snprintf(nullptr, 0, fmt.c_str(), t...);
+        std::unique_ptr<char[]> buf(new char[size + 1]);
+        std::snprintf(buf.get(), size + 1, fmt.c_str(), t...);
+        detail::WriteNow(lvl, prefix, timestamp, print, buf.get(), size);
     }
 
     template<typename... Tn>
-    inline static void writeLog(Level lvl, const char *file, int line, const std::string &fmt, Tn &&...tn) {
-        writeFormatter(lvl, "%.3f " + fmt + "\n", LogTime(), convert(std::forward<Tn>(tn))...);
+    inline static void writeLog(Level lvl, const char *prefix, const std::string &fmt, Tn &&...tn) {
+        writeFormatter(lvl, prefix, true, fmt, convert(std::forward<Tn>(tn))...);
     }
 
     template<typename... T>
     static void ConsoleWrite(Level lvl, const std::string &fmt, T... t) {
-        writeFormatter(lvl, fmt + "\n", convert(std::forward<T>(t))...);
+        writeFormatter(lvl, nullptr, false, fmt, convert(std::forward<T>(t))...);
     }
 
     template<typename... T>
     static void Trace(const char *file, int line, const std::string &fmt, T... t) {
-        writeLog(Level::Trace, file, line, "[trace] " + fmt, t...);
+        writeLog(Level::Trace, "[trace] ", fmt, t...);
     }
 
     template<typename... T>
     static void Debug(const char *file, int line, const std::string &fmt, T... t) {
-        writeLog(Level::Debug, file, line, "[dbg] " + fmt, t...);
+        writeLog(Level::Debug, "[dbg] ", fmt, t...);
     }
 
     template<typename... T>
     static void Log(const char *file, int line, const std::string &fmt, T... t) {
-        writeLog(Level::Log, file, line, "[log] " + fmt, t...);
+        writeLog(Level::Log, "[log] ", fmt, t...);
     }
 
     template<typename... T>
     static void Warn(const char *file, int line, const std::string &fmt, T... t) {
-        writeLog(Level::Warn, file, line, "[warn] " + fmt, t...);
+        writeLog(Level::Warn, "[warn] ", fmt, t...);
     }
 
     template<typename... T>
     static void Error(const char *file, int line, const std::string &fmt, T... t) {
-        writeLog(Level::Error, file, line, "[error] " + fmt, t...);
+        writeLog(Level::Error, "[error] ", fmt, t...);
     }
 
     template<typename... T>
     [[noreturn]] static void Abort(const char *file, int line, const std::string &fmt, T... t) {
-        writeLog(Level::Error, file, line, "[abort] " + fmt, t...);
+        writeLog(Level::Error, "[abort] ", fmt, t...);
+        Flush();
         sp::Abort();
     }
 } // namespace sp::logging
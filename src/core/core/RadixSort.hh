@@ -0,0 +1,66 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace sp {
+    // Maps a float to an unsigned integer with the same ordering, including negative values.
+    inline uint32 OrderedFloatBits(float value) {
+        uint32 bits = std::bit_cast<uint32>(value);
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    /**
+     * Stable LSD radix sort of items by a 64 bit key, 8 bits per pass.
+     * Passes where every key has the same byte are skipped, so keys packed into the low bits only pay for the bytes
+     * they use. Equal keys keep their input order, making the result deterministic.
+     *
+     * scratch is resized to match items and used as the second buffer between passes.
+     */
+    template<typename T, typename KeyFn>
+    void RadixSort(std::vector<T> &items, std::vector<T> &scratch, KeyFn &&keyFn) {
+        static_assert(std::is_trivially_copyable<T>(), "RadixSort items must be trivially copyable");
+        const size_t passCount = sizeof(uint64);
+        if (items.size() < 2) return;
+
+        std::array<std::array<size_t, 256>, passCount> histograms = {};
+        for (auto &item : items) {
+            uint64 key = keyFn(item);
+            for (size_t pass = 0; pass < passCount; pass++) {
+                histograms[pass][(key >> (pass * 8)) & 0xff]++;
+            }
+        }
+
+        scratch.resize(items.size());
+        T *src = items.data();
+        T *dst = scratch.data();
+        for (size_t pass = 0; pass < passCount; pass++) {
+            auto &histogram = histograms[pass];
+            uint64 firstByte = (keyFn(*src) >> (pass * 8)) & 0xff;
+            if (histogram[firstByte] == items.size()) continue;
+
+            size_t offset = 0;
+            for (auto &count : histogram) {
+                size_t bucketSize = count;
+                count = offset;
+                offset += bucketSize;
+            }
+            for (size_t i = 0; i < items.size(); i++) {
+                dst[histogram[(keyFn(src[i]) >> (pass * 8)) & 0xff]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+        if (src != items.data()) std::memcpy(items.data(), src, items.size() * sizeof(T));
+    }
+} // namespace sp
@@ -18,10 +18,12 @@
 
 namespace sp {
     RegisteredThread::RegisteredThread(std::string threadName, chrono_clock::duration interval, bool traceFrames)
-        : threadName(threadName), interval(interval), traceFrames(traceFrames), state(ThreadState::Stopped) {}
+        : threadName(threadName), interval(interval), traceFrames(traceFrames),
+          telemetry(RegisterThreadTelemetry(threadName)), state(ThreadState::Stopped) {}
 
     RegisteredThread::RegisteredThread(std::string threadName, double framesPerSecond, bool traceFrames)
-        : threadName(threadName), interval(0), traceFrames(traceFrames), state(ThreadState::Stopped) {
+        : threadName(threadName), interval(0), traceFrames(traceFrames), telemetry(RegisterThreadTelemetry(threadName)),
+          state(ThreadState::Stopped) {
         if (framesPerSecond > 0.0) {
             interval = std::chrono::nanoseconds((int64_t)(1e9 / framesPerSecond));
         }
@@ -58,6 +60,7 @@ namespace sp {
             try {
 #endif
                 while (state == ThreadState::Started) {
+                    auto frameStart = chrono_clock::now();
                     this->PreFrame();
                     if (stepMode) {
                         while (stepCount < maxStepCount) {
@@ -79,15 +82,18 @@ namespace sp {
                     if (this->interval.count() > 0) {
                         frameEnd += this->interval;
 
-                        if (realFrameEnd >= frameEnd) {
+                        bool missedDeadline = realFrameEnd >= frameEnd;
+                        if (missedDeadline) {
                             // Falling behind, reset target frame end time.
                             // Add some extra time to allow other threads to start transactions.
                             frameEnd = realFrameEnd + std::chrono::nanoseconds(100);
                         }
 
                         std::this_thread::sleep_until(frameEnd);
+                        telemetry->AddFrame(frameStart, realFrameEnd, chrono_clock::now(), frameEnd, missedDeadline);
                     } else {
                         std::this_thread::yield();
+                        telemetry->AddFrame(frameStart, realFrameEnd, chrono_clock::now(), {}, false);
                     }
                 }
 #ifdef CATCH_GLOBAL_EXCEPTIONS
@@ -8,8 +8,10 @@
 #pragma once
 
 #include "core/Common.hh"
+#include "core/ThreadTelemetry.hh"
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <thread>
 
@@ -27,6 +29,7 @@ namespace sp {
         chrono_clock::duration interval;
         std::atomic_uint64_t stepCount, maxStepCount;
         const bool traceFrames = false;
+        const std::shared_ptr<ThreadTelemetry> telemetry;
 
     protected:
         void StartThread(bool stepMode = false);
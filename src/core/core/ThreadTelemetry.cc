@@ -0,0 +1,170 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "ThreadTelemetry.hh"
+
+#include "core/Logging.hh"
+
+#include <mutex>
+
+namespace sp {
+    // Registered threads may be constructed during static initialization, so these are initialized on first use
+    struct TelemetryRegistry {
+        const chrono_clock::time_point epoch = chrono_clock::now();
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadTelemetry>> threads;
+    };
+
+    static TelemetryRegistry &telemetryRegistry() {
+        static TelemetryRegistry registry;
+        return registry;
+    }
+
+    static uint64 toNanoseconds(chrono_clock::duration duration) {
+        if (duration.count() <= 0) return 0;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    static double toMilliseconds(uint64 nanoseconds) {
+        return nanoseconds / 1000000.0;
+    }
+
+    void ThreadTelemetry::AddFrame(chrono_clock::time_point frameStart,
+        chrono_clock::time_point workEnd,
+        chrono_clock::time_point frameEnd,
+        chrono_clock::time_point sleepTarget,
+        bool missedDeadline) {
+        auto workTime = workEnd - frameStart;
+        chrono_clock::duration sleepOvershoot(0);
+        if (sleepTarget != chrono_clock::time_point() && frameEnd > sleepTarget) {
+            sleepOvershoot = frameEnd - sleepTarget;
+        }
+
+        uint64 index = frameCount.load(std::memory_order_relaxed);
+        auto &entry = ring[index & (RING_SIZE - 1)];
+        entry.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.frameStart.store(frameStart.time_since_epoch().count(), std::memory_order_relaxed);
+        entry.frameEnd.store(frameEnd.time_since_epoch().count(), std::memory_order_relaxed);
+        entry.workTime.store(workTime.count(), std::memory_order_relaxed);
+        entry.sleepOvershoot.store(sleepOvershoot.count(), std::memory_order_relaxed);
+        entry.missedDeadline.store(missedDeadline, std::memory_order_relaxed);
+        entry.sequence.store(index * 2 + 2, std::memory_order_release);
+        frameCount.store(index + 1, std::memory_order_release);
+
+        frameTimes.AddSample(toNanoseconds(frameEnd - frameStart));
+        workTimes.AddSample(toNanoseconds(workTime));
+        totalSleepOvershoot.fetch_add(toNanoseconds(sleepOvershoot), std::memory_order_relaxed);
+        if (missedDeadline) missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<ThreadTelemetry::Frame> ThreadTelemetry::GetFrames(size_t maxFrames) const {
+        uint64 end = frameCount.load(std::memory_order_acquire);
+        uint64 count = std::min({(uint64)maxFrames, (uint64)RING_SIZE, end});
+
+        std::vector<Frame> frames;
+        frames.reserve(count);
+        for (uint64 index = end - count; index < end; index++) {
+            auto &entry = ring[index & (RING_SIZE - 1)];
+            uint64 sequence = entry.sequence.load(std::memory_order_acquire);
+            // Skip entries that have been overwritten, or are being overwritten
+            if (sequence != index * 2 + 2) continue;
+
+            Frame frame;
+            frame.index = index;
+            frame.frameStart = chrono_clock::time_point(
+                chrono_clock::duration(entry.frameStart.load(std::memory_order_relaxed)));
+            frame.frameEnd = chrono_clock::time_point(
+                chrono_clock::duration(entry.frameEnd.load(std::memory_order_relaxed)));
+            frame.workTime = chrono_clock::duration(entry.workTime.load(std::memory_order_relaxed));
+            frame.sleepOvershoot = chrono_clock::duration(entry.sleepOvershoot.load(std::memory_order_relaxed));
+            frame.missedDeadline = entry.missedDeadline.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) != sequence) continue;
+            frames.emplace_back(frame);
+        }
+        return frames;
+    }
+
+    std::shared_ptr<ThreadTelemetry> RegisterThreadTelemetry(const std::string &threadName) {
+        auto telemetry = std::make_shared<ThreadTelemetry>(threadName);
+        auto &registry = telemetryRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.threads.emplace_back(telemetry);
+        return telemetry;
+    }
+
+    std::vector<std::shared_ptr<ThreadTelemetry>> GetThreadTelemetry() {
+        auto &registry = telemetryRegistry();
+        std::lock_guard lock(registry.mutex);
+        return registry.threads;
+    }
+
+    void PrintThreadTelemetry(const std::string &filter) {
+        for (auto &telemetry : GetThreadTelemetry()) {
+            if (!filter.empty() && telemetry->threadName.find(filter) == std::string::npos) continue;
+            uint64 frameCount = telemetry->FrameCount();
+            if (frameCount == 0) continue;
+
+            auto &frameTimes = telemetry->frameTimes;
+            auto &workTimes = telemetry->workTimes;
+            Logf("%s: %u frames, %u missed deadlines, avg sleep overshoot %.3fms",
+                telemetry->threadName,
+                frameCount,
+                telemetry->missedDeadlines.load(),
+                toMilliseconds(telemetry->totalSleepOvershoot.load() / frameCount));
+            Logf("    frame time: p50 %.3fms, p90 %.3fms, p99 %.3fms, p99.9 %.3fms, max %.3fms",
+                toMilliseconds(frameTimes.GetPercentile(50)),
+                toMilliseconds(frameTimes.GetPercentile(90)),
+                toMilliseconds(frameTimes.GetPercentile(99)),
+                toMilliseconds(frameTimes.GetPercentile(99.9)),
+                toMilliseconds(frameTimes.max.load()));
+            Logf("    work time: p50 %.3fms, p90 %.3fms, p99 %.3fms, p99.9 %.3fms, max %.3fms",
+                toMilliseconds(workTimes.GetPercentile(50)),
+                toMilliseconds(workTimes.GetPercentile(90)),
+                toMilliseconds(workTimes.GetPercentile(99)),
+                toMilliseconds(workTimes.GetPercentile(99.9)),
+                toMilliseconds(workTimes.max.load()));
+        }
+    }
+
+    void PrintThreadFrames(const std::string &threadName, size_t count) {
+        auto epoch = telemetryRegistry().epoch;
+        bool found = false;
+        for (auto &telemetry : GetThreadTelemetry()) {
+            if (telemetry->threadName != threadName) continue;
+            found = true;
+
+            for (auto &frame : telemetry->GetFrames(count)) {
+                Logf("%s frame %u: start %.3fms, frame %.3fms, work %.3fms, sleep overshoot %.3fms%s",
+                    threadName,
+                    frame.index,
+                    toMilliseconds(toNanoseconds(frame.frameStart - epoch)),
+                    toMilliseconds(toNanoseconds(frame.frameEnd - frame.frameStart)),
+                    toMilliseconds(toNanoseconds(frame.workTime)),
+                    toMilliseconds(toNanoseconds(frame.sleepOvershoot)),
+                    frame.missedDeadline ? ", missed deadline" : "");
+            }
+        }
+        if (!found) Errorf("No registered thread named: %s", threadName);
+    }
+
+    void SaveThreadTelemetryCsv(std::ostream &out) {
+        auto epoch = telemetryRegistry().epoch;
+        out << "thread,frame,frame_start_ns,frame_end_ns,work_ns,sleep_overshoot_ns,missed_deadline" << std::endl;
+        for (auto &telemetry : GetThreadTelemetry()) {
+            for (auto &frame : telemetry->GetFrames()) {
+                out << telemetry->threadName << "," << frame.index << ",";
+                out << toNanoseconds(frame.frameStart - epoch) << "," << toNanoseconds(frame.frameEnd - epoch) << ",";
+                out << toNanoseconds(frame.workTime) << "," << toNanoseconds(frame.sleepOvershoot) << ",";
+                out << (frame.missedDeadline ? 1 : 0) << "\n";
+            }
+        }
+        out.flush();
+    }
+} // namespace sp
@@ -0,0 +1,134 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sp {
+    /**
+     * A histogram with HDR-style buckets: values below SubBucketCount are exact, and each power of two above that is
+     * split into SubBucketCount linear buckets, giving every value the same relative precision.
+     * Samples can be added while other threads are reading percentiles.
+     */
+    template<size_t SubBucketBits = 5, size_t MaxBits = 40>
+    struct LogHistogram {
+        static constexpr size_t SubBucketCount = 1 << SubBucketBits;
+        static constexpr size_t BucketCount = (MaxBits - SubBucketBits + 1) * SubBucketCount;
+        static constexpr uint64 MaxValue = (1ull << MaxBits) - 1;
+
+        std::array<std::atomic_uint32_t, BucketCount> buckets = {};
+        std::atomic_uint64_t count = 0, max = 0;
+
+        static size_t BucketIndex(uint64 value) {
+            value = std::min(value, MaxValue);
+            if (value < SubBucketCount) return value;
+            size_t shift = std::bit_width(value) - SubBucketBits - 1;
+            return shift * SubBucketCount + (value >> shift);
+        }
+
+        // Returns the largest value that would be stored in the bucket at index
+        static uint64 BucketValue(size_t index) {
+            if (index < SubBucketCount) return index;
+            size_t shift = index / SubBucketCount - 1;
+            uint64 lowest = (uint64)(index - shift * SubBucketCount) << shift;
+            return lowest + (1ull << shift) - 1;
+        }
+
+        void AddSample(uint64 sample) {
+            buckets[BucketIndex(sample)].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            uint64 current = max.load(std::memory_order_relaxed);
+            while (sample > current && !max.compare_exchange_weak(current, sample, std::memory_order_relaxed)) {}
+        }
+
+        uint64 GetPercentile(double percentile) const {
+            uint64 total = count.load(std::memory_order_relaxed);
+            if (total == 0) return 0;
+            uint64 target = std::max<uint64>(1, (uint64)std::ceil(percentile * total / 100.0));
+            uint64 sum = 0;
+            for (size_t i = 0; i < buckets.size(); i++) {
+                sum += buckets[i].load(std::memory_order_relaxed);
+                if (sum >= target) return std::min(BucketValue(i), max.load(std::memory_order_relaxed));
+            }
+            return max.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * Always-on frame timing for a RegisteredThread. Frames are written by the owning thread into a fixed-size ring
+     * without locking, and can be read from any thread. Frames that are overwritten while being read are skipped.
+     */
+    class ThreadTelemetry : public NonCopyable {
+    public:
+        static constexpr size_t RING_SIZE = 1024;
+        static_assert(std::has_single_bit(RING_SIZE), "ThreadTelemetry::RING_SIZE must be a power of 2");
+
+        struct Frame {
+            uint64 index;
+            chrono_clock::time_point frameStart, frameEnd;
+            chrono_clock::duration workTime, sleepOvershoot;
+            bool missedDeadline;
+        };
+
+        ThreadTelemetry(const std::string &threadName) : threadName(threadName) {}
+
+        /**
+         * Must only be called by the owning thread. workEnd is when Frame() and PostFrame() returned, and frameEnd is
+         * when the thread woke up for the next frame. sleepTarget should be left default if the thread isn't paced.
+         */
+        void AddFrame(chrono_clock::time_point frameStart,
+            chrono_clock::time_point workEnd,
+            chrono_clock::time_point frameEnd,
+            chrono_clock::time_point sleepTarget,
+            bool missedDeadline);
+
+        // Returns up to maxFrames of the most recent frames, oldest first
+        std::vector<Frame> GetFrames(size_t maxFrames = RING_SIZE) const;
+
+        uint64 FrameCount() const {
+            return frameCount.load(std::memory_order_acquire);
+        }
+
+        const std::string threadName;
+
+        // Totals since the thread was created, durations are in nanoseconds
+        LogHistogram<> frameTimes, workTimes;
+        std::atomic_uint64_t missedDeadlines = 0, totalSleepOvershoot = 0;
+
+    private:
+        struct RingEntry {
+            // Set to index * 2 + 1 while the entry is being written, and index * 2 + 2 once it is complete
+            std::atomic_uint64_t sequence = 0;
+            std::atomic<chrono_clock::rep> frameStart, frameEnd, workTime, sleepOvershoot;
+            std::atomic_bool missedDeadline;
+        };
+
+        std::array<RingEntry, RING_SIZE> ring;
+        std::atomic_uint64_t frameCount = 0;
+    };
+
+    // Telemetry is kept for the lifetime of the process so stopped threads are still included in reports
+    std::shared_ptr<ThreadTelemetry> RegisterThreadTelemetry(const std::string &threadName);
+    std::vector<std::shared_ptr<ThreadTelemetry>> GetThreadTelemetry();
+
+    // Logs frame time percentiles for every thread, or only threads matching the filter
+    void PrintThreadTelemetry(const std::string &filter = "");
+    // Logs the most recent frames recorded for a thread
+    void PrintThreadFrames(const std::string &threadName, size_t count);
+    // Writes every frame still in each thread's ring as CSV, with times relative to process start
+    void SaveThreadTelemetryCsv(std::ostream &out);
+} // namespace sp
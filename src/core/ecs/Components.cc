@@ -11,6 +11,7 @@
 
 #include <glm/glm.hpp>
 #include <map>
+#include <robin_hood.h>
 #include <stdexcept>
 #include <typeindex>
 
@@ -67,4 +68,84 @@ namespace ecs {
     void ForEachComponent(std::function<void(const std::string &, const ComponentBase &)> callback) {
         forEachComponent((ecs::ECS *)nullptr, callback);
     }
+
+    const ComponentBase *LookupComponentSchema(sp::Hash64 schemaHash) {
+        static const auto schemaMap = [] {
+            Assertf(componentNameMap != nullptr, "LookupComponentSchema called before components registered.");
+            robin_hood::unordered_flat_map<sp::Hash64, const ComponentBase *> map;
+            for (auto &[name, comp] : *componentNameMap) {
+                auto [it, inserted] = map.emplace(comp->SchemaHash(), comp);
+                Assertf(inserted, "Duplicate component schema hash: %s and %s", it->second->name, name);
+            }
+            return map;
+        }();
+
+        auto it = schemaMap.find(schemaHash);
+        if (it != schemaMap.end()) return it->second;
+        return nullptr;
+    }
+
+    template<typename T>
+    const ComponentBase &lookupComponentCached() {
+        static const ComponentBase *base = LookupComponent(typeid(T));
+        Assertf(base != nullptr, "Component lookup returned nullptr: %s", typeid(T).name());
+        return *base;
+    }
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    void saveEntityBinary(ECSType<AllComponentTypes...> *, sp::binary::Writer &dst, const FlatEntity &src) {
+        size_t countOffset = dst.Size();
+        uint32_t count = 0;
+        dst.WriteRaw(count);
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                if constexpr (std::is_same_v<T, SceneInfo>) {
+                    // Skip
+                } else if constexpr (!Tecs::is_global_component<T>()) {
+                    auto &opt = std::get<std::optional<T>>(src);
+                    if (!opt) return;
+
+                    auto &base = lookupComponentCached<T>();
+                    dst.WriteRaw(base.SchemaHash());
+                    size_t sizeOffset = dst.Size();
+                    dst.WriteRaw<uint32_t>(0);
+                    base.SaveBinary(dst, &*opt);
+                    dst.Patch(sizeOffset, (uint32_t)(dst.Size() - sizeOffset - sizeof(uint32_t)));
+                    count++;
+                }
+            }(),
+            ...);
+        dst.Patch(countOffset, count);
+    }
+
+    void SaveEntityBinary(sp::binary::Writer &dst, const FlatEntity &src) {
+        saveEntityBinary((ecs::ECS *)nullptr, dst, src);
+    }
+
+    bool LoadEntityBinary(FlatEntity &dst, sp::binary::Reader &src) {
+        uint32_t count;
+        if (!src.ReadRaw(count)) return false;
+        for (uint32_t i = 0; i < count; i++) {
+            sp::Hash64 schemaHash;
+            uint32_t size;
+            sp::binary::Reader data;
+            if (!src.ReadRaw(schemaHash) || !src.ReadRaw(size) || !src.Slice(size, data)) {
+                Errorf("Binary entity data is truncated");
+                return false;
+            }
+
+            auto *comp = LookupComponentSchema(schemaHash);
+            if (!comp) {
+                Warnf("Skipping binary component with unknown schema: %016llx", (unsigned long long)schemaHash);
+                continue;
+            }
+            if (!comp->LoadBinary(dst, data) || data.Remaining() > 0) {
+                Errorf("Binary entity has invalid %s component", comp->name);
+                return false;
+            }
+        }
+        return true;
+    }
 } // namespace ecs
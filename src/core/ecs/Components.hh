@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "assets/BinaryHelpers.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/StructMetadata.hh"
 #include "ecs/components/Name.hh"
@@ -55,6 +56,11 @@ namespace ecs {
         virtual const void *GetLiveDefault() const = 0;
         virtual const void *GetStagingDefault() const = 0;
 
+        // Binary data contains every field, and can only be loaded by a component with the same SchemaHash()
+        virtual bool LoadBinary(FlatEntity &dst, sp::binary::Reader &src) const = 0;
+        virtual void SaveBinary(sp::binary::Writer &dst, const void *src) const = 0;
+        virtual sp::Hash64 SchemaHash() const = 0;
+
         template<typename T>
         void ApplyComponent(T &dst, const T &src, bool liveTarget) const {
             dynamic_cast<const Component<T> *>(this)->ApplyComponent(dst, src, liveTarget);
@@ -73,9 +79,18 @@ namespace ecs {
     const ComponentBase *LookupComponent(const std::string &name);
     const ComponentBase *LookupComponent(const std::type_index &idx);
 
+    const ComponentBase *LookupComponentSchema(sp::Hash64 schemaHash);
+
     // Calls the provided function for all components except Name and SceneInfo
     void ForEachComponent(std::function<void(const std::string &, const ComponentBase &)> callback);
 
+    /**
+     * Entities are saved in binary as a component count, followed by each component's schema hash, data size, and
+     * data. Components with an unknown schema hash are skipped when loading. SceneInfo is never saved.
+     */
+    void SaveEntityBinary(sp::binary::Writer &dst, const FlatEntity &src);
+    bool LoadEntityBinary(FlatEntity &dst, sp::binary::Reader &src);
+
     template<typename T>
     const Component<T> &LookupComponent() {
         auto ptr = LookupComponent(std::type_index(typeid(T)));
@@ -151,6 +166,21 @@ namespace ecs {
             }
         }
 
+        bool LoadBinary(FlatEntity &dst, sp::binary::Reader &src) const override {
+            CompType comp = defaultStagingComponent;
+            if (!sp::binary::Load(comp, src)) return false;
+            std::get<std::optional<CompType>>(dst) = std::move(comp);
+            return true;
+        }
+
+        void SaveBinary(sp::binary::Writer &dst, const void *src) const override {
+            sp::binary::Save(dst, *static_cast<const CompType *>(src));
+        }
+
+        sp::Hash64 SchemaHash() const override {
+            return sp::binary::HashCombine(sp::binary::SchemaHash<CompType>(), name);
+        }
+
         void ApplyComponent(CompType &dst, const CompType &src, bool liveTarget) const {
             const auto &defaultComponent = liveTarget ? defaultLiveComponent : defaultStagingComponent;
             // Merge existing component with a new one
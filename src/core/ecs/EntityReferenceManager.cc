@@ -14,36 +14,187 @@
 #include <shared_mutex>
 
 namespace ecs {
+    // Unreferenced names are kept for this long before being removed, matching the previous PreservingMap
+    const int64_t REF_PRESERVE_AGE_MS = 1000;
+    const size_t MIN_TABLE_CAPACITY = 16;
+
+    /**
+     * Epoch based reclamation for the lock-free name tables. Each thread publishes the global epoch while it is
+     * reading a table, and 0 otherwise. Anything retired at epoch N can be freed once no thread is reading at an
+     * epoch <= N.
+     */
+    struct alignas(64) ReaderEpoch {
+        std::atomic_uint64_t epoch = 0;
+    };
+
+    struct ReaderRegistry {
+        std::atomic_uint64_t epoch = 1;
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ReaderEpoch>> readers;
+    };
+
+    static ReaderRegistry &getReaderRegistry() {
+        static ReaderRegistry registry;
+        return registry;
+    }
+
+    struct ThreadReaderEpoch {
+        std::shared_ptr<ReaderEpoch> reader = std::make_shared<ReaderEpoch>();
+
+        ThreadReaderEpoch() {
+            auto &registry = getReaderRegistry();
+            std::lock_guard lock(registry.mutex);
+            registry.readers.emplace_back(reader);
+        }
+
+        ~ThreadReaderEpoch() {
+            auto &registry = getReaderRegistry();
+            std::lock_guard lock(registry.mutex);
+            std::erase(registry.readers, reader);
+        }
+    };
+
+    class ReadGuard {
+    public:
+        ReadGuard() : reader(*threadReader.reader) {
+            reader.epoch = getReaderRegistry().epoch.load();
+        }
+
+        ~ReadGuard() {
+            reader.epoch.store(0, std::memory_order_release);
+        }
+
+    private:
+        static thread_local ThreadReaderEpoch threadReader;
+        ReaderEpoch &reader;
+    };
+
+    thread_local ThreadReaderEpoch ReadGuard::threadReader;
+
+    static uint64_t retireEpoch() {
+        return getReaderRegistry().epoch.fetch_add(1);
+    }
+
+    static bool isEpochReleased(uint64_t epoch) {
+        auto &registry = getReaderRegistry();
+        std::lock_guard lock(registry.mutex);
+        for (auto &reader : registry.readers) {
+            auto readerEpoch = reader->epoch.load();
+            if (readerEpoch != 0 && readerEpoch <= epoch) return false;
+        }
+        return true;
+    }
+
     EntityReferenceManager &GetEntityRefs() {
         static EntityReferenceManager entityRefs;
         return entityRefs;
     }
 
+    EntityReferenceManager::RefEntry::RefEntry(const Name &name, size_t hash)
+        : hash(hash), ref(make_shared<EntityRef::Ref>(name)) {}
+
+    EntityReferenceManager::RefTable::RefTable(size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<RefEntry *>[capacity]()) {
+        Assertf((capacity & mask) == 0, "RefTable capacity must be a power of 2: %u", capacity);
+    }
+
+    EntityReferenceManager::RefEntry *EntityReferenceManager::RefTable::Find(const Name &name, size_t hash) const {
+        for (size_t i = (hash / SHARD_COUNT) & mask;; i = (i + 1) & mask) {
+            auto *entry = slots[i].load(std::memory_order_acquire);
+            if (!entry) return nullptr;
+            if (entry->hash == hash && entry->ref->name == name) return entry;
+        }
+    }
+
+    void EntityReferenceManager::RefTable::Insert(RefEntry *entry) {
+        for (size_t i = (entry->hash / SHARD_COUNT) & mask;; i = (i + 1) & mask) {
+            if (!slots[i].load(std::memory_order_relaxed)) {
+                slots[i].store(entry, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    EntityReferenceManager::EntityReferenceManager() : lastTick(chrono_clock::now()) {}
+
     EntityRef EntityReferenceManager::Get(const Name &name) {
         if (!name) return EntityRef();
 
-        EntityRef ref = entityRefs.Load(name);
-        if (!ref) {
-            std::lock_guard lock(mutex);
-            ref = entityRefs.Load(name);
-            if (ref) return ref;
+        size_t hash = std::hash<Name>()(name);
+        auto &shard = nameShards[hash % SHARD_COUNT];
+        {
+            ReadGuard guard;
+            auto *table = shard.published.load(std::memory_order_acquire);
+            auto *entry = table ? table->Find(name, hash) : nullptr;
+            if (entry) {
+                EntityRef ref(entry->ref);
+                // Pairs with the fence in Tick(), either Tick() sees this reference, or this sees the removal
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!entry->removed.load(std::memory_order_relaxed)) {
+                    if (entry->unusedMs.load(std::memory_order_relaxed) != 0) entry->unusedMs = 0;
+                    return ref;
+                }
+            }
+        }
+        return Insert(shard, name, hash);
+    }
 
-            ref = make_shared<EntityRef::Ref>(name);
-            entityRefs.Register(name, ref.ptr);
+    EntityRef EntityReferenceManager::Insert(NameShard &shard, const Name &name, size_t hash) {
+        std::lock_guard lock(shard.mutex);
+        if (shard.table) {
+            auto *entry = shard.table->Find(name, hash);
+            if (entry) {
+                entry->unusedMs = 0;
+                return EntityRef(entry->ref);
+            }
         }
+
+        auto &entry = shard.entries.emplace_back(make_unique<RefEntry>(name, hash));
+        EntityRef ref(entry->ref);
+
+        // Keep the table at most half full so probe sequences stay short
+        size_t capacity = shard.table ? shard.table->mask + 1 : 0;
+        if (shard.entries.size() * 2 > capacity) {
+            Publish(shard, std::max(capacity * 2, MIN_TABLE_CAPACITY), {});
+        } else {
+            shard.table->Insert(entry.get());
+        }
+
+        std::lock_guard indexLock(indexMutex);
+        fullNameIndex.emplace(name.String(), name);
+        entityNameIndex.emplace(name.entity, name);
         return ref;
     }
 
+    void EntityReferenceManager::Publish(NameShard &shard,
+        size_t capacity,
+        std::vector<std::unique_ptr<RefEntry>> &&removed) {
+        auto table = make_unique<RefTable>(capacity);
+        for (auto &entry : shard.entries) {
+            table->Insert(entry.get());
+        }
+        shard.published = table.get();
+        std::swap(shard.table, table);
+
+        if (table || !removed.empty()) {
+            std::lock_guard lock(retiredMutex);
+            retired.emplace_back(RetiredRefs{retireEpoch(), std::move(table), std::move(removed)});
+        }
+    }
+
     EntityRef EntityReferenceManager::Get(const Entity &entity) {
         if (!entity) return EntityRef();
 
-        std::shared_lock lock(mutex);
+        auto &shard = entityShards[entity.index % SHARD_COUNT];
+        std::shared_lock lock(shard.mutex);
         if (IsLive(entity)) {
-            if (liveRefs.count(entity) == 0) return EntityRef();
-            return EntityRef(liveRefs[entity].lock());
+            auto it = shard.liveRefs.find(entity);
+            if (it == shard.liveRefs.end()) return EntityRef();
+            return EntityRef(it->second.lock());
         } else if (IsStaging(entity)) {
-            if (stagingRefs.count(entity) == 0) return EntityRef();
-            return EntityRef(stagingRefs[entity].lock());
+            auto it = shard.stagingRefs.find(entity);
+            if (it == shard.stagingRefs.end()) return EntityRef();
+            return EntityRef(it->second.lock());
         } else {
             Abortf("Invalid EntityReferenceManager entity: %s", std::to_string(entity));
         }
@@ -53,13 +204,14 @@ namespace ecs {
         Assertf(entity, "Trying to set EntityRef with null Entity");
 
         auto ref = Get(name);
-        std::lock_guard lock(mutex);
+        auto &shard = entityShards[entity.index % SHARD_COUNT];
+        std::lock_guard lock(shard.mutex);
         if (IsLive(entity)) {
             ref.ptr->liveEntity = entity;
-            liveRefs[entity] = ref.ptr;
+            shard.liveRefs[entity] = ref.ptr;
         } else if (IsStaging(entity)) {
             ref.ptr->stagingEntity = entity;
-            stagingRefs[entity] = ref.ptr;
+            shard.stagingRefs[entity] = ref.ptr;
         } else {
             Abortf("Invalid EntityReferenceManager entity: %s", std::to_string(entity));
         }
@@ -68,24 +220,92 @@ namespace ecs {
 
     std::set<Name> EntityReferenceManager::GetNames(const std::string &search) {
         std::set<Name> results;
-        entityRefs.ForEach([&](auto &name, auto &) {
-            if (search.empty() || name.String().find(search) != std::string::npos) {
-                results.emplace(name);
+        std::lock_guard lock(indexMutex);
+        auto addPrefixMatches = [&](auto &index) {
+            for (auto it = index.lower_bound(search); it != index.end() && it->first.starts_with(search); it++) {
+                results.emplace(it->second);
             }
-        });
+        };
+        addPrefixMatches(fullNameIndex);
+        if (!search.empty() && search.find(':') == std::string::npos) addPrefixMatches(entityNameIndex);
         return results;
     }
 
+    void EntityReferenceManager::ReleaseEntity(const Entity &entity) {
+        if (!entity) return;
+        auto &shard = entityShards[entity.index % SHARD_COUNT];
+        std::lock_guard lock(shard.mutex);
+        if (IsLive(entity)) {
+            shard.liveRefs.erase(entity);
+        } else {
+            shard.stagingRefs.erase(entity);
+        }
+    }
+
     void EntityReferenceManager::Tick(chrono_clock::duration maxTickInterval) {
-        entityRefs.Tick(maxTickInterval, [this](std::shared_ptr<EntityRef::Ref> &refPtr) {
-            EntityRef ref(refPtr);
-            auto staging = ref.GetStaging();
-            auto live = ref.GetLive();
-            if (staging || live) {
-                std::lock_guard lock(mutex);
-                if (staging) stagingRefs.erase(staging);
-                if (live) liveRefs.erase(live);
+        auto now = chrono_clock::now();
+        chrono_clock::duration tickInterval = std::min(now - lastTick, maxTickInterval);
+        lastTick = now;
+        auto intervalMs = std::chrono::duration_cast<std::chrono::milliseconds>(tickInterval).count();
+
+        for (auto &shard : nameShards) {
+            std::lock_guard lock(shard.mutex);
+            std::vector<std::unique_ptr<RefEntry>> removed;
+            for (size_t i = 0; i < shard.entries.size();) {
+                auto &entry = *shard.entries[i];
+                if (entry.ref.use_count() > 1) {
+                    if (entry.unusedMs.load(std::memory_order_relaxed) != 0) entry.unusedMs = 0;
+                    i++;
+                    continue;
+                } else if ((entry.unusedMs += intervalMs) <= REF_PRESERVE_AGE_MS) {
+                    i++;
+                    continue;
+                }
+
+                // A reader may have found this entry just before it was marked removed
+                entry.removed = true;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (entry.ref.use_count() > 1) {
+                    entry.removed = false;
+                    entry.unusedMs = 0;
+                    i++;
+                    continue;
+                }
+
+                removed.emplace_back(std::move(shard.entries[i]));
+                shard.entries[i] = std::move(shard.entries.back());
+                shard.entries.pop_back();
+            }
+            if (removed.empty()) continue;
+
+            size_t capacity = shard.table->mask + 1;
+            while (capacity > MIN_TABLE_CAPACITY && shard.entries.size() * 8 < capacity) {
+                capacity /= 2;
+            }
+            for (auto &entry : removed) {
+                ReleaseEntity(entry->ref->stagingEntity.load());
+                ReleaseEntity(entry->ref->liveEntity.load());
             }
+            {
+                std::lock_guard indexLock(indexMutex);
+                for (auto &entry : removed) {
+                    auto &name = entry->ref->name;
+                    fullNameIndex.erase(name.String());
+                    auto [begin, end] = entityNameIndex.equal_range(name.entity);
+                    for (auto it = begin; it != end; it++) {
+                        if (it->second == name) {
+                            entityNameIndex.erase(it);
+                            break;
+                        }
+                    }
+                }
+            }
+            Publish(shard, capacity, std::move(removed));
+        }
+
+        std::lock_guard lock(retiredMutex);
+        std::erase_if(retired, [](auto &refs) {
+            return isEpochReleased(refs.epoch);
         });
     }
 } // namespace ecs
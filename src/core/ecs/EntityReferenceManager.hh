@@ -8,36 +8,105 @@
 #pragma once
 
 #include "core/Common.hh"
-#include "core/EntityMap.hh"
 #include "core/LockFreeMutex.hh"
-#include "core/PreservingMap.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EntityRef.hh"
 #include "ecs/SignalRef.hh"
 #include "ecs/components/Name.hh"
 #include "ecs/components/Signals.hh"
 
+#include <array>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <robin_hood.h>
+#include <set>
+#include <vector>
 
 namespace ecs {
-    class EntityReferenceManager {
+    /**
+     * Tracks a single EntityRef::Ref per name, so every EntityRef with the same name shares one handle and can be
+     * compared by pointer.
+     *
+     * Name lookups are split across shards by hash. Each shard publishes an open-addressed table of entries that is
+     * read without locking. Writers serialize on the shard's mutex, and replace the table whenever it grows or entries
+     * are removed. Replaced tables and removed entries are only freed once every reader that could still see them
+     * has finished, so Get(name) never blocks on another thread unless the name is new.
+     */
+    class EntityReferenceManager : public sp::NonCopyable {
     public:
-        EntityReferenceManager() {}
+        EntityReferenceManager();
 
         EntityRef Get(const Name &name);
         EntityRef Get(const Entity &entity);
         EntityRef Set(const Name &name, const Entity &entity);
+
+        // Returns all names where either the full name or the entity part of the name starts with search
         std::set<Name> GetNames(const std::string &search = "");
 
         void Tick(chrono_clock::duration maxTickInterval);
 
     private:
-        sp::LockFreeMutex mutex;
-        sp::PreservingMap<Name, EntityRef::Ref, 1000> entityRefs;
-        sp::EntityMap<std::weak_ptr<EntityRef::Ref>> stagingRefs;
-        sp::EntityMap<std::weak_ptr<EntityRef::Ref>> liveRefs;
+        static constexpr size_t SHARD_COUNT = 64;
+
+        struct RefEntry {
+            RefEntry(const Name &name, size_t hash);
+
+            size_t hash;
+            std::shared_ptr<EntityRef::Ref> ref;
+            // Milliseconds since the ref was last used outside of the manager
+            std::atomic_int64_t unusedMs = 0;
+            std::atomic_bool removed = false;
+        };
+
+        struct RefTable {
+            RefTable(size_t capacity);
+
+            RefEntry *Find(const Name &name, size_t hash) const;
+            void Insert(RefEntry *entry);
+
+            size_t mask;
+            std::unique_ptr<std::atomic<RefEntry *>[]> slots;
+        };
+
+        struct alignas(64) NameShard {
+            std::mutex mutex;
+            std::atomic<RefTable *> published = nullptr;
+
+            // Guarded by mutex
+            std::unique_ptr<RefTable> table;
+            std::vector<std::unique_ptr<RefEntry>> entries;
+        };
+
+        struct alignas(64) EntityShard {
+            sp::LockFreeMutex mutex;
+            robin_hood::unordered_flat_map<Entity, std::weak_ptr<EntityRef::Ref>> stagingRefs;
+            robin_hood::unordered_flat_map<Entity, std::weak_ptr<EntityRef::Ref>> liveRefs;
+        };
+
+        // Tables and entries that may still be visible to readers of the given epoch
+        struct RetiredRefs {
+            uint64_t epoch;
+            std::unique_ptr<RefTable> table;
+            std::vector<std::unique_ptr<RefEntry>> entries;
+        };
+
+        EntityRef Insert(NameShard &shard, const Name &name, size_t hash);
+        void Publish(NameShard &shard, size_t capacity, std::vector<std::unique_ptr<RefEntry>> &&removed);
+        void ReleaseEntity(const Entity &entity);
+
+        std::array<NameShard, SHARD_COUNT> nameShards;
+        std::array<EntityShard, SHARD_COUNT> entityShards;
+
+        std::mutex retiredMutex;
+        std::vector<RetiredRefs> retired;
+
+        std::mutex indexMutex;
+        std::map<std::string, Name, std::less<>> fullNameIndex;
+        std::multimap<std::string, Name, std::less<>> entityNameIndex;
+
+        chrono_clock::time_point lastTick;
     };
 
     struct EntityRef::Ref {
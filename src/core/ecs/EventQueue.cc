@@ -12,8 +12,11 @@
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
 
+#include <deque>
 #include <optional>
 #include <picojson/picojson.h>
+#include <robin_hood.h>
+#include <shared_mutex>
 #include <sstream>
 
 namespace ecs {
@@ -73,6 +76,62 @@ namespace ecs {
             src);
     }
 
+    struct EventNameTable {
+        std::shared_mutex mutex;
+        // Deque elements don't move, so EventNames can hold pointers to their string
+        std::deque<std::string> names;
+        robin_hood::unordered_flat_map<std::string_view, uint32_t> ids;
+
+        EventNameTable() {
+            ids.emplace(names.emplace_back(), 0);
+        }
+    };
+
+    static EventNameTable &getEventNameTable() {
+        static EventNameTable table;
+        return table;
+    }
+
+    EventName::EventName(std::string_view name) {
+        if (name.empty()) return;
+
+        auto &table = getEventNameTable();
+        {
+            std::shared_lock lock(table.mutex);
+            auto it = table.ids.find(name);
+            if (it != table.ids.end()) {
+                id = it->second;
+                str = &table.names[id];
+                return;
+            }
+        }
+
+        std::unique_lock lock(table.mutex);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) {
+            id = it->second;
+        } else {
+            id = (uint32_t)table.names.size();
+            table.ids.emplace(table.names.emplace_back(name), id);
+        }
+        str = &table.names[id];
+    }
+
+    std::ostream &operator<<(std::ostream &out, const EventName &name) {
+        return out << name.String();
+    }
+
+    const EventData *AsyncEvent::Get() const {
+        if (!asyncData) return &data;
+        // The Async object keeps its value alive for as long as asyncData is held
+        return asyncData->Get().get();
+    }
+
+    sp::AsyncPtr<EventData> AsyncEvent::GetAsync() const {
+        if (asyncData) return asyncData;
+        return std::make_shared<sp::Async<EventData>>(std::make_shared<EventData>(data));
+    }
+
     std::string Event::toString() const {
         std::stringstream ss;
         ss << this->name << ":" << this->data;
@@ -103,24 +162,36 @@ namespace ecs {
         return out;
     }
 
-    bool EventQueue::Add(const AsyncEvent &event) {
+    EventQueue::EventSlot *EventQueue::acquireSlot(const EventName &name, const Entity &source) {
         State s, s2;
         do {
             s = state.load();
             s2 = {s.head, (s.tail + 1) % (uint32_t)events.size()};
             if (s2.tail == s2.head) {
-                Warnf("Event Queue full! Dropping event %s from %s", event.name, std::to_string(event.source));
-                return false;
+                Warnf("Event Queue full! Dropping event %s from %s", name, std::to_string(source));
+                return nullptr;
             }
         } while (!state.compare_exchange_weak(s, s2, std::memory_order_acquire, std::memory_order_relaxed));
-        events[s.tail] = event;
+        return &events[s.tail];
+    }
+
+    bool EventQueue::Add(const AsyncEvent &event) {
+        auto *slot = acquireSlot(event.name, event.source);
+        if (!slot) return false;
+        slot->event = event;
+        slot->ready.store(true, std::memory_order_release);
         return true;
     }
 
     bool EventQueue::Add(const Event &event, size_t transactionId) {
-        AsyncEvent asyncEvent(event.name, event.source, event.data);
-        asyncEvent.transactionId = transactionId;
-        return Add(asyncEvent);
+        auto *slot = acquireSlot(event.name, event.source);
+        if (!slot) return false;
+        slot->event.name = event.name;
+        slot->event.source = event.source;
+        slot->event.SetData(event.data);
+        slot->event.transactionId = transactionId;
+        slot->ready.store(true, std::memory_order_release);
+        return true;
     }
 
     bool EventQueue::Poll(Event &eventOut, size_t transactionId) {
@@ -129,23 +200,35 @@ namespace ecs {
             State s = state.load();
             if (s.head == s.tail) break;
 
-            auto &async = events[s.head];
+            auto &slot = events[s.head];
+            // The writer may still be filling in this slot
+            if (!slot.ready.load(std::memory_order_acquire)) break;
+
+            auto &async = slot.event;
             // Check if this event should be visible to the current transaction.
             // Events are not visible to the transaction that emitted them.
             if (async.transactionId >= transactionId && transactionId > 0) break;
-            if (!async.data || !async.data->Ready()) break;
-
-            auto data = async.data->Get();
-            if (data) {
-                eventOut = Event{
-                    async.name,
-                    async.source,
-                    *data,
-                };
+            if (!async.Ready()) break;
+
+            if (!async.asyncData) {
+                // Inline data is owned by the slot, so it can be moved out without copying
+                eventOut.name = async.name;
+                eventOut.source = async.source;
+                eventOut.data = std::move(async.data);
                 outputSet = true;
             } else {
-                // A null event means it was filtered out asynchronously, skip over it
+                auto data = async.asyncData->Get();
+                if (data) {
+                    eventOut.name = async.name;
+                    eventOut.source = async.source;
+                    eventOut.data = *data;
+                    outputSet = true;
+                } else {
+                    // A null event means it was filtered out asynchronously, skip over it
+                }
+                async.asyncData.reset();
             }
+            slot.ready.store(false, std::memory_order_relaxed);
 
             State s2;
             do {
@@ -173,6 +256,9 @@ namespace ecs {
 
     void EventQueue::Resize(uint32_t newSize) {
         events.resize(newSize);
+        for (auto &slot : events) {
+            slot.ready.store(false);
+        }
         state.store({0, 0});
     }
 
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <variant>
 
 namespace ecs {
@@ -46,32 +47,118 @@ namespace ecs {
         const EventData &src,
         const EventData *def);
 
+    /**
+     * An interned event name. Each unique name is stored once in a global table for the lifetime of the program,
+     * so event names can be copied, compared, and hashed by id without allocating.
+     *
+     * Constructing an EventName from a string performs a table lookup, so frequently sent events should keep
+     * their EventName around rather than converting from a string each time.
+     */
+    class EventName {
+    public:
+        EventName() {}
+        EventName(std::string_view name);
+        EventName(const std::string &name) : EventName(std::string_view(name)) {}
+        EventName(const char *name) : EventName(std::string_view(name)) {}
+
+        uint32_t Id() const {
+            return id;
+        }
+
+        const std::string &String() const {
+            return *str;
+        }
+
+        const char *c_str() const {
+            return str->c_str();
+        }
+
+        bool empty() const {
+            return id == 0;
+        }
+
+        size_t size() const {
+            return str->size();
+        }
+
+        std::string substr(size_t pos, size_t count = std::string::npos) const {
+            return str->substr(pos, count);
+        }
+
+        operator const std::string &() const {
+            return *str;
+        }
+
+        bool operator==(const EventName &other) const {
+            return id == other.id;
+        }
+
+        bool operator==(const std::string &other) const {
+            return *str == other;
+        }
+
+        bool operator==(const char *other) const {
+            return *str == other;
+        }
+
+    private:
+        static inline const std::string emptyName;
+
+        uint32_t id = 0;
+        const std::string *str = &emptyName;
+    };
+
+    std::ostream &operator<<(std::ostream &out, const EventName &name);
+
     struct Event {
-        std::string name;
+        EventName name;
         Entity source;
         EventData data;
 
         Event() {}
         template<typename T>
-        Event(const std::string &name, const Entity &source, const T &data) : name(name), source(source), data(data) {}
+        Event(const EventName &name, const Entity &source, const T &data) : name(name), source(source), data(data) {}
 
         std::string toString() const;
     };
 
+    /**
+     * An event waiting to be delivered to an EventQueue.
+     *
+     * Event data that is known when the event is sent is stored inline. Only events whose data is produced
+     * asynchronously (e.g. by an event binding filter that can't be evaluated in the sender's transaction) hold
+     * an AsyncPtr, which keeps the common path free of heap allocations.
+     */
     struct AsyncEvent {
-        std::string name;
+        EventName name;
         Entity source;
-        sp::AsyncPtr<EventData> data;
+        EventData data;
+        sp::AsyncPtr<EventData> asyncData;
 
         size_t transactionId = 0;
 
         AsyncEvent() {}
-        AsyncEvent(const std::string &name, const Entity &source, const sp::AsyncPtr<EventData> &data)
-            : name(name), source(source), data(data) {}
+        AsyncEvent(const EventName &name, const Entity &source, const sp::AsyncPtr<EventData> &asyncData)
+            : name(name), source(source), asyncData(asyncData) {}
 
         template<typename T>
-        AsyncEvent(const std::string &name, const Entity &source, T data)
-            : AsyncEvent(name, source, std::make_shared<sp::Async<EventData>>(std::make_shared<T>(data))) {}
+        AsyncEvent(const EventName &name, const Entity &source, const T &data)
+            : name(name), source(source), data(data) {}
+
+        bool Ready() const {
+            return !asyncData || asyncData->Ready();
+        }
+
+        // Blocks until the event data is ready. Returns nullptr if the event was filtered out asynchronously.
+        const EventData *Get() const;
+
+        // Returns the event data as an AsyncPtr, allocating a copy if the data is stored inline.
+        sp::AsyncPtr<EventData> GetAsync() const;
+
+        void SetData(const EventData &newData) {
+            data = newData;
+            asyncData.reset();
+        }
     };
 
     std::ostream &operator<<(std::ostream &out, const EventData &v);
@@ -110,6 +197,15 @@ namespace ecs {
         }
 
     private:
+        struct EventSlot {
+            AsyncEvent event;
+            // Set by the writer once the slot has been filled, and cleared by the reader after polling it
+            std::atomic_bool ready = false;
+        };
+
+        // Reserves the slot at the tail of the queue, returns nullptr if the queue is full
+        EventSlot *acquireSlot(const EventName &name, const Entity &source);
+
         struct State {
             // Workaround for Clang so that std::atomic<State> operations can be inlined as if uint64. See issue:
             // https://stackoverflow.com/questions/60445848/clang-doesnt-inline-stdatomicload-for-loading-64-bit-structs
@@ -117,7 +213,7 @@ namespace ecs {
             uint32_t tail;
         };
 
-        sp::InlineVector<AsyncEvent, MAX_QUEUE_SIZE> events;
+        sp::InlineVector<EventSlot, MAX_QUEUE_SIZE> events;
         std::atomic<State> state;
     };
 
@@ -125,3 +221,12 @@ namespace ecs {
 
     EventQueueRef NewEventQueue(uint32_t maxQueueSize = EventQueue::MAX_QUEUE_SIZE);
 } // namespace ecs
+
+namespace std {
+    template<>
+    struct hash<ecs::EventName> {
+        std::size_t operator()(const ecs::EventName &name) const {
+            return hash<uint32_t>()(name.Id());
+        }
+    };
+} // namespace std
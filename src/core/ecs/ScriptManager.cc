@@ -17,6 +17,9 @@ namespace ecs {
     static sp::CVar<uint32_t> CVarMaxScriptQueueSize("s.MaxScriptQueueSize",
         EventQueue::MAX_QUEUE_SIZE,
         "Maximum number of event queue size for scripts");
+    static sp::CVar<uint32_t> CVarScriptWorkerThreads("s.ScriptWorkerThreads",
+        0,
+        "Number of worker threads for running non-conflicting OnTick scripts in parallel (0 = serial)");
 
     ScriptManager &GetScriptManager() {
         static ScriptManager scriptManager;
@@ -184,9 +187,7 @@ namespace ecs {
         }
     }
 
-    void ScriptManager::RunOnTick(const Lock<WriteAll> &lock, const chrono_clock::duration &interval) {
-        ZoneScoped;
-        std::shared_lock l(mutexes[ScriptCallbackIndex<OnTickFunc>()]);
+    void ScriptManager::runOnTickSerial(const Lock<WriteAll> &lock, const chrono_clock::duration &interval) {
         for (auto &[ent, state] : onTickScripts) {
             if (!ent) continue;
             auto &callback = std::get<OnTickFunc>(state.definition.callback);
@@ -197,6 +198,99 @@ namespace ecs {
         }
     }
 
+    void ScriptManager::scheduleOnTick() {
+        ZoneScoped;
+        for (auto &batch : onTickBatches) {
+            batch.clear();
+        }
+
+        // Each script is placed in the batch after the last earlier script it conflicts with, so conflicting
+        // scripts always run in the same order as the script list.
+        std::array<int, ScriptAccess::COMPONENT_COUNT> lastRead, lastWrite;
+        lastRead.fill(-1);
+        lastWrite.fill(-1);
+        size_t batchCount = 0;
+        for (size_t i = 0; i < onTickScripts.size(); i++) {
+            auto &[ent, state] = onTickScripts[i];
+            if (!ent) continue;
+            if (state.definition.filterOnEvent && state.eventQueue && state.eventQueue->Empty()) continue;
+
+            auto &access = state.definition.access;
+            int batch = 0;
+            for (size_t c = 0; c < ScriptAccess::COMPONENT_COUNT; c++) {
+                if (access.write[c]) {
+                    batch = std::max({batch, lastRead[c] + 1, lastWrite[c] + 1});
+                } else if (access.read[c]) {
+                    batch = std::max(batch, lastWrite[c] + 1);
+                }
+            }
+            for (size_t c = 0; c < ScriptAccess::COMPONENT_COUNT; c++) {
+                if (access.write[c]) {
+                    lastWrite[c] = batch;
+                } else if (access.read[c]) {
+                    lastRead[c] = std::max(lastRead[c], batch);
+                }
+            }
+
+            if ((size_t)batch >= onTickBatches.size()) onTickBatches.resize(batch + 1);
+            onTickBatches[batch].emplace_back(i);
+            batchCount = std::max(batchCount, (size_t)batch + 1);
+        }
+        onTickBatches.resize(batchCount);
+    }
+
+    void ScriptManager::RunOnTick(const Lock<WriteAll> &lock, const chrono_clock::duration &interval) {
+        ZoneScoped;
+        std::shared_lock l(mutexes[ScriptCallbackIndex<OnTickFunc>()]);
+
+        size_t workerCount = CVarScriptWorkerThreads.Get();
+        if (workerCount == 0) {
+            runOnTickSerial(lock, interval);
+            return;
+        }
+        if (!onTickWorkQueue || onTickWorkerCount != workerCount) {
+            onTickWorkQueue = make_unique<sp::DispatchQueue>("ScriptOnTick",
+                workerCount,
+                std::chrono::milliseconds(1),
+                sp::DispatchScheduler::WorkStealing);
+            onTickWorkerCount = workerCount;
+        }
+
+        scheduleOnTick();
+
+        auto runScripts = [&](const std::vector<size_t> &batch, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto &[ent, state] = onTickScripts[batch[i]];
+                auto &callback = std::get<OnTickFunc>(state.definition.callback);
+                callback(state, lock, ent, interval);
+            }
+        };
+
+        std::vector<sp::AsyncPtr<void>> pending;
+        for (auto &batch : onTickBatches) {
+            if (batch.empty()) continue;
+            // Split the batch into one chunk per worker, plus one for the calling thread
+            size_t chunkCount = std::min(batch.size(), workerCount + 1);
+            size_t chunkSize = (batch.size() + chunkCount - 1) / chunkCount;
+            for (size_t begin = chunkSize; begin < batch.size(); begin += chunkSize) {
+                size_t end = std::min(begin + chunkSize, batch.size());
+                pending.emplace_back(onTickWorkQueue->Dispatch<void>(
+                    sp::DispatchOptions{sp::DispatchPriority::FrameCritical},
+                    [&runScripts, &batch, begin, end] {
+                        runScripts(batch, begin, end);
+                    }));
+            }
+            runScripts(batch, 0, std::min(chunkSize, batch.size()));
+            for (auto &future : pending) {
+                future->Get();
+            }
+            pending.clear();
+
+            // Later batches may run on different threads and read components written by this batch
+            Signals::InvalidateTransactionCaches();
+        }
+    }
+
     void ScriptManager::RunOnPhysicsUpdate(const PhysicsUpdateLock &lock, const chrono_clock::duration &interval) {
         ZoneScoped;
         std::shared_lock l(mutexes[ScriptCallbackIndex<OnPhysicsUpdateFunc>()]);
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "core/Common.hh"
+#include "core/DispatchQueue.hh"
 #include "core/LockFreeMutex.hh"
 #include "core/Logging.hh"
 #include "ecs/Ecs.hh"
@@ -15,6 +16,7 @@
 #include "ecs/components/Events.hh"
 
 #include <any>
+#include <bitset>
 #include <deque>
 #include <functional>
 #include <limits>
@@ -50,6 +52,59 @@ namespace ecs {
     template<>
     struct ScriptCallbackIndex<PrefabFunc> : std::integral_constant<size_t, 3> {};
 
+    namespace detail {
+        template<typename LockType, typename>
+        struct lock_access {};
+        template<typename LockType, typename... Tn>
+        struct lock_access<LockType, Tecs::ECS<Tn...>> {
+            template<typename BitsetType>
+            static void Get(BitsetType &read, BitsetType &write) {
+                size_t i = 0;
+                ((read[i] = Tecs::is_read_allowed<Tn, LockType>(),
+                     write[i] = Tecs::is_write_allowed<Tn, LockType>(),
+                     i++),
+                    ...);
+            }
+        };
+    } // namespace detail
+
+    /**
+     * The set of components a script may read and write, indexed in ECS component order.
+     *
+     * Script definitions default to exclusive access to every component. Scripts that declare a narrower lock type
+     * can be run in parallel with other scripts that don't write any of the same components.
+     */
+    struct ScriptAccess {
+        static constexpr size_t COMPONENT_COUNT = std::tuple_size_v<FlatEntity>;
+
+        std::bitset<COMPONENT_COUNT> read, write;
+
+        ScriptAccess() {
+            read.set();
+            write.set();
+        }
+
+        template<typename LockType>
+        static ScriptAccess FromLock() {
+            ScriptAccess access;
+            detail::lock_access<LockType, ECS>::Get(access.read, access.write);
+            if constexpr (Tecs::is_read_allowed<EventBindings, LockType>()) {
+                // Sending events appends to other entities' event queues through a read lock. Treat it as a write
+                // so scripts that send events run in script order, and events arrive in a deterministic order.
+                ScriptAccess sendAccess;
+                detail::lock_access<Lock<Write<EventBindings, EventInput>>, ECS>::Get(sendAccess.read,
+                    sendAccess.write);
+                access.read |= sendAccess.read;
+                access.write |= sendAccess.write;
+            }
+            return access;
+        }
+
+        bool Conflicts(const ScriptAccess &other) const {
+            return (write & (other.read | other.write)).any() || (other.write & read).any();
+        }
+    };
+
     struct InternalScriptBase {
         const StructMetadata &metadata;
         InternalScriptBase(const StructMetadata &metadata) : metadata(metadata) {}
@@ -65,6 +120,7 @@ namespace ecs {
         const InternalScriptBase *context = nullptr;
         std::optional<ScriptInitFunc> initFunc;
         ScriptCallback callback;
+        ScriptAccess access;
     };
 
     struct ScriptDefinitions {
@@ -170,6 +226,9 @@ namespace ecs {
         void RunPrefabs(const Lock<AddRemove> &lock, Entity ent);
 
     private:
+        void runOnTickSerial(const Lock<WriteAll> &lock, const chrono_clock::duration &interval);
+        void scheduleOnTick();
+
         void internalRegisterEvents(const Lock<Read<Name, Scripts>, Write<EventInput>> &lock,
             const Entity &ent,
             const ScriptState &state) const;
@@ -189,6 +248,12 @@ namespace ecs {
             &prefabScripts,
         };
 
+        // Indexes into onTickScripts, grouped into batches of scripts with non-conflicting access.
+        // Batches run in order, and scripts within a batch may run in parallel.
+        std::vector<std::vector<size_t>> onTickBatches;
+        std::unique_ptr<sp::DispatchQueue> onTickWorkQueue;
+        size_t onTickWorkerCount = 0;
+
         friend class StructMetadata;
         friend class ScriptInstance;
         friend struct sp::EditorContext;
@@ -0,0 +1,92 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "SignalBindingBatch.hh"
+
+#include "console/CVar.hh"
+#include "core/Tracing.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <cmath>
+#include <robin_hood.h>
+
+namespace ecs {
+    extern sp::CVar<bool> CVarMemoizeSignals; // Defined in SignalRef.cc
+
+    void SignalBindingBatch::Clear() {
+        refs.clear();
+        compiled = false;
+    }
+
+    void SignalBindingBatch::Add(const SignalRef &ref) {
+        if (!ref) return;
+        refs.emplace_back(ref);
+        compiled = false;
+    }
+
+    void SignalBindingBatch::compile(const DynamicLock<ReadSignalsLock> &lock) {
+        ZoneScoped;
+        ZoneValue(refs.size());
+        auto &signals = lock.Get<Signals>();
+        robin_hood::unordered_flat_set<size_t> added;
+        std::vector<SignalExpression> expressions;
+        slots.clear();
+        for (auto &ref : refs) {
+            const SignalSlot &slot = ref.GetSlot(lock);
+            if (!signals.Contains(slot)) continue;
+            if (signals.expressions[slot.index].IsNull()) continue;
+            if (!added.emplace(slot.index).second) continue;
+
+            slots.emplace_back(slot);
+            expressions.emplace_back(signals.expressions[slot.index]);
+        }
+        batch = SignalExpressionBatch(std::move(expressions));
+        results.resize(slots.size());
+        cacheability.resize(slots.size());
+        compiledVersion = signals.bindingVersion;
+        compiled = true;
+    }
+
+    size_t SignalBindingBatch::Evaluate(const DynamicLock<ReadSignalsLock> &lock) {
+        ZoneScoped;
+        if (refs.empty() || !CVarMemoizeSignals.Get()) return 0;
+        auto &signals = lock.Get<Signals>();
+        if (!compiled || compiledVersion != signals.bindingVersion) compile(lock);
+
+        // Bindings are only evaluated if at least one signal would otherwise be evaluated on read
+        size_t transactionId = lock.GetTransactionId();
+        bool uncached = false;
+        for (auto &slot : slots) {
+            if (!std::isinf(signals.values[slot.index])) continue;
+            double value;
+            SignalCacheability result;
+            if (!signals.LoadCachedValue(slot.index, transactionId, value, result)) {
+                uncached = true;
+                break;
+            }
+        }
+        if (!uncached) return 0;
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            // Matches the initial cacheability used by SignalRef::GetSignal()
+            bool tracked = signals.dependencies[slots[i].index].tracked;
+            cacheability[i] = tracked ? SignalCacheability::UntilChanged : SignalCacheability::Transaction;
+        }
+        batch.Evaluate(lock, results, 0, cacheability);
+
+        size_t evaluated = 0;
+        for (size_t i = 0; i < slots.size(); i++) {
+            size_t index = slots[i].index;
+            // Signals with a value set don't read their binding
+            if (!std::isinf(signals.values[index])) continue;
+            signals.StoreCachedValue(index, transactionId, results[i], cacheability[i]);
+            evaluated++;
+        }
+        ZoneValue(evaluated);
+        return evaluated;
+    }
+} // namespace ecs
@@ -0,0 +1,53 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "ecs/Ecs.hh"
+#include "ecs/SignalExpression.hh"
+#include "ecs/SignalRef.hh"
+
+#include <vector>
+
+namespace ecs {
+    /**
+     * Evaluates the bindings of a set of signals together in a single SignalExpressionBatch.
+     *
+     * Systems that read the same signals every frame call Evaluate() before reading them with GetSignal().
+     * Results are stored in each signal's memoized cache, so the reads don't evaluate bindings one at a time, and
+     * signals written later in the frame are still invalidated as usual. Nothing is evaluated if every binding is
+     * already cached, or if s.MemoizeSignals is disabled.
+     *
+     * The batch is recompiled when the set of signals changes, or when any signal binding is set or cleared.
+     */
+    class SignalBindingBatch {
+    public:
+        void Clear();
+        void Add(const SignalRef &ref);
+
+        // Returns the number of bindings that were evaluated
+        size_t Evaluate(const DynamicLock<ReadSignalsLock> &lock);
+
+        size_t Size() const {
+            return refs.size();
+        }
+
+    private:
+        void compile(const DynamicLock<ReadSignalsLock> &lock);
+
+        std::vector<SignalRef> refs;
+        bool compiled = false;
+        size_t compiledVersion = 0;
+
+        // Slots of the signals with bindings, in the same order as the batch expressions
+        std::vector<SignalSlot> slots;
+        SignalExpressionBatch batch;
+
+        std::vector<double> results;
+        std::vector<SignalCacheability> cacheability;
+    };
+} // namespace ecs
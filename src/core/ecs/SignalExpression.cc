@@ -7,15 +7,145 @@
 
 #include "SignalExpression.hh"
 
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
+#include "console/CVar.hh"
 #include "core/Common.hh"
+#include "core/Hashing.hh"
 #include "core/Logging.hh"
 #include "ecs/Components.hh"
 #include "ecs/EcsImpl.hh"
 #include "ecs/EntityRef.hh"
 #include "ecs/SignalStructAccess.hh"
 
+#include <bit>
+#include <numeric>
+
 namespace ecs {
+    static sp::CVar<bool> CVarSignalBytecode("s.SignalBytecode",
+        true,
+        "Evaluate signal expressions using compiled bytecode instead of the parsed node tree");
+
+    using Op = SignalExpression::Op;
+
+    static double finiteResult(double result, double a, const char *op, double b) {
+        if (!std::isfinite(result)) {
+            Warnf("Signal expression evaluation error: %f %s %f = %f", a, op, b, result);
+            return 0.0;
+        }
+        return result;
+    }
+
+    double SignalExpression::ApplyOperation(Op op, double a, double b) {
+        switch (op) {
+        case Op::Negate:
+            return -a;
+        case Op::Not:
+            return a >= 0.5 ? 0.0 : 1.0;
+        case Op::Sin:
+            return std::sin(a);
+        case Op::Cos:
+            return std::cos(a);
+        case Op::Tan:
+            return std::tan(a);
+        case Op::Floor:
+            return std::floor(a);
+        case Op::Ceil:
+            return std::ceil(a);
+        case Op::Abs:
+            return std::abs(a);
+        case Op::Add:
+            return finiteResult(a + b, a, "+", b);
+        case Op::Subtract:
+            return finiteResult(a - b, a, "-", b);
+        case Op::Multiply:
+            return finiteResult(a * b, a, "*", b);
+        case Op::Divide:
+            return finiteResult(a / b, a, "/", b);
+        case Op::And:
+            return a >= 0.5 && b >= 0.5;
+        case Op::Or:
+            return a >= 0.5 || b >= 0.5;
+        case Op::Greater:
+            return a > b;
+        case Op::GreaterEqual:
+            return a >= b;
+        case Op::Less:
+            return a < b;
+        case Op::LessEqual:
+            return a <= b;
+        case Op::Equal:
+            return a == b;
+        case Op::NotEqual:
+            return a != b;
+        case Op::Min:
+            return std::min(a, b);
+        case Op::Max:
+            return std::max(a, b);
+        default:
+            Abortf("Invalid signal expression operation: %s", magic_enum::enum_name(op));
+        }
+    }
+
+    static Op lookupOperation(std::string_view token) {
+        if (token == "sin") return Op::Sin;
+        if (token == "cos") return Op::Cos;
+        if (token == "tan") return Op::Tan;
+        if (token == "floor") return Op::Floor;
+        if (token == "ceil") return Op::Ceil;
+        if (token == "abs") return Op::Abs;
+        if (token == "min") return Op::Min;
+        if (token == "max") return Op::Max;
+        if (token == "+") return Op::Add;
+        if (token == "-") return Op::Subtract;
+        if (token == "*") return Op::Multiply;
+        if (token == "/") return Op::Divide;
+        if (token == "&&") return Op::And;
+        if (token == "||") return Op::Or;
+        if (token == ">") return Op::Greater;
+        if (token == ">=") return Op::GreaterEqual;
+        if (token == "<") return Op::Less;
+        if (token == "<=") return Op::LessEqual;
+        if (token == "==") return Op::Equal;
+        if (token == "!=") return Op::NotEqual;
+        Abortf("Invalid operator token: %s", std::string(token));
+    }
+
+    // Equal nodes always have equal hashes, but different nodes may collide.
+    static size_t hashNode(const SignalExpression::Node &node) {
+        size_t hash = ((const SignalExpression::NodeVariant &)node).index();
+        std::visit(
+            [&](auto &node) {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, SignalExpression::ConstantNode>) {
+                    sp::hash_combine(hash, node.value);
+                } else if constexpr (std::is_same_v<T, SignalExpression::IdentifierNode>) {
+                    sp::hash_combine(hash, node.field.name);
+                } else if constexpr (std::is_same_v<T, SignalExpression::SignalNode>) {
+                    sp::hash_combine(hash, node.signal);
+                } else if constexpr (std::is_same_v<T, SignalExpression::ComponentNode>) {
+                    sp::hash_combine(hash, node.component);
+                    sp::hash_combine(hash, node.field.name);
+                } else if constexpr (std::is_same_v<T, SignalExpression::FocusCondition>) {
+                    sp::hash_combine(hash, node.ifFocused);
+                    sp::hash_combine(hash, node.inputIndex);
+                } else if constexpr (std::is_same_v<T, SignalExpression::OneInputOperation>) {
+                    sp::hash_combine(hash, node.op);
+                    sp::hash_combine(hash, node.inputIndex);
+                } else if constexpr (std::is_same_v<T, SignalExpression::TwoInputOperation>) {
+                    sp::hash_combine(hash, node.op);
+                    sp::hash_combine(hash, node.inputIndexA);
+                    sp::hash_combine(hash, node.inputIndexB);
+                } else if constexpr (std::is_same_v<T, SignalExpression::DeciderOperation>) {
+                    sp::hash_combine(hash, node.ifIndex);
+                    sp::hash_combine(hash, node.trueIndex);
+                    sp::hash_combine(hash, node.falseIndex);
+                }
+            },
+            (const SignalExpression::NodeVariant &)node);
+        return hash;
+    }
+
     struct PrecedenceTable {
         constexpr PrecedenceTable() {
             // Right associative unary operators (-X and !X)
@@ -71,14 +201,20 @@ namespace ecs {
 
     int SignalExpression::deduplicateNode(int index) {
         if (index < 0) return index;
-        for (int i = 0; i < (int)nodes.size(); i++) {
-            if (i != index && nodes[i] == nodes[index]) {
-                nodes.erase(nodes.begin() + index);
-                nodeStrings.erase(nodeStrings.begin() + index);
+        size_t hash = hashNode(nodes[index]);
+        auto range = nodeHashes.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++) {
+            int i = it->second;
+            if (i == index) return index; // Already unique
+            if (nodes[i] == nodes[index]) {
                 Assertf(i < index, "Deduped invalid node index: %d < %d", i, index);
+                Assertf((size_t)index + 1 == nodes.size(), "Deduped node is not the newest: %d", index);
+                nodes.pop_back();
+                nodeStrings.pop_back();
                 return i;
             }
         }
+        nodeHashes.emplace(hash, index);
         return index;
     }
 
@@ -177,45 +313,20 @@ namespace ecs {
                 }
 
                 auto *constantNode = std::get_if<SignalExpression::ConstantNode>(&nodes[inputIndex]);
-                if (token == "-") {
-                    if (constantNode) {
-                        index = nodes.size();
-                        nodes.emplace_back(SignalExpression::ConstantNode{constantNode->value * -1},
-                            startToken,
-                            tokenIndex,
-                            index);
-                        nodeStrings.emplace_back("-" + nodeStrings[inputIndex]);
-                    } else {
-                        index = nodes.size();
-                        nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                               [](double input) -> double {
-                                                   return -input;
-                                               }},
-                            startToken,
-                            tokenIndex,
-                            index);
-                        nodeStrings.emplace_back("-" + nodeStrings[inputIndex]);
-                    }
-                } else if (token == "!") {
-                    if (constantNode) {
-                        index = nodes.size();
-                        nodes.emplace_back(SignalExpression::ConstantNode{constantNode->value >= 0.5 ? 0.0 : 1.0},
-                            startToken,
-                            tokenIndex,
-                            index);
-                        nodeStrings.emplace_back("!" + nodeStrings[inputIndex]);
-                    } else {
-                        index = nodes.size();
-                        nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                               [](double input) -> double {
-                                                   return input >= 0.5 ? 0.0 : 1.0;
-                                               }},
-                            startToken,
-                            tokenIndex,
-                            index);
-                        nodeStrings.emplace_back("!" + nodeStrings[inputIndex]);
-                    }
+                Op op = token == "-" ? Op::Negate : Op::Not;
+                index = nodes.size();
+                if (constantNode) {
+                    nodes.emplace_back(SignalExpression::ConstantNode{ApplyOperation(op, constantNode->value)},
+                        startToken,
+                        tokenIndex,
+                        index);
+                } else {
+                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex, op},
+                        startToken,
+                        tokenIndex,
+                        index);
                 }
+                nodeStrings.emplace_back(std::string(token) + nodeStrings[inputIndex]);
             } else if (token == "is_focused" || token == "sin" || token == "cos" || token == "tan" ||
                        token == "floor" || token == "ceil" || token == "abs") {
                 // Parse as 1 argument function
@@ -266,56 +377,11 @@ namespace ecs {
                         Errorf("Blank focus layer specified for is_focused: %s", std::string(focusStr));
                     }
                     nodes.emplace_back(SignalExpression::FocusCondition{focus, -1}, startToken, tokenIndex, index);
-                } else if (token == "sin") {
-                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                           [](double input) -> double {
-                                               return std::sin(input);
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "cos") {
-                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                           [](double input) -> double {
-                                               return std::cos(input);
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "tan") {
-                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                           [](double input) -> double {
-                                               return std::tan(input);
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "floor") {
-                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                           [](double input) -> double {
-                                               return std::floor(input);
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "ceil") {
-                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                           [](double input) -> double {
-                                               return std::ceil(input);
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "abs") {
-                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex,
-                                           [](double input) -> double {
-                                               return std::abs(input);
-                                           }},
+                } else {
+                    nodes.emplace_back(SignalExpression::OneInputOperation{inputIndex, lookupOperation(token)},
                         startToken,
                         tokenIndex,
                         index);
-                } else {
-                    Abortf("Invalid function token: %s", std::string(token));
                 }
 
                 nodeStrings.emplace_back(std::string(token) + "( " + nodeStrings[inputIndex] + " )");
@@ -382,26 +448,11 @@ namespace ecs {
                         Errorf("Blank focus layer specified for if_focused: %s", std::string(focusStr));
                     }
                     nodes.emplace_back(SignalExpression::FocusCondition{focus, bIndex}, startToken, tokenIndex, index);
-                } else if (token == "min") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return std::min(a, b);
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "max") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return std::max(a, b);
-                                           }},
+                } else {
+                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex, bIndex, lookupOperation(token)},
                         startToken,
                         tokenIndex,
                         index);
-                } else {
-                    Abortf("Invalid function token: %s", std::string(token));
                 }
 
                 nodeStrings.emplace_back(
@@ -429,142 +480,10 @@ namespace ecs {
                 }
 
                 index = nodes.size();
-                if (token == "+") {
-                    nodes.emplace_back(
-                        SignalExpression::TwoInputOperation{aIndex,
-                            bIndex,
-                            [](double a, double b) -> double {
-                                double result = a + b;
-                                if (!std::isfinite(result)) {
-                                    Warnf("Signal expression evaluation error: %f + %f = %f", a, b, result);
-                                    return 0.0;
-                                }
-                                return result;
-                            }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "-") {
-                    nodes.emplace_back(
-                        SignalExpression::TwoInputOperation{aIndex,
-                            bIndex,
-                            [](double a, double b) -> double {
-                                double result = a - b;
-                                if (!std::isfinite(result)) {
-                                    Warnf("Signal expression evaluation error: %f - %f = %f", a, b, result);
-                                    return 0.0;
-                                }
-                                return result;
-                            }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "*") {
-                    nodes.emplace_back(
-                        SignalExpression::TwoInputOperation{aIndex,
-                            bIndex,
-                            [](double a, double b) -> double {
-                                double result = a * b;
-                                if (!std::isfinite(result)) {
-                                    Warnf("Signal expression evaluation error: %f * %f = %f", a, b, result);
-                                    return 0.0;
-                                }
-                                return result;
-                            }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "/") {
-                    nodes.emplace_back(
-                        SignalExpression::TwoInputOperation{aIndex,
-                            bIndex,
-                            [](double a, double b) -> double {
-                                double result = a / b;
-                                if (!std::isfinite(result)) {
-                                    Warnf("Signal expression evaluation error: %f / %f = %f", a, b, result);
-                                    return 0.0;
-                                }
-                                return result;
-                            }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "&&") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a >= 0.5 && b >= 0.5;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "||") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a >= 0.5 || b >= 0.5;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == ">") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a > b;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == ">=") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a >= b;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "<") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a < b;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "<=") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a <= b;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "==") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a == b;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else if (token == "!=") {
-                    nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex,
-                                           bIndex,
-                                           [](double a, double b) -> double {
-                                               return a != b;
-                                           }},
-                        startToken,
-                        tokenIndex,
-                        index);
-                } else {
-                    Abortf("Invalid operator token: %s", std::string(token));
-                }
-
+                nodes.emplace_back(SignalExpression::TwoInputOperation{aIndex, bIndex, lookupOperation(token)},
+                    startToken,
+                    tokenIndex,
+                    index);
                 nodeStrings.emplace_back(nodeStrings[aIndex] + " " + std::string(token) + " " + nodeStrings[bIndex]);
             } else if (sp::is_float(token)) {
                 if (index >= 0) {
@@ -675,6 +594,8 @@ namespace ecs {
         this->rootIndex = nodes.size();
         this->nodes.emplace_back(SignalNode{signal}, 0, 0, this->rootIndex);
         this->nodeStrings.emplace_back(expr);
+        this->nodes[rootIndex].compile(*this, false);
+        compileProgram();
     }
 
     SignalExpression::SignalExpression(std::string_view expr, const Name &scope) : scope(scope), expr(expr) {
@@ -716,8 +637,10 @@ namespace ecs {
         // Parse the expression into a deduplicated tree of nodes
         nodes.clear();
         nodeStrings.clear();
+        program = Program();
         size_t tokenIndex = 0;
         rootIndex = parseNode(tokenIndex);
+        nodeHashes.clear();
         if (rootIndex < 0) {
             Errorf("Failed to parse expression: %s", expr);
             return false;
@@ -737,9 +660,259 @@ namespace ecs {
         // Compile the parsed expression tree into a lambda function
         nodes[rootIndex].compile(*this, false);
         Assertf(nodes[rootIndex].evaluate, "Failed to compile expression: %s", expr);
+
+        // Compile the expression tree into flat bytecode
+        compileProgram();
         return true;
     }
 
+    // Emits bytecode for one or more parsed expressions into a shared Program.
+    class ProgramBuilder {
+    public:
+        ProgramBuilder(SignalExpression::Program &program, bool branchless)
+            : program(program), branchless(branchless) {}
+
+        uint32_t Emit(const SignalExpression &expr, uint32_t source) {
+            memo.assign(expr.nodes.size(), std::nullopt);
+            memoLog.clear();
+            return emitNode(expr, source, expr.rootIndex).reg;
+        }
+
+        uint32_t Constant(double value) {
+            return constant(value).reg;
+        }
+
+    private:
+        struct Operand {
+            uint32_t reg = 0;
+            std::optional<double> constant;
+        };
+
+        using OperationKey = sp::HashKey<std::array<uint32_t, 4>>;
+
+        struct Scope {
+            size_t memo, operations, loads;
+        };
+
+        uint32_t newRegister() {
+            program.registers.emplace_back(0.0);
+            return program.registers.size() - 1;
+        }
+
+        size_t emitInstruction(Op op, uint32_t dst, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+            program.instructions.emplace_back(SignalExpression::Instruction{op, dst, a, b, c});
+            return program.instructions.size() - 1;
+        }
+
+        Operand constant(double value) {
+            auto [it, inserted] = constants.emplace(std::bit_cast<uint64_t>(value), 0);
+            if (inserted) {
+                it->second = newRegister();
+                program.registers[it->second] = value;
+            }
+            return Operand{it->second, value};
+        }
+
+        uint32_t operation(Op op, uint32_t a, uint32_t b = 0, uint32_t c = 0) {
+            OperationKey key(std::array<uint32_t, 4>{(uint32_t)op, a, b, c});
+            auto existing = operations.find(key);
+            if (existing != operations.end()) return existing->second;
+
+            uint32_t dst = newRegister();
+            emitInstruction(op, dst, a, b, c);
+            operations.emplace(key, dst);
+            operationLog.emplace_back(key);
+            return dst;
+        }
+
+        Operand load(const SignalExpression &expr, uint32_t source, int index, SignalExpression::CompiledFunc func) {
+            auto &node = expr.nodes[index];
+            size_t hash = hashNode(node);
+            auto range = loads.equal_range(hash);
+            for (auto it = range.first; it != range.second; it++) {
+                if (*it->second.first == node) return Operand{it->second.second};
+            }
+
+            uint32_t dst = newRegister();
+            emitInstruction(Op::Load, dst, program.loads.size());
+            program.loads.emplace_back(SignalExpression::LoadOperation{source, index, func});
+            loads.emplace(hash, std::make_pair(&node, dst));
+            loadLog.emplace_back(hash, dst);
+            return Operand{dst};
+        }
+
+        // Values computed inside a branch can't be reused after it, since the branch may not have run.
+        Scope pushScope() const {
+            return Scope{memoLog.size(), operationLog.size(), loadLog.size()};
+        }
+
+        void popScope(const Scope &scope) {
+            while (memoLog.size() > scope.memo) {
+                memo[memoLog.back()].reset();
+                memoLog.pop_back();
+            }
+            while (operationLog.size() > scope.operations) {
+                operations.erase(operationLog.back());
+                operationLog.pop_back();
+            }
+            while (loadLog.size() > scope.loads) {
+                auto [hash, reg] = loadLog.back();
+                auto range = loads.equal_range(hash);
+                for (auto it = range.first; it != range.second; it++) {
+                    if (it->second.second == reg) {
+                        loads.erase(it);
+                        break;
+                    }
+                }
+                loadLog.pop_back();
+            }
+        }
+
+        // Evaluates to the true node if condition >= 0.5, otherwise the false node, or 0 if falseIndex < 0.
+        Operand branch(const SignalExpression &expr,
+            uint32_t source,
+            uint32_t condition,
+            int trueIndex,
+            int falseIndex) {
+            if (branchless) {
+                Operand trueValue = emitNode(expr, source, trueIndex);
+                Operand falseValue = falseIndex >= 0 ? emitNode(expr, source, falseIndex) : constant(0.0);
+                return Operand{operation(Op::Select, condition, trueValue.reg, falseValue.reg)};
+            }
+
+            uint32_t dst = newRegister();
+            size_t jumpIfFalse = emitInstruction(Op::JumpIfFalse, 0, condition);
+
+            Scope scope = pushScope();
+            Operand trueValue = emitNode(expr, source, trueIndex);
+            emitInstruction(Op::Move, dst, trueValue.reg);
+            popScope(scope);
+            size_t jump = emitInstruction(Op::Jump, 0);
+
+            program.instructions[jumpIfFalse].b = program.instructions.size();
+            Operand falseValue = falseIndex >= 0 ? emitNode(expr, source, falseIndex) : constant(0.0);
+            emitInstruction(Op::Move, dst, falseValue.reg);
+            popScope(scope);
+
+            program.instructions[jump].a = program.instructions.size();
+            return Operand{dst};
+        }
+
+        Operand emitNode(const SignalExpression &expr, uint32_t source, int index) {
+            if (memo[index]) return *memo[index];
+
+            Operand result = std::visit(
+                [&](auto &node) {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, SignalExpression::ConstantNode>) {
+                        return constant(node.value);
+                    } else if constexpr (std::is_same_v<T, SignalExpression::IdentifierNode> ||
+                                         std::is_same_v<T, SignalExpression::SignalNode> ||
+                                         std::is_same_v<T, SignalExpression::ComponentNode>) {
+                        return load(expr, source, index, &T::Evaluate);
+                    } else if constexpr (std::is_same_v<T, SignalExpression::FocusCondition>) {
+                        uint32_t focused = operation(Op::IsFocused, (uint32_t)node.ifFocused);
+                        if (node.inputIndex < 0) return Operand{focused};
+                        return branch(expr, source, focused, node.inputIndex, -1);
+                    } else if constexpr (std::is_same_v<T, SignalExpression::OneInputOperation>) {
+                        Operand input = emitNode(expr, source, node.inputIndex);
+                        if (input.constant) {
+                            return constant(SignalExpression::ApplyOperation(node.op, *input.constant));
+                        }
+                        return Operand{operation(node.op, input.reg)};
+                    } else if constexpr (std::is_same_v<T, SignalExpression::TwoInputOperation>) {
+                        Operand a = emitNode(expr, source, node.inputIndexA);
+                        Operand b = emitNode(expr, source, node.inputIndexB);
+                        if (a.constant && b.constant) {
+                            return constant(SignalExpression::ApplyOperation(node.op, *a.constant, *b.constant));
+                        }
+                        bool commutative = node.op == Op::Add || node.op == Op::Multiply || node.op == Op::And ||
+                                           node.op == Op::Or || node.op == Op::Equal || node.op == Op::NotEqual;
+                        if (commutative && a.reg > b.reg) std::swap(a, b);
+                        return Operand{operation(node.op, a.reg, b.reg)};
+                    } else if constexpr (std::is_same_v<T, SignalExpression::DeciderOperation>) {
+                        Operand condition = emitNode(expr, source, node.ifIndex);
+                        if (condition.constant) {
+                            int taken = *condition.constant >= 0.5 ? node.trueIndex : node.falseIndex;
+                            return emitNode(expr, source, taken);
+                        }
+                        return branch(expr, source, condition.reg, node.trueIndex, node.falseIndex);
+                    }
+                },
+                (const SignalExpression::NodeVariant &)expr.nodes[index]);
+
+            memo[index] = result;
+            memoLog.emplace_back(index);
+            return result;
+        }
+
+        SignalExpression::Program &program;
+        bool branchless;
+
+        std::vector<std::optional<Operand>> memo;
+        std::vector<int> memoLog;
+        robin_hood::unordered_flat_map<uint64_t, uint32_t> constants;
+        robin_hood::unordered_flat_map<OperationKey, uint32_t, OperationKey::Hasher> operations;
+        std::vector<OperationKey> operationLog;
+        std::unordered_multimap<size_t, std::pair<const SignalExpression::Node *, uint32_t>> loads;
+        std::vector<std::pair<size_t, uint32_t>> loadLog;
+    };
+
+    // Returns the number of registers an instruction reads from its a, b, and c fields.
+    static int registerInputs(Op op) {
+        if (op == Op::Load || op == Op::IsFocused || op == Op::Jump) return 0;
+        if (op == Op::Select) return 3;
+        if (op < Op::Add) return 1;
+        return 2;
+    }
+
+    // Removes registers that are never read or written, such as intermediate constants that were folded.
+    static void compactRegisters(SignalExpression::Program &program, std::span<uint32_t> results) {
+        std::vector<uint32_t> remap(program.registers.size(), std::numeric_limits<uint32_t>::max());
+        std::vector<double> registers;
+        auto use = [&](uint32_t &reg) {
+            if (remap[reg] == std::numeric_limits<uint32_t>::max()) {
+                remap[reg] = registers.size();
+                registers.emplace_back(program.registers[reg]);
+            }
+            reg = remap[reg];
+        };
+        for (auto &inst : program.instructions) {
+            int inputs = registerInputs(inst.op);
+            if (inputs > 0) use(inst.a);
+            if (inputs > 1) use(inst.b);
+            if (inputs > 2) use(inst.c);
+            if (inst.op != Op::Jump && inst.op != Op::JumpIfFalse) use(inst.dst);
+        }
+        for (auto &result : results) {
+            use(result);
+        }
+        program.registers = std::move(registers);
+    }
+
+    void SignalExpression::compileProgram() {
+        program = Program();
+        if (rootIndex < 0 || (size_t)rootIndex >= nodes.size()) return;
+
+        ProgramBuilder builder(program, false);
+        program.resultRegister = builder.Emit(*this, 0);
+        compactRegisters(program, std::span(&program.resultRegister, 1));
+        if (program.registers.size() > MAX_SIGNAL_EXPRESSION_REGISTERS) {
+            Errorf("Failed to compile expression, too many registers %u > %u: %s",
+                program.registers.size(),
+                MAX_SIGNAL_EXPRESSION_REGISTERS,
+                expr);
+            program = Program();
+        }
+    }
+
+    static double evaluateFocus(const SignalExpression::Context &ctx, FocusLayer layer) {
+        ctx.RestrictCacheability(
+            ctx.lock.TryLock<Write<FocusLock>>() ? SignalCacheability::None : SignalCacheability::Transaction);
+        if (!ctx.lock.Has<FocusLock>()) return 0.0;
+        return ctx.lock.Get<FocusLock>().HasPrimaryFocus(layer) ? 1.0 : 0.0;
+    }
+
     double cacheLookup(const SignalExpression::Context &ctx, const SignalExpression::Node &node, size_t depth) {
         return ctx.cache[node.index];
     }
@@ -803,9 +976,13 @@ namespace ecs {
         auto &signalNode = std::get<SignalExpression::SignalNode>(node);
         if (depth >= MAX_SIGNAL_BINDING_DEPTH) {
             Errorf("Max signal binding depth exceeded: %s -> %s", ctx.expr.expr, signalNode.signal.String());
+            ctx.RestrictCacheability(SignalCacheability::None);
             return 0.0;
         }
-        return signalNode.signal.GetSignal(ctx.lock, depth + 1);
+        SignalCacheability cacheability = SignalCacheability::UntilChanged;
+        double value = signalNode.signal.GetSignal(ctx.lock, depth + 1, &cacheability);
+        ctx.RestrictCacheability(cacheability);
+        return value;
     }
 
     double SignalExpression::ComponentNode::Evaluate(const Context &ctx, const Node &node, size_t depth) {
@@ -813,25 +990,34 @@ namespace ecs {
         auto &componentNode = std::get<SignalExpression::ComponentNode>(node);
         if (!componentNode.component) return 0.0;
         Entity ent = componentNode.entity.Get(ctx.lock);
-        if (!ent) return 0.0;
+        if (!ent) {
+            // The entity may still be created later in this transaction
+            ctx.RestrictCacheability(SignalCacheability::None);
+            return 0.0;
+        }
         return GetFieldType(componentNode.component->metadata.type, [&](auto *typePtr) {
             using T = std::remove_pointer_t<decltype(typePtr)>;
             if constexpr (!ECS::IsComponent<T>() || Tecs::is_global_component<T>()) {
                 Warnf("SignalExpression can't evaluate component type: %s", typeid(T).name());
                 return 0.0;
-            } else if constexpr (Tecs::is_read_allowed<T, ReadSignalsLock>()) {
-                auto &component = ent.Get<const T>(ctx.lock);
-                return ecs::ReadStructField(&component, componentNode.field);
             } else {
-                auto tryLock = ctx.lock.TryLock<Read<T>>();
-                if (tryLock) {
-                    auto &component = ent.Get<const T>(*tryLock);
+                // Component values are only stable for the rest of the transaction if it can't write to them
+                ctx.RestrictCacheability(ctx.lock.TryLock<Write<T>>() ? SignalCacheability::None
+                                                                      : SignalCacheability::Transaction);
+                if constexpr (Tecs::is_read_allowed<T, ReadSignalsLock>()) {
+                    auto &component = ent.Get<const T>(ctx.lock);
                     return ecs::ReadStructField(&component, componentNode.field);
                 } else {
-                    Warnf("SignalExpression can't evaluate component '%s' without lock: %s",
-                        componentNode.field.name,
-                        typeid(T).name());
-                    return 0.0;
+                    auto tryLock = ctx.lock.TryLock<Read<T>>();
+                    if (tryLock) {
+                        auto &component = ent.Get<const T>(*tryLock);
+                        return ecs::ReadStructField(&component, componentNode.field);
+                    } else {
+                        Warnf("SignalExpression can't evaluate component '%s' without lock: %s",
+                            componentNode.field.name,
+                            typeid(T).name());
+                        return 0.0;
+                    }
                 }
             }
         });
@@ -840,7 +1026,7 @@ namespace ecs {
     double SignalExpression::FocusCondition::Evaluate(const Context &ctx, const Node &node, size_t depth) {
         // ZoneScoped;
         auto &focusNode = std::get<SignalExpression::FocusCondition>(node);
-        if (!ctx.lock.Has<FocusLock>() || !ctx.lock.Get<FocusLock>().HasPrimaryFocus(focusNode.ifFocused)) {
+        if (evaluateFocus(ctx, focusNode.ifFocused) < 0.5) {
             return 0.0;
         } else if (focusNode.inputIndex < 0) {
             return 1.0;
@@ -855,7 +1041,7 @@ namespace ecs {
         auto &opNode = std::get<SignalExpression::OneInputOperation>(node);
 
         auto &inputNode = ctx.expr.nodes[opNode.inputIndex];
-        return opNode.evaluate(opNode.inputFunc(ctx, inputNode, depth));
+        return ApplyOperation(opNode.op, opNode.inputFunc(ctx, inputNode, depth));
     }
 
     double SignalExpression::TwoInputOperation::Evaluate(const Context &ctx, const Node &node, size_t depth) {
@@ -867,7 +1053,7 @@ namespace ecs {
         // Argument execution order is undefined, so args must be evaluated before
         double inputA = opNode.inputFuncA(ctx, inputNodeA, depth);
         double inputB = opNode.inputFuncB(ctx, inputNodeB, depth);
-        return opNode.evaluate(inputA, inputB);
+        return ApplyOperation(opNode.op, inputA, inputB);
     }
 
     double SignalExpression::DeciderOperation::Evaluate(const Context &ctx, const Node &node, size_t depth) {
@@ -921,26 +1107,328 @@ namespace ecs {
         return true;
     }
 
-    double SignalExpression::Evaluate(const DynamicLock<ReadSignalsLock> &lock, size_t depth) const {
+    /**
+     * Register files are allocated from a per-thread stack and sized to each program, since evaluations nest when a
+     * signal's binding reads other bindings. Nesting is limited by MAX_SIGNAL_BINDING_DEPTH, so the stack only falls
+     * back to a heap allocation if several top-level evaluations are nested.
+     */
+    class RegisterFrame : public sp::NonCopyable {
+    public:
+        RegisterFrame(const std::vector<double> &initial) : size(initial.size()) {
+            static const size_t stackSize = MAX_SIGNAL_EXPRESSION_REGISTERS * (MAX_SIGNAL_BINDING_DEPTH + 2);
+            if (stack.empty()) stack.resize(stackSize);
+            if (top + size <= stack.size()) {
+                registers = stack.data() + top;
+                top += size;
+            } else {
+                overflow.resize(size);
+                registers = overflow.data();
+            }
+            std::copy(initial.begin(), initial.end(), registers);
+        }
+
+        ~RegisterFrame() {
+            if (registers != overflow.data()) top -= size;
+        }
+
+        double *registers;
+
+    private:
+        size_t size;
+        std::vector<double> overflow;
+
+        static thread_local std::vector<double> stack;
+        static thread_local size_t top;
+    };
+
+    thread_local std::vector<double> RegisterFrame::stack;
+    thread_local size_t RegisterFrame::top = 0;
+
+    double SignalExpression::evaluateProgram(const Context &ctx, size_t depth) const {
+        RegisterFrame frame(program.registers);
+        double *registers = frame.registers;
+
+        const auto &instructions = program.instructions;
+        size_t pc = 0;
+        while (pc < instructions.size()) {
+            auto &inst = instructions[pc++];
+            switch (inst.op) {
+            case Op::Load: {
+                auto &load = program.loads[inst.a];
+                registers[inst.dst] = load.evaluate(ctx, nodes[load.nodeIndex], depth);
+                break;
+            }
+            case Op::IsFocused:
+                registers[inst.dst] = evaluateFocus(ctx, (FocusLayer)inst.a);
+                break;
+            case Op::Move:
+                registers[inst.dst] = registers[inst.a];
+                break;
+            case Op::Jump:
+                pc = inst.a;
+                break;
+            case Op::JumpIfFalse:
+                if (registers[inst.a] < 0.5) pc = inst.b;
+                break;
+            case Op::Select:
+                registers[inst.dst] = registers[inst.a] >= 0.5 ? registers[inst.b] : registers[inst.c];
+                break;
+            default:
+                registers[inst.dst] = ApplyOperation(inst.op, registers[inst.a], registers[inst.b]);
+                break;
+            }
+        }
+        return registers[program.resultRegister];
+    }
+
+    double SignalExpression::Evaluate(const DynamicLock<ReadSignalsLock> &lock,
+        size_t depth,
+        SignalCacheability *cacheability) const {
         // ZoneScoped;
         // ZoneStr(expr);
         if (rootIndex < 0 || (size_t)rootIndex >= nodes.size()) return 0.0;
-        Storage cache;
-        auto &rootNode = nodes[rootIndex];
-        Context ctx(lock, *this, cache, 0.0);
-        return rootNode.evaluate(ctx, rootNode, depth);
+        double value;
+        SignalCacheability result;
+        if (CVarSignalBytecode.Get() && program.Valid()) {
+            Context ctx(lock, *this, {}, 0.0);
+            value = evaluateProgram(ctx, depth);
+            result = ctx.cacheability;
+        } else {
+            Storage cache;
+            auto &rootNode = nodes[rootIndex];
+            Context ctx(lock, *this, cache, 0.0);
+            value = rootNode.evaluate(ctx, rootNode, depth);
+            result = ctx.cacheability;
+        }
+        if (cacheability && result > *cacheability) *cacheability = result;
+        return value;
     }
 
     double SignalExpression::EvaluateEvent(const DynamicLock<ReadSignalsLock> &lock, const EventData &input) const {
         // ZoneScoped;
         // ZoneStr(expr);
         if (rootIndex < 0 || (size_t)rootIndex >= nodes.size()) return 0.0;
+        if (CVarSignalBytecode.Get() && program.Valid()) {
+            Context ctx(lock, *this, {}, input);
+            return evaluateProgram(ctx, 0);
+        }
         Storage cache;
         auto &rootNode = nodes[rootIndex];
         Context ctx(lock, *this, cache, input);
         return rootNode.evaluate(ctx, rootNode, 0);
     }
 
+    template<Op Operation>
+    static void evaluateRun(const SignalExpression::Instruction *inst,
+        const SignalExpression::Instruction *end,
+        double *registers) {
+        for (; inst != end; inst++) {
+            if constexpr (Operation == Op::Select) {
+                registers[inst->dst] = registers[inst->a] >= 0.5 ? registers[inst->b] : registers[inst->c];
+            } else {
+                registers[inst->dst] = SignalExpression::ApplyOperation(Operation,
+                    registers[inst->a],
+                    registers[inst->b]);
+            }
+        }
+    }
+
+    // Returns true if evaluating the subtree can log an error, such as a division by zero or an unreadable signal.
+    static bool canReportError(const SignalExpression &expr, int index) {
+        return std::visit(
+            [&](auto &node) {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, SignalExpression::IdentifierNode> ||
+                              std::is_same_v<T, SignalExpression::SignalNode> ||
+                              std::is_same_v<T, SignalExpression::ComponentNode>) {
+                    return true;
+                } else if constexpr (std::is_same_v<T, SignalExpression::FocusCondition>) {
+                    return node.inputIndex >= 0 && canReportError(expr, node.inputIndex);
+                } else if constexpr (std::is_same_v<T, SignalExpression::OneInputOperation>) {
+                    return canReportError(expr, node.inputIndex);
+                } else if constexpr (std::is_same_v<T, SignalExpression::TwoInputOperation>) {
+                    if (node.op == Op::Add || node.op == Op::Subtract || node.op == Op::Multiply ||
+                        node.op == Op::Divide) {
+                        return true;
+                    }
+                    return canReportError(expr, node.inputIndexA) || canReportError(expr, node.inputIndexB);
+                } else if constexpr (std::is_same_v<T, SignalExpression::DeciderOperation>) {
+                    return canReportError(expr, node.ifIndex) || canReportError(expr, node.trueIndex) ||
+                           canReportError(expr, node.falseIndex);
+                } else {
+                    return false;
+                }
+            },
+            (const SignalExpression::NodeVariant &)expr.nodes[index]);
+    }
+
+    // Returns true if a conditional in the subtree has a side that can report an error when evaluated speculatively.
+    static bool hasFallibleBranch(const SignalExpression &expr, int index) {
+        return std::visit(
+            [&](auto &node) {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, SignalExpression::FocusCondition>) {
+                    return node.inputIndex >= 0 && canReportError(expr, node.inputIndex);
+                } else if constexpr (std::is_same_v<T, SignalExpression::OneInputOperation>) {
+                    return hasFallibleBranch(expr, node.inputIndex);
+                } else if constexpr (std::is_same_v<T, SignalExpression::TwoInputOperation>) {
+                    return hasFallibleBranch(expr, node.inputIndexA) || hasFallibleBranch(expr, node.inputIndexB);
+                } else if constexpr (std::is_same_v<T, SignalExpression::DeciderOperation>) {
+                    return hasFallibleBranch(expr, node.ifIndex) || canReportError(expr, node.trueIndex) ||
+                           canReportError(expr, node.falseIndex);
+                } else {
+                    return false;
+                }
+            },
+            (const SignalExpression::NodeVariant &)expr.nodes[index]);
+    }
+
+    template<size_t... I>
+    static constexpr auto makeRunTable(std::index_sequence<I...>) {
+        return std::array{&evaluateRun<(Op)I>...};
+    }
+
+    SignalExpressionBatch::SignalExpressionBatch(std::vector<SignalExpression> &&expressions)
+        : expressions(std::move(expressions)) {
+        ZoneScoped;
+        ProgramBuilder builder(program, true);
+        resultRegisters.reserve(this->expressions.size());
+        for (uint32_t i = 0; i < this->expressions.size(); i++) {
+            auto &expr = this->expressions[i];
+            if (expr && hasFallibleBranch(expr, expr.rootIndex)) {
+                // Evaluated separately with real branches, so untaken branches don't log errors every frame
+                branchingExpressions.emplace_back(i);
+                resultRegisters.emplace_back(builder.Constant(0.0));
+            } else if (expr) {
+                resultRegisters.emplace_back(builder.Emit(expr, i));
+            } else {
+                resultRegisters.emplace_back(builder.Constant(0.0));
+            }
+        }
+        compactRegisters(program, resultRegisters);
+
+        // Find the loads and focus checks each expression reads, before instructions are reordered
+        auto &instructions = program.instructions;
+        std::vector<uint32_t> producers(program.registers.size(), std::numeric_limits<uint32_t>::max());
+        for (uint32_t i = 0; i < instructions.size(); i++) {
+            // Batch programs are branchless, every other instruction writes its dst register
+            producers[instructions[i].dst] = i;
+        }
+        std::vector<uint32_t> visited(program.registers.size(), 0);
+        std::vector<uint32_t> stack;
+        expressionInputs.resize(this->expressions.size());
+        for (uint32_t i = 0; i < this->expressions.size(); i++) {
+            stack.assign(1, resultRegisters[i]);
+            while (!stack.empty()) {
+                uint32_t reg = stack.back();
+                stack.pop_back();
+                if (visited[reg] == i + 1) continue;
+                visited[reg] = i + 1;
+                if (producers[reg] >= instructions.size()) continue; // Constant
+
+                auto &inst = instructions[producers[reg]];
+                int inputs = registerInputs(inst.op);
+                if (inputs == 0) expressionInputs[i].emplace_back(reg);
+                if (inputs > 0) stack.emplace_back(inst.a);
+                if (inputs > 1) stack.emplace_back(inst.b);
+                if (inputs > 2) stack.emplace_back(inst.c);
+            }
+        }
+
+        // Sort instructions by dependency level so each run of the same operation only reads earlier results
+        std::vector<uint32_t> registerLevels(program.registers.size(), 0);
+        std::vector<uint32_t> levels(instructions.size(), 0);
+        for (size_t i = 0; i < instructions.size(); i++) {
+            auto &inst = instructions[i];
+            // Loads and focus checks only read external state, and stay at level 0
+            uint32_t level = 0;
+            int inputs = registerInputs(inst.op);
+            if (inputs > 0) level = std::max(level, registerLevels[inst.a] + 1);
+            if (inputs > 1) level = std::max(level, registerLevels[inst.b] + 1);
+            if (inputs > 2) level = std::max(level, registerLevels[inst.c] + 1);
+            registerLevels[inst.dst] = levels[i] = level;
+        }
+
+        std::vector<uint32_t> order(instructions.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return std::tie(levels[a], instructions[a].op) < std::tie(levels[b], instructions[b].op);
+        });
+        std::vector<SignalExpression::Instruction> sorted;
+        sorted.reserve(instructions.size());
+        for (auto &i : order) {
+            sorted.emplace_back(instructions[i]);
+        }
+        instructions = std::move(sorted);
+
+        for (uint32_t i = 0; i < instructions.size(); i++) {
+            if (runs.empty() || runs.back().op != instructions[i].op) {
+                runs.emplace_back(Run{instructions[i].op, i, i + 1});
+            } else {
+                runs.back().end = i + 1;
+            }
+        }
+    }
+
+    void SignalExpressionBatch::Evaluate(const DynamicLock<ReadSignalsLock> &lock,
+        std::span<double> results,
+        size_t depth,
+        std::span<SignalCacheability> cacheability) const {
+        ZoneScoped;
+        Assertf(results.size() >= expressions.size(),
+            "SignalExpressionBatch::Evaluate results too small: %u < %u",
+            results.size(),
+            expressions.size());
+        Assertf(cacheability.empty() || cacheability.size() >= expressions.size(),
+            "SignalExpressionBatch::Evaluate cacheability too small: %u < %u",
+            cacheability.size(),
+            expressions.size());
+        static constexpr auto runTable = makeRunTable(std::make_index_sequence<magic_enum::enum_count<Op>()>());
+
+        // Loads may evaluate other bindings, but never another batch, so these aren't reentered
+        static thread_local std::vector<double> registers;
+        static thread_local std::vector<SignalCacheability> inputCacheability;
+        registers.assign(program.registers.begin(), program.registers.end());
+        if (!cacheability.empty()) inputCacheability.resize(program.registers.size());
+
+        const EventData input = 0.0;
+        for (auto &run : runs) {
+            auto *begin = program.instructions.data() + run.begin;
+            auto *end = program.instructions.data() + run.end;
+            if (run.op == Op::Load) {
+                for (auto *inst = begin; inst != end; inst++) {
+                    auto &load = program.loads[inst->a];
+                    auto &expr = expressions[load.source];
+                    SignalExpression::Context ctx(lock, expr, {}, input);
+                    registers[inst->dst] = load.evaluate(ctx, expr.nodes[load.nodeIndex], depth);
+                    if (!cacheability.empty()) inputCacheability[inst->dst] = ctx.cacheability;
+                }
+            } else if (run.op == Op::IsFocused) {
+                SignalExpression::Context ctx(lock, expressions.front(), {}, input);
+                for (auto *inst = begin; inst != end; inst++) {
+                    registers[inst->dst] = evaluateFocus(ctx, (FocusLayer)inst->a);
+                    if (!cacheability.empty()) inputCacheability[inst->dst] = ctx.cacheability;
+                }
+            } else {
+                runTable[(size_t)run.op](begin, end, registers.data());
+            }
+        }
+
+        for (size_t i = 0; i < resultRegisters.size(); i++) {
+            results[i] = registers[resultRegisters[i]];
+        }
+        if (!cacheability.empty()) {
+            for (size_t i = 0; i < expressionInputs.size(); i++) {
+                for (auto reg : expressionInputs[i]) {
+                    cacheability[i] = std::max(cacheability[i], inputCacheability[reg]);
+                }
+            }
+        }
+        for (auto i : branchingExpressions) {
+            results[i] = expressions[i].Evaluate(lock, depth, cacheability.empty() ? nullptr : &cacheability[i]);
+        }
+    }
+
     void SignalExpression::SetScope(const EntityScope &scope) {
         this->scope = scope;
         for (auto &node : nodes) {
@@ -999,4 +1487,24 @@ namespace ecs {
         typeSchema["description"] = picojson::value(
             "A signal expression string, e.g: \"scene:entity/signal + (other_entity/signal2 + 1)\"");
     }
+
+    template<>
+    bool StructMetadata::LoadBinary<SignalExpression>(SignalExpression &dst, sp::binary::Reader &src) {
+        EntityScope scope;
+        std::string expr;
+        if (!sp::binary::Load(scope, src) || !src.ReadString(expr)) return false;
+        if (expr.empty()) {
+            dst = SignalExpression();
+            return true;
+        }
+        dst = SignalExpression(expr, scope);
+        return !dst.nodes.empty();
+    }
+
+    template<>
+    void StructMetadata::SaveBinary<SignalExpression>(sp::binary::Writer &dst, const SignalExpression &src) {
+        // Unlike JSON, the original scope is kept so the expression is parsed identically when loaded
+        sp::binary::Save(dst, src.scope);
+        dst.WriteString(src.expr);
+    }
 } // namespace ecs
@@ -15,7 +15,9 @@
 
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
+#include <unordered_map>
 #include <variant>
 
 namespace ecs {
@@ -70,6 +72,8 @@ Signal expressions support the following operations and functions:
 )";
 
     static const size_t MAX_SIGNAL_EXPRESSION_NODES = 256;
+    // Each node needs at most one register for its value and one for a branch result, plus a shared zero constant.
+    static const size_t MAX_SIGNAL_EXPRESSION_REGISTERS = MAX_SIGNAL_EXPRESSION_NODES * 2 + 1;
 
     class SignalExpression {
     public:
@@ -79,22 +83,67 @@ Signal expressions support the following operations and functions:
 
         SignalExpression(const SignalExpression &other)
             : scope(other.scope), expr(other.expr), nodes(other.nodes), nodeStrings(other.nodeStrings),
-              rootIndex(other.rootIndex) {}
+              rootIndex(other.rootIndex), program(other.program) {}
 
         struct Node;
         using Storage = std::array<double, MAX_SIGNAL_EXPRESSION_NODES>;
 
+        enum class Op : uint8_t {
+            // Bytecode instructions
+            Load = 0, // dst = program.loads[a]
+            IsFocused, // dst = primary focus == (FocusLayer)a
+            Move, // dst = a
+            Jump, // goto a
+            JumpIfFalse, // if a < 0.5: goto b
+            Select, // dst = a >= 0.5 ? b : c
+
+            // One input operations
+            Negate,
+            Not,
+            Sin,
+            Cos,
+            Tan,
+            Floor,
+            Ceil,
+            Abs,
+
+            // Two input operations
+            Add,
+            Subtract,
+            Multiply,
+            Divide,
+            And,
+            Or,
+            Greater,
+            GreaterEqual,
+            Less,
+            LessEqual,
+            Equal,
+            NotEqual,
+            Min,
+            Max,
+        };
+
+        // Evaluates a one or two input operation. Non-finite arithmetic results are converted to 0.
+        static double ApplyOperation(Op op, double a, double b = 0.0);
+
         struct Context {
             const DynamicLock<ReadSignalsLock> &lock;
             const SignalExpression &expr;
-            Storage &cache;
+            // Per-node results for the node tree evaluator. Bytecode evaluation doesn't use the cache.
+            std::span<double> cache;
             const EventData &input;
+            mutable SignalCacheability cacheability = SignalCacheability::UntilChanged;
 
             Context(const DynamicLock<ReadSignalsLock> &lock,
                 const SignalExpression &expr,
-                Storage &cache,
+                std::span<double> cache,
                 const EventData &input)
                 : lock(lock), expr(expr), cache(cache), input(input) {}
+
+            void RestrictCacheability(SignalCacheability newCacheability) const {
+                if (newCacheability > cacheability) cacheability = newCacheability;
+            }
         };
         using CompiledFunc = double (*)(const Context &, const Node &, size_t);
 
@@ -134,7 +183,7 @@ Signal expressions support the following operations and functions:
         };
         struct OneInputOperation {
             int inputIndex = -1;
-            double (*evaluate)(double) = nullptr;
+            Op op = Op::Negate;
             CompiledFunc inputFunc = nullptr;
 
             static double Evaluate(const Context &ctx, const Node &node, size_t depth);
@@ -143,7 +192,7 @@ Signal expressions support the following operations and functions:
         struct TwoInputOperation {
             int inputIndexA = -1;
             int inputIndexB = -1;
-            double (*evaluate)(double, double) = nullptr;
+            Op op = Op::Add;
             CompiledFunc inputFuncA = nullptr;
             CompiledFunc inputFuncB = nullptr;
 
@@ -183,6 +232,36 @@ Signal expressions support the following operations and functions:
             CompiledFunc compile(SignalExpression &expr, bool noCacheWrite);
         };
 
+        struct Instruction {
+            Op op;
+            uint32_t dst = 0;
+            uint32_t a = 0;
+            uint32_t b = 0;
+            uint32_t c = 0;
+        };
+
+        struct LoadOperation {
+            uint32_t source = 0; // Index of the source expression in a SignalExpressionBatch
+            int nodeIndex = -1;
+            CompiledFunc evaluate = nullptr;
+        };
+
+        /**
+         * A flat register bytecode generated from the parsed node tree, with constants folded,
+         * common subexpressions merged, and unreachable nodes removed.
+         */
+        struct Program {
+            std::vector<Instruction> instructions;
+            std::vector<LoadOperation> loads;
+            // Initial register values, with all constants preloaded
+            std::vector<double> registers;
+            uint32_t resultRegister = 0;
+
+            bool Valid() const {
+                return resultRegister < registers.size();
+            }
+        };
+
         // Called automatically by constructor. Should be called when expression string is changed.
         bool Compile();
 
@@ -197,7 +276,10 @@ Signal expressions support the following operations and functions:
             }
         }
 
-        double Evaluate(const DynamicLock<ReadSignalsLock> &lock, size_t depth = 0) const;
+        // If cacheability is provided, it will be restricted based on what the result depends on.
+        double Evaluate(const DynamicLock<ReadSignalsLock> &lock,
+            size_t depth = 0,
+            SignalCacheability *cacheability = nullptr) const;
         double EvaluateEvent(const DynamicLock<ReadSignalsLock> &lock, const EventData &input) const;
 
         bool operator==(const SignalExpression &other) const {
@@ -223,15 +305,65 @@ Signal expressions support the following operations and functions:
         std::vector<Node> nodes;
         std::vector<std::string> nodeStrings;
         int rootIndex = -1;
+        Program program;
 
     private:
         std::string joinTokens(size_t startToken, size_t endToken) const;
         int deduplicateNode(int index);
         int parseNode(size_t &tokenIndex, uint8_t precedence = '\x0');
+        void compileProgram();
+        double evaluateProgram(const Context &ctx, size_t depth) const;
 
         bool canEvaluate(const DynamicLock<ReadSignalsLock> &lock, size_t depth) const;
 
         std::vector<std::string_view> tokens; // string_views into expr
+        std::unordered_multimap<size_t, int> nodeHashes; // Parse-time index for deduplicateNode()
+
+        friend class SignalExpressionBatch;
+    };
+
+    /**
+     * Evaluates a fixed set of expressions together in a single straight-line program.
+     * Signal and component reads are shared between expressions and performed up front, then the remaining
+     * arithmetic is grouped into runs of the same operation so it can be evaluated in tight loops.
+     * Both sides of conditionals are evaluated, unless a side can report an error such as a division by zero.
+     * Expressions with such conditionals are evaluated separately after the batch, using real branches.
+     */
+    class SignalExpressionBatch {
+    public:
+        SignalExpressionBatch() {}
+        SignalExpressionBatch(std::vector<SignalExpression> &&expressions);
+
+        /**
+         * results must have room for one value per expression, in the order they were provided.
+         * If cacheability is provided, each entry is restricted based on what its expression depends on.
+         */
+        void Evaluate(const DynamicLock<ReadSignalsLock> &lock,
+            std::span<double> results,
+            size_t depth = 0,
+            std::span<SignalCacheability> cacheability = {}) const;
+
+        size_t Size() const {
+            return expressions.size();
+        }
+
+        const std::vector<SignalExpression> &Expressions() const {
+            return expressions;
+        }
+
+    private:
+        struct Run {
+            SignalExpression::Op op;
+            uint32_t begin, end;
+        };
+
+        std::vector<SignalExpression> expressions;
+        SignalExpression::Program program;
+        std::vector<Run> runs;
+        std::vector<uint32_t> resultRegisters;
+        // Load and focus registers read by each expression, used to combine their cacheability
+        std::vector<std::vector<uint32_t>> expressionInputs;
+        std::vector<uint32_t> branchingExpressions;
     };
 
     static StructMetadata MetadataSignalExpression(typeid(SignalExpression),
@@ -249,4 +381,8 @@ Signal expressions support the following operations and functions:
     template<>
     void StructMetadata::DefineSchema<SignalExpression>(picojson::value &dst,
         sp::json::SchemaTypeReferences *references);
+    template<>
+    bool StructMetadata::LoadBinary<SignalExpression>(SignalExpression &dst, sp::binary::Reader &src);
+    template<>
+    void StructMetadata::SaveBinary<SignalExpression>(sp::binary::Writer &dst, const SignalExpression &src);
 } // namespace ecs
@@ -35,6 +35,11 @@ namespace ecs {
     }
 
     SignalRef SignalManager::GetRef(const EntityRef &entity, const std::string_view &signalName) {
+        if (!entity || signalName.empty()) return SignalRef();
+
+        // Most refs already exist, so look them up without allocating a key
+        SignalRef ref = signalRefs.Load(SignalKeyView{entity, signalName});
+        if (ref) return ref;
         return GetRef(SignalKey{entity, signalName});
     }
 
@@ -44,10 +49,8 @@ namespace ecs {
 
     void SignalManager::ClearEntity(const Lock<Write<Signals>> &lock, const EntityRef &entity) {
         auto &signals = lock.Get<Signals>();
-        for (auto &signal : signals.signals) {
-            if (signal.ref == entity) {
-                signal = Signals::Signal();
-            }
+        for (size_t i = 0; i < signals.Size(); i++) {
+            if (signals.refs[i] == entity) signals.ClearSignal(i);
         }
     }
 
@@ -83,8 +86,8 @@ namespace ecs {
                 auto lock = ecs::StartStagingTransaction<Write<Signals>>();
                 auto &signals = lock.Get<Signals>();
                 for (auto &refPtr : refsToFree) {
-                    signals.FreeSignal(refPtr->stagingIndex);
-                    refPtr->stagingIndex = std::numeric_limits<size_t>::max();
+                    signals.FreeSignal(refPtr->stagingSlot);
+                    refPtr->stagingSlot = {};
                 }
             }
             {
@@ -92,8 +95,8 @@ namespace ecs {
                 auto lock = ecs::StartTransaction<Write<Signals>>();
                 auto &signals = lock.Get<Signals>();
                 for (auto &refPtr : refsToFree) {
-                    signals.FreeSignal(refPtr->liveIndex);
-                    refPtr->liveIndex = std::numeric_limits<size_t>::max();
+                    signals.FreeSignal(refPtr->liveSlot);
+                    refPtr->liveSlot = {};
                 }
             }
         }
@@ -18,6 +18,7 @@
 
 #include <limits>
 #include <memory>
+#include <set>
 
 namespace ecs {
     class SignalManager {
@@ -35,14 +36,14 @@ namespace ecs {
 
     private:
         sp::LockFreeMutex mutex;
-        sp::PreservingMap<SignalKey, SignalRef::Ref, 1000> signalRefs;
+        sp::PreservingMap<SignalKey, SignalRef::Ref, 1000, SignalKeyHash, SignalKeyEqual> signalRefs;
         std::vector<std::shared_ptr<SignalRef::Ref>> setValues;
     };
 
     struct SignalRef::Ref {
         SignalKey signal;
-        size_t liveIndex = std::numeric_limits<size_t>::max();
-        size_t stagingIndex = std::numeric_limits<size_t>::max();
+        SignalSlot liveSlot;
+        SignalSlot stagingSlot;
 
         Ref(const SignalKey &signal) : signal(signal) {}
     };
@@ -7,12 +7,32 @@
 
 #include "SignalRef.hh"
 
+#include "console/CVar.hh"
 #include "ecs/EcsImpl.hh"
 #include "ecs/SignalManager.hh"
 
 #include <limits>
 
 namespace ecs {
+    sp::CVar<bool> CVarMemoizeSignals("s.MemoizeSignals",
+        true,
+        "Cache signal binding results until one of their inputs changes");
+
+    // Returns the indexes of all signals read by expr, or std::nullopt if any of them don't exist yet.
+    static std::optional<std::vector<size_t>> bindingDependencies(const Lock<Write<Signals>> &lock,
+        const SignalExpression &expr) {
+        auto &signals = lock.Get<Signals>();
+        std::vector<size_t> dependencies;
+        for (auto &node : expr.nodes) {
+            auto *signalNode = std::get_if<SignalExpression::SignalNode>(&node);
+            if (!signalNode || !signalNode->signal) continue;
+            const SignalSlot &slot = signalNode->signal.GetSlot(lock);
+            if (!signals.Contains(slot)) return std::nullopt;
+            dependencies.emplace_back(slot.index);
+        }
+        return dependencies;
+    }
+
     SignalRef::SignalRef(const EntityRef &ent, const std::string_view &signalName) {
         if (!ent || signalName.empty()) return;
         ptr = GetSignalManager().GetRef(ent, signalName).ptr;
@@ -23,24 +43,24 @@ namespace ecs {
         ptr = GetSignalManager().GetRef(str, scope).ptr;
     }
 
-    size_t &SignalRef::GetIndex(const Lock<> &lock) const {
+    SignalSlot &SignalRef::GetSlot(const Lock<> &lock) const {
         if (IsLive(lock)) {
-            return GetLiveIndex();
+            return GetLiveSlot();
         } else if (IsStaging(lock)) {
-            return GetStagingIndex();
+            return GetStagingSlot();
         } else {
             Abortf("Invalid SignalRef lock: %u", lock.GetInstance().GetInstanceId());
         }
     }
 
-    size_t &SignalRef::GetLiveIndex() const {
-        Assert(ptr, "SignalRef::GetLiveIndex() called on null SignalRef");
-        return ptr->liveIndex;
+    SignalSlot &SignalRef::GetLiveSlot() const {
+        Assert(ptr, "SignalRef::GetLiveSlot() called on null SignalRef");
+        return ptr->liveSlot;
     }
 
-    size_t &SignalRef::GetStagingIndex() const {
-        Assert(ptr, "SignalRef::GetStagingIndex() called on null SignalRef");
-        return ptr->stagingIndex;
+    SignalSlot &SignalRef::GetStagingSlot() const {
+        Assert(ptr, "SignalRef::GetStagingSlot() called on null SignalRef");
+        return ptr->stagingSlot;
     }
 
     const EntityRef &SignalRef::GetEntity() const {
@@ -73,63 +93,69 @@ namespace ecs {
         Assertf(ptr, "SignalRef::SetValue() called on null SignalRef");
         Assertf(std::isfinite(value), "SignalRef::SetValue() called with non-finite value: %f", value);
         auto &signals = lock.Get<Signals>();
-        size_t &index = GetIndex(lock);
-        if (index < signals.signals.size()) {
-            auto &signal = signals.signals[index];
-            signal.value = value;
-            signal.ref = *this;
-            return signal.value;
+        SignalSlot &slot = GetSlot(lock);
+        if (signals.Contains(slot)) {
+            auto &signalValue = signals.values[slot.index];
+            if (signalValue != value) {
+                signalValue = value;
+                signals.MarkDirty(slot.index);
+            }
+            signals.refs[slot.index] = *this;
+            return signalValue;
         } else {
-            index = signals.NewSignal(*this, value);
-            return signals.signals[index].value;
+            slot = signals.NewSignal(*this, value);
+            signals.MarkDirty(slot.index);
+            return signals.values[slot.index];
         }
     }
 
     void SignalRef::ClearValue(const Lock<Write<Signals>> &lock) const {
         Assertf(ptr, "SignalRef::ClearValue() called on null SignalRef");
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return; // Noop
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) return; // Noop
 
-        auto &signal = signals[index];
-        signal.value = -std::numeric_limits<double>::infinity();
-        if (signal.expr.IsNull()) signal.ref = {};
+        auto &signalValue = signals.values[slot.index];
+        if (!std::isinf(signalValue)) signals.MarkDirty(slot.index);
+        signalValue = -std::numeric_limits<double>::infinity();
+        if (signals.expressions[slot.index].IsNull()) signals.refs[slot.index] = {};
     }
 
     bool SignalRef::HasValue(const Lock<Read<Signals>> &lock) const {
         if (!ptr) return false;
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return false;
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) return false;
 
-        return !std::isinf(signals[index].value);
+        return !std::isinf(signals.values[slot.index]);
     }
 
     const double &SignalRef::GetValue(const Lock<Read<Signals>> &lock) const {
         static const double empty = 0.0;
         if (!ptr) return empty;
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return empty;
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) return empty;
 
-        return signals[index].value;
+        return signals.values[slot.index];
     }
 
     SignalExpression &SignalRef::SetBinding(const Lock<Write<Signals>> &lock, const SignalExpression &expr) const {
         Assertf(ptr, "SignalRef::SetBinding() called on null SignalRef");
         Assertf(!expr.IsNull(), "SignalRef::SetBinding() called with null SignalExpression");
         auto &signals = lock.Get<Signals>();
-        size_t &index = GetIndex(lock);
+        SignalSlot &slot = GetSlot(lock);
 
-        if (index < signals.signals.size()) {
-            auto &signal = signals.signals[index];
-            signal.expr = expr;
-            signal.ref = *this;
-            return signal.expr;
+        if (signals.Contains(slot)) {
+            signals.expressions[slot.index] = expr;
+            signals.refs[slot.index] = *this;
+            signals.MarkBindingChanged();
         } else {
-            index = signals.NewSignal(*this, expr);
-            return signals.signals[index].expr;
+            slot = signals.NewSignal(*this, expr);
         }
+        signals.SetDependencies(slot.index, bindingDependencies(lock, expr));
+        signals.MarkDirty(slot.index);
+        return signals.expressions[slot.index];
     }
 
     SignalExpression &SignalRef::SetBinding(const Lock<Write<Signals>> &lock,
@@ -140,44 +166,67 @@ namespace ecs {
 
     void SignalRef::ClearBinding(const Lock<Write<Signals>> &lock) const {
         Assertf(ptr, "SignalRef::ClearBinding() called on null SignalRef");
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return; // Noop
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) return; // Noop
 
-        auto &signal = signals[index];
-        signal.expr = SignalExpression();
-        if (std::isinf(signal.value)) signal.ref = {};
+        signals.expressions[slot.index] = SignalExpression();
+        signals.MarkBindingChanged();
+        if (std::isinf(signals.values[slot.index])) signals.refs[slot.index] = {};
+        signals.SetDependencies(slot.index, {});
+        signals.MarkDirty(slot.index);
     }
 
     bool SignalRef::HasBinding(const Lock<Read<Signals>> &lock) const {
         if (!ptr) return false;
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return false;
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) return false;
 
-        return !signals[index].expr.IsNull();
+        return !signals.expressions[slot.index].IsNull();
     }
 
     const SignalExpression &SignalRef::GetBinding(const Lock<Read<Signals>> &lock) const {
         static const SignalExpression empty = {};
         if (!ptr) return empty;
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return empty;
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) return empty;
 
-        return signals[index].expr;
+        return signals.expressions[slot.index];
     }
 
-    double SignalRef::GetSignal(const DynamicLock<ReadSignalsLock> &lock, size_t depth) const {
+    double SignalRef::GetSignal(const DynamicLock<ReadSignalsLock> &lock,
+        size_t depth,
+        SignalCacheability *cacheability) const {
         ZoneScoped;
         if (!ptr) return 0.0;
-        auto &signals = lock.Get<Signals>().signals;
-        const size_t &index = GetIndex(lock);
-        if (index >= signals.size()) return 0.0;
+        auto &signals = lock.Get<Signals>();
+        const SignalSlot &slot = GetSlot(lock);
+        if (!signals.Contains(slot)) {
+            // The signal may still be created later in this transaction
+            if (cacheability) *cacheability = std::max(*cacheability, SignalCacheability::Transaction);
+            return 0.0;
+        }
 
-        auto &signal = signals[index];
-        if (!std::isinf(signal.value)) return signal.value;
-        return signal.expr.Evaluate(lock, depth);
+        size_t index = slot.index;
+        double signalValue = signals.values[index];
+        if (!std::isinf(signalValue)) return signalValue;
+        auto &expr = signals.expressions[index];
+        if (!CVarMemoizeSignals.Get()) return expr.Evaluate(lock, depth, cacheability);
+
+        size_t transactionId = lock.GetTransactionId();
+        double value;
+        SignalCacheability result;
+        if (!signals.LoadCachedValue(index, transactionId, value, result)) {
+            // Untracked bindings won't be marked dirty when their inputs change
+            bool tracked = signals.dependencies[index].tracked;
+            result = tracked ? SignalCacheability::UntilChanged : SignalCacheability::Transaction;
+            value = expr.Evaluate(lock, depth, &result);
+            signals.StoreCachedValue(index, transactionId, value, result);
+        }
+        if (cacheability) *cacheability = std::max(*cacheability, result);
+        return value;
     }
 
     bool SignalRef::operator==(const EntityRef &other) const {
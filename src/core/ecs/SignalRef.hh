@@ -10,6 +10,7 @@
 #include "ecs/Ecs.hh"
 #include "ecs/EntityRef.hh"
 
+#include <limits>
 #include <memory>
 #include <string_view>
 
@@ -19,6 +20,23 @@ namespace ecs {
 
     using ReadSignalsLock = Lock<Read<Name, Signals, SignalOutput, SignalBindings, FocusLock>>;
 
+    // Describes how long an evaluated signal value can be reused for. Combined values use the most restrictive.
+    enum class SignalCacheability : uint8_t {
+        // Only depends on other signals, valid until one of them is changed.
+        UntilChanged = 0,
+        // Depends on components that can't change for the rest of the current transaction.
+        Transaction,
+        // Depends on components that may be written by the current transaction, or is otherwise not repeatable.
+        None,
+    };
+
+    // Identifies a signal's storage in the Signals component. Slots are reused after being freed, so the generation
+    // must match for the slot to be valid.
+    struct SignalSlot {
+        size_t index = std::numeric_limits<size_t>::max();
+        uint32_t generation = 0;
+    };
+
     class SignalRef {
     private:
         struct Ref;
@@ -30,9 +48,9 @@ namespace ecs {
         SignalRef(const SignalRef &ref) : ptr(ref.ptr) {}
         SignalRef(const std::shared_ptr<Ref> &ptr) : ptr(ptr) {}
 
-        size_t &GetIndex(const Lock<> &lock) const;
-        size_t &GetLiveIndex() const;
-        size_t &GetStagingIndex() const;
+        SignalSlot &GetSlot(const Lock<> &lock) const;
+        SignalSlot &GetLiveSlot() const;
+        SignalSlot &GetStagingSlot() const;
 
         const EntityRef &GetEntity() const;
         const std::string &GetSignalName() const;
@@ -53,7 +71,14 @@ namespace ecs {
         bool HasBinding(const Lock<Read<Signals>> &lock) const;
         const SignalExpression &GetBinding(const Lock<Read<Signals>> &lock) const;
 
-        double GetSignal(const DynamicLock<ReadSignalsLock> &lock, size_t depth = 0) const;
+        /**
+         * Returns the signal's value if set, otherwise evaluates its binding.
+         * Binding results are memoized when s.MemoizeSignals is enabled.
+         * If cacheability is provided, it will be restricted based on what the result depends on.
+         */
+        double GetSignal(const DynamicLock<ReadSignalsLock> &lock,
+            size_t depth = 0,
+            SignalCacheability *cacheability = nullptr) const;
 
         explicit operator bool() const {
             return !!ptr;
@@ -7,6 +7,7 @@
 
 #include "StructMetadata.hh"
 
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
 #include "core/Common.hh"
 #include "ecs/StructFieldTypes.hh"
@@ -25,6 +26,14 @@ namespace ecs {
         return nullptr;
     }
 
+    sp::Hash64 StructMetadata::SchemaHash() const {
+        sp::Hash64 hash = sp::binary::HashCombine(0, name);
+        for (auto &field : fields) {
+            hash = sp::binary::HashCombine(hash, field.SchemaHash());
+        }
+        return hash;
+    }
+
     void StructMetadata::Register(const std::type_index &idx, const StructMetadata *comp) {
         if (metadataTypeMap == nullptr) metadataTypeMap = new MetadataTypeMap();
         metadataTypeMap->emplace(idx, comp);
@@ -184,4 +193,27 @@ namespace ecs {
             }
         });
     }
+
+    void StructField::SaveBinary(sp::binary::Writer &dst, const void *srcStruct) const {
+        auto *field = static_cast<const char *>(srcStruct) + offset;
+
+        GetFieldType(type, field, [&](auto &value) {
+            sp::binary::Save(dst, value);
+        });
+    }
+
+    bool StructField::LoadBinary(void *dstStruct, sp::binary::Reader &src) const {
+        auto *field = static_cast<char *>(dstStruct) + offset;
+
+        return GetFieldType(type, field, [&](auto &dstValue) {
+            return sp::binary::Load(dstValue, src);
+        });
+    }
+
+    sp::Hash64 StructField::SchemaHash() const {
+        return GetFieldType(type, [&](auto *typePtr) {
+            using T = std::remove_pointer_t<decltype(typePtr)>;
+            return sp::binary::HashCombine(sp::binary::SchemaHash<T>(), name);
+        });
+    }
 } // namespace ecs
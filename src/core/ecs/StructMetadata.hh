@@ -38,6 +38,11 @@ namespace sp {
     namespace json {
         using SchemaTypeReferences = std::set<const ecs::StructMetadata *>;
     }
+
+    namespace binary {
+        class Writer;
+        class Reader;
+    } // namespace binary
 } // namespace sp
 
 template<>
@@ -173,6 +178,10 @@ namespace ecs {
             const void *srcStruct,
             const void *defaultStruct) const;
         void Apply(void *dstStruct, const void *srcStruct, const void *defaultPtr) const;
+        // Binary fields are always saved and loaded, regardless of FieldAction flags
+        void SaveBinary(sp::binary::Writer &dst, const void *srcStruct) const;
+        bool LoadBinary(void *dstStruct, sp::binary::Reader &src) const;
+        sp::Hash64 SchemaHash() const;
     };
 
     class StructMetadata {
@@ -200,6 +209,9 @@ namespace ecs {
 
         static const StructMetadata *Get(const std::type_index &idx);
 
+        // Hashes the struct name, and each field's name and binary type
+        sp::Hash64 SchemaHash() const;
+
         template<typename T>
         static const StructMetadata &Get() {
             auto ptr = Get(std::type_index(typeid(T)));
@@ -241,6 +253,17 @@ namespace ecs {
             // Custom field serialization is always called, default to no-op.
         }
 
+        template<typename T>
+        static bool LoadBinary(T &dst, sp::binary::Reader &src) {
+            // Custom binary serialization is always called, default to no-op.
+            return true;
+        }
+
+        template<typename T>
+        static void SaveBinary(sp::binary::Writer &dst, const T &src) {
+            // Custom binary serialization is always called, default to no-op.
+        }
+
     private:
         static void Register(const std::type_index &idx, const StructMetadata *comp);
     };
@@ -0,0 +1,286 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "TransformHierarchy.hh"
+
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <algorithm>
+
+namespace ecs {
+    // Nodes per parallel batch, smaller levels are computed on the calling thread
+    const size_t HIERARCHY_BATCH_SIZE = 2048;
+
+    TransformHierarchy::TransformHierarchy(const std::string &name, size_t threadCount) : threadCount(threadCount) {
+        if (threadCount > 0) {
+            workQueue = std::make_unique<sp::DispatchQueue>(name,
+                threadCount,
+                std::chrono::milliseconds(5),
+                sp::DispatchScheduler::WorkStealing);
+        }
+    }
+
+    void TransformHierarchy::Sync(Lock<Read<TransformTree, TransformSnapshot>> lock) {
+        ZoneScoped;
+        syncCount++;
+        syncedNodes.clear();
+        for (auto &ent : lock.EntitiesWith<TransformTree>()) {
+            if (!ent.Has<TransformTree>(lock)) continue;
+
+            auto *existing = nodeIndex.find(ent);
+            uint32_t node = existing ? *existing : AddNode(ent);
+            lastSync[node] = syncCount;
+            syncedNodes.emplace_back(node);
+
+            // A newly added snapshot needs its global transform, even if the tree is unchanged
+            bool snapshot = ent.Has<TransformSnapshot>(lock);
+            if (snapshot && !hasSnapshot[node]) MarkDirty(node);
+            hasSnapshot[node] = snapshot;
+        }
+
+        // Remove nodes for entities that no longer have a TransformTree
+        for (uint32_t node = 0; node < entities.size(); node++) {
+            if (entities[node] && lastSync[node] != syncCount) RemoveNode(node);
+        }
+
+        for (auto node : syncedNodes) {
+            auto &tree = entities[node].Get<const TransformTree>(lock);
+
+            // Parents without a TransformTree are treated as the scene root, matching GetGlobalTransform()
+            auto *parentNode = nodeIndex.find(tree.parent.Get(lock));
+            uint32_t parent = parentNode ? *parentNode : NO_NODE;
+            if (parent != requestedParents[node]) {
+                requestedParents[node] = parent;
+                SetParent(node, parent);
+                if (parents[node] != parent) {
+                    Errorf("TransformTree parent of %s forms a cycle: %s",
+                        std::to_string(entities[node]),
+                        std::to_string(entities[parent]));
+                }
+            } else if (parents[node] != parent) {
+                // Retry parents that previously formed a cycle
+                SetParent(node, parent);
+            }
+
+            if (tree.pose != localPoses[node]) {
+                localPoses[node] = tree.pose;
+                MarkDirty(node);
+            }
+        }
+    }
+
+    void TransformHierarchy::Update() {
+        ZoneScoped;
+        ZoneValue(dirtyNodes.size());
+        updatedNodes.clear();
+
+        // Changed nodes start a dirty subtree at their level, unless an ancestor is also dirty
+        dirtyLevels.resize(levels.size());
+        for (auto &level : dirtyLevels) {
+            level.clear();
+        }
+        for (auto node : dirtyNodes) {
+            if (entities[node]) dirtyLevels[depths[node]].emplace_back(node);
+        }
+
+        std::vector<uint32_t> frontier, nextFrontier;
+        for (size_t depth = 0; depth < levels.size(); depth++) {
+            frontier.swap(nextFrontier);
+            frontier.insert(frontier.end(), dirtyLevels[depth].begin(), dirtyLevels[depth].end());
+            nextFrontier.clear();
+            if (frontier.empty()) continue;
+
+            UpdateLevel(frontier, nextFrontier);
+            updatedNodes.insert(updatedNodes.end(), frontier.begin(), frontier.end());
+        }
+
+        for (auto node : dirtyNodes) {
+            dirty[node] = 0;
+        }
+        dirtyNodes.clear();
+    }
+
+    void TransformHierarchy::UpdateLevel(const std::vector<uint32_t> &frontier, std::vector<uint32_t> &nextFrontier) {
+        ZoneScoped;
+        ZoneValue(frontier.size());
+        size_t batchCount = 1;
+        if (workQueue) {
+            batchCount = std::min((frontier.size() + HIERARCHY_BATCH_SIZE - 1) / HIERARCHY_BATCH_SIZE,
+                threadCount + 1);
+        }
+        size_t batchSize = (frontier.size() + batchCount - 1) / batchCount;
+        if (batchChildren.size() < batchCount) batchChildren.resize(batchCount);
+
+        // Parents were all computed by the previous level, so batches only read shared state
+        auto updateBatch = [&](size_t batch) {
+            auto &batchFrontier = batchChildren[batch];
+            batchFrontier.clear();
+            size_t end = std::min((batch + 1) * batchSize, frontier.size());
+            for (size_t i = batch * batchSize; i < end; i++) {
+                auto node = frontier[i];
+                auto parent = parents[node];
+                if (parent == NO_NODE) {
+                    globalPoses[node] = localPoses[node];
+                } else {
+                    globalPoses[node] = globalPoses[parent] * localPoses[node];
+                }
+                for (auto child : children[node]) {
+                    // Dirty children are already queued at their own level
+                    if (!dirty[child]) batchFrontier.emplace_back(child);
+                }
+            }
+        };
+
+        std::vector<sp::AsyncPtr<void>> pending;
+        for (size_t batch = 1; batch < batchCount; batch++) {
+            pending.emplace_back(workQueue->Dispatch<void>([&updateBatch, batch] {
+                updateBatch(batch);
+            }));
+        }
+        updateBatch(0);
+        for (auto &future : pending) {
+            future->Get();
+        }
+
+        for (size_t batch = 0; batch < batchCount; batch++) {
+            nextFrontier.insert(nextFrontier.end(), batchChildren[batch].begin(), batchChildren[batch].end());
+        }
+    }
+
+    uint32_t TransformHierarchy::AddNode(Entity ent) {
+        uint32_t node;
+        if (!freeNodes.empty()) {
+            node = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            node = entities.size();
+            entities.emplace_back();
+            parents.emplace_back();
+            requestedParents.emplace_back();
+            depths.emplace_back();
+            levelIndices.emplace_back();
+            localPoses.emplace_back();
+            globalPoses.emplace_back();
+            dirty.emplace_back(0);
+            hasSnapshot.emplace_back(0);
+            lastSync.emplace_back(0);
+            children.emplace_back();
+        }
+        entities[node] = ent;
+        parents[node] = NO_NODE;
+        requestedParents[node] = NO_NODE;
+        localPoses[node] = Transform();
+        hasSnapshot[node] = 0;
+        nodeIndex[ent] = node;
+
+        if (levels.empty()) levels.resize(1);
+        depths[node] = 0;
+        levelIndices[node] = levels[0].size();
+        levels[0].emplace_back(node);
+
+        MarkDirty(node);
+        return node;
+    }
+
+    void TransformHierarchy::RemoveNode(uint32_t node) {
+        SetParent(node, NO_NODE);
+
+        // Orphaned children become roots, as if their parent has no TransformTree
+        for (auto child : children[node]) {
+            parents[child] = NO_NODE;
+            requestedParents[child] = NO_NODE;
+            UpdateDepths(child);
+            MarkDirty(child);
+        }
+        children[node].clear();
+
+        auto &level = levels[depths[node]];
+        auto moved = level.back();
+        level[levelIndices[node]] = moved;
+        levelIndices[moved] = levelIndices[node];
+        level.pop_back();
+
+        nodeIndex.erase(entities[node]);
+        entities[node] = Entity();
+        freeNodes.emplace_back(node);
+    }
+
+    void TransformHierarchy::SetParent(uint32_t node, uint32_t parent) {
+        // Parenting a node to one of its own descendants would form a cycle, leave it as a root instead
+        for (auto ancestor = parent; ancestor != NO_NODE; ancestor = parents[ancestor]) {
+            if (ancestor == node) {
+                parent = NO_NODE;
+                break;
+            }
+        }
+        if (parent == parents[node]) return;
+
+        if (parents[node] != NO_NODE) {
+            auto &siblings = children[parents[node]];
+            siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+        }
+        parents[node] = parent;
+        if (parent != NO_NODE) children[parent].emplace_back(node);
+
+        UpdateDepths(node);
+        MarkDirty(node);
+    }
+
+    void TransformHierarchy::UpdateDepths(uint32_t node) {
+        // Moves a reparented subtree to its new levels, stopping at nodes that are already at the right depth
+        depthStack.clear();
+        depthStack.emplace_back(node);
+        while (!depthStack.empty()) {
+            auto current = depthStack.back();
+            depthStack.pop_back();
+
+            auto parent = parents[current];
+            uint32_t depth = parent == NO_NODE ? 0 : depths[parent] + 1;
+            if (depth == depths[current]) continue;
+
+            auto &oldLevel = levels[depths[current]];
+            auto moved = oldLevel.back();
+            oldLevel[levelIndices[current]] = moved;
+            levelIndices[moved] = levelIndices[current];
+            oldLevel.pop_back();
+
+            if (depth >= levels.size()) levels.resize(depth + 1);
+            depths[current] = depth;
+            levelIndices[current] = levels[depth].size();
+            levels[depth].emplace_back(current);
+
+            depthStack.insert(depthStack.end(), children[current].begin(), children[current].end());
+        }
+    }
+
+    void TransformHierarchy::MarkDirty(uint32_t node) {
+        if (dirty[node]) return;
+        dirty[node] = 1;
+        dirtyNodes.emplace_back(node);
+    }
+
+    void TransformHierarchy::Clear() {
+        entities.clear();
+        parents.clear();
+        requestedParents.clear();
+        depths.clear();
+        levelIndices.clear();
+        localPoses.clear();
+        globalPoses.clear();
+        dirty.clear();
+        hasSnapshot.clear();
+        lastSync.clear();
+        children.clear();
+        freeNodes.clear();
+        nodeIndex.clear();
+        levels.clear();
+        dirtyNodes.clear();
+        updatedNodes.clear();
+    }
+} // namespace ecs
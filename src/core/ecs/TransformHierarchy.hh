@@ -0,0 +1,95 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
+#include "core/EntityMap.hh"
+#include "ecs/Ecs.hh"
+#include "ecs/components/Transform.h"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace ecs {
+    /**
+     * A cache of the TransformTree hierarchy, stored as flat arrays with nodes grouped by their depth in the tree.
+     * Global transforms are computed one level at a time, so every parent is complete before its children, and
+     * each level is split into batches that run in parallel. Only subtrees that changed since the last Update()
+     * are recomputed.
+     *
+     * Sync() reads the latest TransformTree state, and maintains parent links and depths incrementally as entities
+     * are added, removed, or reparented. Nodes are also marked dirty when their entity gains a TransformSnapshot, so
+     * new snapshots are initialized even if the tree didn't change. It must be called before each Update().
+     *
+     * Not thread safe, a hierarchy should only be used by the thread that owns it.
+     */
+    class TransformHierarchy : public sp::NonCopyable {
+    public:
+        // If threadCount is 0, all levels are computed on the calling thread.
+        TransformHierarchy(const std::string &name, size_t threadCount);
+
+        void Sync(Lock<Read<TransformTree, TransformSnapshot>> lock);
+        void Update();
+
+        // Calls callback(entity, globalPose) for each entity whose global transform was recomputed by Update().
+        template<typename Fn>
+        void ForEachUpdated(Fn &&callback) const {
+            for (auto node : updatedNodes) {
+                callback(entities[node], globalPoses[node]);
+            }
+        }
+
+        size_t NodeCount() const {
+            return entities.size() - freeNodes.size();
+        }
+
+        size_t LevelCount() const {
+            return levels.size();
+        }
+
+        size_t UpdatedCount() const {
+            return updatedNodes.size();
+        }
+
+        void Clear();
+
+    private:
+        static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+        uint32_t AddNode(Entity ent);
+        void RemoveNode(uint32_t node);
+        void SetParent(uint32_t node, uint32_t parent);
+        void UpdateDepths(uint32_t node);
+        void MarkDirty(uint32_t node);
+        void UpdateLevel(const std::vector<uint32_t> &frontier, std::vector<uint32_t> &nextFrontier);
+
+        std::unique_ptr<sp::DispatchQueue> workQueue;
+        size_t threadCount;
+
+        // Node data, indexed by node id. Ids of removed nodes are reused.
+        std::vector<Entity> entities;
+        std::vector<uint32_t> parents, requestedParents;
+        std::vector<uint32_t> depths, levelIndices;
+        std::vector<Transform> localPoses, globalPoses;
+        std::vector<uint8_t> dirty, hasSnapshot;
+        std::vector<uint32_t> lastSync;
+        std::vector<std::vector<uint32_t>> children;
+        std::vector<uint32_t> freeNodes;
+        sp::EntityMap<uint32_t> nodeIndex;
+
+        // Node ids at each depth, levels[0] are the roots
+        std::vector<std::vector<uint32_t>> levels;
+
+        std::vector<uint32_t> dirtyNodes, updatedNodes;
+        std::vector<uint32_t> syncedNodes, depthStack;
+        std::vector<std::vector<uint32_t>> dirtyLevels, batchChildren;
+        uint32_t syncCount = 0;
+    };
+} // namespace ecs
@@ -7,6 +7,7 @@
 
 #include "Events.hh"
 
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
@@ -36,9 +37,9 @@ namespace ecs {
         const EventDest *def) {
         sp::json::Save(scope, dst, src.target);
         if (dst.is<std::string>()) {
-            dst = picojson::value(dst.get<std::string>() + src.queueName);
+            dst = picojson::value(dst.get<std::string>() + src.queueName.String());
         } else {
-            Errorf("Failed to save EventDest: %s", src.target.Name().String() + src.queueName);
+            Errorf("Failed to save EventDest: %s", src.target.Name().String() + src.queueName.String());
         }
     }
 
@@ -56,6 +57,20 @@ namespace ecs {
             "An event destintation is an entity name + event queue name, in the format: \"scene:entity/event/queue\"");
     }
 
+    template<>
+    bool StructMetadata::LoadBinary<EventDest>(EventDest &dst, sp::binary::Reader &src) {
+        std::string queueName;
+        if (!sp::binary::Load(dst.target, src) || !src.ReadString(queueName)) return false;
+        dst.queueName = queueName;
+        return true;
+    }
+
+    template<>
+    void StructMetadata::SaveBinary<EventDest>(sp::binary::Writer &dst, const EventDest &src) {
+        sp::binary::Save(dst, src.target);
+        dst.WriteString(src.queueName.String());
+    }
+
     template<>
     bool StructMetadata::Load<EventBinding>(EventBinding &binding, const picojson::value &src) {
         if (src.is<std::string>()) {
@@ -150,7 +165,7 @@ namespace ecs {
         }
     }
 
-    void EventInput::Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const std::string &binding) {
+    void EventInput::Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const EventName &binding) {
         Assertf(IsLive(lock), "Attempting to register event on non-live entity: %s", binding);
         Assertf(queue, "EventInput::Register called with null queue: %s", binding);
 
@@ -159,7 +174,7 @@ namespace ecs {
         queueList.emplace_back(queue);
     }
 
-    void EventInput::Unregister(const std::shared_ptr<EventQueue> &queue, const std::string &binding) {
+    void EventInput::Unregister(const std::shared_ptr<EventQueue> &queue, const EventName &binding) {
         if (!queue) return;
 
         auto it = events.find(binding);
@@ -170,9 +185,14 @@ namespace ecs {
     }
 
     size_t EventInput::Add(const Event &event, size_t transactionId) const {
-        AsyncEvent asyncEvent(event.name, event.source, event.data);
-        asyncEvent.transactionId = transactionId;
-        return Add(asyncEvent);
+        size_t eventsSent = 0;
+        auto it = events.find(event.name);
+        if (it != events.end()) {
+            for (auto &queue : it->second) {
+                if (queue->Add(event, transactionId)) eventsSent++;
+            }
+        }
+        return eventsSent;
     }
 
     size_t EventInput::Add(const AsyncEvent &event) const {
@@ -275,23 +295,18 @@ namespace ecs {
     }
 
     bool filterAndModifyEvent(const DynamicLock<ReadSignalsLock> &lock,
-        sp::AsyncPtr<EventData> &asyncOutput,
-        const sp::AsyncPtr<EventData> &asyncInput,
+        AsyncEvent &output,
+        const AsyncEvent &input,
         const EventBinding &binding) {
-        Assertf(asyncOutput && asyncInput, "FilterAndModifyEvent called with null input/output");
-
-        if (binding.actions.setValue) {
-            asyncOutput = std::make_shared<sp::Async<EventData>>(
-                std::make_shared<EventData>(*binding.actions.setValue));
-        }
+        if (binding.actions.setValue) output.SetData(*binding.actions.setValue);
 
         if (binding.actions.filterExpr) {
-            if (binding.actions.filterExpr->CanEvaluate(lock) && asyncInput->Ready()) {
-                auto input = asyncInput->Get();
-                if (!input) return false; // Event filtered asynchronously
-                if (binding.actions.filterExpr->EvaluateEvent(lock, *input) < 0.5) return false;
+            if (binding.actions.filterExpr->CanEvaluate(lock) && input.Ready()) {
+                auto *inputData = input.Get();
+                if (!inputData) return false; // Event filtered asynchronously
+                if (binding.actions.filterExpr->EvaluateEvent(lock, *inputData) < 0.5) return false;
             } else {
-                asyncOutput = ecs::TransactionQueue().Dispatch<EventData>(asyncInput,
+                output.asyncData = ecs::TransactionQueue().Dispatch<EventData>(input.GetAsync(),
                     [filterExpr = binding.actions.filterExpr](std::shared_ptr<EventData> input) {
                         if (!input) {
                             return std::make_shared<EventData>(); // Event filtered asynchronously
@@ -313,16 +328,19 @@ namespace ecs {
                 [&lock](auto &&expr) {
                     return expr.CanEvaluate(lock);
                 });
-            if (canEval && asyncOutput->Ready() && asyncInput->Ready()) {
-                auto input = asyncInput->Get();
-                if (!input) return false; // Event filtered asynchronously
-                auto outputPtr = asyncOutput->Get();
-                EventData output = outputPtr ? *outputPtr : *input;
-                modifyEvent(lock, output, *input, binding);
-                asyncOutput = std::make_shared<sp::Async<EventData>>(std::make_shared<EventData>(output));
+            if (canEval && output.Ready() && input.Ready()) {
+                auto *inputData = input.Get();
+                if (!inputData) return false; // Event filtered asynchronously
+                if (output.asyncData) {
+                    auto *outputData = output.Get();
+                    if (!outputData) return false; // Event filtered asynchronously
+                    output.SetData(*outputData);
+                }
+                // Output data is now stored inline and can be modified in place
+                modifyEvent(lock, output.data, *inputData, binding);
             } else {
-                asyncOutput = ecs::TransactionQueue().Dispatch<EventData>(asyncInput,
-                    asyncOutput,
+                output.asyncData = ecs::TransactionQueue().Dispatch<EventData>(input.GetAsync(),
+                    output.GetAsync(),
                     [binding](std::shared_ptr<EventData> input, std::shared_ptr<EventData> output) {
                         if (!input || !output) {
                             return std::make_shared<EventData>(); // Event filtered asynchronously
@@ -374,7 +392,7 @@ namespace ecs {
                 for (auto &binding : list->second) {
                     // Execute event modifiers before submitting to the destination queue
                     AsyncEvent outputEvent = event;
-                    if (!filterAndModifyEvent(lock, outputEvent.data, event.data, binding)) continue;
+                    if (!filterAndModifyEvent(lock, outputEvent, event, binding)) continue;
 
                     for (auto &dest : binding.outputs) {
                         outputEvent.name = dest.queueName;
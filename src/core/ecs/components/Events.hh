@@ -28,8 +28,8 @@ namespace ecs {
     struct EventInput {
         EventInput() {}
 
-        void Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const std::string &binding);
-        void Unregister(const EventQueueRef &queue, const std::string &binding);
+        void Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const EventName &binding);
+        void Unregister(const EventQueueRef &queue, const EventName &binding);
 
         /**
          * Adds an event to any matching event input queues.
@@ -41,7 +41,7 @@ namespace ecs {
         size_t Add(const AsyncEvent &event) const;
         static bool Poll(Lock<Read<EventInput>> lock, const EventQueueRef &queue, Event &eventOut);
 
-        robin_hood::unordered_map<std::string, std::vector<EventQueueRef>> events;
+        robin_hood::unordered_map<EventName, std::vector<EventQueueRef>> events;
     };
 
     static StructMetadata MetadataEventInput(typeid(EventInput), "event_input", R"(
@@ -55,7 +55,7 @@ their own event queues as needed.
 
     struct EventDest {
         EntityRef target;
-        std::string queueName;
+        EventName queueName;
 
         bool operator==(const EventDest &) const = default;
     };
@@ -74,6 +74,10 @@ their own event queues as needed.
     void StructMetadata::SetScope<EventDest>(EventDest &dst, const EntityScope &scope);
     template<>
     void StructMetadata::DefineSchema<EventDest>(picojson::value &dst, sp::json::SchemaTypeReferences *references);
+    template<>
+    bool StructMetadata::LoadBinary<EventDest>(EventDest &dst, sp::binary::Reader &src);
+    template<>
+    void StructMetadata::SaveBinary<EventDest>(sp::binary::Writer &dst, const EventDest &src);
 
     struct EventBindingActions {
         std::optional<SignalExpression> filterExpr;
@@ -7,6 +7,7 @@
 
 #include "LaserLine.hh"
 
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
 #include "ecs/EcsImpl.hh"
 
@@ -78,6 +79,50 @@ namespace ecs {
         }
     }
 
+    template<>
+    bool StructMetadata::LoadBinary<LaserLine>(LaserLine &dst, sp::binary::Reader &src) {
+        uint64_t index;
+        if (!src.ReadVarint(index)) return false;
+        if (index == 0) {
+            LaserLine::Line line;
+            if (!sp::binary::Load(line.points, src) || !sp::binary::Load(line.color, src)) return false;
+            dst.line = std::move(line);
+        } else if (index == 1) {
+            uint64_t count;
+            if (!src.ReadVarint(count) || count > src.Remaining()) return false;
+            LaserLine::Segments segments(count);
+            for (auto &segment : segments) {
+                if (!src.ReadRaw(segment.start) || !src.ReadRaw(segment.end)) return false;
+                if (!sp::binary::Load(segment.color, src)) return false;
+            }
+            dst.line = std::move(segments);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    template<>
+    void StructMetadata::SaveBinary<LaserLine>(sp::binary::Writer &dst, const LaserLine &src) {
+        static_assert(std::is_same_v<std::variant_alternative_t<0, decltype(src.line)>, LaserLine::Line>);
+        static_assert(std::is_same_v<std::variant_alternative_t<1, decltype(src.line)>, LaserLine::Segments>);
+
+        dst.WriteVarint(src.line.index());
+        if (std::holds_alternative<LaserLine::Line>(src.line)) {
+            auto &line = std::get<LaserLine::Line>(src.line);
+            sp::binary::Save(dst, line.points);
+            sp::binary::Save(dst, line.color);
+        } else if (std::holds_alternative<LaserLine::Segments>(src.line)) {
+            auto &segments = std::get<LaserLine::Segments>(src.line);
+            dst.WriteVarint(segments.size());
+            for (auto &segment : segments) {
+                dst.WriteRaw(segment.start);
+                dst.WriteRaw(segment.end);
+                sp::binary::Save(dst, segment.color);
+            }
+        }
+    }
+
     template<>
     void Component<LaserLine>::Apply(LaserLine &dst, const LaserLine &src, bool liveTarget) {
         auto &defaultComp = liveTarget ? ComponentLaserLine.defaultLiveComponent
@@ -54,5 +54,9 @@ namespace ecs {
         const LaserLine &src,
         const LaserLine *def);
     template<>
+    bool StructMetadata::LoadBinary<LaserLine>(LaserLine &dst, sp::binary::Reader &src);
+    template<>
+    void StructMetadata::SaveBinary<LaserLine>(sp::binary::Writer &dst, const LaserLine &src);
+    template<>
     void Component<LaserLine>::Apply(LaserLine &dst, const LaserLine &src, bool liveTarget);
 } // namespace ecs
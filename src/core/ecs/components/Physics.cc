@@ -8,6 +8,7 @@
 #include "Physics.hh"
 
 #include "assets/AssetManager.hh"
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
 #include "assets/PhysicsInfo.hh"
 #include "ecs/EcsImpl.hh"
@@ -180,6 +181,57 @@ namespace ecs {
             def ? &def->material.restitution : nullptr);
     }
 
+    template<>
+    bool StructMetadata::LoadBinary<PhysicsShape>(PhysicsShape &shape, sp::binary::Reader &src) {
+        // Transform and material are loaded as regular fields
+        uint64_t index;
+        if (!src.ReadVarint(index)) return false;
+        if (index == 0) {
+            shape.shape = std::monostate();
+        } else if (index == 1) {
+            PhysicsShape::Sphere sphere;
+            if (!src.ReadRaw(sphere.radius)) return false;
+            shape.shape = sphere;
+        } else if (index == 2) {
+            PhysicsShape::Capsule capsule;
+            if (!src.ReadRaw(capsule.radius) || !src.ReadRaw(capsule.height)) return false;
+            shape.shape = capsule;
+        } else if (index == 3) {
+            PhysicsShape::Box box;
+            if (!src.ReadRaw(box.extents)) return false;
+            shape.shape = box;
+        } else if (index == 4) {
+            shape.shape = PhysicsShape::Plane();
+        } else if (index == 5) {
+            std::string modelName, meshName;
+            if (!src.ReadString(modelName) || !src.ReadString(meshName)) return false;
+            if (modelName.empty() || meshName.empty()) return false;
+            shape.shape = PhysicsShape::ConvexMesh(modelName, meshName);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    template<>
+    void StructMetadata::SaveBinary<PhysicsShape>(sp::binary::Writer &dst, const PhysicsShape &src) {
+        // The variant index is saved directly, LoadBinary() must match the order of PhysicsShape::shape
+        dst.WriteVarint(src.shape.index());
+        if (std::holds_alternative<PhysicsShape::Sphere>(src.shape)) {
+            dst.WriteRaw(std::get<PhysicsShape::Sphere>(src.shape).radius);
+        } else if (std::holds_alternative<PhysicsShape::Capsule>(src.shape)) {
+            auto &capsule = std::get<PhysicsShape::Capsule>(src.shape);
+            dst.WriteRaw(capsule.radius);
+            dst.WriteRaw(capsule.height);
+        } else if (std::holds_alternative<PhysicsShape::Box>(src.shape)) {
+            dst.WriteRaw(std::get<PhysicsShape::Box>(src.shape).extents);
+        } else if (std::holds_alternative<PhysicsShape::ConvexMesh>(src.shape)) {
+            auto &model = std::get<PhysicsShape::ConvexMesh>(src.shape);
+            dst.WriteString(model.modelName);
+            dst.WriteString(model.meshName);
+        }
+    }
+
     PhysicsShape::ConvexMesh::ConvexMesh(const std::string &fullMeshName) {
         auto sep = fullMeshName.find('.');
         if (sep != std::string::npos) {
@@ -196,6 +196,10 @@ which decomposes the duck model into multiple convex hulls to more accurately re
         picojson::value &dst,
         const PhysicsShape &src,
         const PhysicsShape *def);
+    template<>
+    bool StructMetadata::LoadBinary<PhysicsShape>(PhysicsShape &dst, sp::binary::Reader &src);
+    template<>
+    void StructMetadata::SaveBinary<PhysicsShape>(sp::binary::Writer &dst, const PhysicsShape &src);
 
     enum class PhysicsActorType : uint8_t {
         Static,
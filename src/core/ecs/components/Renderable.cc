@@ -8,6 +8,7 @@
 #include "Renderable.hh"
 
 #include <assets/AssetManager.hh>
+#include <assets/BinaryHelpers.hh>
 #include <core/Logging.hh>
 #include <ecs/EcsImpl.hh>
 #include <picojson/picojson.h>
@@ -21,6 +22,14 @@ namespace ecs {
         return true;
     }
 
+    template<>
+    bool StructMetadata::LoadBinary<Renderable>(Renderable &renderable, sp::binary::Reader &src) {
+        if (!renderable.modelName.empty()) {
+            renderable.model = sp::Assets().LoadGltf(renderable.modelName);
+        }
+        return true;
+    }
+
     template<>
     void Component<Renderable>::Apply(Renderable &dst, const Renderable &src, bool liveTarget) {
         if (liveTarget || (!dst.model && src.model)) {
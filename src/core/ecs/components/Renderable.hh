@@ -100,5 +100,7 @@ It is usually preferred to load the model using the [gltf Prefab Script](Prefab_
     template<>
     bool StructMetadata::Load<Renderable>(Renderable &dst, const picojson::value &src);
     template<>
+    bool StructMetadata::LoadBinary<Renderable>(Renderable &dst, sp::binary::Reader &src);
+    template<>
     void Component<Renderable>::Apply(Renderable &dst, const Renderable &src, bool liveTarget);
 } // namespace ecs
@@ -7,6 +7,7 @@
 
 #include "SceneProperties.hh"
 
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
 #include "ecs/EcsImpl.hh"
 
@@ -85,6 +86,41 @@ namespace ecs {
         }
     }
 
+    enum class GravityFunction : uint8_t {
+        None,
+        StationSpin,
+    };
+
+    template<>
+    bool StructMetadata::LoadBinary<SceneProperties>(SceneProperties &dst, sp::binary::Reader &src) {
+        GravityFunction gravityFunc;
+        if (!src.ReadRaw(gravityFunc)) return false;
+        if (gravityFunc == GravityFunction::None) {
+            dst.gravityFunction = nullptr;
+        } else if (gravityFunc == GravityFunction::StationSpin) {
+            dst.gravityFunction = &stationSpinFunc;
+        } else {
+            Errorf("SceneProperties unknown binary gravity_func: %u", (uint32_t)gravityFunc);
+            return false;
+        }
+        return true;
+    }
+
+    template<>
+    void StructMetadata::SaveBinary<SceneProperties>(sp::binary::Writer &dst, const SceneProperties &src) {
+        if (!src.gravityFunction) {
+            dst.WriteRaw(GravityFunction::None);
+            return;
+        }
+
+        auto *target = src.gravityFunction.target<glm::vec3 (*)(glm::vec3)>();
+        if (target && *target == &stationSpinFunc) {
+            dst.WriteRaw(GravityFunction::StationSpin);
+        } else {
+            Abortf("Failed to serialize gravity function");
+        }
+    }
+
     template<>
     void Component<SceneProperties>::Apply(SceneProperties &dst, const SceneProperties &src, bool liveTarget) {
         if (liveTarget) {
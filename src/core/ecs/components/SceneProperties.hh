@@ -44,6 +44,11 @@ namespace ecs {
         const SceneProperties &src,
         const SceneProperties *def);
 
+    template<>
+    bool StructMetadata::LoadBinary<SceneProperties>(SceneProperties &dst, sp::binary::Reader &src);
+    template<>
+    void StructMetadata::SaveBinary<SceneProperties>(sp::binary::Writer &dst, const SceneProperties &src);
+
     template<>
     void Component<SceneProperties>::Apply(SceneProperties &dst, const SceneProperties &src, bool liveTarget);
 } // namespace ecs
@@ -7,6 +7,7 @@
 
 #include "Scripts.hh"
 
+#include "assets/BinaryHelpers.hh"
 #include "assets/JsonHelpers.hh"
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
@@ -127,6 +128,101 @@ namespace ecs {
         }
     }
 
+    enum class BinaryScriptType : uint8_t {
+        Inline,
+        OnTick,
+        Prefab,
+    };
+
+    template<>
+    bool StructMetadata::LoadBinary<ScriptInstance>(ScriptInstance &instance, sp::binary::Reader &src) {
+        BinaryScriptType scriptType;
+        if (!src.ReadRaw(scriptType)) return false;
+        if (scriptType == BinaryScriptType::Inline) {
+            Errorf("Inline C++ lambda scripts can't be loaded");
+            return false;
+        }
+
+        std::string scriptName;
+        sp::Hash64 paramsHash;
+        uint32_t paramsSize;
+        sp::binary::Reader params;
+        if (!src.ReadString(scriptName) || !src.ReadRaw(paramsHash) || !src.ReadRaw(paramsSize)) return false;
+        if (!src.Slice(paramsSize, params)) return false;
+
+        const auto &definitions = GetScriptDefinitions();
+        const ScriptDefinition *definition = nullptr;
+        if (scriptType == BinaryScriptType::OnTick) {
+            auto it = definitions.scripts.find(scriptName);
+            if (it != definitions.scripts.end()) definition = &it->second;
+        } else if (scriptType == BinaryScriptType::Prefab) {
+            auto it = definitions.prefabs.find(scriptName);
+            if (it != definitions.prefabs.end()) definition = &it->second;
+        } else {
+            return false;
+        }
+        if (!definition) {
+            Errorf("Script has unknown definition: %s", scriptName);
+            return false;
+        }
+
+        auto state = ScriptState(*definition);
+        if (definition->context) {
+            // Access will initialize default parameters
+            void *dataPtr = state.definition.context->Access(state);
+            Assertf(dataPtr, "Script definition returned null data: %s", state.definition.name);
+
+            auto &metadata = state.definition.context->metadata;
+            if (paramsHash == metadata.SchemaHash()) {
+                for (auto &field : metadata.fields) {
+                    if (!field.LoadBinary(dataPtr, params)) {
+                        Errorf("Script %s has invalid parameter: %s", state.definition.name, field.name);
+                        return false;
+                    }
+                }
+            } else {
+                Warnf("Script %s parameters have changed, using defaults", state.definition.name);
+            }
+        }
+        instance = std::make_shared<ScriptState>(std::move(state));
+        return true;
+    }
+
+    template<>
+    void StructMetadata::SaveBinary<ScriptInstance>(sp::binary::Writer &dst, const ScriptInstance &src) {
+        if (!src.state || src.state->definition.name.empty() ||
+            std::holds_alternative<std::monostate>(src.state->definition.callback)) {
+            dst.WriteRaw(BinaryScriptType::Inline);
+            return;
+        }
+        const auto &state = *src.state;
+        if (std::holds_alternative<PrefabFunc>(state.definition.callback)) {
+            dst.WriteRaw(BinaryScriptType::Prefab);
+        } else {
+            dst.WriteRaw(BinaryScriptType::OnTick);
+        }
+        dst.WriteString(state.definition.name);
+
+        if (!state.definition.context) {
+            dst.WriteRaw<sp::Hash64>(0);
+            dst.WriteRaw<uint32_t>(0);
+            return;
+        }
+
+        // Parameters are prefixed with their schema hash and size, so they can be skipped if the script changes
+        std::lock_guard l(GetScriptManager().mutexes[state.definition.callback.index()]);
+        const void *dataPtr = state.definition.context->Access(state);
+        Assertf(dataPtr, "Script definition returned null data: %s", state.definition.name);
+        auto &metadata = state.definition.context->metadata;
+        dst.WriteRaw(metadata.SchemaHash());
+        size_t sizeOffset = dst.Size();
+        dst.WriteRaw<uint32_t>(0);
+        for (auto &field : metadata.fields) {
+            field.SaveBinary(dst, dataPtr);
+        }
+        dst.Patch(sizeOffset, (uint32_t)(dst.Size() - sizeOffset - sizeof(uint32_t)));
+    }
+
     template<>
     void StructMetadata::SetScope<ScriptInstance>(ScriptInstance &dst, const EntityScope &scope) {
         if (!dst.state) return;
@@ -92,6 +92,10 @@ Here is an example of an instance definition for a "spotlight" [`template` Prefa
         const ScriptInstance *def);
     template<>
     void StructMetadata::SetScope<ScriptInstance>(ScriptInstance &dst, const EntityScope &scope);
+    template<>
+    bool StructMetadata::LoadBinary<ScriptInstance>(ScriptInstance &dst, sp::binary::Reader &src);
+    template<>
+    void StructMetadata::SaveBinary<ScriptInstance>(sp::binary::Writer &dst, const ScriptInstance &src);
 
     struct Scripts {
         ScriptState &AddOnTick(const EntityScope &scope, const std::string &scriptName) {
@@ -132,8 +136,23 @@ Here is an example of an instance definition for a "spotlight" [`template` Prefa
     struct script_has_init_func<T, std::void_t<decltype(std::declval<T>().Init(std::declval<ScriptState &>()))>>
         : std::true_type {};
 
+    // Extracts the lock type from a script's OnTick(ScriptState &, LockType, Entity, chrono_clock::duration) function
+    template<typename Fn>
+    struct script_on_tick_lock {};
+    template<typename T, typename LockType>
+    struct script_on_tick_lock<void (T::*)(ScriptState &, LockType, Entity, chrono_clock::duration)> {
+        using type = std::remove_cvref_t<LockType>;
+    };
+
+    /**
+     * Registers an OnTick script type. The script's OnTick() may take any lock type that is a subset of
+     * Lock<WriteAll>. The lock type declares which components the script accesses, and scripts that don't write
+     * components accessed by other scripts may be run in parallel on worker threads.
+     */
     template<typename T>
     struct InternalScript final : public InternalScriptBase {
+        using OnTickLock = typename script_on_tick_lock<decltype(&T::OnTick)>::type;
+
         const T defaultValue = {};
 
         const void *GetDefault() const override {
@@ -164,14 +183,25 @@ Here is an example of an instance definition for a "spotlight" [`template` Prefa
         }
 
         InternalScript(const std::string &name, const StructMetadata &metadata) : InternalScriptBase(metadata) {
-            GetScriptDefinitions().RegisterScript({name, {}, false, this, ScriptInitFunc(&Init), OnTickFunc(&OnTick)});
+            GetScriptDefinitions().RegisterScript({name,
+                {},
+                false,
+                this,
+                ScriptInitFunc(&Init),
+                OnTickFunc(&OnTick),
+                ScriptAccess::FromLock<OnTickLock>()});
         }
 
         template<typename... Events>
         InternalScript(const std::string &name, const StructMetadata &metadata, bool filterOnEvent, Events... events)
             : InternalScriptBase(metadata) {
-            GetScriptDefinitions().RegisterScript(
-                {name, {events...}, filterOnEvent, this, ScriptInitFunc(&Init), OnTickFunc(&OnTick)});
+            GetScriptDefinitions().RegisterScript({name,
+                {events...},
+                filterOnEvent,
+                this,
+                ScriptInitFunc(&Init),
+                OnTickFunc(&OnTick),
+                ScriptAccess::FromLock<OnTickLock>()});
         }
     };
 
@@ -54,45 +54,182 @@ namespace ecs {
 
 namespace std {
     std::size_t hash<ecs::SignalKey>::operator()(const ecs::SignalKey &key) const {
-        auto val = hash<string>()(key.signalName);
-        sp::hash_combine(val, key.entity.Name());
-        return val;
+        return ecs::SignalKeyHash()(key);
     }
 } // namespace std
 
 namespace ecs {
-    size_t Signals::NewSignal(const SignalRef &ref, double value) {
-        size_t index;
+    std::size_t SignalKeyHash::operator()(const SignalKey &key) const {
+        return (*this)(SignalKeyView{key.entity, key.signalName});
+    }
+
+    std::size_t SignalKeyHash::operator()(const SignalKeyView &key) const {
+        // std::hash<std::string_view> matches std::hash<std::string> for the same characters
+        auto val = std::hash<std::string_view>()(key.signalName);
+        sp::hash_combine(val, key.entity.Name());
+        return val;
+    }
+
+    SignalSlot Signals::allocateSlot() {
+        SignalSlot slot;
         if (freeIndexes.empty()) {
-            index = signals.size();
-            signals.emplace_back(value, ref);
+            slot.index = values.size();
+            values.emplace_back(-std::numeric_limits<double>::infinity());
+            expressions.emplace_back();
+            refs.emplace_back();
+            dependencies.emplace_back();
+            cachedValues.emplace_back();
+            generations.emplace_back(0);
         } else {
-            auto it = freeIndexes.begin();
-            index = *it;
-            freeIndexes.erase(it);
-            signals[index] = Signal(value, ref);
+            slot.index = freeIndexes.back();
+            freeIndexes.pop_back();
         }
-        return index;
+        slot.generation = generations[slot.index];
+        return slot;
     }
 
-    size_t Signals::NewSignal(const SignalRef &ref, const SignalExpression &expr) {
-        size_t index;
-        if (freeIndexes.empty()) {
-            index = signals.size();
-            signals.emplace_back(expr, ref);
-        } else {
-            auto it = freeIndexes.begin();
-            index = *it;
-            freeIndexes.erase(it);
-            signals[index] = Signal(expr, ref);
+    SignalSlot Signals::NewSignal(const SignalRef &ref, double value) {
+        SignalSlot slot = allocateSlot();
+        values[slot.index] = value;
+        if (!std::isinf(value)) refs[slot.index] = ref;
+        return slot;
+    }
+
+    SignalSlot Signals::NewSignal(const SignalRef &ref, const SignalExpression &expr) {
+        SignalSlot slot = allocateSlot();
+        expressions[slot.index] = expr;
+        if (expr) refs[slot.index] = ref;
+        MarkBindingChanged();
+        return slot;
+    }
+
+    void Signals::ClearSignal(size_t index) {
+        if (index >= Size()) return;
+        MarkDirty(index);
+        UntrackDependents(index);
+        SetDependencies(index, {});
+        values[index] = -std::numeric_limits<double>::infinity();
+        if (!expressions[index].IsNull()) MarkBindingChanged();
+        expressions[index] = SignalExpression();
+        refs[index] = {};
+    }
+
+    void Signals::FreeSignal(const SignalSlot &slot) {
+        if (!Contains(slot)) return;
+        ClearSignal(slot.index);
+        generations[slot.index]++;
+        freeIndexes.emplace_back(slot.index);
+    }
+
+    void Signals::SetDependencies(size_t index, std::optional<std::vector<size_t>> &&newDependencies) {
+        if (index >= Size()) return;
+        auto &signal = dependencies[index];
+        for (auto &dependency : signal.dependencies) {
+            if (dependency < Size()) sp::erase(dependencies[dependency].dependents, index);
+        }
+        signal.dependencies.clear();
+        signal.tracked = newDependencies.has_value();
+        if (!newDependencies) return;
+
+        signal.dependencies = std::move(*newDependencies);
+        for (auto &dependency : signal.dependencies) {
+            Assertf(dependency < Size(), "Signals::SetDependencies invalid dependency: %u", dependency);
+            auto &dependents = dependencies[dependency].dependents;
+            if (!sp::contains(dependents, index)) dependents.emplace_back(index);
         }
-        return index;
     }
 
-    void Signals::FreeSignal(size_t index) {
-        if (index >= signals.size()) return;
-        signals[index] = Signal();
-        freeIndexes.insert(index);
+    void Signals::UntrackDependents(size_t index) {
+        if (index >= Size()) return;
+        // Each dependent removes itself from the list, so iterate over a copy
+        untrackList.assign(dependencies[index].dependents.begin(), dependencies[index].dependents.end());
+        for (auto &dependent : untrackList) {
+            SetDependencies(dependent, {});
+        }
+        dependencies[index].dependents.clear();
+    }
+
+    struct TransactionSignalCache {
+        size_t transactionId = 0;
+        size_t generation = 0;
+        const Signals *signals = nullptr;
+        robin_hood::unordered_flat_map<size_t, double> values;
+    };
+
+    static thread_local TransactionSignalCache transactionCache;
+    // Incremented to invalidate the transaction caches of all threads at once
+    static std::atomic_size_t transactionCacheGeneration;
+
+    static bool transactionCacheValid(const Signals *signals, size_t transactionId) {
+        return transactionCache.signals == signals && transactionCache.transactionId == transactionId &&
+               transactionCache.generation == transactionCacheGeneration.load(std::memory_order_acquire);
+    }
+
+    void Signals::InvalidateTransactionCaches() {
+        transactionCacheGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    void Signals::MarkDirty(size_t index) {
+        if (index >= Size()) return;
+        // Any transaction-cached values may have been derived from this signal, possibly on another thread
+        InvalidateTransactionCaches();
+
+        // If a signal's cache is invalid, all of its dependents' caches must also be invalid,
+        // so propagation can stop early. The root is always propagated since values aren't cached.
+        cachedValues[index].valid = false;
+        dirtyStack.assign(dependencies[index].dependents.begin(), dependencies[index].dependents.end());
+        while (!dirtyStack.empty()) {
+            size_t dependent = dirtyStack.back();
+            dirtyStack.pop_back();
+            if (dependent >= Size()) continue;
+            auto &cachedValue = cachedValues[dependent];
+            if (!cachedValue.valid) continue;
+            cachedValue.valid = false;
+            auto &dependents = dependencies[dependent].dependents;
+            dirtyStack.insert(dirtyStack.end(), dependents.begin(), dependents.end());
+        }
+    }
+
+    static std::atomic_size_t nextBindingVersion;
+
+    void Signals::MarkBindingChanged() {
+        bindingVersion = ++nextBindingVersion;
+    }
+
+    bool Signals::LoadCachedValue(size_t index,
+        size_t transactionId,
+        double &valueOut,
+        SignalCacheability &cacheabilityOut) const {
+        if (index >= Size()) return false;
+        if (cachedValues[index].Load(valueOut)) {
+            cacheabilityOut = SignalCacheability::UntilChanged;
+            return true;
+        }
+        if (!transactionCacheValid(this, transactionId)) return false;
+        auto it = transactionCache.values.find(index);
+        if (it == transactionCache.values.end()) return false;
+        valueOut = it->second;
+        cacheabilityOut = SignalCacheability::Transaction;
+        return true;
+    }
+
+    void Signals::StoreCachedValue(size_t index,
+        size_t transactionId,
+        double value,
+        SignalCacheability cacheability) const {
+        if (index >= Size()) return;
+        // Values can only be invalidated if this signal is registered as a dependent of its inputs
+        if (cacheability == SignalCacheability::UntilChanged && dependencies[index].tracked) {
+            cachedValues[index].Store(value);
+        } else if (cacheability != SignalCacheability::None && transactionId > 0) {
+            if (!transactionCacheValid(this, transactionId)) {
+                transactionCache.signals = this;
+                transactionCache.transactionId = transactionId;
+                transactionCache.generation = transactionCacheGeneration.load(std::memory_order_acquire);
+                transactionCache.values.clear();
+            }
+            transactionCache.values[index] = value;
+        }
     }
 
     template<>
@@ -13,36 +13,112 @@
 #include "ecs/SignalExpression.hh"
 #include "ecs/SignalRef.hh"
 
+#include <atomic>
 #include <limits>
+#include <optional>
 #include <robin_hood.h>
-#include <set>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace ecs {
     static const size_t MAX_SIGNAL_BINDING_DEPTH = 10;
 
     struct Signals {
-        struct Signal {
-            double value;
-            SignalExpression expr;
-            SignalRef ref;
-
-            Signal() : value(-std::numeric_limits<double>::infinity()) {}
-            Signal(double value, const SignalRef &ref) : value(value) {
-                if (!std::isinf(value)) this->ref = ref;
+        // Memoized result of a signal's binding expression. Stored atomically since it is written from read locks.
+        struct CachedValue {
+            std::atomic<double> value = 0.0;
+            std::atomic_bool valid = false;
+
+            CachedValue() {}
+            CachedValue(const CachedValue &other) {
+                *this = other;
+            }
+
+            CachedValue &operator=(const CachedValue &other) {
+                bool otherValid = other.valid.load(std::memory_order_acquire);
+                value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                valid.store(otherValid, std::memory_order_release);
+                return *this;
             }
-            Signal(const SignalExpression &expr, const SignalRef &ref)
-                : value(-std::numeric_limits<double>::infinity()), expr(expr) {
-                if (expr) this->ref = ref;
+
+            bool Load(double &valueOut) const {
+                if (!valid.load(std::memory_order_acquire)) return false;
+                valueOut = value.load(std::memory_order_relaxed);
+                return true;
             }
+
+            void Store(double newValue) const {
+                // const_cast is safe here, the cache is only ever written with values that are identical for all
+                // readers of the same transaction state.
+                auto &self = const_cast<CachedValue &>(*this);
+                self.value.store(newValue, std::memory_order_relaxed);
+                self.valid.store(true, std::memory_order_release);
+            }
+        };
+
+        // Binding dependency bookkeeping, stored apart from the values and expressions read during evaluation.
+        struct Dependencies {
+            // Indexes of signals whose bindings read this signal, and the indexes this signal's binding reads.
+            // Dependencies are only tracked if every signal referenced by the binding has an index.
+            std::vector<size_t> dependents;
+            std::vector<size_t> dependencies;
+            bool tracked = false;
         };
 
-        std::vector<Signal> signals;
-        std::set<size_t> freeIndexes;
+        // Signal slots are stored as parallel arrays indexed by SignalSlot::index.
+        // A value of -inf means no value is set, and a null expression means no binding is set.
+        std::vector<double> values;
+        std::vector<SignalExpression> expressions;
+        std::vector<SignalRef> refs;
+        std::vector<Dependencies> dependencies;
+        std::vector<CachedValue> cachedValues;
+        // Incremented each time a slot is freed so stale SignalSlot handles can be detected
+        std::vector<uint32_t> generations;
+        std::vector<size_t> freeIndexes;
+        // Set to a new process-wide unique value whenever any binding expression is set or cleared
+        size_t bindingVersion = 0;
+
+        size_t Size() const {
+            return values.size();
+        }
+
+        bool Contains(const SignalSlot &slot) const {
+            return slot.index < generations.size() && generations[slot.index] == slot.generation;
+        }
+
+        SignalSlot NewSignal(const SignalRef &ref, double value);
+        SignalSlot NewSignal(const SignalRef &ref, const SignalExpression &expr);
+        void ClearSignal(size_t index);
+        void FreeSignal(const SignalSlot &slot);
+
+        // Replaces the set of signals read by the binding at index. Pass std::nullopt if some are unresolved.
+        void SetDependencies(size_t index, std::optional<std::vector<size_t>> &&newDependencies);
+        // Stops tracking every binding that reads the signal at index, since the slot is being reset.
+        void UntrackDependents(size_t index);
+        // Invalidates any memoized values derived from the signal at index.
+        void MarkDirty(size_t index);
+        // Must be called after a binding expression is changed, so compiled SignalBindingBatches are rebuilt.
+        void MarkBindingChanged();
 
-        size_t NewSignal(const SignalRef &ref, double value);
-        size_t NewSignal(const SignalRef &ref, const SignalExpression &expr);
-        void FreeSignal(size_t index);
+        // Memoized values are stored per-signal if they are only derived from other signals, or in a thread-local
+        // cache for the duration of a transaction if they read other components.
+        bool LoadCachedValue(size_t index,
+            size_t transactionId,
+            double &valueOut,
+            SignalCacheability &cacheabilityOut) const;
+        void StoreCachedValue(size_t index, size_t transactionId, double value, SignalCacheability cacheability) const;
+
+        // Invalidates the transaction caches of every thread. Must be called when a transaction is shared between
+        // threads and one of them writes components that other threads' cached values may have been derived from.
+        static void InvalidateTransactionCaches();
+
+        // Scratch space for MarkDirty() and UntrackDependents()
+        std::vector<size_t> dirtyStack;
+        std::vector<size_t> untrackList;
+
+    private:
+        SignalSlot allocateSlot();
     };
 
     struct SignalKey {
@@ -71,6 +147,31 @@ namespace ecs {
     };
 
     std::ostream &operator<<(std::ostream &out, const SignalKey &v);
+
+    // Used to look up existing signals by name without allocating a SignalKey
+    struct SignalKeyView {
+        const EntityRef &entity;
+        std::string_view signalName;
+    };
+
+    struct SignalKeyHash {
+        using is_transparent = void;
+
+        std::size_t operator()(const SignalKey &key) const;
+        std::size_t operator()(const SignalKeyView &key) const;
+    };
+
+    struct SignalKeyEqual {
+        using is_transparent = void;
+
+        bool operator()(const SignalKeyView &lhs, const SignalKey &rhs) const {
+            const std::string_view view = rhs.signalName;
+            return lhs.signalName == view && lhs.entity == rhs.entity;
+        }
+        bool operator()(const SignalKey &lhs, const SignalKey &rhs) const {
+            return lhs == rhs;
+        }
+    };
 } // namespace ecs
 
 TECS_GLOBAL_COMPONENT(ecs::Signals);
@@ -8,6 +8,7 @@
 #include "Sound.hh"
 
 #include "assets/AssetManager.hh"
+#include "assets/BinaryHelpers.hh"
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
 
@@ -22,6 +23,14 @@ namespace ecs {
         return true;
     }
 
+    template<>
+    bool StructMetadata::LoadBinary<Sound>(Sound &sound, sp::binary::Reader &src) {
+        if (!sound.filePath.empty()) {
+            sound.file = sp::Assets().Load("audio/" + sound.filePath);
+        }
+        return true;
+    }
+
     template<>
     void Component<Audio>::Apply(Audio &dst, const Audio &src, bool liveTarget) {
         for (auto &sound : src.sounds) {
@@ -47,6 +47,8 @@ namespace ecs {
         StructField::New("volume", &Sound::volume));
     template<>
     bool StructMetadata::Load<Sound>(Sound &dst, const picojson::value &src);
+    template<>
+    bool StructMetadata::LoadBinary<Sound>(Sound &dst, sp::binary::Reader &src);
 
     struct Audio {
         std::vector<Sound> sounds;
@@ -0,0 +1,407 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "CompiledScene.hh"
+
+#include "assets/Asset.hh"
+#include "assets/BinaryHelpers.hh"
+#include "assets/JsonHelpers.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+#include "ecs/Components.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <cstring>
+#include <picojson/picojson.h>
+#include <robin_hood.h>
+
+namespace sp {
+    using namespace compiled_scene;
+
+    struct CompiledSceneWriter {
+        std::vector<StringEntry> strings;
+        std::string stringData;
+        robin_hood::unordered_flat_map<std::string, uint32_t> stringIndex;
+
+        std::vector<ComponentEntry> components;
+        robin_hood::unordered_flat_map<const ecs::ComponentBase *, uint32_t> componentIndex;
+
+        std::vector<EntityEntry> entities;
+        std::vector<ComponentValue> componentValues;
+        std::vector<uint8_t> data;
+
+        uint32_t AddString(const std::string &str) {
+            auto it = stringIndex.find(str);
+            if (it != stringIndex.end()) return it->second;
+
+            uint32_t index = strings.size();
+            strings.emplace_back(StringEntry{(uint32_t)stringData.size(), (uint32_t)str.size()});
+            stringData.append(str);
+            stringData.push_back('\0');
+            stringIndex.emplace(str, index);
+            return index;
+        }
+
+        uint32_t AddComponent(const ecs::ComponentBase &comp) {
+            auto it = componentIndex.find(&comp);
+            if (it != componentIndex.end()) return it->second;
+
+            uint32_t index = components.size();
+            components.emplace_back(ComponentEntry{comp.SchemaHash(), AddString(comp.name), 0});
+            componentIndex.emplace(&comp, index);
+            return index;
+        }
+    };
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    static void saveComponents(ECSType<AllComponentTypes...> *,
+        CompiledSceneWriter &writer,
+        sp::binary::Writer &dataWriter,
+        const ecs::FlatEntity &src) {
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                if constexpr (!std::is_same_v<T, ecs::Name> && !std::is_same_v<T, ecs::SceneInfo> &&
+                              !Tecs::is_global_component<T>()) {
+                    auto &opt = std::get<std::optional<T>>(src);
+                    if (!opt) return;
+
+                    auto &comp = ecs::LookupComponent<T>();
+                    ComponentValue value;
+                    value.component = writer.AddComponent(comp);
+                    value.dataOffset = writer.data.size();
+                    comp.SaveBinary(dataWriter, &*opt);
+                    value.dataSize = writer.data.size() - value.dataOffset;
+                    writer.componentValues.emplace_back(value);
+                }
+            }(),
+            ...);
+    }
+
+    template<typename T>
+    static uint32_t appendTable(std::vector<uint8_t> &output, const T *data, size_t count) {
+        // Keep every table 8 byte aligned so values can be read in place from the mapping
+        output.resize((output.size() + 7) & ~(size_t)7);
+        uint32_t offset = output.size();
+        output.resize(output.size() + sizeof(T) * count);
+        if (count > 0) std::memcpy(output.data() + offset, data, sizeof(T) * count);
+        return offset;
+    }
+
+    // Saves every field like ComponentBase::SaveEntity() would, without skipping default values
+    template<typename T>
+    static std::string componentJson(const ecs::Component<T> &comp, const T &value) {
+        picojson::value dst;
+        for (auto &field : comp.metadata.fields) {
+            field.Save(ecs::Name(), dst, &value, nullptr);
+        }
+        ecs::StructMetadata::Save<T>(ecs::Name(), dst, value, nullptr);
+        return dst.serialize();
+    }
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    static bool compareEntities(ECSType<AllComponentTypes...> *,
+        const std::string &sceneName,
+        const ecs::FlatEntity &expected,
+        const ecs::FlatEntity &compiled) {
+        bool match = true;
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                if constexpr (!std::is_same_v<T, ecs::SceneInfo> && !Tecs::is_global_component<T>()) {
+                    auto &optA = std::get<std::optional<T>>(expected);
+                    auto &optB = std::get<std::optional<T>>(compiled);
+                    auto &comp = ecs::LookupComponent<T>();
+                    if (optA.has_value() != optB.has_value()) {
+                        Errorf("CompileScene(%s): Compiled entity is missing component: %s", sceneName, comp.name);
+                        match = false;
+                    } else if (optA && componentJson(comp, *optA) != componentJson(comp, *optB)) {
+                        Errorf("CompileScene(%s): Compiled component doesn't match json: %s", sceneName, comp.name);
+                        match = false;
+                    }
+                }
+            }(),
+            ...);
+        return match;
+    }
+
+    std::vector<uint8_t> CompileScene(const std::string &sceneName,
+        const picojson::value &sceneRoot,
+        const Hash128 &sourceHash,
+        const AssetFileInfo &sourceInfo) {
+        ZoneScoped;
+        if (!sceneRoot.is<picojson::object>()) {
+            Errorf("Failed to compile scene (%s): %s", sceneName, sceneRoot.to_str());
+            return {};
+        }
+        auto &sceneObj = sceneRoot.get<picojson::object>();
+
+        CompiledSceneWriter writer;
+        sp::binary::Writer dataWriter(writer.data);
+        Header header = {};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.sourceHash = sourceHash;
+        header.sourceSize = sourceInfo.size;
+        header.sourceModifiedTime = sourceInfo.modifiedTime;
+        header.binaryVersion = sp::binary::VERSION;
+        header.priority = NO_INDEX;
+        header.propertiesOffset = NO_INDEX;
+
+        auto &propertiesComponent = ecs::LookupComponent<ecs::SceneProperties>();
+        header.propertiesSchema = propertiesComponent.SchemaHash();
+
+        ScenePriority priority = ScenePriority::Scene;
+        auto priorityIt = sceneObj.find("priority");
+        if (priorityIt != sceneObj.end() && json::Load(priority, priorityIt->second)) {
+            header.priority = (uint32_t)priority;
+        }
+        auto propertiesIt = sceneObj.find("properties");
+        if (propertiesIt != sceneObj.end()) {
+            ecs::SceneProperties properties = {};
+            if (!json::Load(properties, propertiesIt->second)) {
+                Errorf("Failed to compile scene (%s): invalid properties", sceneName);
+                return {};
+            }
+            header.propertiesOffset = writer.data.size();
+            propertiesComponent.SaveBinary(dataWriter, &properties);
+            header.propertiesSize = writer.data.size() - header.propertiesOffset;
+        }
+
+        // Entities are loaded with the same json loaders as the runtime, and kept to verify the output
+        ecs::EntityScope scope(sceneName, "");
+        std::vector<ecs::FlatEntity> expectedEntities;
+        auto entitiesIt = sceneObj.find("entities");
+        if (entitiesIt != sceneObj.end()) {
+            if (!entitiesIt->second.is<picojson::array>()) {
+                Errorf("Failed to compile scene (%s): entities must be an array", sceneName);
+                return {};
+            }
+            for (auto &value : entitiesIt->second.get<picojson::array>()) {
+                if (!value.is<picojson::object>()) {
+                    Errorf("Failed to compile scene (%s): invalid entity %s", sceneName, value.to_str());
+                    return {};
+                }
+                auto &entSrc = value.get<picojson::object>();
+                auto &entFlat = expectedEntities.emplace_back();
+                auto &entDst = writer.entities.emplace_back();
+                entDst.name = NO_INDEX;
+                entDst.firstComponent = writer.componentValues.size();
+
+                auto nameIt = entSrc.find("name");
+                if (nameIt != entSrc.end() && nameIt->second.is<std::string>()) {
+                    entDst.name = writer.AddString(nameIt->second.get<std::string>());
+                    ecs::Name name(nameIt->second.get<std::string>(), scope);
+                    if (name) std::get<std::optional<ecs::Name>>(entFlat) = name;
+                }
+
+                for (auto &comp : entSrc) {
+                    if (comp.first.empty() || comp.first[0] == '_' || comp.first == "name") continue;
+
+                    auto componentType = ecs::LookupComponent(comp.first);
+                    if (componentType == nullptr) {
+                        Errorf("CompileScene(%s): Unknown component, ignoring: %s", sceneName, comp.first);
+                    } else if (!componentType->LoadEntity(entFlat, comp.second)) {
+                        Errorf("CompileScene(%s): Failed to load component, ignoring: %s", sceneName, comp.first);
+                    }
+                }
+
+                // Components are saved from the loaded entity so the output matches what the json loaders produce
+                saveComponents((ecs::ECS *)nullptr, writer, dataWriter, entFlat);
+                entDst.componentCount = writer.componentValues.size() - entDst.firstComponent;
+            }
+        }
+
+        std::vector<uint8_t> output(sizeof(Header));
+        header.stringCount = writer.strings.size();
+        header.stringsOffset = appendTable(output, writer.strings.data(), writer.strings.size());
+        header.stringDataSize = writer.stringData.size();
+        header.stringDataOffset = appendTable(output, writer.stringData.data(), writer.stringData.size());
+        header.componentCount = writer.components.size();
+        header.componentsOffset = appendTable(output, writer.components.data(), writer.components.size());
+        header.entityCount = writer.entities.size();
+        header.entitiesOffset = appendTable(output, writer.entities.data(), writer.entities.size());
+        header.componentValueCount = writer.componentValues.size();
+        header.componentValuesOffset = appendTable(output,
+            writer.componentValues.data(),
+            writer.componentValues.size());
+        header.dataSize = writer.data.size();
+        header.dataOffset = appendTable(output, writer.data.data(), writer.data.size());
+        std::memcpy(output.data(), &header, sizeof(Header));
+
+        // Verify the compiled output loads back to exactly what the json loaders produce
+        auto compiled = CompiledScene::Open(sceneName, nullptr, output.data(), output.size());
+        if (!compiled) {
+            Errorf("CompileScene(%s): Compiled scene failed to open", sceneName);
+            return {};
+        }
+        std::vector<ecs::FlatEntity> compiledEntities;
+        compiled->LoadEntities(scope, compiledEntities);
+        if (compiledEntities.size() != expectedEntities.size()) {
+            Errorf("CompileScene(%s): Compiled scene has %u entities, expected %u",
+                sceneName,
+                compiledEntities.size(),
+                expectedEntities.size());
+            return {};
+        }
+        for (size_t i = 0; i < expectedEntities.size(); i++) {
+            if (!compareEntities((ecs::ECS *)nullptr, sceneName, expectedEntities[i], compiledEntities[i])) {
+                return {};
+            }
+        }
+        return output;
+    }
+
+    std::shared_ptr<const CompiledScene> CompiledScene::Open(const std::string &sceneName,
+        std::shared_ptr<const void> storage,
+        const uint8_t *data,
+        size_t size) {
+        if (!data || size < sizeof(Header)) {
+            Errorf("Compiled scene is truncated: %s", sceneName);
+            return nullptr;
+        }
+        Assertf(((uintptr_t)data & 7) == 0, "Compiled scene data is not 8 byte aligned: %s", sceneName);
+
+        std::shared_ptr<CompiledScene> scene(new CompiledScene(sceneName));
+        scene->storage = storage;
+        scene->header = reinterpret_cast<const Header *>(data);
+        if (scene->header->magic != MAGIC) {
+            Errorf("Compiled scene has invalid header: %s", sceneName);
+            return nullptr;
+        } else if (scene->header->version != VERSION) {
+            Warnf("Compiled scene has version %u, expected %u: %s", scene->header->version, VERSION, sceneName);
+            return nullptr;
+        } else if (scene->header->binaryVersion != sp::binary::VERSION) {
+            Warnf("Compiled scene has binary version %u, expected %u: %s",
+                scene->header->binaryVersion,
+                sp::binary::VERSION,
+                sceneName);
+            return nullptr;
+        }
+        if (!scene->validate(size)) {
+            Errorf("Compiled scene is corrupt: %s", sceneName);
+            return nullptr;
+        }
+        if (!scene->resolveComponents()) return nullptr;
+        return scene;
+    }
+
+    template<typename T>
+    static const T *tableAt(const Header *header, size_t size, uint32_t offset, uint32_t count) {
+        if (offset % alignof(T) != 0) return nullptr;
+        if ((uint64_t)offset + (uint64_t)count * sizeof(T) > size) return nullptr;
+        return reinterpret_cast<const T *>(reinterpret_cast<const uint8_t *>(header) + offset);
+    }
+
+    bool CompiledScene::validate(size_t size) {
+        strings = tableAt<StringEntry>(header, size, header->stringsOffset, header->stringCount);
+        stringData = tableAt<char>(header, size, header->stringDataOffset, header->stringDataSize);
+        components = tableAt<ComponentEntry>(header, size, header->componentsOffset, header->componentCount);
+        entities = tableAt<EntityEntry>(header, size, header->entitiesOffset, header->entityCount);
+        componentValues = tableAt<ComponentValue>(header,
+            size,
+            header->componentValuesOffset,
+            header->componentValueCount);
+        data = tableAt<uint8_t>(header, size, header->dataOffset, header->dataSize);
+        if (!strings || !stringData || !components || !entities || !componentValues || !data) return false;
+
+        for (uint32_t i = 0; i < header->stringCount; i++) {
+            auto &entry = strings[i];
+            if ((uint64_t)entry.offset + entry.length >= header->stringDataSize) return false;
+            if (stringData[entry.offset + entry.length] != '\0') return false;
+        }
+        for (uint32_t i = 0; i < header->componentCount; i++) {
+            if (components[i].name >= header->stringCount) return false;
+        }
+        for (uint32_t i = 0; i < header->entityCount; i++) {
+            auto &entity = entities[i];
+            if (entity.name != NO_INDEX && entity.name >= header->stringCount) return false;
+            if ((uint64_t)entity.firstComponent + entity.componentCount > header->componentValueCount) return false;
+        }
+        for (uint32_t i = 0; i < header->componentValueCount; i++) {
+            auto &comp = componentValues[i];
+            if (comp.component >= header->componentCount) return false;
+            if ((uint64_t)comp.dataOffset + comp.dataSize > header->dataSize) return false;
+        }
+        if (header->propertiesOffset != NO_INDEX) {
+            if ((uint64_t)header->propertiesOffset + header->propertiesSize > header->dataSize) return false;
+        }
+        return true;
+    }
+
+    bool CompiledScene::resolveComponents() {
+        auto &propertiesComponent = ecs::LookupComponent<ecs::SceneProperties>();
+        if (header->propertiesSchema != propertiesComponent.SchemaHash()) {
+            Warnf("Compiled scene was built with different scene properties, recompile it: %s", sceneName);
+            return false;
+        }
+
+        // Component types are only looked up once per file instead of once per entity
+        componentTypes.resize(header->componentCount);
+        for (uint32_t i = 0; i < header->componentCount; i++) {
+            auto name = String(components[i].name);
+            componentTypes[i] = ecs::LookupComponent(std::string(name));
+            if (!componentTypes[i]) {
+                Warnf("Compiled scene contains unknown component %s, recompile it: %s", name, sceneName);
+                return false;
+            } else if (componentTypes[i]->SchemaHash() != components[i].schemaHash) {
+                Warnf("Compiled scene was built with a different %s component, recompile it: %s", name, sceneName);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CompiledScene::MatchesSource(const AssetFileInfo &sourceInfo) const {
+        if (sourceInfo.size != header->sourceSize) return false;
+        // Files packed into the asset bundle have no modified time, and are compiled together with the bundle
+        return sourceInfo.modifiedTime == 0 || sourceInfo.modifiedTime == header->sourceModifiedTime;
+    }
+
+    std::string_view CompiledScene::String(uint32_t index) const {
+        if (index >= header->stringCount) return {};
+        return std::string_view(stringData + strings[index].offset, strings[index].length);
+    }
+
+    bool CompiledScene::LoadProperties(ScenePriority &priority, ecs::SceneProperties &properties) const {
+        if (header->priority != NO_INDEX) priority = (ScenePriority)header->priority;
+        if (header->propertiesOffset != NO_INDEX) {
+            sp::binary::Reader reader(data + header->propertiesOffset, header->propertiesSize);
+            if (!sp::binary::Load(properties, reader) || reader.Remaining() != 0) {
+                Errorf("Scene contains invalid properties: %s", sceneName);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CompiledScene::LoadEntities(const ecs::EntityScope &scope, std::vector<ecs::FlatEntity> &output) const {
+        ZoneScoped;
+        output.reserve(output.size() + header->entityCount);
+        for (uint32_t i = 0; i < header->entityCount; i++) {
+            auto &entSrc = entities[i];
+            auto &entDst = output.emplace_back();
+
+            if (entSrc.name != NO_INDEX) {
+                ecs::Name name(String(entSrc.name), scope);
+                if (name) std::get<std::optional<ecs::Name>>(entDst) = name;
+            }
+
+            for (uint32_t c = 0; c < entSrc.componentCount; c++) {
+                auto &comp = componentValues[entSrc.firstComponent + c];
+                auto *componentType = componentTypes[comp.component];
+
+                sp::binary::Reader reader(data + comp.dataOffset, comp.dataSize);
+                if (!componentType->LoadBinary(entDst, reader) || reader.Remaining() != 0) {
+                    Errorf("LoadScene(%s): Failed to load component, ignoring: %s", sceneName, componentType->name);
+                }
+            }
+        }
+    }
+} // namespace sp
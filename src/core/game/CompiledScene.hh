@@ -0,0 +1,148 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+#include "ecs/Ecs.hh"
+#include "ecs/components/Name.hh"
+#include "game/SceneRef.hh"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace picojson {
+    class value;
+}
+
+namespace ecs {
+    class ComponentBase;
+    struct SceneProperties;
+} // namespace ecs
+
+namespace sp {
+    struct AssetFileInfo;
+
+    /**
+     * Compiled scenes (.spscene) are generated offline from the scene json files by the scene_compiler tool.
+     * The json file remains the authoring source. The compiler loads it through the regular json component loaders,
+     * and stores each component in the binary format from BinaryHelpers.hh, so loading a compiled scene doesn't
+     * touch json at all. The compiled file records the size and modified time of the json it was built from, so
+     * stale files can be detected without reading the json, as well as its hash, for when only the time changed.
+     *
+     * Layout (all offsets are in bytes from the start of the file, tables are 8 byte aligned, little endian):
+     *   Header
+     *   StringEntry[stringCount]          Offsets into the string data, each string is null terminated
+     *   char[stringDataSize]              String data
+     *   ComponentEntry[componentCount]    Component names and schema hashes, resolved to component types on open
+     *   EntityEntry[entityCount]          Entity names and their range in the ComponentValue table
+     *   ComponentValue[componentValueCount]
+     *   uint8_t[dataSize]                 Binary component and scene property data
+     */
+    namespace compiled_scene {
+        static const uint32_t MAGIC = 0x43535053; // "SPSC"
+        static const uint32_t VERSION = 2;
+        static const uint32_t NO_INDEX = ~0u;
+
+        struct Header {
+            uint32_t magic, version;
+            Hash128 sourceHash;
+            uint64_t sourceSize;
+            int64_t sourceModifiedTime;
+            uint32_t binaryVersion;
+            // ScenePriority, or NO_INDEX if the scene doesn't set one
+            uint32_t priority;
+            uint32_t stringCount, stringsOffset;
+            uint32_t stringDataSize, stringDataOffset;
+            uint32_t componentCount, componentsOffset;
+            uint32_t entityCount, entitiesOffset;
+            uint32_t componentValueCount, componentValuesOffset;
+            uint32_t dataSize, dataOffset;
+            // Range of the binary SceneProperties in the data table, offset is NO_INDEX if the scene has none
+            uint32_t propertiesOffset, propertiesSize;
+            Hash64 propertiesSchema;
+        };
+
+        struct StringEntry {
+            uint32_t offset, length;
+        };
+
+        struct ComponentEntry {
+            Hash64 schemaHash;
+            uint32_t name;
+            uint32_t padding;
+        };
+
+        struct EntityEntry {
+            uint32_t name;
+            uint32_t firstComponent, componentCount;
+        };
+
+        struct ComponentValue {
+            uint32_t component;
+            uint32_t dataOffset, dataSize;
+        };
+
+        static_assert(sizeof(Header) % 8 == 0, "Compiled scene header must be 8 byte aligned");
+    } // namespace compiled_scene
+
+    /**
+     * Loads a parsed scene json document and serializes its components. The output is loaded back and compared
+     * against the json before it is returned. Returns an empty buffer if the scene is invalid.
+     */
+    std::vector<uint8_t> CompileScene(const std::string &sceneName,
+        const picojson::value &sceneRoot,
+        const Hash128 &sourceHash,
+        const AssetFileInfo &sourceInfo);
+
+    class CompiledScene : public NonCopyable {
+    public:
+        // Validates all tables in the data, returning nullptr if anything is out of bounds, or if any component
+        // was compiled with a different layout than the current build.
+        // The storage pointer keeps the underlying file mapping or buffer alive.
+        static std::shared_ptr<const CompiledScene> Open(const std::string &sceneName,
+            std::shared_ptr<const void> storage,
+            const uint8_t *data,
+            size_t size);
+
+        const Hash128 &SourceHash() const {
+            return header->sourceHash;
+        }
+
+        // Compares the size and modified time recorded at compile time, without reading the source.
+        bool MatchesSource(const AssetFileInfo &sourceInfo) const;
+
+        size_t EntityCount() const {
+            return header->entityCount;
+        }
+
+        std::string_view String(uint32_t index) const;
+
+        bool LoadProperties(ScenePriority &priority, ecs::SceneProperties &properties) const;
+        void LoadEntities(const ecs::EntityScope &scope, std::vector<ecs::FlatEntity> &entities) const;
+
+        const std::string sceneName;
+
+    private:
+        CompiledScene(const std::string &sceneName) : sceneName(sceneName) {}
+
+        bool validate(size_t size);
+        bool resolveComponents();
+
+        std::shared_ptr<const void> storage;
+        const compiled_scene::Header *header = nullptr;
+        const compiled_scene::StringEntry *strings = nullptr;
+        const char *stringData = nullptr;
+        const compiled_scene::ComponentEntry *components = nullptr;
+        const compiled_scene::EntityEntry *entities = nullptr;
+        const compiled_scene::ComponentValue *componentValues = nullptr;
+        const uint8_t *data = nullptr;
+
+        std::vector<const ecs::ComponentBase *> componentTypes;
+    };
+} // namespace sp
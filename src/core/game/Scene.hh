@@ -15,6 +15,10 @@
 #include "ecs/components/SceneInfo.hh"
 #include "game/SceneRef.hh"
 
+namespace ecs {
+    class TransformHierarchy;
+}
+
 namespace sp {
     class Asset;
     struct SceneMetadata;
@@ -41,6 +45,12 @@ namespace sp {
         std::unordered_map<ecs::Name, ecs::Entity> namedEntities;
         std::vector<ecs::EntityRef> references;
 
+        // Staging entities added or edited since the last ApplyScene(), only their live entities are rebuilt unless
+        // reapplyAll is set. New scenes always start with a full apply.
+        std::vector<ecs::Entity> changedStagingIds;
+        bool reapplyAll = true;
+        size_t reportedChangeCount = 0;
+
     public:
         // ==== Below functions are defined in game module: game/game/Scene.cc
 
@@ -71,11 +81,22 @@ namespace sp {
         // Should only be called from SceneManager thread
         void RemovePrefabEntity(ecs::Lock<ecs::AddRemove> stagingLock, ecs::Entity ent);
 
+        // Edit callbacks should report every existing staging entity they modify, so the next ApplyScene() only
+        // rebuilds those entities. If an edit reports nothing, the whole scene is reapplied.
+        // Entities created through this class are tracked automatically.
+        // Should only be called from SceneManager thread
+        void MarkStagingChanged(ecs::Entity stagingId);
+
+        // Should only be called from SceneManager thread
+        void MarkAllStagingChanged();
+
         using SceneApplyCallback = std::function<void(const ecs::Lock<ecs::ReadAll, ecs::Write<ecs::SceneInfo>> &,
             const ecs::Lock<ecs::AddRemove> &)>;
 
         // Should only be called from SceneManager thread
-        void ApplyScene(bool resetLive = false, SceneApplyCallback callback = nullptr);
+        void ApplyScene(ecs::TransformHierarchy &transforms,
+            bool resetLive = false,
+            SceneApplyCallback callback = nullptr);
 
         // Should only be called from SceneManager thread
         void RemoveScene(ecs::Lock<ecs::AddRemove> staging, ecs::Lock<ecs::AddRemove> live);
@@ -11,8 +11,10 @@
 #include "core/Tracing.hh"
 #include "ecs/EntityReferenceManager.hh"
 #include "ecs/ScriptManager.hh"
+#include "ecs/TransformHierarchy.hh"
 #include "game/SceneImpl.hh"
-#include "game/SceneManager.hh"
+
+#include <robin_hood.h>
 
 namespace sp {
     std::shared_ptr<Scene> Scene::New(ecs::Lock<ecs::AddRemove> stagingLock,
@@ -67,6 +69,7 @@ namespace sp {
         entity.Set<ecs::Name>(stagingLock, entityName);
         namedEntities.emplace(entityName, entity);
         references.emplace_back(entityName, entity);
+        changedStagingIds.emplace_back(entity);
         return entity;
     }
 
@@ -101,7 +104,11 @@ namespace sp {
         auto entity = lock.NewEntity();
         entity.Set<ecs::SceneInfo>(lock, entity, scene);
         entity.Set<ecs::Name>(lock, entityName);
-        if (ecs::IsLive(lock)) entity.Set<ecs::SceneProperties>(lock, scene->data->GetProperties(lock));
+        if (ecs::IsLive(lock)) {
+            entity.Set<ecs::SceneProperties>(lock, scene->data->GetProperties(lock));
+        } else {
+            changedStagingIds.emplace_back(entity);
+        }
         namedEntities.emplace(entityName, entity);
         references.emplace_back(entityName, entity);
         return entity;
@@ -160,6 +167,7 @@ namespace sp {
             namedEntities.emplace(entityName, entity);
         }
         references.emplace_back(entityName, entity);
+        changedStagingIds.emplace_back(entity);
 
         return entity;
     }
@@ -177,7 +185,8 @@ namespace sp {
         }
 
         auto &rootSceneInfo = stagingInfo.rootStagingId.Get<ecs::SceneInfo>(stagingLock);
-        if (!rootSceneInfo.Remove(stagingLock, ent)) {
+        auto remainingId = rootSceneInfo.Remove(stagingLock, ent);
+        if (!remainingId) {
             if (ent.Has<ecs::Name>(stagingLock)) {
                 auto &name = ent.Get<ecs::Name>(stagingLock);
                 namedEntities.erase(name);
@@ -185,14 +194,28 @@ namespace sp {
                     return ref.Name() == name;
                 });
             }
+        } else {
+            // The remaining staging entities need to be rebuilt without this one
+            changedStagingIds.emplace_back(remainingId);
         }
         ent.Destroy(stagingLock);
     }
 
-    void Scene::ApplyScene(bool resetLive, SceneApplyCallback callback) {
+    void Scene::MarkStagingChanged(ecs::Entity stagingId) {
+        changedStagingIds.emplace_back(stagingId);
+        reportedChangeCount++;
+    }
+
+    void Scene::MarkAllStagingChanged() {
+        reapplyAll = true;
+        changedStagingIds.clear();
+    }
+
+    void Scene::ApplyScene(ecs::TransformHierarchy &transforms, bool resetLive, SceneApplyCallback callback) {
         ZoneScoped;
         ZoneStr(data->name);
-        Tracef("Applying scene: %s", data->name);
+        bool applyAll = resetLive || reapplyAll;
+        Tracef("Applying scene: %s (%s)", data->name, applyAll ? "full" : "incremental");
         Assertf(data->sceneEntity,
             "Scene::ApplyScene %s missing scene entity: %s",
             data->name,
@@ -207,19 +230,35 @@ namespace sp {
 
         // Build a flattened list of entities to apply for the staging ECS
         std::vector<std::pair<ecs::Entity, ecs::FlatEntity>> entities;
-        for (auto &e : staging.EntitiesWith<ecs::SceneInfo>()) {
+        auto addRootEntity = [&](const ecs::Entity &e) {
             auto &sceneInfo = e.Get<ecs::SceneInfo>(staging);
-            if (sceneInfo.scene != *this) continue;
+            if (sceneInfo.scene != *this) return;
             if (sceneInfo.rootStagingId != e) {
                 // Skip entities that aren't the root staging id
-                continue;
+                return;
             } else if (!e.Has<ecs::Name>(staging)) {
                 Errorf("Scene contains unnamed entity: %s %s", data->name, ecs::ToString(staging, e));
-                continue;
+                return;
             }
 
             entities.emplace_back(e, scene::BuildEntity(ecs::Lock<ecs::ReadAll>(staging), e));
+        };
+        if (applyAll) {
+            for (auto &e : staging.EntitiesWith<ecs::SceneInfo>()) {
+                addRootEntity(e);
+            }
+        } else {
+            // Only rebuild the linked lists containing changed staging entities
+            robin_hood::unordered_flat_set<ecs::Entity> changedRoots;
+            for (auto &e : changedStagingIds) {
+                if (!e.Has<ecs::SceneInfo>(staging)) continue;
+                auto &rootId = e.Get<ecs::SceneInfo>(staging).rootStagingId;
+                if (!rootId.Has<ecs::SceneInfo>(staging)) continue;
+                if (changedRoots.emplace(rootId).second) addRootEntity(rootId);
+            }
         }
+        changedStagingIds.clear();
+        reapplyAll = false;
 
         auto live = ecs::StartTransaction<ecs::AddRemove>();
 
@@ -282,23 +321,34 @@ namespace sp {
                 scene::ApplyFlatEntity(live, sceneInfo.liveId, flatEntity, resetLive);
             }
         }
-        {
-            ZoneScopedN("AnimationUpdate");
-            for (auto &e : live.EntitiesWith<ecs::Animation>()) {
-                if (!e.Has<ecs::Animation, ecs::TransformTree>(live)) continue;
+        if (applyAll) {
+            {
+                ZoneScopedN("AnimationUpdate");
+                for (auto &e : live.EntitiesWith<ecs::Animation>()) {
+                    if (!e.Has<ecs::Animation, ecs::TransformTree>(live)) continue;
 
-                ecs::Animation::UpdateTransform(live, e);
+                    ecs::Animation::UpdateTransform(live, e);
+                }
+            }
+            ecs::GetScriptManager().RegisterEvents(live);
+        } else {
+            ZoneScopedN("UpdateChangedEntities");
+            for (auto &[e, flatEntity] : entities) {
+                auto liveId = e.Get<const ecs::SceneInfo>(staging).liveId;
+                if (liveId.Has<ecs::Animation, ecs::TransformTree>(live)) {
+                    ecs::Animation::UpdateTransform(live, liveId);
+                }
+                ecs::GetScriptManager().RegisterEvents(live, liveId);
             }
         }
-        ecs::GetScriptManager().RegisterEvents(live);
         {
             ZoneScopedN("TransformSnapshot");
-            for (auto &e : live.EntitiesWith<ecs::TransformTree>()) {
-                if (!e.Has<ecs::TransformTree>(live)) continue;
-
-                auto transform = e.Get<ecs::TransformTree>(live).GetGlobalTransform(live);
+            // Only subtrees that changed since the last applied scene are recomputed
+            transforms.Sync(live);
+            transforms.Update();
+            transforms.ForEachUpdated([&](ecs::Entity e, const ecs::Transform &transform) {
                 e.Set<ecs::TransformSnapshot>(live, transform);
-            }
+            });
         }
         active = true;
 
@@ -395,6 +445,8 @@ namespace sp {
                 data->name,
                 data->sceneEntity.Name().String());
             stagingSceneId.Get<ecs::SceneProperties>(stagingLock).rootTransform = rootTransform;
+            // Every live entity in the scene is offset by the root transform
+            MarkAllStagingChanged();
         }
     }
 } // namespace sp
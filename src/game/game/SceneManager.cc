@@ -10,6 +10,7 @@
 #include "assets/Asset.hh"
 #include "assets/AssetManager.hh"
 #include "assets/JsonHelpers.hh"
+#include "assets/MappedFile.hh"
 #include "console/Console.hh"
 #include "console/ConsoleBindingManager.hh"
 #include "core/Logging.hh"
@@ -18,6 +19,7 @@
 #include "ecs/EntityReferenceManager.hh"
 #include "ecs/ScriptManager.hh"
 #include "ecs/SignalManager.hh"
+#include "game/CompiledScene.hh"
 #include "game/GameEntities.hh"
 #include "game/Scene.hh"
 
@@ -30,6 +32,13 @@
 #include <shared_mutex>
 
 namespace sp {
+    static CVar<bool> CVarCompiledScenes("s.CompiledScenes",
+        true,
+        "Load scenes from their compiled .spscene files when they are up to date");
+    static CVar<uint32_t> CVarSceneTransformThreads("s.TransformThreads",
+        2,
+        "Number of extra threads used to update transform snapshots when applying scenes (takes effect on restart)");
+
     SceneManager &GetSceneManager() {
         // Ensure ECS, ScriptManager, and AssetManager are constructed first so they are destructed in the right order.
         ecs::World();
@@ -51,7 +60,9 @@ namespace sp {
         return result;
     }
 
-    SceneManager::SceneManager() : RegisteredThread("SceneManager", 30.0) {
+    SceneManager::SceneManager()
+        : RegisteredThread("SceneManager", 30.0),
+          transformHierarchy("SceneTransforms", CVarSceneTransformThreads.Get()) {
         activeSceneManagerThread = std::this_thread::get_id();
         funcs.Register<std::string>("loadscene",
             "Load a scene and replace current scenes",
@@ -167,10 +178,13 @@ namespace sp {
 
                     {
                         auto stagingLock = ecs::StartStagingTransaction<ecs::AddRemove>();
+                        auto reportedChanges = scene->reportedChangeCount;
                         item.editSceneCallback(stagingLock, scene);
+                        // Edits that weren't reported may have modified any entity in the scene
+                        if (scene->reportedChangeCount == reportedChanges) scene->MarkAllStagingChanged();
                     }
                     Tracef("Applying system scene: %s", scene->data->name);
-                    scene->ApplyScene();
+                    scene->ApplyScene(transformHierarchy);
                 }
                 item.promise.set_value();
             } else if (item.action == SceneAction::EditStagingScene) {
@@ -183,7 +197,9 @@ namespace sp {
                             Tracef("Editing staging scene: %s", scene->data->name);
                             {
                                 auto stagingLock = ecs::StartStagingTransaction<ecs::AddRemove>();
+                                auto reportedChanges = scene->reportedChangeCount;
                                 item.editSceneCallback(stagingLock, scene);
+                                if (scene->reportedChangeCount == reportedChanges) scene->MarkAllStagingChanged();
                             }
                         } else {
                             Errorf("SceneManager::EditStagingScene: Cannot edit system scene: %s", scene->data->name);
@@ -384,7 +400,7 @@ namespace sp {
 
                 bindingsScene = LoadBindingsJson();
                 if (bindingsScene) {
-                    bindingsScene->ApplyScene();
+                    bindingsScene->ApplyScene(transformHierarchy);
                 } else {
                     Errorf("Failed to load bindings scene!");
                 }
@@ -566,7 +582,7 @@ namespace sp {
             }
         }
 
-        scene->ApplyScene(resetLive, [&](auto &stagingLock, auto &liveLock) {
+        scene->ApplyScene(transformHierarchy, resetLive, [&](auto &stagingLock, auto &liveLock) {
             if (callback) callback(stagingLock, liveLock, scene);
             {
                 std::lock_guard lock(preloadMutex);
@@ -598,44 +614,56 @@ namespace sp {
 
                 scriptManager.RunPrefabs(lock, e);
             }
+            scene->MarkAllStagingChanged();
         }
     }
 
-    std::shared_ptr<Scene> SceneManager::LoadSceneJson(const std::string &sceneName, SceneType sceneType) {
-        Logf("Loading scene: %s", sceneName);
-
-        auto asset = Assets().Load("scenes/" + sceneName + ".json", AssetType::Bundled, true)->Get();
-        if (!asset) {
-            Errorf("Scene not found: %s", sceneName);
-            return nullptr;
+    static std::shared_ptr<const CompiledScene> openCompiledScene(const std::string &sceneName) {
+        ZoneScoped;
+        auto path = "cache/scenes/" + sceneName + ".spscene";
+        if (auto mapping = Assets().MapFile(path)) {
+            return CompiledScene::Open(sceneName, mapping, mapping->Data(), mapping->Size());
         }
 
+        // Packaged builds read the compiled scene in place from the mapped asset bundle
+        std::ifstream in;
+        if (!Assets().InputStream(path, AssetType::Bundled, in)) return nullptr;
+        in.close();
+
+        auto asset = Assets().Load(path)->Get();
+        if (!asset) return nullptr;
+        return CompiledScene::Open(sceneName, asset, asset->BufferPtr(), asset->BufferSize());
+    }
+
+    static bool loadSceneJson(const std::string &sceneName,
+        const Asset &asset,
+        const ecs::EntityScope &scope,
+        ScenePriority &priority,
+        ecs::SceneProperties &sceneProperties,
+        std::vector<ecs::FlatEntity> &entities) {
+        ZoneScoped;
         picojson::value root;
-        string err = picojson::parse(root, asset->String());
+        string err = picojson::parse(root, asset.String());
         if (!err.empty()) {
             Errorf("Failed to parse scene (%s): %s", sceneName, err);
-            return nullptr;
+            return false;
         }
         if (!root.is<picojson::object>()) {
             Errorf("Failed to parse scene (%s): %s", sceneName, root.to_str());
-            return nullptr;
+            return false;
         }
         auto &sceneObj = root.get<picojson::object>();
 
-        ScenePriority priority = sceneType == SceneType::System ? ScenePriority::System : ScenePriority::Scene;
-        ecs::EntityScope scope(sceneName, "");
         if (sceneObj.count("priority")) {
             json::Load(priority, sceneObj["priority"]);
         }
 
-        ecs::SceneProperties sceneProperties = {};
         if (sceneObj.count("properties")) {
             if (!json::Load(sceneProperties, sceneObj["properties"])) {
                 Errorf("Scene contains invalid properties: %s", sceneName);
             }
         }
 
-        std::vector<ecs::FlatEntity> entities;
         if (sceneObj.count("entities")) {
             auto &entityList = sceneObj["entities"];
             for (auto &value : entityList.get<picojson::array>()) {
@@ -661,6 +689,50 @@ namespace sp {
                 }
             }
         }
+        return true;
+    }
+
+    std::shared_ptr<Scene> SceneManager::LoadSceneJson(const std::string &sceneName, SceneType sceneType) {
+        Logf("Loading scene: %s", sceneName);
+
+        auto path = "scenes/" + sceneName + ".json";
+        AssetFileInfo sourceInfo;
+        if (!Assets().GetFileInfo(path, sourceInfo)) {
+            Errorf("Scene not found: %s", sceneName);
+            return nullptr;
+        }
+
+        ScenePriority priority = sceneType == SceneType::System ? ScenePriority::System : ScenePriority::Scene;
+        ecs::EntityScope scope(sceneName, "");
+        ecs::SceneProperties sceneProperties = {};
+        std::vector<ecs::FlatEntity> entities;
+
+        std::shared_ptr<const CompiledScene> compiled;
+        if (CVarCompiledScenes.Get()) compiled = openCompiledScene(sceneName);
+
+        // The json is only read if the compiled scene's recorded size or modified time don't match
+        std::shared_ptr<const Asset> asset;
+        if (!compiled || !compiled->MatchesSource(sourceInfo)) {
+            asset = Assets().Load(path, AssetType::Bundled, true)->Get();
+            if (!asset) {
+                Errorf("Scene not found: %s", sceneName);
+                return nullptr;
+            }
+            if (compiled && compiled->SourceHash() != asset->Hash()) {
+                Logf("Compiled scene is out of date, loading json instead: %s", sceneName);
+                compiled.reset();
+            }
+        } else {
+            // Scenes only keep their source asset for its path
+            asset = std::make_shared<Asset>(path);
+        }
+
+        if (compiled) {
+            compiled->LoadProperties(priority, sceneProperties);
+            compiled->LoadEntities(scope, entities);
+        } else if (!loadSceneJson(sceneName, *asset, scope, priority, sceneProperties, entities)) {
+            return nullptr;
+        }
 
         auto lock = ecs::StartStagingTransaction<ecs::AddRemove>();
         auto scene = Scene::New(lock, sceneName, sceneType, priority, sceneProperties, asset);
@@ -15,6 +15,7 @@
 #include "core/PreservingMap.hh"
 #include "core/RegisteredThread.hh"
 #include "ecs/Ecs.hh"
+#include "ecs/TransformHierarchy.hh"
 #include "ecs/components/SceneInfo.hh"
 #include "game/Scene.hh"
 #include "game/SceneRef.hh"
@@ -139,6 +140,7 @@ namespace sp {
         using SceneList = std::vector<std::shared_ptr<Scene>>;
         EnumArray<SceneList, SceneType> scenes;
         std::shared_ptr<Scene> playerScene, bindingsScene;
+        ecs::TransformHierarchy transformHierarchy;
         CFuncCollection funcs;
 
         friend class SceneInfo;
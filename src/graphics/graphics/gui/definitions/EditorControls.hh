@@ -545,6 +545,7 @@ namespace sp {
                         std::shared_ptr<Scene> scene) {
                         void *component = comp.Access((ecs::Lock<ecs::WriteAll>)lock, target);
                         field.Access<T>(component) = value;
+                        scene->MarkStagingChanged(target);
                     });
             } else {
                 Errorf("Can't add ImGui field controls for null scene: %s", std::to_string(target));
@@ -624,6 +625,9 @@ namespace sp {
                 }
             }(),
             ...);
+
+        auto scene = targetScene.Lock();
+        if (scene) scene->MarkStagingChanged(stagingId);
     }
 
     void EditorContext::AddLiveSignalControls(const ecs::Lock<ecs::ReadAll> &lock, const ecs::EntityRef &targetEntity) {
@@ -231,8 +231,7 @@ namespace sp::vulkan {
 
         GPUScene::DrawBufferIDs drawIDs;
         if (CVarSortedDraw.Get()) {
-            glm::vec3 viewPos = view.invViewMat * glm::vec4(0, 0, 0, 1);
-            drawIDs = scene.GenerateSortedDrawsForView(graph, viewPos, view.visibilityMask, CVarDrawReverseOrder.Get());
+            drawIDs = scene.GenerateSortedDrawsForView(graph, view, view.visibilityMask, CVarDrawReverseOrder.Get());
         } else {
             drawIDs = scene.GenerateDrawsForView(graph, view.visibilityMask);
         }
@@ -261,6 +260,8 @@ namespace sp::vulkan {
                 builder.Read("WarpedVertexBuffer", Access::VertexBuffer);
                 builder.Read(drawIDs.drawCommandsBuffer, Access::IndirectBuffer);
                 builder.Read(drawIDs.drawParamsBuffer, Access::VertexShaderReadStorage);
+
+                builder.RecordInParallel();
             })
             .Execute([this, view, drawIDs](rg::Resources &resources, CommandContext &cmd) {
                 cmd.SetShaders("scene.vert", "generate_gbuffer.frag");
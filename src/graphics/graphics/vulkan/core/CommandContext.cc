@@ -43,7 +43,7 @@ namespace sp::vulkan {
         renderPass.reset();
     }
 
-    void CommandContext::BeginRenderPass(const RenderPassInfo &info) {
+    void CommandContext::BeginRenderPass(const RenderPassInfo &info, vk::SubpassContents contents) {
         Reset();
         Assert(!framebuffer, "render pass already started");
 
@@ -78,7 +78,7 @@ namespace sp::vulkan {
         renderPassBeginInfo.renderArea = scissors[0];
         renderPassBeginInfo.clearValueCount = clearValueCount;
         renderPassBeginInfo.pClearValues = clearValues;
-        cmd->beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+        cmd->beginRenderPass(renderPassBeginInfo, contents);
 
         renderPass->RecordImplicitImageLayoutTransitions(info);
     }
@@ -98,6 +98,42 @@ namespace sp::vulkan {
         recording = true;
     }
 
+    void CommandContext::BeginSecondary(const shared_ptr<Framebuffer> &framebuffer) {
+        Assert(!recording, "command buffer already recording");
+        Reset();
+        secondary = true;
+
+        vk::CommandBufferInheritanceInfo inheritanceInfo;
+        vk::CommandBufferBeginInfo beginInfo;
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        if (framebuffer) {
+            this->framebuffer = framebuffer;
+
+            pipelineInput.state.viewportCount = 1;
+            pipelineInput.state.scissorCount = 1;
+            viewports[0] = vk::Rect2D{{0, 0}, framebuffer->Extent()};
+            scissors[0] = viewports[0];
+            pipelineInput.renderPass = framebuffer->GetRenderPass();
+
+            // Any render pass compatible with the one begun in the primary command buffer can be inherited
+            inheritanceInfo.renderPass = *pipelineInput.renderPass;
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = *framebuffer;
+            beginInfo.flags |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+        }
+
+        cmd->begin(beginInfo);
+        recording = true;
+    }
+
+    void CommandContext::ExecuteCommands(CommandContext &secondary) {
+        Assert(secondary.secondary, "can only execute secondary command contexts");
+        if (secondary.recording) secondary.End();
+        cmd->executeCommands({secondary.Raw()});
+    }
+
     void CommandContext::End() {
         Assert(recording, "command buffer not recording");
         cmd->end();
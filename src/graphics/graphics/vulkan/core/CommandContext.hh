@@ -75,9 +75,13 @@ namespace sp::vulkan {
         void Abandon();
 
         void Reset();
-        void BeginRenderPass(const RenderPassInfo &info);
+        void BeginRenderPass(const RenderPassInfo &info,
+            vk::SubpassContents contents = vk::SubpassContents::eInline);
         void EndRenderPass();
 
+        // Ends recording of a secondary command context and executes it as part of this one.
+        void ExecuteCommands(CommandContext &secondary);
+
         void PushConstants(const void *data, VkDeviceSize offset, VkDeviceSize range);
 
         template<typename T>
@@ -428,6 +432,8 @@ namespace sp::vulkan {
     protected:
         friend class DeviceContext;
         void Begin();
+        // Begins a secondary command buffer, continuing framebuffer's render pass if it is set.
+        void BeginSecondary(const shared_ptr<Framebuffer> &framebuffer);
         void End();
 
         vk::UniqueCommandBuffer &RawRef() {
@@ -473,7 +479,7 @@ namespace sp::vulkan {
 
         vk::UniqueFence fence;
 
-        bool recording = false, abandoned = false;
+        bool recording = false, abandoned = false, secondary = false;
 
         YDirection viewportYDirection = YDirection::Up;
         std::array<vk::Rect2D, MAX_VIEWPORTS> viewports;
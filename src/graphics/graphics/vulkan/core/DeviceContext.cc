@@ -830,6 +830,7 @@ namespace sp::vulkan {
         if (perfTimer) perfTimer->StartFrame();
 
         if (reloadShaders.exchange(false)) {
+            std::lock_guard lock(shaderMutex);
             for (size_t i = 0; i < shaders.size(); i++) {
                 auto &currentShader = shaders[i];
                 auto newShader = CreateShader(currentShader->name, currentShader->hash);
@@ -992,6 +993,56 @@ namespace sp::vulkan {
         return cmdHandle;
     }
 
+    CommandContextPtr DeviceContext::GetSecondaryCommandContext(const shared_ptr<Framebuffer> &framebuffer) {
+        auto &thr = Thread();
+        auto &pool = thr.secondaryCommandContexts[frameIndex];
+        if (thr.secondaryFrameCounter != frameCounter) {
+            thr.secondaryFrameCounter = frameCounter;
+            if (pool.nextIndex > 0) {
+                // The frame fence was waited on in BeginFrame, so this pool's last use has completed
+                ZoneScopedN("ResetCommandPool");
+                device->resetCommandPool(*pool.commandPool);
+            }
+            pool.nextIndex = 0;
+
+            // The render thread releases its own resources in PrepareResourcesForFrame
+            if (std::this_thread::get_id() != renderThread) thr.ReleaseAvailableResources();
+        }
+
+        if (!pool.commandPool) {
+            vk::CommandPoolCreateInfo poolInfo;
+            poolInfo.queueFamilyIndex = queueFamilyIndex[QUEUE_TYPE_GRAPHICS];
+            poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+            pool.commandPool = device->createCommandPoolUnique(poolInfo);
+        }
+
+        CommandContextPtr cmd;
+        if (pool.nextIndex < pool.list.size()) {
+            cmd = pool.list[pool.nextIndex++];
+
+            // Reset cmd to default state
+            auto buffer = std::move(cmd->RawRef());
+            cmd->~CommandContext();
+            new (cmd.get())
+                CommandContext(*this, std::move(buffer), CommandContextType::General, CommandContextScope::Frame);
+        } else {
+            vk::CommandBufferAllocateInfo allocInfo;
+            allocInfo.commandPool = *pool.commandPool;
+            allocInfo.level = vk::CommandBufferLevel::eSecondary;
+            allocInfo.commandBufferCount = 1;
+            auto buffers = device->allocateCommandBuffersUnique(allocInfo);
+
+            cmd = make_shared<CommandContext>(*this,
+                std::move(buffers[0]),
+                CommandContextType::General,
+                CommandContextScope::Frame);
+            pool.list.push_back(cmd);
+            pool.nextIndex++;
+        }
+        cmd->BeginSecondary(framebuffer);
+        return cmd;
+    }
+
     void DeviceContext::Submit(CommandContextPtr &cmd,
         vk::ArrayProxy<const vk::Semaphore> signalSemaphores,
         vk::ArrayProxy<const vk::Semaphore> waitSemaphores,
@@ -1157,10 +1208,17 @@ namespace sp::vulkan {
             transferCmd->Raw().copyBuffer(srcBuf, dstBuf, {region});
         }
 
-        return frameEndQueue.Dispatch<void>([this, transferCmd]() {
+        // Resolves once the copies have completed on the GPU, so the staging buffers can be released
+        auto transferComplete = make_shared<Async<void>>();
+        frameEndQueue.Dispatch<void>([this, transferCmd, transferComplete]() {
             auto cmd = transferCmd;
+            auto fence = cmd->Fence();
             Submit(cmd);
+            ExecuteAfterFence(fence, [transferCmd, transferComplete]() {
+                transferComplete->Set(nullptr);
+            });
         });
+        return transferComplete;
     }
 
     ImagePtr DeviceContext::AllocateImage(vk::ImageCreateInfo info,
@@ -1544,6 +1602,7 @@ namespace sp::vulkan {
     }
 
     vk::Sampler DeviceContext::GetSampler(SamplerType type) {
+        std::lock_guard lock(samplerMutex);
         auto &sampler = namedSamplers[type];
         if (sampler) return *sampler;
 
@@ -1611,6 +1670,7 @@ namespace sp::vulkan {
         Assert(info.pNext == 0, "sampler info pNext can't be set");
 
         SamplerKey key((const VkSamplerCreateInfo &)info);
+        std::lock_guard lock(samplerMutex);
         auto &sampler = adhocSamplers[key];
         if (sampler) return *sampler;
 
@@ -1619,6 +1679,7 @@ namespace sp::vulkan {
     }
 
     ShaderHandle DeviceContext::LoadShader(string_view name) {
+        std::lock_guard lock(shaderMutex);
         auto it = shaderHandles.find(name);
         if (it != shaderHandles.end()) return it->second;
 
@@ -1653,6 +1714,7 @@ namespace sp::vulkan {
     }
 
     shared_ptr<Shader> DeviceContext::GetShader(ShaderHandle handle) const {
+        std::lock_guard lock(shaderMutex);
         if (handle == 0 || shaders.size() < (size_t)handle) return nullptr;
 
         return shaders[handle - 1];
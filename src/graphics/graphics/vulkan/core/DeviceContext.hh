@@ -20,6 +20,7 @@
 
 #include <atomic>
 #include <future>
+#include <mutex>
 #include <robin_hood.h>
 #include <variant>
 
@@ -95,6 +96,13 @@ namespace sp::vulkan {
         // Returns a CommandContext that can be recorded on any thread, and isn't reset until its fence is signalled.
         CommandContextPtr GetFencedCommandContext(CommandContextType type = CommandContextType::General);
 
+        /**
+         * Returns a secondary CommandContext for recording on the calling thread during the current frame.
+         * It must be executed by a frame CommandContext with ExecuteCommands before the frame's last submit.
+         * If framebuffer is set, commands are recorded inside the render pass it was begun with.
+         */
+        CommandContextPtr GetSecondaryCommandContext(const shared_ptr<Framebuffer> &framebuffer = nullptr);
+
         // Releases *cmd back to the DeviceContext and resets cmd
         void Submit(CommandContextPtr &cmd,
             vk::ArrayProxy<const vk::Semaphore> signalSemaphores = {},
@@ -140,6 +148,7 @@ namespace sp::vulkan {
             std::variant<BufferPtr, SubBufferPtr> src;
             std::variant<BufferPtr, SubBufferPtr> dst;
         };
+        // The returned future resolves after the transfer fence signals
         AsyncPtr<void> TransferBuffers(vk::ArrayProxy<const BufferTransfer> batch);
 
         ImagePtr AllocateImage(vk::ImageCreateInfo info,
@@ -163,6 +172,10 @@ namespace sp::vulkan {
         // Returns a Pipeline from cache, keyed by `input`. Builds the pipeline if not found in cache.
         shared_ptr<Pipeline> GetPipeline(const PipelineCompileInput &input);
 
+        PipelineManager &Pipelines() {
+            return *pipelinePool;
+        }
+
         // Returns a RenderPass from cache, keyed by `info.state`. Builds the render pass if not found in cache.
         shared_ptr<RenderPass> GetRenderPass(const RenderPassInfo &info);
 
@@ -183,6 +196,10 @@ namespace sp::vulkan {
             return physicalDeviceProperties.properties.limits;
         }
 
+        const vk::PhysicalDeviceProperties &DeviceProperties() const {
+            return physicalDeviceProperties.properties;
+        }
+
         const vk::PhysicalDeviceDescriptorIndexingProperties &IndexingLimits() const {
             return physicalDeviceDescriptorIndexingProperties;
         }
@@ -348,6 +365,10 @@ namespace sp::vulkan {
             std::array<unique_ptr<HandlePool<CommandContextPtr>>, QUEUE_TYPES_COUNT> commandContexts;
             std::array<vector<SharedHandle<CommandContextPtr>>, QUEUE_TYPES_COUNT> pendingCommandContexts;
 
+            // Secondary graphics command buffers, reset by the owning thread the first time it records in a frame
+            std::array<CommandContextPool, MAX_FRAMES_IN_FLIGHT> secondaryCommandContexts;
+            uint32 secondaryFrameCounter = ~0u;
+
             unique_ptr<BufferPool> bufferPool;
             std::atomic_bool printBufferStats;
 
@@ -364,6 +385,9 @@ namespace sp::vulkan {
             return *threadContexts[threadIndex];
         }
 
+        // Shaders and samplers are looked up while render graph passes are recorded on worker threads
+        mutable std::mutex shaderMutex, samplerMutex;
+
         robin_hood::unordered_map<string, ShaderHandle, StringHash, StringEqual> shaderHandles;
         vector<shared_ptr<Shader>> shaders; // indexed by ShaderHandle minus 1
         std::atomic_bool reloadShaders;
@@ -9,6 +9,7 @@
 #include "Memory.hh"
 
 #include "core/Common.hh"
+#include "graphics/vulkan/core/PagedBuffer.hh"
 
 namespace sp::vulkan {
     vk::Result UniqueMemory::MapPersistent(void **data) {
@@ -54,14 +55,20 @@ namespace sp::vulkan {
     }
 
     SubBuffer::~SubBuffer() {
-        vmaVirtualFree(subAllocationBlock, offsetBytes);
+        if (pagedBuffer) {
+            pagedBuffer->Free(*this);
+        } else if (subAllocationBlock != VK_NULL_HANDLE) {
+            vmaVirtualFree(subAllocationBlock, offsetBytes);
+        }
     }
 
     void *SubBuffer::Mapped() {
-        return static_cast<uint8_t *>(parentBuffer->Mapped()) + offsetBytes;
+        auto *buffer = pagedBuffer ? pagedBuffer->Get().get() : parentBuffer;
+        return static_cast<uint8_t *>(buffer->Mapped()) + offsetBytes;
     }
 
     SubBuffer::operator vk::Buffer() const {
+        if (pagedBuffer) return *pagedBuffer->Get();
         return (vk::Buffer)*parentBuffer;
     }
 
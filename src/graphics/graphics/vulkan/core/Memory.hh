@@ -141,6 +141,12 @@ namespace sp::vulkan {
             : parentBuffer(buffer), subAllocationBlock(subAllocationBlock), offsetBytes(offsetBytes), size(size),
               arrayOffset(arrayOffset), arrayCount(arrayCount) {}
 
+        // Allocation in a PagedBuffer, whose buffer and offsets can change when it is reallocated
+        SubBuffer(PagedBuffer *pagedBuffer, size_t arrayOffset, size_t arrayCount, vk::DeviceSize arrayStride)
+            : parentBuffer(nullptr), pagedBuffer(pagedBuffer), subAllocationBlock(VK_NULL_HANDLE),
+              offsetBytes(arrayOffset * arrayStride), size(arrayCount * arrayStride), arrayOffset(arrayOffset),
+              arrayCount(arrayCount) {}
+
         ~SubBuffer();
 
         void *Mapped();
@@ -165,9 +171,12 @@ namespace sp::vulkan {
 
     private:
         Buffer *parentBuffer;
+        PagedBuffer *pagedBuffer = nullptr;
         VmaVirtualBlock subAllocationBlock;
         vk::DeviceSize offsetBytes, size;
         size_t arrayOffset, arrayCount;
+
+        friend class PagedBuffer;
     };
 
     class Buffer : public UniqueMemory {
@@ -0,0 +1,145 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "PagedBuffer.hh"
+
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+#include "graphics/vulkan/core/DeviceContext.hh"
+
+namespace sp::vulkan {
+    PagedBuffer::PagedBuffer(DeviceContext &device,
+        size_t arrayStride,
+        size_t pageSize,
+        size_t initialPages,
+        vk::BufferUsageFlags usage)
+        : device(device), arrayStride(arrayStride), pageSize(pageSize),
+          usage(usage | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst) {
+        Assertf(arrayStride > 0 && pageSize > 0, "invalid paged buffer layout");
+        size_t capacity = std::max(size_t(1), initialPages) * pageSize;
+        buffer = device.AllocateBuffer({arrayStride, capacity}, this->usage, VMA_MEMORY_USAGE_GPU_ONLY);
+        freeRanges.emplace(0, capacity);
+    }
+
+    PagedBuffer::~PagedBuffer() {
+        // Allocations that outlive the array are detached, so they don't free into it
+        for (auto &[offset, subBuffer] : allocations) {
+            subBuffer->pagedBuffer = nullptr;
+        }
+    }
+
+    SubBufferPtr PagedBuffer::ArrayAllocate(size_t elementCount) {
+        Assertf(elementCount > 0, "paged buffer allocations must not be empty");
+
+        // Best fit, to leave large ranges for large meshes
+        auto best = freeRanges.end();
+        for (auto it = freeRanges.begin(); it != freeRanges.end(); it++) {
+            if (it->second < elementCount) continue;
+            if (best == freeRanges.end() || it->second < best->second) best = it;
+            if (best->second == elementCount) break;
+        }
+        if (best == freeRanges.end()) return nullptr;
+
+        size_t offset = best->first;
+        size_t remaining = best->second - elementCount;
+        freeRanges.erase(best);
+        if (remaining > 0) freeRanges.emplace(offset + elementCount, remaining);
+
+        auto subBuffer = make_shared<SubBuffer>(this, offset, elementCount, arrayStride);
+        allocations.emplace(offset, subBuffer.get());
+        liveCount += elementCount;
+        return subBuffer;
+    }
+
+    bool PagedBuffer::Reserve(size_t elementCount) {
+        for (auto &[offset, count] : freeRanges) {
+            if (count >= elementCount) return true;
+        }
+        pendingGrowth += elementCount;
+        return false;
+    }
+
+    void PagedBuffer::Free(SubBuffer &subBuffer) {
+        size_t offset = subBuffer.arrayOffset;
+        size_t count = subBuffer.arrayCount;
+        allocations.erase(offset);
+        liveCount -= count;
+
+        // Merge with the neighbouring free ranges
+        auto next = freeRanges.lower_bound(offset);
+        if (next != freeRanges.end() && next->first == offset + count) {
+            count += next->second;
+            next = freeRanges.erase(next);
+        }
+        if (next != freeRanges.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                prev->second += count;
+                return;
+            }
+        }
+        freeRanges.emplace(offset, count);
+    }
+
+    BufferPtr PagedBuffer::Reallocate(bool compact, vector<vk::BufferCopy> &copies) {
+        ZoneScoped;
+        size_t usedCount = liveCount;
+        if (!compact && !allocations.empty()) {
+            auto &[lastOffset, lastAllocation] = *allocations.rbegin();
+            usedCount = lastOffset + lastAllocation->arrayCount;
+        }
+        size_t pageCount = std::max(size_t(1), (usedCount + pendingGrowth + pageSize - 1) / pageSize);
+        size_t capacity = pageCount * pageSize;
+        ZoneValue(capacity);
+        pendingGrowth = 0;
+
+        auto oldBuffer = buffer;
+        buffer = device.AllocateBuffer({arrayStride, capacity}, usage, VMA_MEMORY_USAGE_GPU_ONLY);
+
+        copies.clear();
+        freeRanges.clear();
+        std::map<size_t, SubBuffer *> moved;
+        size_t end = 0;
+        for (auto &[offset, subBuffer] : allocations) {
+            size_t newOffset = compact ? end : offset;
+            if (newOffset > end) freeRanges.emplace(end, newOffset - end);
+
+            vk::DeviceSize srcOffset = offset * arrayStride;
+            vk::DeviceSize dstOffset = newOffset * arrayStride;
+            vk::DeviceSize size = subBuffer->arrayCount * arrayStride;
+            auto *lastCopy = copies.empty() ? nullptr : &copies.back();
+            if (lastCopy && lastCopy->srcOffset + lastCopy->size == srcOffset &&
+                lastCopy->dstOffset + lastCopy->size == dstOffset) {
+                lastCopy->size += size;
+            } else {
+                copies.emplace_back(srcOffset, dstOffset, size);
+            }
+
+            subBuffer->arrayOffset = newOffset;
+            subBuffer->offsetBytes = dstOffset;
+            moved.emplace(newOffset, subBuffer);
+            end = newOffset + subBuffer->arrayCount;
+        }
+        if (end < capacity) freeRanges.emplace(end, capacity - end);
+        allocations = std::move(moved);
+        return oldBuffer;
+    }
+
+    size_t PagedBuffer::FragmentedCount() const {
+        size_t freeCount = Capacity() - liveCount;
+        if (freeRanges.empty()) return freeCount;
+        auto &[lastOffset, lastCount] = *freeRanges.rbegin();
+        if (lastOffset + lastCount == Capacity()) freeCount -= lastCount;
+        return freeCount;
+    }
+
+    float PagedBuffer::Fragmentation() const {
+        size_t fragmented = FragmentedCount();
+        if (fragmented == 0) return 0.0f;
+        return (float)fragmented / (float)(fragmented + liveCount);
+    }
+} // namespace sp::vulkan
@@ -0,0 +1,99 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "graphics/vulkan/core/Memory.hh"
+#include "graphics/vulkan/core/VkCommon.hh"
+
+#include <map>
+
+namespace sp::vulkan {
+    /**
+     * A GPU only array that grows by whole pages instead of failing when it runs out of space.
+     * Elements are sub-allocated from a free list, which also reports how fragmented the array is.
+     *
+     * The underlying buffer is never resized in place. Reallocate() replaces it with a new buffer and returns the
+     * regions that must be copied from the old one on the GPU. SubBuffers allocated here always refer to the current
+     * buffer, and their offsets are updated when Reallocate() compacts the array.
+     *
+     * Not thread safe, allocations must be created and destroyed on the render thread.
+     */
+    class PagedBuffer : public NonCopyable {
+    public:
+        PagedBuffer(DeviceContext &device,
+            size_t arrayStride,
+            size_t pageSize,
+            size_t initialPages,
+            vk::BufferUsageFlags usage);
+        ~PagedBuffer();
+
+        // Returns nullptr if there is no free range large enough, see Reserve().
+        SubBufferPtr ArrayAllocate(size_t elementCount);
+
+        /**
+         * Returns true if elementCount elements can be allocated now.
+         * Otherwise the array is marked to grow by at least elementCount elements on the next Reallocate().
+         */
+        bool Reserve(size_t elementCount);
+
+        bool NeedsGrowth() const {
+            return pendingGrowth > 0;
+        }
+
+        /**
+         * Replaces the buffer with a new one, sized in whole pages to fit the live elements and any pending growth.
+         * If compact is set, live allocations are packed to the start of the array, otherwise they keep their offsets.
+         * The returned old buffer must stay alive until `copies` from it into Get() have completed.
+         */
+        BufferPtr Reallocate(bool compact, vector<vk::BufferCopy> &copies);
+
+        const BufferPtr &Get() const {
+            return buffer;
+        }
+
+        size_t Capacity() const {
+            return buffer->ArraySize();
+        }
+
+        size_t LiveCount() const {
+            return liveCount;
+        }
+
+        size_t FreeRangeCount() const {
+            return freeRanges.size();
+        }
+
+        size_t ArrayStride() const {
+            return arrayStride;
+        }
+
+        size_t PageSize() const {
+            return pageSize;
+        }
+
+        // Free elements that are not part of the trailing free range, and can only be reclaimed by compaction.
+        size_t FragmentedCount() const;
+
+        // Fraction of the used part of the array that is lost to free ranges between allocations.
+        float Fragmentation() const;
+
+    private:
+        void Free(SubBuffer &subBuffer);
+
+        DeviceContext &device;
+        size_t arrayStride, pageSize;
+        vk::BufferUsageFlags usage;
+        BufferPtr buffer;
+
+        std::map<size_t, size_t> freeRanges; // element offset -> element count
+        std::map<size_t, SubBuffer *> allocations; // element offset -> live allocation
+        size_t liveCount = 0, pendingGrowth = 0;
+
+        friend class SubBuffer;
+    };
+} // namespace sp::vulkan
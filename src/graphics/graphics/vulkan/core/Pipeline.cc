@@ -7,10 +7,16 @@
 
 #include "Pipeline.hh"
 
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "console/CVar.hh"
 #include "core/Logging.hh"
 #include "graphics/vulkan/core/DeviceContext.hh"
 
 #include <SPIRV-Reflect/common/output_stream.h>
+#include <cstring>
+#include <fstream>
+#include <map>
 
 void StreamWriteDescriptorBinding(std::ostream &os,
     const SpvReflectDescriptorBinding &obj,
@@ -20,9 +26,282 @@ void StreamWriteDescriptorBinding(std::ostream &os,
 
 namespace sp::vulkan {
 
-    PipelineManager::PipelineManager(DeviceContext &device) : device(device) {
+    static CVar<bool> CVarPipelineCache("r.PipelineCache", true, "Load and save the pipeline cache on disk");
+    static CVar<bool> CVarPipelinePrewarm("r.PipelinePrewarm",
+        true,
+        "Build all pipelines recorded in the pipeline cache on a background thread at startup");
+
+    const std::string pipelineCachePath = "cache/vulkan/pipelines.bin";
+    const uint32 pipelineCacheMagic = 0x53504331; // "SPC1"
+    // Increment when PipelinePermutationData or any of the types it contains change layout
+    const uint32 pipelineCacheVersion = 1;
+
+    /**
+     * Layout:
+     *   pipelineCacheHeader
+     *   PipelinePermutationData[permutationCount]
+     *   uint8[dataSize]    Opaque driver cache data from vkGetPipelineCacheData
+     */
+    struct pipelineCacheHeader {
+        uint32 magicNumber = pipelineCacheMagic;
+        uint32 version = pipelineCacheVersion;
+        uint32 permutationSize = sizeof(PipelineManager::PipelinePermutationData);
+        uint32 permutationCount = 0;
+        uint32 vendorID = 0, deviceID = 0, driverVersion = 0;
+        uint32 padding = 0;
+        uint8 pipelineCacheUUID[VK_UUID_SIZE] = {};
+        Hash64 shaderSetHash = 0;
+        uint64 dataSize = 0;
+        Hash64 dataHash = 0;
+    };
+
+    static_assert(sizeof(pipelineCacheHeader) == 72, "Pipeline cache header size changed unexpectedly");
+
+    // Matches VkPipelineCacheHeaderVersionOne, written by the driver at the start of its cache data
+    struct driverCacheHeader {
+        uint32 headerSize;
+        uint32 headerVersion;
+        uint32 vendorID, deviceID;
+        uint8 pipelineCacheUUID[VK_UUID_SIZE];
+    };
+
+    static_assert(sizeof(driverCacheHeader) == 32, "Driver cache header size changed unexpectedly");
+
+    static Hash64 hashShaderSet(const std::map<string, Hash64> &shaderHashes) {
+        Hash64 hash = 0;
+        for (auto &[name, shaderHash] : shaderHashes) {
+            hash_combine(hash, robin_hood::hash_bytes(name.data(), name.size()));
+            hash_combine(hash, shaderHash);
+        }
+        return hash;
+    }
+
+    PipelineManager::PipelineManager(DeviceContext &device) : device(device), prewarmQueue("PipelinePrewarm") {
+        prewarmCancel = make_shared<DispatchCancelToken>();
+        LoadCache();
+        if (CVarPipelinePrewarm.Get()) StartPrewarm();
+    }
+
+    PipelineManager::~PipelineManager() {
+        prewarmCancel->Cancel();
+        prewarmQueue.Shutdown();
+
+        if (pipelinesCreated > 0) {
+            Logf("Created %u pipelines in %.1fms with a %s pipeline cache",
+                pipelinesCreated,
+                std::chrono::duration<double, std::milli>(pipelineCreateTime).count(),
+                pipelineCacheLoaded ? "warm" : "cold");
+        }
+        if (CVarPipelineCache.Get()) SaveCache();
+    }
+
+    void PipelineManager::LoadCache() {
+        ZoneScoped;
         vk::PipelineCacheCreateInfo pipelineCacheInfo;
+        // Always reload, the file is rewritten on shutdown and a previous device may have left it in the asset cache
+        auto asset = CVarPipelineCache.Get() ? Assets().Load(pipelineCachePath, AssetType::Bundled, true)->Get()
+                                             : nullptr;
+        if (!asset) {
+            pipelineCache = device->createPipelineCacheUnique(pipelineCacheInfo);
+            return;
+        }
+
+        auto buf = asset->Buffer();
+        pipelineCacheHeader header;
+        if (buf.size() < sizeof(header)) {
+            Errorf("Pipeline cache is corrupt, starting with an empty cache");
+            pipelineCache = device->createPipelineCacheUnique(pipelineCacheInfo);
+            return;
+        }
+        std::memcpy(&header, buf.data(), sizeof(header));
+        if (header.magicNumber != pipelineCacheMagic || header.version != pipelineCacheVersion ||
+            header.permutationSize != sizeof(PipelinePermutationData)) {
+            Logf("Pipeline cache format is stale, rebuilding pipelines");
+            pipelineCache = device->createPipelineCacheUnique(pipelineCacheInfo);
+            return;
+        }
+
+        size_t permutationsSize = (size_t)header.permutationCount * sizeof(PipelinePermutationData);
+        if (buf.size() - sizeof(header) < permutationsSize ||
+            buf.size() - sizeof(header) - permutationsSize != header.dataSize) {
+            Errorf("Pipeline cache is corrupt, starting with an empty cache");
+            pipelineCache = device->createPipelineCacheUnique(pipelineCacheInfo);
+            return;
+        }
+        const uint8 *permutationData = buf.data() + sizeof(header);
+        const uint8 *driverData = permutationData + permutationsSize;
+
+        // Shaders may have been rebuilt since the cache was saved, only keep permutations that are still current
+        std::map<string, Hash64> savedShaders, currentShaders;
+        for (size_t i = 0; i < header.permutationCount; i++) {
+            PipelinePermutationKey key;
+            std::memcpy(&key.input, permutationData + i * sizeof(PipelinePermutationData), sizeof(key.input));
+
+            bool current = true;
+            for (auto &s : magic_enum::enum_values<ShaderStage>()) {
+                auto &nameBuf = key.input.shaderNames[s];
+                if (!std::memchr(nameBuf.data(), 0, nameBuf.size())) {
+                    Errorf("Pipeline cache is corrupt, starting with an empty cache");
+                    pipelineCache = device->createPipelineCacheUnique(pipelineCacheInfo);
+                    permutations.clear();
+                    knownPermutations.clear();
+                    return;
+                }
+                string name(nameBuf.data());
+                if (name.empty()) continue;
+
+                savedShaders[name] = key.input.shaderHashes[s];
+                if (!currentShaders.count(name)) {
+                    auto shaderAsset = Assets().Load("shaders/" + name + ".spv")->Get();
+                    currentShaders[name] = shaderAsset ? Hash128To64(shaderAsset->Hash()) : 0;
+                }
+                if (currentShaders[name] != key.input.shaderHashes[s]) current = false;
+            }
+            if (current && knownPermutations.insert(key).second) permutations.push_back(key);
+        }
+
+        auto &props = device.DeviceProperties();
+        if (hashShaderSet(savedShaders) != header.shaderSetHash) {
+            Errorf("Pipeline cache is corrupt, starting with an empty cache");
+        } else if (hashShaderSet(savedShaders) != hashShaderSet(currentShaders)) {
+            Logf("Pipeline cache is stale, shaders changed since it was saved, rebuilding %u pipelines",
+                permutations.size());
+        } else if (header.vendorID != props.vendorID || header.deviceID != props.deviceID ||
+                   header.driverVersion != props.driverVersion ||
+                   std::memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0) {
+            Logf("Pipeline cache is stale, graphics driver changed since it was saved, rebuilding %u pipelines",
+                permutations.size());
+        } else if (robin_hood::hash_bytes(driverData, header.dataSize) != header.dataHash) {
+            Errorf("Pipeline cache data is corrupt, starting with an empty cache");
+        } else {
+            driverCacheHeader driverHeader;
+            if (header.dataSize < sizeof(driverHeader)) {
+                Errorf("Pipeline cache data is corrupt, starting with an empty cache");
+            } else {
+                std::memcpy(&driverHeader, driverData, sizeof(driverHeader));
+                bool sameDriver = driverHeader.vendorID == props.vendorID && driverHeader.deviceID == props.deviceID &&
+                                  std::memcmp(driverHeader.pipelineCacheUUID,
+                                      props.pipelineCacheUUID.data(),
+                                      VK_UUID_SIZE) == 0;
+                if (driverHeader.headerSize < sizeof(driverHeader) ||
+                    driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+                    Errorf("Pipeline cache data has an invalid header, starting with an empty cache");
+                } else if (!sameDriver) {
+                    Logf("Pipeline cache data is stale, it was saved by a different driver, rebuilding %u pipelines",
+                        permutations.size());
+                } else {
+                    pipelineCacheInfo.initialDataSize = header.dataSize;
+                    pipelineCacheInfo.pInitialData = driverData;
+                    pipelineCacheLoaded = true;
+                }
+            }
+        }
+
         pipelineCache = device->createPipelineCacheUnique(pipelineCacheInfo);
+        if (pipelineCacheLoaded) {
+            Logf("Loaded pipeline cache with %u pipelines (%u bytes)", permutations.size(), header.dataSize);
+        }
+    }
+
+    void PipelineManager::SaveCache() {
+        ZoneScoped;
+        auto data = device->getPipelineCacheData(*pipelineCache);
+
+        pipelineCacheHeader header;
+        header.permutationCount = permutations.size();
+
+        auto &props = device.DeviceProperties();
+        header.vendorID = props.vendorID;
+        header.deviceID = props.deviceID;
+        header.driverVersion = props.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, props.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+        std::map<string, Hash64> shaderHashes;
+        for (auto &key : permutations) {
+            for (auto &s : magic_enum::enum_values<ShaderStage>()) {
+                string name(key.input.shaderNames[s].data());
+                if (!name.empty()) shaderHashes[name] = key.input.shaderHashes[s];
+            }
+        }
+        header.shaderSetHash = hashShaderSet(shaderHashes);
+        header.dataSize = data.size();
+        header.dataHash = robin_hood::hash_bytes(data.data(), data.size());
+
+        std::ofstream out;
+        if (Assets().OutputStream(pipelineCachePath, out)) {
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            for (auto &key : permutations) {
+                out.write(reinterpret_cast<const char *>(&key.input), sizeof(key.input));
+            }
+            out.write(reinterpret_cast<const char *>(data.data()), data.size());
+            out.close();
+        }
+    }
+
+    void PipelineManager::RecordPermutation(const ShaderSet &shaders,
+        const PipelineStaticState &state,
+        const shared_ptr<RenderPass> &renderPass) {
+        PipelinePermutationKey key;
+        for (auto &s : magic_enum::enum_values<ShaderStage>()) {
+            auto &shader = shaders[s];
+            if (!shader) continue;
+            // Names are stored null terminated in a fixed size buffer
+            if (shader->name.size() >= MAX_SHADER_NAME_LENGTH) return;
+            std::copy(shader->name.begin(), shader->name.end(), key.input.shaderNames[s].begin());
+            key.input.shaderHashes[s] = shader->hash;
+        }
+        key.input.state = state;
+        key.input.state.shaders = {};
+        if (renderPass) key.input.renderPass = renderPass->State();
+
+        if (knownPermutations.insert(key).second) permutations.push_back(key);
+    }
+
+    /**
+     * Builds every recorded permutation against a compatible render pass. The resulting pipelines are discarded,
+     * they are only built to fill the driver's pipeline cache so the first GetPipeline call for each permutation
+     * during rendering is a cache hit.
+     */
+    void PipelineManager::StartPrewarm() {
+        ZoneScoped;
+        if (permutations.empty()) return;
+
+        using RenderPassKey = HashKey<RenderPassState>;
+        robin_hood::unordered_map<RenderPassKey, shared_ptr<RenderPass>, RenderPassKey::Hasher> renderPasses;
+
+        // Shaders, layouts, and render passes are created here since the manager's maps aren't thread safe
+        vector<std::pair<PipelineCompileInput, ShaderSet>> inputs;
+        inputs.reserve(permutations.size());
+        for (auto &key : permutations) {
+            auto &[compile, shaders] = inputs.emplace_back();
+            compile.state = key.input.state;
+            for (auto &s : magic_enum::enum_values<ShaderStage>()) {
+                string name(key.input.shaderNames[s].data());
+                if (name.empty()) continue;
+                compile.state.shaders[s] = device.LoadShader(name);
+                shaders[s] = device.GetShader(compile.state.shaders[s]);
+            }
+            if (!shaders[ShaderStage::Compute]) {
+                auto &pass = renderPasses[RenderPassKey(key.input.renderPass)];
+                if (!pass) pass = make_shared<RenderPass>(device, key.input.renderPass);
+                compile.renderPass = pass;
+            }
+        }
+
+        auto start = chrono_clock::now();
+        auto remaining = make_shared<std::atomic_size_t>(inputs.size());
+        for (auto &input : inputs) {
+            auto layout = GetPipelineLayout(input.second);
+            prewarmQueue.Dispatch<void>(DispatchOptions{DispatchPriority::Background, prewarmCancel},
+                [this, input, layout, start, remaining]() {
+                    ZoneScopedN("PrewarmPipeline");
+                    Pipeline pipeline(device, input.second, input.first, layout, *pipelineCache);
+                    if (remaining->fetch_sub(1) == 1) {
+                        Logf("Prewarmed pipeline cache in %.1fms",
+                            std::chrono::duration<double, std::milli>(chrono_clock::now() - start).count());
+                    }
+                });
+        }
     }
 
     ShaderSet FetchShaders(const DeviceContext &device, const ShaderHandleSet &handles) {
@@ -44,6 +323,11 @@ namespace sp::vulkan {
     }
 
     shared_ptr<PipelineLayout> PipelineManager::GetPipelineLayout(const ShaderSet &shaders) {
+        std::lock_guard lock(mutex);
+        return GetPipelineLayoutInternal(shaders);
+    }
+
+    shared_ptr<PipelineLayout> PipelineManager::GetPipelineLayoutInternal(const ShaderSet &shaders) {
         PipelineLayoutKey key;
         key.input.shaderHashes = GetShaderHashes(shaders);
 
@@ -63,7 +347,8 @@ namespace sp::vulkan {
 
         for (uint32 set = 0; set < MAX_BOUND_DESCRIPTOR_SETS; set++) {
             if (!HasDescriptorSet(set)) continue;
-            descriptorPools[set] = manager.GetDescriptorPool(info.descriptorSets[set]);
+            // Layouts are only created by the manager while it holds its mutex
+            descriptorPools[set] = manager.GetDescriptorPoolInternal(info.descriptorSets[set]);
             layouts[set] = descriptorPools[set]->GetDescriptorSetLayout();
             layoutCount = set + 1;
         }
@@ -254,6 +539,7 @@ namespace sp::vulkan {
             }
         });
 
+        std::lock_guard lock(descriptorPools[set]->mutex);
         auto [descriptorSet, existed] = descriptorPools[set]->GetDescriptorSet(hash);
         if (!existed) {
             auto &sizes = info.sizes[set];
@@ -336,10 +622,17 @@ namespace sp::vulkan {
             key.input.state.srcBlendFactor = vk::BlendFactor::eZero;
         }
 
+        std::lock_guard lock(mutex);
         auto &pipelineMapValue = pipelines[key];
         if (!pipelineMapValue) {
-            auto layout = GetPipelineLayout(shaders);
-            pipelineMapValue = make_shared<Pipeline>(device, shaders, compile, layout);
+            auto layout = GetPipelineLayoutInternal(shaders);
+
+            auto start = chrono_clock::now();
+            pipelineMapValue = make_shared<Pipeline>(device, shaders, compile, layout, *pipelineCache);
+            pipelineCreateTime += chrono_clock::now() - start;
+            pipelinesCreated++;
+
+            RecordPermutation(shaders, key.input.state, compile.renderPass);
         }
         return pipelineMapValue;
     }
@@ -347,7 +640,8 @@ namespace sp::vulkan {
     Pipeline::Pipeline(DeviceContext &device,
         const ShaderSet &shaders,
         const PipelineCompileInput &compile,
-        shared_ptr<PipelineLayout> layout)
+        shared_ptr<PipelineLayout> layout,
+        vk::PipelineCache pipelineCache)
         : layout(layout) {
 
         auto &state = compile.state;
@@ -403,7 +697,7 @@ namespace sp::vulkan {
             computeInfo.stage.pNext = &subgroupSizeInfo;*/
 
             Assert(computeInfo.stage.stage == vk::ShaderStageFlagBits::eCompute, "multiple bound shaders");
-            auto pipelinesResult = device->createComputePipelineUnique({}, computeInfo);
+            auto pipelinesResult = device->createComputePipelineUnique(pipelineCache, computeInfo);
             AssertVKSuccess(pipelinesResult.result, "creating pipelines");
             uniqueHandle = std::move(pipelinesResult.value);
             return;
@@ -506,12 +800,17 @@ namespace sp::vulkan {
         pipelineInfo.renderPass = **compile.renderPass;
         pipelineInfo.subpass = 0;
 
-        auto pipelinesResult = device->createGraphicsPipelineUnique({}, {pipelineInfo});
+        auto pipelinesResult = device->createGraphicsPipelineUnique(pipelineCache, {pipelineInfo});
         AssertVKSuccess(pipelinesResult.result, "creating pipelines");
         uniqueHandle = std::move(pipelinesResult.value);
     }
 
     shared_ptr<DescriptorPool> PipelineManager::GetDescriptorPool(const DescriptorSetLayoutInfo &layout) {
+        std::lock_guard lock(mutex);
+        return GetDescriptorPoolInternal(layout);
+    }
+
+    shared_ptr<DescriptorPool> PipelineManager::GetDescriptorPoolInternal(const DescriptorSetLayoutInfo &layout) {
         DescriptorPoolKey key(layout);
         auto &mapValue = descriptorPools[key];
         if (!mapValue) {
@@ -7,18 +7,22 @@
 
 #pragma once
 
+#include "core/DispatchQueue.hh"
 #include "core/Hashing.hh"
+#include "graphics/vulkan/core/RenderPass.hh"
 #include "graphics/vulkan/core/Shader.hh"
 #include "graphics/vulkan/core/VertexLayout.hh"
 #include "graphics/vulkan/core/VkCommon.hh"
 
 #include <SPIRV-Reflect/spirv_reflect.h>
 #include <bitset>
+#include <mutex>
 #include <robin_hood.h>
 
 namespace sp::vulkan {
     class Model;
-    class RenderPass;
+
+    const size_t MAX_SHADER_NAME_LENGTH = 64;
 
     struct SpecializationData {
         std::array<uint32, MAX_SPEC_CONSTANTS> values = {};
@@ -106,6 +110,10 @@ namespace sp::vulkan {
         vector<vk::UniqueDescriptorPool> usedPools;
 
         bool bindless = false;
+
+        // Held while a set is fetched and filled, since sets are shared by passes recorded on different threads
+        std::mutex mutex;
+        friend class PipelineLayout;
     };
 
     class PipelineManager;
@@ -151,7 +159,8 @@ namespace sp::vulkan {
         Pipeline(DeviceContext &device,
             const ShaderSet &shaders,
             const PipelineCompileInput &compile,
-            shared_ptr<PipelineLayout> layout);
+            shared_ptr<PipelineLayout> layout,
+            vk::PipelineCache pipelineCache);
 
         shared_ptr<PipelineLayout> GetLayout() const {
             return layout;
@@ -164,11 +173,22 @@ namespace sp::vulkan {
     class PipelineManager : public NonCopyable {
     public:
         PipelineManager(DeviceContext &device);
+        ~PipelineManager();
 
         shared_ptr<Pipeline> GetPipeline(const PipelineCompileInput &compile);
         shared_ptr<PipelineLayout> GetPipelineLayout(const ShaderSet &shaders);
         shared_ptr<DescriptorPool> GetDescriptorPool(const DescriptorSetLayoutInfo &layout);
 
+        // True if the driver data in the pipeline cache file was valid and passed to the driver at startup
+        bool CacheLoaded() const {
+            return pipelineCacheLoaded;
+        }
+
+        size_t PipelinesCreated() {
+            std::lock_guard lock(mutex);
+            return pipelinesCreated;
+        }
+
         struct PipelineKeyData {
             ShaderHashSet shaderHashes;
             UniqueID renderPassID;
@@ -179,13 +199,46 @@ namespace sp::vulkan {
             ShaderHashSet shaderHashes;
         };
 
+        // Everything needed to rebuild a pipeline in a later run, stored in the pipeline cache file.
+        // Shader handles in the state are cleared since they are only valid for the current run.
+        struct PipelinePermutationData {
+            sp::EnumArray<std::array<char, MAX_SHADER_NAME_LENGTH>, ShaderStage> shaderNames;
+            ShaderHashSet shaderHashes;
+            PipelineStaticState state;
+            RenderPassState renderPass;
+        };
+
         using PipelineKey = HashKey<PipelineKeyData>;
         using PipelineLayoutKey = HashKey<PipelineLayoutKeyData>;
         using DescriptorPoolKey = HashKey<DescriptorSetLayoutInfo>;
+        using PipelinePermutationKey = HashKey<PipelinePermutationData>;
 
     private:
+        // Callers must hold mutex
+        shared_ptr<PipelineLayout> GetPipelineLayoutInternal(const ShaderSet &shaders);
+        shared_ptr<DescriptorPool> GetDescriptorPoolInternal(const DescriptorSetLayoutInfo &layout);
+
+        void LoadCache();
+        void SaveCache();
+        void RecordPermutation(const ShaderSet &shaders,
+            const PipelineStaticState &state,
+            const shared_ptr<RenderPass> &renderPass);
+        void StartPrewarm();
+
         DeviceContext &device;
         vk::UniquePipelineCache pipelineCache;
+        bool pipelineCacheLoaded = false;
+
+        vector<PipelinePermutationKey> permutations;
+        robin_hood::unordered_flat_set<PipelinePermutationKey, PipelinePermutationKey::Hasher> knownPermutations;
+
+        size_t pipelinesCreated = 0;
+        chrono_clock::duration pipelineCreateTime = {};
+
+        DispatchQueue prewarmQueue;
+        shared_ptr<DispatchCancelToken> prewarmCancel;
+
+        std::mutex mutex; // guards the caches below, pipelines may be requested from multiple recording threads
 
         template<typename K, typename V>
         using mapType = robin_hood::unordered_flat_map<K, V, typename K::Hasher>;
@@ -193,5 +246,7 @@ namespace sp::vulkan {
         mapType<PipelineKey, shared_ptr<Pipeline>> pipelines;
         mapType<PipelineLayoutKey, shared_ptr<PipelineLayout>> pipelineLayouts;
         mapType<DescriptorPoolKey, shared_ptr<DescriptorPool>> descriptorPools;
+
+        friend class PipelineLayout;
     };
 } // namespace sp::vulkan
@@ -12,12 +12,19 @@
 
 namespace sp::vulkan {
     RenderPass::RenderPass(DeviceContext &device, const RenderPassInfo &info) : state(info.state) {
+        Create(device, &info);
+    }
+
+    RenderPass::RenderPass(DeviceContext &device, const RenderPassState &state) : state(state) {
+        Create(device, nullptr);
+    }
+
+    void RenderPass::Create(DeviceContext &device, const RenderPassInfo *info) {
         uint32 attachmentCount = 0;
         vk::AttachmentDescription attachments[MAX_COLOR_ATTACHMENTS + 1] = {};
         vk::AttachmentReference colorAttachmentRefs[MAX_COLOR_ATTACHMENTS];
         vk::AttachmentReference depthAttachmentRef;
 
-        auto &state = info.state;
         Assert(state.colorAttachmentCount < MAX_COLOR_ATTACHMENTS, "too many attachments");
 
         for (uint32 i = 0; i < state.colorAttachmentCount; i++) {
@@ -32,13 +39,13 @@ namespace sp::vulkan {
 
             colorAttachment.finalLayout = vk::ImageLayout::eUndefined;
 
-            if (info.colorAttachments[i]->IsSwapchain()) {
+            if (info && info->colorAttachments[i]->IsSwapchain()) {
                 if (colorAttachment.loadOp == vk::AttachmentLoadOp::eLoad) {
-                    colorAttachment.initialLayout = info.colorAttachments[i]->SwapchainLayout();
+                    colorAttachment.initialLayout = info->colorAttachments[i]->SwapchainLayout();
                 } else {
                     colorAttachment.initialLayout = vk::ImageLayout::eUndefined;
                 }
-                colorAttachment.finalLayout = info.colorAttachments[i]->SwapchainLayout();
+                colorAttachment.finalLayout = info->colorAttachments[i]->SwapchainLayout();
             } else {
                 colorAttachment.initialLayout = vk::ImageLayout::eColorAttachmentOptimal;
                 colorAttachment.finalLayout = vk::ImageLayout::eColorAttachmentOptimal;
@@ -113,7 +120,7 @@ namespace sp::vulkan {
         renderPassInfo.dependencyCount = 0;
 
         vk::SubpassDependency dependency;
-        if (state.colorAttachmentCount > 0 && info.colorAttachments[0]->IsSwapchain()) {
+        if (info && state.colorAttachmentCount > 0 && info->colorAttachments[0]->IsSwapchain()) {
             // TODO: this external dependency is specifically for the swapchain renderpass, make it configurable
             dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
             dependency.dstSubpass = 0;
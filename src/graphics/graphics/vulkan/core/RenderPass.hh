@@ -165,6 +165,10 @@ namespace sp::vulkan {
     public:
         RenderPass(DeviceContext &device, const RenderPassInfo &info);
 
+        // Creates a render pass without any attachment views, for building pipelines that are compatible with
+        // render passes of the same state. Swapchain layouts are not known, so this can't be used for rendering.
+        RenderPass(DeviceContext &device, const RenderPassState &state);
+
         // Updates the cached layout of the framebuffer attachment images
         void RecordImplicitImageLayoutTransitions(const RenderPassInfo &info);
 
@@ -172,7 +176,13 @@ namespace sp::vulkan {
             return state.colorAttachmentCount;
         }
 
+        const RenderPassState &State() const {
+            return state;
+        }
+
     private:
+        void Create(DeviceContext &device, const RenderPassInfo *info);
+
         RenderPassState state;
         std::array<vk::ImageLayout, MAX_COLOR_ATTACHMENTS + 1> initialLayouts, finalLayouts;
     };
@@ -23,6 +23,7 @@ namespace sp::vulkan {
     class CommandContext;
     class Buffer;
     class SubBuffer;
+    class PagedBuffer;
     class Image;
     class ImageView;
     typedef shared_ptr<CommandContext> CommandContextPtr;
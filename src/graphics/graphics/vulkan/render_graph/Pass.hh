@@ -88,6 +88,8 @@ namespace sp::vulkan::render_graph {
         uint8 primaryAttachmentIndex = 0;
         bool isRenderPass = false;
         bool flushCommands = false; // true will submit pending command buffers
+        bool recordInParallel = false;
+        CommandContextPtr recordedCmd; // secondary command buffer recorded on a worker thread
 
         std::variant<std::monostate,
             std::function<void(Resources &, CommandContext &)>,
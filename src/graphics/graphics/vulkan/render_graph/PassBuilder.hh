@@ -76,6 +76,16 @@ namespace sp::vulkan::render_graph {
             pass.required = true;
         }
 
+        /**
+         * Allows a CommandContext Execute function to be recorded into a secondary command buffer on a worker
+         * thread, concurrently with other passes and before any earlier pass has executed. The function must only
+         * access resources declared in Build, must not depend on CPU side effects of other passes,
+         * and must not record barriers or begin render passes.
+         */
+        void RecordInParallel() {
+            pass.recordInParallel = true;
+        }
+
     private:
         Resource OutputAttachment(uint32 index, string_view name, const ImageDesc &desc, const AttachmentInfo &info);
 
@@ -12,6 +12,7 @@
 
 namespace sp::vulkan::render_graph {
     const ImageViewPtr &PooledImage::LayerImageView(uint32 layer) {
+        std::lock_guard lock(viewMutex);
         Assert(layer < desc.arrayLayers, "render target image layer too high");
         if (layerImageViews.empty()) layerImageViews.resize(desc.arrayLayers);
 
@@ -27,6 +28,7 @@ namespace sp::vulkan::render_graph {
     }
 
     const ImageViewPtr &PooledImage::MipImageView(uint32 mip) {
+        std::lock_guard lock(viewMutex);
         Assert(mip < desc.mipLevels, "render target image layer too high");
         if (mipImageViews.empty()) mipImageViews.resize(desc.mipLevels);
 
@@ -42,6 +44,7 @@ namespace sp::vulkan::render_graph {
     }
 
     const ImageViewPtr &PooledImage::DepthImageView() {
+        std::lock_guard lock(viewMutex);
         if (depthImageView) return depthImageView;
 
         ImageViewCreateInfo info = imageView->CreateInfo();
@@ -10,6 +10,8 @@
 #include "core/Hashing.hh"
 #include "graphics/vulkan/core/VkCommon.hh"
 
+#include <mutex>
+
 namespace sp::vulkan::render_graph {
     struct ImageDesc {
         vk::Extent3D extent;
@@ -62,6 +64,7 @@ namespace sp::vulkan::render_graph {
         DeviceContext *device;
         ImageDesc desc;
         ImageViewPtr imageView;
+        std::mutex viewMutex; // views are created on demand, possibly by passes recorded on different threads
         vector<ImageViewPtr> layerImageViews;
         vector<ImageViewPtr> mipImageViews;
         ImageViewPtr depthImageView;
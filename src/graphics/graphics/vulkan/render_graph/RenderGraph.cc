@@ -7,6 +7,7 @@
 
 #include "RenderGraph.hh"
 
+#include "console/CVar.hh"
 #include "core/Logging.hh"
 #include "graphics/vulkan/core/CommandContext.hh"
 #include "graphics/vulkan/core/DeviceContext.hh"
@@ -14,10 +15,34 @@
 #include "graphics/vulkan/core/VkTracing.hh"
 
 namespace sp::vulkan::render_graph {
-    RenderGraph::RenderGraph(DeviceContext &device) : device(device), resources(device) {}
+    static CVar<bool> CVarParallelRecording("r.ParallelRecording",
+        true,
+        "Record passes that allow it into secondary command buffers on worker threads");
+    static CVar<uint32> CVarRecordThreads("r.RenderGraphThreads",
+        2,
+        "Number of worker threads recording render graph passes (takes effect on restart)");
+
+    RenderGraph::RenderGraph(DeviceContext &device)
+        : device(device), resources(device), recordThreadCount(std::max(1u, CVarRecordThreads.Get())),
+          recordQueue("RenderGraphRecord", recordThreadCount) {
+        funcs.Register("rendergraphtimings", "Print average render graph build, cull, and record times", [&]() {
+            printTimings = true;
+        });
+        funcs.Register<size_t>("assert_parallelpasses",
+            "Asserts at least N passes were recorded in parallel last frame (assert_parallelpasses <N>)",
+            [&](size_t expected) {
+                size_t recorded = lastParallelPasses;
+                Assertf(recorded >= expected,
+                    "Expected at least %u passes recorded in parallel, got %u",
+                    expected,
+                    recorded);
+            });
+    }
 
     void RenderGraph::Execute() {
         ZoneScoped;
+        auto cullStart = chrono_clock::now();
+        if (!passes.empty()) timings.build += cullStart - buildStart;
         resources.ResizeIfNeeded();
         resources.lastOutputID = InvalidResource;
 
@@ -59,6 +84,14 @@ namespace sp::vulkan::render_graph {
         }
         futureDependencies[resources.frameIndex].clear();
 
+        auto recordStart = chrono_clock::now();
+        timings.cull += recordStart - cullStart;
+        lastParallelPasses = 0;
+        if (CVarParallelRecording.Get()) RecordParallelPasses();
+
+        auto serialRecordStart = chrono_clock::now();
+        timings.parallelRecord += serialRecordStart - recordStart;
+
         auto timer = device.GetPerfTimer();
 
 #ifdef TRACY_ENABLE_GRAPHICS
@@ -92,34 +125,7 @@ namespace sp::vulkan::render_graph {
             AddPreBarriers(cmd, pass); // creates cmd if necessary
             if (pass.flushCommands) submitPendingCmds(false);
 
-            RenderPassInfo renderPassInfo;
-
-            for (uint32 i = 0; i < pass.attachments.size(); i++) {
-                auto &attachment = pass.attachments[i];
-                if (attachment.resourceID == InvalidResource) continue;
-                pass.isRenderPass = true;
-
-                auto imageView = resources.GetImageView(attachment.resourceID);
-                if (attachment.arrayIndex != ~0u && imageView->ArrayLayers() > 1) {
-                    imageView = resources.GetImageLayerView(attachment.resourceID, attachment.arrayIndex);
-                } else if (imageView->MipLevels() > 1) {
-                    imageView = resources.GetImageMipView(attachment.resourceID, 0);
-                }
-
-                if (i != MAX_COLOR_ATTACHMENTS) {
-                    renderPassInfo.state.colorAttachmentCount = i + 1;
-                    renderPassInfo.SetColorAttachment(i,
-                        imageView,
-                        attachment.loadOp,
-                        attachment.storeOp,
-                        attachment.clearColor);
-                } else {
-                    renderPassInfo.SetDepthStencilAttachment(imageView,
-                        attachment.loadOp,
-                        attachment.storeOp,
-                        attachment.clearDepthStencil);
-                }
-            }
+            auto renderPassInfo = GetRenderPassInfo(pass);
 
             for (int i = std::max(pass.scopes.size(), frameScopeStack.size()) - 1; i >= 0; i--) {
                 uint8 passScope = i < (int)pass.scopes.size() ? pass.scopes[i] : 255;
@@ -173,8 +179,13 @@ namespace sp::vulkan::render_graph {
                 GPUZoneTransient(&device, cmd, traceVkZone, pass.name.data(), pass.name.size());
                 RenderPhase phase(pass.name);
                 phase.StartTimer(*cmd);
-                cmd->BeginRenderPass(renderPassInfo);
-                pass.Execute(resources, *cmd);
+                if (pass.recordedCmd) {
+                    cmd->BeginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+                    cmd->ExecuteCommands(*pass.recordedCmd);
+                } else {
+                    cmd->BeginRenderPass(renderPassInfo);
+                    pass.Execute(resources, *cmd);
+                }
                 cmd->EndRenderPass();
             } else if (pass.ExecutesWithDeviceContext()) {
                 RenderPhase phase(pass.name);
@@ -185,7 +196,11 @@ namespace sp::vulkan::render_graph {
                 GPUZoneTransient(&device, cmd, traceVkZone, pass.name.data(), pass.name.size());
                 RenderPhase phase(pass.name);
                 phase.StartTimer(*cmd);
-                pass.Execute(resources, *cmd);
+                if (pass.recordedCmd) {
+                    cmd->ExecuteCommands(*pass.recordedCmd);
+                } else {
+                    pass.Execute(resources, *cmd);
+                }
             } else {
                 Abort("invalid pass");
             }
@@ -198,11 +213,129 @@ namespace sp::vulkan::render_graph {
             }
 
             pass.executeFunc = {}; // releases any captures
+            pass.recordedCmd.reset();
             UpdateLastOutput(pass);
+            timings.passes++;
         }
 
         submitPendingCmds(true);
         AdvanceFrame();
+
+        timings.record += chrono_clock::now() - serialRecordStart;
+        timings.frames++;
+        if (printTimings.exchange(false)) LogTimings();
+    }
+
+    RenderPassInfo RenderGraph::GetRenderPassInfo(Pass &pass) {
+        RenderPassInfo renderPassInfo;
+
+        for (uint32 i = 0; i < pass.attachments.size(); i++) {
+            auto &attachment = pass.attachments[i];
+            if (attachment.resourceID == InvalidResource) continue;
+            pass.isRenderPass = true;
+
+            auto imageView = resources.GetImageView(attachment.resourceID);
+            if (attachment.arrayIndex != ~0u && imageView->ArrayLayers() > 1) {
+                imageView = resources.GetImageLayerView(attachment.resourceID, attachment.arrayIndex);
+            } else if (imageView->MipLevels() > 1) {
+                imageView = resources.GetImageMipView(attachment.resourceID, 0);
+            }
+
+            if (i != MAX_COLOR_ATTACHMENTS) {
+                renderPassInfo.state.colorAttachmentCount = i + 1;
+                renderPassInfo.SetColorAttachment(i,
+                    imageView,
+                    attachment.loadOp,
+                    attachment.storeOp,
+                    attachment.clearColor);
+            } else {
+                renderPassInfo.SetDepthStencilAttachment(imageView,
+                    attachment.loadOp,
+                    attachment.storeOp,
+                    attachment.clearDepthStencil);
+            }
+        }
+        return renderPassInfo;
+    }
+
+    /**
+     * Records every active pass that allows it into a secondary command buffer, split between the worker threads
+     * and this thread. Passes are picked up in graph order, and are executed in that order by Execute.
+     */
+    void RenderGraph::RecordParallelPasses() {
+        ZoneScoped;
+        struct ParallelPass {
+            Pass *pass;
+            shared_ptr<Framebuffer> framebuffer;
+        };
+        vector<ParallelPass> parallelPasses;
+
+        for (auto &pass : passes) {
+            if (!pass.active || !pass.recordInParallel) continue;
+            if (!pass.ExecutesWithCommandContext() || pass.flushCommands) continue;
+
+            // Resources are created on first access, so create them here while only this thread is using the graph.
+            // They are all referenced until the pass executes, since every active pass holds a reference.
+            for (auto &access : pass.accesses) {
+                auto &res = resources.resources[access.id];
+                if (res.type == Resource::Type::Image) {
+                    resources.GetPooledImage(access.id);
+                } else if (res.type == Resource::Type::Buffer) {
+                    resources.GetBuffer(access.id);
+                }
+            }
+
+            auto renderPassInfo = GetRenderPassInfo(pass);
+            auto &parallelPass = parallelPasses.emplace_back(ParallelPass{&pass});
+            if (pass.isRenderPass) parallelPass.framebuffer = device.GetFramebuffer(renderPassInfo);
+        }
+        if (parallelPasses.empty()) return;
+        timings.parallelPasses += parallelPasses.size();
+        lastParallelPasses = parallelPasses.size();
+
+        std::atomic_size_t nextPass = 0;
+        auto recordPasses = [&]() {
+            for (size_t i = nextPass++; i < parallelPasses.size(); i = nextPass++) {
+                auto &[pass, framebuffer] = parallelPasses[i];
+                ZoneScopedN("RecordPass");
+                ZoneStr(pass->name);
+
+                auto cmd = device.GetSecondaryCommandContext(framebuffer);
+                Resources::recordingScopeStack = &pass->scopes;
+                pass->Execute(resources, *cmd);
+                Resources::recordingScopeStack = nullptr;
+                pass->recordedCmd = cmd;
+            }
+        };
+
+        vector<AsyncPtr<void>> pending;
+        size_t workerCount = std::min(recordThreadCount, parallelPasses.size() - 1);
+        for (size_t i = 0; i < workerCount; i++) {
+            pending.emplace_back(recordQueue.Dispatch<void>([&recordPasses] {
+                recordPasses();
+            }));
+        }
+        recordPasses();
+        for (auto &future : pending) {
+            future->Get();
+        }
+    }
+
+    void RenderGraph::LogTimings() {
+        if (timings.frames == 0) return;
+        auto averageMs = [&](chrono_clock::duration total) {
+            return std::chrono::duration<double, std::milli>(total).count() / timings.frames;
+        };
+        Logf("Render graph over %u frames, %.1f passes per frame (%.1f recorded in parallel)",
+            timings.frames,
+            (double)timings.passes / timings.frames,
+            (double)timings.parallelPasses / timings.frames);
+        Logf("  build %.3fms, cull %.3fms, parallel record %.3fms, record and submit %.3fms",
+            averageMs(timings.build),
+            averageMs(timings.cull),
+            averageMs(timings.parallelRecord),
+            averageMs(timings.record));
+        timings = {};
     }
 
     void RenderGraph::AddPreBarriers(CommandContextPtr &cmd, Pass &pass) {
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "console/CFunc.hh"
+#include "core/DispatchQueue.hh"
 #include "graphics/vulkan/render_graph/Pass.hh"
 #include "graphics/vulkan/render_graph/PassBuilder.hh"
 #include "graphics/vulkan/render_graph/Resources.hh"
@@ -42,6 +44,7 @@ namespace sp::vulkan::render_graph {
                 ZoneScoped;
                 ZoneStr(name);
                 Assert(passIndex == ~0u, "multiple Build calls for the same pass");
+                if (graph.passes.empty()) graph.buildStart = chrono_clock::now();
                 Pass pass(name);
                 pass.scopes = graph.resources.scopeStack;
 
@@ -157,7 +160,10 @@ namespace sp::vulkan::render_graph {
     private:
         friend class InitialPassState;
         void AddPreBarriers(CommandContextPtr &cmd, Pass &pass);
+        RenderPassInfo GetRenderPassInfo(Pass &pass);
+        void RecordParallelPasses();
         void AdvanceFrame();
+        void LogTimings();
 
         void UpdateLastOutput(const Pass &pass) {
             if (pass.primaryAttachmentIndex >= pass.attachments.size()) return;
@@ -169,5 +175,17 @@ namespace sp::vulkan::render_graph {
         vector<Pass> passes;
         Resources resources;
         std::array<vector<ResourceID>, RESOURCE_FRAME_COUNT> futureDependencies;
+
+        size_t recordThreadCount;
+        DispatchQueue recordQueue;
+
+        chrono_clock::time_point buildStart;
+        struct {
+            chrono_clock::duration build = {}, cull = {}, parallelRecord = {}, record = {};
+            size_t frames = 0, passes = 0, parallelPasses = 0;
+        } timings;
+        std::atomic_size_t lastParallelPasses = 0; // each is recorded into its own secondary command buffer
+        std::atomic_bool printTimings;
+        CFuncCollection funcs;
     };
 } // namespace sp::vulkan::render_graph
@@ -10,6 +10,8 @@
 #include "graphics/vulkan/core/DeviceContext.hh"
 
 namespace sp::vulkan::render_graph {
+    thread_local const Resources::ScopeStack *Resources::recordingScopeStack = nullptr;
+
     Resources::Resources(DeviceContext &device) : device(device) {
         Reset();
         nameScopes.emplace_back();
@@ -176,7 +178,8 @@ namespace sp::vulkan::render_graph {
             return result;
         }
 
-        for (auto scopeIt = scopeStack.rbegin(); scopeIt != scopeStack.rend(); scopeIt++) {
+        auto &scopes = recordingScopeStack ? *recordingScopeStack : scopeStack;
+        for (auto scopeIt = scopes.rbegin(); scopeIt != scopes.rend(); scopeIt++) {
             auto id = nameScopes[*scopeIt].GetID(name, getFrameIndex);
             if (id != InvalidResource) return id;
         }
@@ -148,8 +148,13 @@ namespace sp::vulkan::render_graph {
             void ClearID(ResourceID id);
         };
 
+        using ScopeStack = InlineVector<uint8, MAX_RESOURCE_SCOPE_DEPTH>;
+
         vector<Scope> nameScopes;
-        InlineVector<uint8, MAX_RESOURCE_SCOPE_DEPTH> scopeStack; // refers to indexes in nameScopes
+        ScopeStack scopeStack; // refers to indexes in nameScopes
+
+        // Set while a pass is recorded on a worker thread, so names resolve in that pass's scopes
+        static thread_local const ScopeStack *recordingScopeStack;
 
         vector<Resource> resources;
         vector<string> resourceNames;
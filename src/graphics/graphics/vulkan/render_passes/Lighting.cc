@@ -417,6 +417,8 @@ namespace sp::vulkan::renderer {
                 builder.Read("WarpedVertexBuffer", Access::VertexBuffer);
                 builder.Read(drawAllIDs.drawCommandsBuffer, Access::IndirectBuffer);
                 builder.Read(drawAllIDs.drawParamsBuffer, Access::VertexShaderReadStorage);
+
+                builder.RecordInParallel();
             })
             .Execute([this, drawAllIDs](rg::Resources &resources, CommandContext &cmd) {
                 cmd.SetShaders("shadow_map.vert", "shadow_map.frag");
@@ -447,6 +449,8 @@ namespace sp::vulkan::renderer {
 
                 builder.Read(drawOpticIDs.drawCommandsBuffer, Access::IndirectBuffer);
                 builder.Read(drawOpticIDs.drawParamsBuffer, Access::VertexShaderReadStorage);
+
+                builder.RecordInParallel();
             })
             .Execute([this, drawOpticIDs](rg::Resources &resources, CommandContext &cmd) {
                 cmd.SetShaders("optic_visibility.vert", "optic_visibility.frag");
@@ -15,8 +15,7 @@
 
 namespace sp::vulkan::renderer {
     void Transparency::AddPass(RenderGraph &graph, const ecs::View &view) {
-        glm::vec3 viewPos = view.invViewMat * glm::vec4(0, 0, 0, 1);
-        auto drawIDs = scene.GenerateSortedDrawsForView(graph, viewPos, ecs::VisibilityMask::Transparent, true);
+        auto drawIDs = scene.GenerateSortedDrawsForView(graph, view, ecs::VisibilityMask::Transparent, true);
 
         graph.AddPass("Transparency")
             .Build([&](PassBuilder &builder) {
@@ -34,6 +33,8 @@ namespace sp::vulkan::renderer {
 
                 builder.SetColorAttachment(0, builder.LastOutputID(), {LoadOp::Load, StoreOp::Store});
                 builder.SetDepthAttachment("GBufferDepthStencil", {LoadOp::Load, StoreOp::ReadOnly});
+
+                builder.RecordInParallel();
             })
             .Execute([this, drawIDs](Resources &resources, CommandContext &cmd) {
                 cmd.SetShaders("scene.vert", "lighting_transparent.frag");
@@ -8,33 +8,58 @@
 #include "GPUScene.hh"
 
 #include "assets/GltfImpl.hh"
+#include "console/CVar.hh"
+#include "core/RadixSort.hh"
 #include "ecs/EcsImpl.hh"
 #include "graphics/vulkan/core/CommandContext.hh"
 #include "graphics/vulkan/core/DeviceContext.hh"
 #include "graphics/vulkan/scene/Mesh.hh"
 #include "graphics/vulkan/scene/VertexLayouts.hh"
 
-namespace sp::vulkan {
-    GPUScene::GPUScene(DeviceContext &device) : device(device), workQueue("", 0), textures(device, workQueue) {
-        indexBuffer = device.AllocateBuffer({sizeof(uint32), 10 * 1024 * 1024},
-            vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-            VMA_MEMORY_USAGE_GPU_ONLY);
+#include <glm/gtc/matrix_access.hpp>
 
-        vertexBuffer = device.AllocateBuffer({sizeof(SceneVertex), 1024 * 1024},
-            vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-
-        jointsBuffer = device.AllocateBuffer({sizeof(JointVertex), 128 * 1024},
-            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-
-        primitiveLists = device.AllocateBuffer({sizeof(GPUMeshPrimitive), 10 * 1024},
+namespace sp::vulkan {
+    static CVar<uint32> CVarSortedDrawThreads("r.SortedDrawThreads",
+        4,
+        "Number of worker threads used to generate depth sorted draws");
+
+    static CVar<uint32> CVarMeshDecodeThreads("r.MeshDecodeThreads",
+        2,
+        "Number of worker threads used to decode mesh vertex data (takes effect on restart)");
+    static CVar<uint32> CVarMeshUploadBudget("r.MeshUploadBudget",
+        32 * 1024 * 1024,
+        "Maximum bytes of mesh data uploaded per frame, at least one mesh is always uploaded");
+    static CVar<bool> CVarMeshBufferCompaction("r.MeshBufferCompaction",
+        true,
+        "Compact the mesh buffers when they become fragmented");
+    static CVar<float> CVarMeshBufferFragmentation("r.MeshBufferFragmentation",
+        0.5f,
+        "Fraction of a mesh buffer's used space that can be lost to fragmentation before it is compacted");
+
+    // Renderables per chunk below which sorted draw generation isn't split across more threads
+    static const size_t MIN_SORTED_DRAW_CHUNK = 1024;
+
+    GPUScene::GPUScene(DeviceContext &device)
+        : device(device), workQueue("", 0),
+          indexBuffer(device, sizeof(uint32), 1024 * 1024, 10, vk::BufferUsageFlagBits::eIndexBuffer),
+          vertexBuffer(device, sizeof(SceneVertex), 256 * 1024, 4, vk::BufferUsageFlagBits::eVertexBuffer),
+          jointsBuffer(device, sizeof(JointVertex), 32 * 1024, 4, vk::BufferUsageFlagBits::eStorageBuffer),
+          primitiveLists(device, sizeof(GPUMeshPrimitive), 2 * 1024, 5, vk::BufferUsageFlagBits::eStorageBuffer),
+          models(device, sizeof(GPUMeshModel), 256, 4, vk::BufferUsageFlagBits::eStorageBuffer),
+          textures(device, workQueue), meshDecodeQueue("MeshDecode", std::max(1u, CVarMeshDecodeThreads.Get())) {
+        funcs.Register("meshbufferstats", "Print GPU scene mesh buffer usage", [&]() {
+            printMeshBufferStats = true;
+        });
+
+        renderableEntities = device.AllocateBuffer({sizeof(GPURenderableEntity), 16 * 1024},
             vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
             VMA_MEMORY_USAGE_GPU_ONLY);
 
-        models = device.AllocateBuffer({sizeof(GPUMeshModel), 1024},
-            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
-            VMA_MEMORY_USAGE_GPU_ONLY);
+        auto lock = ecs::StartTransaction<ecs::AddRemove>();
+        renderableObserver = lock.Watch<ecs::ComponentEvent<ecs::Renderable>>();
+        for (auto &ent : lock.EntitiesWith<ecs::Renderable>()) {
+            AllocateSlot(ent);
+        }
     }
 
     GPUScene::OpticInstance::OpticInstance(ecs::Entity ent, const ecs::OpticalElement &optic) : ent(ent) {
@@ -51,95 +76,290 @@ namespace sp::vulkan {
     void GPUScene::LoadState(rg::RenderGraph &graph,
         ecs::Lock<ecs::Read<ecs::Renderable, ecs::OpticalElement, ecs::TransformSnapshot, ecs::Name>> lock) {
         ZoneScoped;
-        renderables.clear();
-        meshes.clear();
+        // Moving mesh data changes mesh offsets, so it happens before any renderables are updated
+        ReallocateMeshBuffers();
+        if (printMeshBufferStats) {
+            printMeshBufferStats = false;
+            LogMeshBufferStats();
+        }
+
+        ecs::ComponentEvent<ecs::Renderable> renderableEvent;
+        while (renderableObserver.Poll(lock, renderableEvent)) {
+            auto &eventEntity = renderableEvent.entity;
+            auto *slotIndex = slotIndexes.find(eventEntity);
+            if (renderableEvent.type == Tecs::EventType::ADDED) {
+                if (!slotIndex) AllocateSlot(eventEntity);
+            } else if (renderableEvent.type == Tecs::EventType::REMOVED) {
+                if (slotIndex) FreeSlot(*slotIndex);
+            }
+        }
+
+        // Free ranges are reused by exact size, so compact when churn leaves too much of the buffer unused
+        if (vertexCount > 64 * 1024 && vertexCount > liveVertexCount * 2) CompactVertices();
+
         opticEntities.clear();
         jointPoses.clear();
-        renderableCount = 0;
         primitiveCount = 0;
-        vertexCount = 0;
 
-        for (auto &ent : lock.EntitiesWith<ecs::Renderable>()) {
-            if (!ent.Has<ecs::TransformSnapshot>(lock)) continue;
+        // Tecs doesn't report component writes, so changes are found by comparing against each slot's last state.
+        // Only slots that differ from the GPU copy are uploaded.
+        for (uint32 i = 0; i < slots.size(); i++) {
+            if (slots[i].ent) UpdateSlot(lock, i);
+        }
 
-            auto &renderable = ent.Get<ecs::Renderable>(lock);
-            if (!renderable.model || !renderable.model->Ready()) continue;
+        renderableCount = slots.size();
+        primitiveCountPowerOfTwo = std::max(1u, CeilToPowerOfTwo(primitiveCount));
 
-            auto model = renderable.model->Get();
-            if (!model) continue;
+        textures.Flush();
 
-            auto vkMesh = LoadMesh(model, renderable.meshIndex);
-            if (!vkMesh || !vkMesh->CheckReady()) continue;
+        UploadRenderables(graph);
+    }
 
-            auto &transform = ent.Get<ecs::TransformSnapshot>(lock).globalPose;
+    void GPUScene::UpdateSlot(
+        const ecs::Lock<ecs::Read<ecs::Renderable, ecs::OpticalElement, ecs::TransformSnapshot, ecs::Name>> &lock,
+        uint32 slotIndex) {
+        auto &slot = slots[slotIndex];
+        auto &ent = slot.ent;
 
-            GPURenderableEntity gpuRenderable;
-            gpuRenderable.modelToWorld = transform.GetMatrix();
-            gpuRenderable.visibilityMask = (uint32_t)renderable.visibility;
-            gpuRenderable.meshIndex = vkMesh->SceneIndex();
-            gpuRenderable.vertexOffset = vertexCount;
-            gpuRenderable.emissiveScale = renderable.emissiveScale;
-            if (glm::all(glm::greaterThanEqual(renderable.colorOverride.color, glm::vec4(0)))) {
-                gpuRenderable.baseColorOverrideID = textures.GetSinglePixelIndex(renderable.colorOverride);
-            }
-            if (glm::all(glm::greaterThanEqual(renderable.metallicRoughnessOverride, glm::vec2(0)))) {
-                gpuRenderable.metallicRoughnessOverrideID = textures.GetSinglePixelIndex(
-                    glm::vec4(renderable.metallicRoughnessOverride, 0, 1));
-            }
-            if (ent.Has<ecs::OpticalElement>(lock)) {
-                auto &optic = ent.Get<ecs::OpticalElement>(lock);
-                opticEntities.emplace_back(ent, optic);
-                gpuRenderable.opticID = opticEntities.size();
-                gpuRenderable.visibilityMask |= (uint32_t)ecs::VisibilityMask::Optics;
-            } else {
-                gpuRenderable.visibilityMask &= (uint32_t)~ecs::VisibilityMask::Optics;
+        GPURenderableEntity gpuRenderable;
+        if (!ent.Has<ecs::Renderable, ecs::TransformSnapshot>(lock)) {
+            ReleaseSlotMesh(slot);
+        } else {
+            auto &renderable = ent.Get<ecs::Renderable>(lock);
+            if (!slot.mesh || slot.model != renderable.model || slot.meshIndex != renderable.meshIndex) {
+                ReleaseSlotMesh(slot);
+
+                if (renderable.model && renderable.model->Ready()) {
+                    auto model = renderable.model->Get();
+                    auto vkMesh = model ? LoadMesh(model, renderable.meshIndex) : nullptr;
+                    if (vkMesh && vkMesh->CheckReady()) {
+                        slot.model = renderable.model;
+                        slot.meshIndex = renderable.meshIndex;
+                        slot.mesh = vkMesh;
+                        AllocateVertices(slot);
+                    }
+                }
             }
-
-            if (!renderable.joints.empty()) gpuRenderable.jointPosesOffset = jointPoses.size();
-
-            for (auto &joint : renderable.joints) {
-                auto jointEntity = joint.entity.Get(lock);
-                if (jointEntity.Has<ecs::TransformSnapshot>(lock)) {
-                    auto &jointTransform = jointEntity.Get<ecs::TransformSnapshot>(lock).globalPose;
-                    jointPoses.push_back(jointTransform.GetMatrix() * joint.inverseBindPose);
+            if (slot.mesh) {
+                auto &transform = ent.Get<ecs::TransformSnapshot>(lock).globalPose;
+
+                gpuRenderable.modelToWorld = transform.GetMatrix();
+                gpuRenderable.visibilityMask = (uint32_t)renderable.visibility;
+                gpuRenderable.meshIndex = slot.mesh->SceneIndex();
+                gpuRenderable.vertexOffset = slot.vertexOffset;
+                gpuRenderable.emissiveScale = renderable.emissiveScale;
+
+                glm::vec4 colorOverride = renderable.colorOverride.color;
+                if (colorOverride != slot.colorOverride) {
+                    slot.colorOverride = colorOverride;
+                    slot.baseColorOverrideID = -1;
+                    if (glm::all(glm::greaterThanEqual(colorOverride, glm::vec4(0)))) {
+                        slot.baseColorOverrideID = textures.GetSinglePixelIndex(colorOverride);
+                    }
+                }
+                if (renderable.metallicRoughnessOverride != slot.metallicRoughnessOverride) {
+                    slot.metallicRoughnessOverride = renderable.metallicRoughnessOverride;
+                    slot.metallicRoughnessOverrideID = -1;
+                    if (glm::all(glm::greaterThanEqual(renderable.metallicRoughnessOverride, glm::vec2(0)))) {
+                        slot.metallicRoughnessOverrideID = textures.GetSinglePixelIndex(
+                            glm::vec4(renderable.metallicRoughnessOverride, 0, 1));
+                    }
+                }
+                gpuRenderable.baseColorOverrideID = slot.baseColorOverrideID;
+                gpuRenderable.metallicRoughnessOverrideID = slot.metallicRoughnessOverrideID;
+
+                if (ent.Has<ecs::OpticalElement>(lock)) {
+                    auto &optic = ent.Get<ecs::OpticalElement>(lock);
+                    opticEntities.emplace_back(ent, optic);
+                    gpuRenderable.opticID = opticEntities.size();
+                    gpuRenderable.visibilityMask |= (uint32_t)ecs::VisibilityMask::Optics;
                 } else {
-                    jointPoses.emplace_back(); // missing joints get an identity matrix
+                    gpuRenderable.visibilityMask &= (uint32_t)~ecs::VisibilityMask::Optics;
                 }
-            }
 
-            renderables.push_back(gpuRenderable);
-            meshes.emplace_back(vkMesh);
+                if (!renderable.joints.empty()) gpuRenderable.jointPosesOffset = jointPoses.size();
+
+                for (auto &joint : renderable.joints) {
+                    auto jointEntity = joint.entity.Get(lock);
+                    if (jointEntity.Has<ecs::TransformSnapshot>(lock)) {
+                        auto &jointTransform = jointEntity.Get<ecs::TransformSnapshot>(lock).globalPose;
+                        jointPoses.push_back(jointTransform.GetMatrix() * joint.inverseBindPose);
+                    } else {
+                        jointPoses.emplace_back(); // missing joints get an identity matrix
+                    }
+                }
 
-            renderableCount++;
-            primitiveCount += vkMesh->PrimitiveCount();
-            vertexCount += vkMesh->VertexCount();
+                primitiveCount += slot.mesh->PrimitiveCount();
+            }
         }
 
-        Assertf(renderables.size() == meshes.size(),
-            "Mismatched renderable and mesh counts: %u != %u",
-            renderables.size(),
-            meshes.size());
+        if (gpuRenderable != renderables[slotIndex]) {
+            renderables[slotIndex] = gpuRenderable;
+            dirtySlots.push_back(slotIndex);
+        }
+    }
 
-        primitiveCountPowerOfTwo = std::max(1u, CeilToPowerOfTwo(primitiveCount));
+    void GPUScene::UploadRenderables(rg::RenderGraph &graph) {
+        ZoneScoped;
+        if (renderables.size() > renderableEntities->ArraySize()) {
+            // The old buffer may still be read by frames in flight, so it is kept alive until this frame completes
+            device.ExecuteAfterFrameFence([oldBuffer = renderableEntities]() {});
+            renderableEntities = device.AllocateBuffer({sizeof(GPURenderableEntity),
+                                                           CeilToPowerOfTwo((uint32)renderables.size())},
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                VMA_MEMORY_USAGE_GPU_ONLY);
+
+            dirtySlots.resize(renderables.size());
+            for (uint32 i = 0; i < dirtySlots.size(); i++) {
+                dirtySlots[i] = i;
+            }
+        }
 
-        textures.Flush();
+        // Merge dirty slots into contiguous copy regions
+        std::sort(dirtySlots.begin(), dirtySlots.end());
+        dirtySlots.erase(std::unique(dirtySlots.begin(), dirtySlots.end()), dirtySlots.end());
+        renderableUploads.clear();
+        renderableUploadRegions.clear();
+        for (auto slotIndex : dirtySlots) {
+            vk::DeviceSize dstOffset = slotIndex * sizeof(GPURenderableEntity);
+            auto *lastRegion = renderableUploadRegions.empty() ? nullptr : &renderableUploadRegions.back();
+            if (lastRegion && lastRegion->dstOffset + lastRegion->size == dstOffset) {
+                lastRegion->size += sizeof(GPURenderableEntity);
+            } else {
+                renderableUploadRegions.emplace_back(renderableUploads.size() * sizeof(GPURenderableEntity),
+                    dstOffset,
+                    sizeof(GPURenderableEntity));
+            }
+            renderableUploads.push_back(renderables[slotIndex]);
+        }
+        dirtySlots.clear();
 
         graph.AddPass("SceneState")
             .Build([&](rg::PassBuilder &builder) {
-                builder.CreateBuffer("RenderableEntities",
-                    {sizeof(renderables.front()), std::max(size_t(1), renderables.size())},
+                // Updates to the persistent renderable and mesh buffers aren't tracked by the graph, so this pass
+                // always runs
+                builder.RequirePass();
+                builder.CreateBuffer("RenderableUpdates",
+                    {sizeof(GPURenderableEntity), std::max(size_t(1), renderableUploads.size())},
                     Residency::CPU_TO_GPU,
                     Access::HostWrite);
 
                 Assertf(jointPoses.size() <= 100, "too many joints: %d", jointPoses.size());
                 builder.CreateUniform("JointPoses", sizeof(glm::mat4) * 100); // TODO: don't hardcode to 100 joints
+
+                if (!modelTableUploads.empty()) {
+                    builder.CreateBuffer("MeshPrimitiveTable",
+                        {sizeof(GPUMeshPrimitive), primitiveTableUploads.size()},
+                        Residency::CPU_TO_GPU,
+                        Access::HostWrite);
+                    builder.CreateBuffer("MeshModelTable",
+                        {sizeof(GPUMeshModel), modelTableUploads.size()},
+                        Residency::CPU_TO_GPU,
+                        Access::HostWrite);
+                }
             })
-            .Execute([this](rg::Resources &resources, DeviceContext &device) {
-                resources.GetBuffer("RenderableEntities")->CopyFrom(renderables.data(), renderables.size());
+            .Execute([this](rg::Resources &resources, CommandContext &cmd) {
+                // Mesh buffer moves must complete before any other pass reads the new buffers
+                if (!meshBufferCopies.empty()) CopyMeshBuffers(resources, cmd);
+
                 resources.GetBuffer("JointPoses")->CopyFrom(jointPoses.data(), jointPoses.size());
+                if (renderableUploadRegions.empty()) return;
+
+                auto uploadBuffer = resources.GetBuffer("RenderableUpdates");
+                uploadBuffer->CopyFrom(renderableUploads.data(), renderableUploads.size());
+
+                vk::BufferMemoryBarrier barrier;
+                barrier.buffer = *renderableEntities;
+                barrier.size = VK_WHOLE_SIZE;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+                // Wait for the previous frame's draw generation to finish reading before overwriting slots
+                barrier.srcAccessMask = vk::AccessFlagBits::eShaderRead;
+                barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+                cmd.Raw().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                    vk::PipelineStageFlagBits::eTransfer,
+                    {},
+                    {},
+                    {barrier},
+                    {});
+
+                cmd.Raw().copyBuffer(*uploadBuffer, *renderableEntities, renderableUploadRegions);
+
+                barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+                barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+                cmd.Raw().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    {},
+                    {},
+                    {barrier},
+                    {});
             });
     }
 
+    void GPUScene::AllocateSlot(ecs::Entity ent) {
+        uint32 slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slotIndex = slots.size();
+            slots.emplace_back();
+            renderables.emplace_back();
+        }
+        slots[slotIndex].ent = ent;
+        slotIndexes[ent] = slotIndex;
+    }
+
+    void GPUScene::FreeSlot(uint32 slotIndex) {
+        auto &slot = slots[slotIndex];
+        ReleaseSlotMesh(slot);
+        slotIndexes.erase(slot.ent);
+        slot = {};
+        if (renderables[slotIndex] != GPURenderableEntity()) {
+            renderables[slotIndex] = {};
+            dirtySlots.push_back(slotIndex);
+        }
+        freeSlots.push_back(slotIndex);
+    }
+
+    void GPUScene::ReleaseSlotMesh(RenderableSlot &slot) {
+        if (slot.vertexCount > 0) {
+            freeVertexRanges[slot.vertexCount].push_back(slot.vertexOffset);
+            liveVertexCount -= slot.vertexCount;
+        }
+        slot.model.reset();
+        slot.mesh.reset();
+        slot.vertexOffset = 0;
+        slot.vertexCount = 0;
+    }
+
+    void GPUScene::AllocateVertices(RenderableSlot &slot) {
+        slot.vertexCount = slot.mesh->VertexCount();
+        if (slot.vertexCount == 0) return;
+        liveVertexCount += slot.vertexCount;
+
+        auto it = freeVertexRanges.find(slot.vertexCount);
+        if (it != freeVertexRanges.end() && !it->second.empty()) {
+            slot.vertexOffset = it->second.back();
+            it->second.pop_back();
+        } else {
+            slot.vertexOffset = vertexCount;
+            vertexCount += slot.vertexCount;
+        }
+    }
+
+    void GPUScene::CompactVertices() {
+        ZoneScoped;
+        freeVertexRanges.clear();
+        vertexCount = 0;
+        for (auto &slot : slots) {
+            if (slot.vertexCount == 0) continue;
+            slot.vertexOffset = vertexCount;
+            vertexCount += slot.vertexCount;
+        }
+    }
+
     shared_ptr<Mesh> GPUScene::LoadMesh(const std::shared_ptr<const sp::Gltf> &model, size_t meshIndex) {
         if (meshIndex >= model->meshes.size()) return nullptr;
         auto vkMesh = activeMeshes.Load(MeshKeyView{model->name, meshIndex});
@@ -152,16 +372,178 @@ namespace sp::vulkan {
     void GPUScene::FlushMeshes() {
         activeMeshes.Tick(std::chrono::milliseconds(33));
 
+        erase_if(inFlightMeshUploads, [](auto &mesh) {
+            return !mesh->staging.transferComplete || mesh->staging.transferComplete->Ready();
+        });
+
         for (int i = (int)meshesToLoad.size() - 1; i >= 0; i--) {
             auto &[model, meshIndex] = meshesToLoad[i];
             if (activeMeshes.Contains(MeshKeyView{model->name, meshIndex})) {
                 meshesToLoad.pop_back();
                 continue;
             }
+            if (meshBuffersWaiting || !ReserveMeshSpace(*model, meshIndex)) break;
 
-            activeMeshes.Register(MeshKey{model->name, meshIndex}, make_shared<Mesh>(model, meshIndex, *this, device));
+            // Buffers are allocated here since sub-allocation isn't thread safe, the vertex data is decoded by workers
+            auto mesh = make_shared<Mesh>(model, meshIndex, *this, device);
+            // pendingMeshUploads keeps the mesh alive until decoding completes, so it is always freed on this thread
+            mesh->staging.decodeComplete = meshDecodeQueue.Dispatch<void>([mesh = mesh.get(), meshIndex = meshIndex]() {
+                mesh->Decode(meshIndex);
+            });
+            activeMeshes.Register(MeshKey{model->name, meshIndex}, mesh);
+            pendingMeshUploads.emplace_back(mesh);
             meshesToLoad.pop_back();
         }
+
+        // Uploads into reallocated mesh buffers must not overlap the copies into them
+        if (meshBuffersMoved && !meshBuffersMoved->Ready()) return;
+
+        size_t uploadBudget = CVarMeshUploadBudget.Get();
+        size_t uploadedBytes = 0;
+        auto it = pendingMeshUploads.begin();
+        while (it != pendingMeshUploads.end()) {
+            auto &mesh = *it;
+            if (!mesh->staging.decodeComplete->Ready()) {
+                it++;
+                continue;
+            }
+            size_t meshBytes = mesh->StagingBytes();
+            if (uploadedBytes > 0 && uploadedBytes + meshBytes > uploadBudget) break;
+
+            mesh->SubmitTransfer(device);
+            uploadedBytes += meshBytes;
+            inFlightMeshUploads.emplace_back(mesh);
+            it = pendingMeshUploads.erase(it);
+        }
+
+        size_t capacityBytes = 0, liveBytes = 0;
+        for (auto *buffer : MeshBuffers()) {
+            capacityBytes += buffer->Capacity() * buffer->ArrayStride();
+            liveBytes += buffer->LiveCount() * buffer->ArrayStride();
+        }
+        TracyPlot("MeshBufferCapacityBytes", (int64_t)capacityBytes);
+        TracyPlot("MeshBufferLiveBytes", (int64_t)liveBytes);
+    }
+
+    bool GPUScene::ReserveMeshSpace(const sp::Gltf &model, size_t meshIndex) {
+        auto &mesh = model.meshes[meshIndex];
+        if (!mesh) return true; // The Mesh constructor reports the error
+        size_t indexCount = 0, vertexCount = 0, jointsCount = 0;
+        for (auto &primitive : mesh->primitives) {
+            indexCount += primitive.indexBuffer.Count();
+            vertexCount += primitive.positionBuffer.Count();
+            jointsCount += primitive.jointsBuffer.Count();
+        }
+        // Every buffer is checked so that a single reallocation grows all of the ones that are full
+        bool fits = indexBuffer.Reserve(indexCount);
+        fits &= vertexBuffer.Reserve(vertexCount);
+        if (jointsCount > 0) fits &= jointsBuffer.Reserve(jointsCount);
+        fits &= primitiveLists.Reserve(mesh->primitives.size());
+        fits &= models.Reserve(1);
+        return fits;
+    }
+
+    std::array<PagedBuffer *, 5> GPUScene::MeshBuffers() {
+        return {&indexBuffer, &vertexBuffer, &jointsBuffer, &primitiveLists, &models};
+    }
+
+    void GPUScene::ReallocateMeshBuffers() {
+        meshBufferCopies.clear();
+        primitiveTableUploads.clear();
+        modelTableUploads.clear();
+
+        bool grow = false, compact = false;
+        for (auto *buffer : MeshBuffers()) {
+            grow |= buffer->NeedsGrowth();
+            // Only compact once at least a page can be reclaimed, so small tables aren't constantly moved
+            if (CVarMeshBufferCompaction.Get() && buffer->FragmentedCount() >= buffer->PageSize()) {
+                compact |= buffer->Fragmentation() > CVarMeshBufferFragmentation.Get();
+            }
+        }
+        meshBuffersWaiting = grow || compact;
+        if (!meshBuffersWaiting) return;
+
+        // Mesh data is copied on the graphics queue, so no transfers into the mesh buffers can be pending.
+        // New meshes aren't loaded while waiting, so this eventually succeeds.
+        if (!pendingMeshUploads.empty() || !inFlightMeshUploads.empty()) return;
+        if (meshBuffersMoved && !meshBuffersMoved->Ready()) return;
+        ZoneScoped;
+        meshBuffersWaiting = false;
+
+        vector<BufferPtr> oldBuffers;
+        for (auto *buffer : MeshBuffers()) {
+            if (!compact && !buffer->NeedsGrowth()) continue;
+            auto &copy = meshBufferCopies.emplace_back();
+            copy.src = buffer->Reallocate(compact, copy.regions);
+            copy.dst = buffer->Get();
+            // Compaction changes mesh offsets, so the tables are rebuilt below instead of being copied
+            if (compact && (buffer == &primitiveLists || buffer == &models)) copy.regions.clear();
+            oldBuffers.emplace_back(copy.src);
+        }
+
+        if (compact) {
+            primitiveTableUploads.resize(primitiveLists.LiveCount());
+            modelTableUploads.resize(models.LiveCount());
+            for (auto *mesh : liveMeshes) {
+                mesh->WriteTables(&primitiveTableUploads[mesh->primitiveList->ArrayOffset()],
+                    &modelTableUploads[mesh->modelEntry->ArrayOffset()]);
+            }
+        }
+        Debugf("%s mesh buffers (%u meshes)", compact ? "Compacting" : "Growing", liveMeshes.size());
+
+        // The old buffers are read by this frame's copies, and uploads into the new ones must wait for them
+        meshBuffersMoved = make_shared<Async<void>>();
+        device.ExecuteAfterFrameFence([oldBuffers, moved = meshBuffersMoved]() {
+            moved->Set(nullptr);
+        });
+    }
+
+    void GPUScene::CopyMeshBuffers(rg::Resources &resources, CommandContext &cmd) {
+        ZoneScoped;
+        for (auto &copy : meshBufferCopies) {
+            if (!copy.regions.empty()) cmd.Raw().copyBuffer(*copy.src, *copy.dst, copy.regions);
+        }
+        if (!modelTableUploads.empty()) {
+            auto primitiveTable = resources.GetBuffer("MeshPrimitiveTable");
+            primitiveTable->CopyFrom(primitiveTableUploads.data(), primitiveTableUploads.size());
+            cmd.Raw().copyBuffer(*primitiveTable,
+                *primitiveLists.Get(),
+                {vk::BufferCopy(0, 0, primitiveTableUploads.size() * sizeof(GPUMeshPrimitive))});
+
+            auto modelTable = resources.GetBuffer("MeshModelTable");
+            modelTable->CopyFrom(modelTableUploads.data(), modelTableUploads.size());
+            cmd.Raw().copyBuffer(*modelTable,
+                *models.Get(),
+                {vk::BufferCopy(0, 0, modelTableUploads.size() * sizeof(GPUMeshModel))});
+        }
+
+        vk::MemoryBarrier barrier;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eIndexRead |
+                                vk::AccessFlagBits::eVertexAttributeRead;
+        cmd.Raw().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader |
+                vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            {barrier},
+            {},
+            {});
+    }
+
+    void GPUScene::LogMeshBufferStats() {
+        static const std::array<const char *, 5> names = {"Indexes", "Vertices", "Joints", "Primitives", "Models"};
+        auto buffers = MeshBuffers();
+        Logf("Mesh buffers (%u meshes):", liveMeshes.size());
+        for (size_t i = 0; i < buffers.size(); i++) {
+            auto *buffer = buffers[i];
+            Logf("  %s: %u/%u live, %u free ranges, %.1f%% fragmented, %.2f MiB",
+                names[i],
+                buffer->LiveCount(),
+                buffer->Capacity(),
+                buffer->FreeRangeCount(),
+                buffer->Fragmentation() * 100.0f,
+                buffer->Capacity() * buffer->ArrayStride() / (1024.0 * 1024.0));
+        }
     }
 
     GPUScene::DrawBufferIDs GPUScene::GenerateDrawsForView(rg::RenderGraph &graph,
@@ -186,7 +568,6 @@ namespace sp::vulkan {
                         cmd.Raw().fillBuffer(*drawBuffer, 0, sizeof(uint32), 0);
                     });
 
-                builder.Read("RenderableEntities", Access::ComputeShaderReadStorage);
                 builder.Read(bufferIDs.drawCommandsBuffer, Access::ComputeShaderReadStorage);
                 builder.Write(bufferIDs.drawCommandsBuffer, Access::ComputeShaderWrite);
 
@@ -197,9 +578,9 @@ namespace sp::vulkan {
             })
             .Execute([this, viewMask, bufferIDs, instanceCount](rg::Resources &resources, CommandContext &cmd) {
                 cmd.SetComputeShader("generate_draws_for_view.comp");
-                cmd.SetStorageBuffer(0, 0, resources.GetBuffer("RenderableEntities"));
-                cmd.SetStorageBuffer(0, 1, models);
-                cmd.SetStorageBuffer(0, 2, primitiveLists);
+                cmd.SetStorageBuffer(0, 0, renderableEntities);
+                cmd.SetStorageBuffer(0, 1, models.Get());
+                cmd.SetStorageBuffer(0, 2, primitiveLists.Get());
                 cmd.SetStorageBuffer(0, 3, resources.GetBuffer(bufferIDs.drawCommandsBuffer));
                 cmd.SetStorageBuffer(0, 4, resources.GetBuffer(bufferIDs.drawParamsBuffer));
 
@@ -223,6 +604,40 @@ namespace sp::vulkan {
         ecs::VisibilityMask viewMask,
         bool reverseSort,
         uint32 instanceCount) {
+        SortedDrawView sortedView;
+        sortedView.position = viewPosition;
+        return AddSortedDrawsPass(graph, sortedView, viewMask, reverseSort, instanceCount);
+    }
+
+    GPUScene::DrawBufferIDs GPUScene::GenerateSortedDrawsForView(rg::RenderGraph &graph,
+        const ecs::View &view,
+        ecs::VisibilityMask viewMask,
+        bool reverseSort,
+        uint32 instanceCount) {
+        SortedDrawView sortedView;
+        sortedView.position = view.invViewMat * glm::vec4(0, 0, 0, 1);
+        sortedView.cull = true;
+
+        // Side planes of the clip volume, extracted from the view-projection matrix rows
+        auto viewProj = view.projMat * view.viewMat;
+        auto rowW = glm::row(viewProj, 3);
+        sortedView.frustumPlanes = {
+            rowW + glm::row(viewProj, 0),
+            rowW - glm::row(viewProj, 0),
+            rowW + glm::row(viewProj, 1),
+            rowW - glm::row(viewProj, 1),
+        };
+        for (auto &plane : sortedView.frustumPlanes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return AddSortedDrawsPass(graph, sortedView, viewMask, reverseSort, instanceCount);
+    }
+
+    GPUScene::DrawBufferIDs GPUScene::AddSortedDrawsPass(rg::RenderGraph &graph,
+        const SortedDrawView &view,
+        ecs::VisibilityMask viewMask,
+        bool reverseSort,
+        uint32 instanceCount) {
         DrawBufferIDs bufferIDs;
 
         graph.AddPass("GenerateSortedDrawsForView")
@@ -239,75 +654,146 @@ namespace sp::vulkan {
                     Access::HostWrite);
                 bufferIDs.drawParamsBuffer = drawParams.id;
             })
-            .Execute([this, viewMask, viewPosition, bufferIDs, instanceCount, reverseSort](rg::Resources &resources,
+            .Execute([this, viewMask, view, bufferIDs, instanceCount, reverseSort](rg::Resources &resources,
                          CommandContext &cmd) {
-                static InlineVector<VkDrawIndexedIndirectCommand, 256 * 1024> drawCommands;
-                static InlineVector<GPUDrawParams, 256 * 1024> drawParams;
-                static InlineVector<float, 256 * 1024> primitiveDepth;
-                drawCommands.clear();
-                drawParams.clear();
-                primitiveDepth.clear();
-
-                for (size_t i = 0; i < renderables.size(); i++) {
-                    auto &renderable = renderables[i];
-                    if (((ecs::VisibilityMask)renderable.visibilityMask & viewMask) != viewMask) continue;
-
-                    auto mesh = meshes[i].lock();
-                    if (!mesh || !mesh->CheckReady()) continue;
-
-                    for (auto &primitive : mesh->primitives) {
-                        auto &drawCmd = drawCommands.emplace_back();
-
-                        drawCmd.indexCount = primitive.indexCount;
-                        drawCmd.instanceCount = instanceCount;
-                        drawCmd.firstIndex = mesh->indexBuffer->ArrayOffset() + primitive.indexOffset;
-                        drawCmd.vertexOffset = renderable.vertexOffset + primitive.vertexOffset;
-
-                        drawCmd.firstInstance = drawParams.size();
-                        auto &drawParam = drawParams.emplace_back();
-
-                        drawParam.baseColorTexID = renderable.baseColorOverrideID >= 0 ? renderable.baseColorOverrideID
-                                                                                       : primitive.baseColor.index;
-                        drawParam.metallicRoughnessTexID = renderable.metallicRoughnessOverrideID >= 0
-                                                               ? renderable.metallicRoughnessOverrideID
-                                                               : primitive.metallicRoughness.index;
-                        drawParam.opticID = renderable.opticID;
-                        drawParam.emissiveScale = renderable.emissiveScale;
-
-                        auto worldPos = renderable.modelToWorld * glm::vec4(primitive.center, 1);
-                        auto relPos = (glm::vec3(worldPos) / worldPos.w) - viewPosition;
-                        primitiveDepth.push_back(glm::length(relPos));
+                size_t workerCount = CVarSortedDrawThreads.Get();
+                if (!drawQueue || drawWorkerCount != workerCount) {
+                    drawQueue = make_unique<DispatchQueue>("SortedDraws",
+                        workerCount,
+                        std::chrono::milliseconds(5),
+                        DispatchScheduler::WorkStealing);
+                    drawWorkerCount = workerCount;
+                }
+
+                // Split the renderables into one chunk per worker, plus one for the render thread
+                size_t chunkCount = std::clamp(renderables.size() / MIN_SORTED_DRAW_CHUNK, size_t(1), workerCount + 1);
+                size_t chunkSize = (renderables.size() + chunkCount - 1) / chunkCount;
+                sortedDrawChunks.resize(chunkCount);
+
+                std::vector<AsyncPtr<void>> pending;
+                for (size_t i = 1; i < chunkCount; i++) {
+                    pending.emplace_back(drawQueue->Dispatch<void>(DispatchOptions{DispatchPriority::FrameCritical},
+                        [&, i] {
+                            GenerateSortedDrawChunk(sortedDrawChunks[i],
+                                i * chunkSize,
+                                std::min((i + 1) * chunkSize, renderables.size()),
+                                view,
+                                viewMask,
+                                reverseSort,
+                                instanceCount);
+                        }));
+                }
+                GenerateSortedDrawChunk(sortedDrawChunks[0],
+                    0,
+                    std::min(chunkSize, renderables.size()),
+                    view,
+                    viewMask,
+                    reverseSort,
+                    instanceCount);
+                for (auto &future : pending) {
+                    future->Get();
+                }
+
+                // Chunks are concatenated in renderable order, so the output doesn't depend on the thread count
+                auto paramsBuffer = resources.GetBuffer(bufferIDs.drawParamsBuffer);
+                GPUDrawParams *paramsBufferPtr = nullptr;
+                paramsBuffer->Map((void **)&paramsBufferPtr);
+                sortedDraws.clear();
+                for (auto &chunk : sortedDrawChunks) {
+                    uint32 paramsOffset = sortedDraws.size();
+                    std::copy_n(chunk.params.data(), chunk.params.size(), paramsBufferPtr + paramsOffset);
+                    for (auto &draw : chunk.draws) {
+                        auto &sortedDraw = sortedDraws.emplace_back(draw);
+                        sortedDraw.command.firstInstance += paramsOffset;
                     }
                 }
+                paramsBuffer->Unmap();
+                paramsBuffer->Flush();
 
-                if (reverseSort) {
-                    // Sort primitives farthest first
-                    std::sort(drawCommands.begin(), drawCommands.end(), [&](auto a, auto b) {
-                        return primitiveDepth[a.firstInstance] > primitiveDepth[b.firstInstance];
-                    });
-                } else {
-                    // Sort primitives nearest first
-                    std::sort(drawCommands.begin(), drawCommands.end(), [&](auto a, auto b) {
-                        return primitiveDepth[a.firstInstance] < primitiveDepth[b.firstInstance];
+                {
+                    ZoneScopedN("RadixSort");
+                    RadixSort(sortedDraws, sortedDrawScratch, [](const SortedDraw &draw) {
+                        return draw.key;
                     });
                 }
 
                 auto commandsBuffer = resources.GetBuffer(bufferIDs.drawCommandsBuffer);
                 uint32_t *cmdBufferPtr = nullptr;
                 commandsBuffer->Map((void **)&cmdBufferPtr);
-                cmdBufferPtr[0] = drawCommands.size();
-                std::copy_n(drawCommands.data(),
-                    drawCommands.size(),
-                    reinterpret_cast<VkDrawIndexedIndirectCommand *>(cmdBufferPtr + 1));
+                cmdBufferPtr[0] = sortedDraws.size();
+                auto *drawCommands = reinterpret_cast<VkDrawIndexedIndirectCommand *>(cmdBufferPtr + 1);
+                for (size_t i = 0; i < sortedDraws.size(); i++) {
+                    drawCommands[i] = sortedDraws[i].command;
+                }
                 commandsBuffer->Unmap();
                 commandsBuffer->Flush();
-
-                auto paramsBuffer = resources.GetBuffer(bufferIDs.drawParamsBuffer);
-                paramsBuffer->CopyFrom(drawParams.data(), drawParams.size());
             });
         return bufferIDs;
     }
 
+    void GPUScene::GenerateSortedDrawChunk(SortedDrawChunk &chunk,
+        size_t begin,
+        size_t end,
+        const SortedDrawView &view,
+        ecs::VisibilityMask viewMask,
+        bool reverseSort,
+        uint32 instanceCount) const {
+        ZoneScoped;
+        chunk.draws.clear();
+        chunk.params.clear();
+
+        for (size_t i = begin; i < end; i++) {
+            auto &mesh = slots[i].mesh;
+            if (!mesh) continue;
+
+            auto &renderable = renderables[i];
+            if (((ecs::VisibilityMask)renderable.visibilityMask & viewMask) != viewMask) continue;
+
+            float scale = std::max({glm::length(glm::vec3(renderable.modelToWorld[0])),
+                glm::length(glm::vec3(renderable.modelToWorld[1])),
+                glm::length(glm::vec3(renderable.modelToWorld[2]))});
+
+            for (auto &primitive : mesh->primitives) {
+                auto worldPos = renderable.modelToWorld * glm::vec4(primitive.center, 1);
+                auto center = glm::vec3(worldPos) / worldPos.w;
+                if (view.cull) {
+                    float radius = primitive.radius * scale;
+                    bool outside = false;
+                    for (auto &plane : view.frustumPlanes) {
+                        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                            outside = true;
+                            break;
+                        }
+                    }
+                    if (outside) continue;
+                }
+
+                auto &draw = chunk.draws.emplace_back();
+                auto &drawCmd = draw.command;
+                drawCmd.indexCount = primitive.indexCount;
+                drawCmd.instanceCount = instanceCount;
+                drawCmd.firstIndex = mesh->indexBuffer->ArrayOffset() + primitive.indexOffset;
+                drawCmd.vertexOffset = renderable.vertexOffset + primitive.vertexOffset;
+                drawCmd.firstInstance = chunk.params.size();
+
+                auto &drawParam = chunk.params.emplace_back();
+                drawParam.baseColorTexID = renderable.baseColorOverrideID >= 0 ? renderable.baseColorOverrideID
+                                                                               : primitive.baseColor.index;
+                drawParam.metallicRoughnessTexID = renderable.metallicRoughnessOverrideID >= 0
+                                                       ? renderable.metallicRoughnessOverrideID
+                                                       : primitive.metallicRoughness.index;
+                drawParam.opticID = renderable.opticID;
+                drawParam.emissiveScale = renderable.emissiveScale;
+
+                // Equal depths are grouped by material to reduce descriptor changes between adjacent draws
+                uint32 depthBits = OrderedFloatBits(glm::length(center - view.position));
+                if (reverseSort) depthBits = ~depthBits;
+                uint32 materialBits = ((uint32)drawParam.baseColorTexID << 16) | drawParam.metallicRoughnessTexID;
+                draw.key = ((uint64)depthBits << 32) | materialBits;
+            }
+        }
+    }
+
     void GPUScene::DrawSceneIndirect(CommandContext &cmd,
         BufferPtr vertexBuffer,
         BufferPtr drawCommandsBuffer,
@@ -317,7 +803,7 @@ namespace sp::vulkan {
         cmd.SetBindlessDescriptors(2, textures.GetDescriptorSet());
 
         cmd.SetVertexLayout(SceneVertex::Layout());
-        cmd.Raw().bindIndexBuffer(*indexBuffer, 0, vk::IndexType::eUint32);
+        cmd.Raw().bindIndexBuffer(*indexBuffer.Get(), 0, vk::IndexType::eUint32);
         cmd.Raw().bindVertexBuffers(0, {*vertexBuffer}, {0});
 
         if (drawParamsBuffer) cmd.SetStorageBuffer(1, 0, drawParamsBuffer);
@@ -344,7 +830,6 @@ namespace sp::vulkan {
                         cmd.Raw().fillBuffer(*resources.GetBuffer("WarpedVertexDrawCmds"), 0, sizeof(uint32), 0);
                     });
 
-                builder.Read("RenderableEntities", Access::ComputeShaderReadStorage);
                 builder.Read("WarpedVertexDrawCmds", Access::ComputeShaderReadStorage);
                 builder.Write("WarpedVertexDrawCmds", Access::ComputeShaderWrite);
 
@@ -357,9 +842,9 @@ namespace sp::vulkan {
                 if (vertexCount == 0) return;
 
                 cmd.SetComputeShader("generate_warp_geometry_draws.comp");
-                cmd.SetStorageBuffer(0, 0, resources.GetBuffer("RenderableEntities"));
-                cmd.SetStorageBuffer(0, 1, models);
-                cmd.SetStorageBuffer(0, 2, primitiveLists);
+                cmd.SetStorageBuffer(0, 0, renderableEntities);
+                cmd.SetStorageBuffer(0, 1, models.Get());
+                cmd.SetStorageBuffer(0, 2, primitiveLists.Get());
                 cmd.SetStorageBuffer(0, 3, resources.GetBuffer("WarpedVertexDrawCmds"));
                 cmd.SetStorageBuffer(0, 4, resources.GetBuffer("WarpedVertexDrawParams"));
 
@@ -394,11 +879,11 @@ namespace sp::vulkan {
                 cmd.SetStorageBuffer(0, 0, paramBuffer);
                 cmd.SetStorageBuffer(0, 1, warpedVertexBuffer);
                 cmd.SetUniformBuffer(0, 2, resources.GetBuffer("JointPoses"));
-                cmd.SetStorageBuffer(0, 3, jointsBuffer);
+                cmd.SetStorageBuffer(0, 3, jointsBuffer.Get());
 
                 cmd.SetVertexLayout(SceneVertex::Layout());
                 cmd.SetPrimitiveTopology(vk::PrimitiveTopology::ePointList);
-                cmd.Raw().bindVertexBuffers(0, {*vertexBuffer}, {0});
+                cmd.Raw().bindVertexBuffers(0, {*vertexBuffer.Get()}, {0});
                 cmd.DrawIndirect(cmdBuffer, sizeof(uint32), primitiveCount);
                 cmd.EndRenderPass();
             });
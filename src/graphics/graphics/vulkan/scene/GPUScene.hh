@@ -9,16 +9,23 @@
 
 #include "assets/Async.hh"
 #include "assets/Gltf.hh"
+#include "console/CFunc.hh"
 #include "core/DispatchQueue.hh"
+#include "core/EntityMap.hh"
 #include "core/Hashing.hh"
 #include "core/PreservingMap.hh"
+#include "ecs/Ecs.hh"
 #include "ecs/components/View.hh"
 #include "graphics/vulkan/core/Image.hh"
 #include "graphics/vulkan/core/Memory.hh"
+#include "graphics/vulkan/core/PagedBuffer.hh"
 #include "graphics/vulkan/core/VkCommon.hh"
 #include "graphics/vulkan/render_graph/RenderGraph.hh"
 #include "graphics/vulkan/scene/TextureSet.hh"
 
+#include <array>
+#include <robin_hood.h>
+
 namespace sp::vulkan {
     class Mesh;
 
@@ -58,16 +65,19 @@ namespace sp::vulkan {
     };
     static_assert(sizeof(GPUMeshModel) % sizeof(uint32) == 0, "std430 alignment");
 
+    // A default constructed renderable is an unused slot, and is skipped by the draw generation shaders
     struct GPURenderableEntity {
-        glm::mat4 modelToWorld;
-        uint32_t meshIndex;
-        uint32_t visibilityMask;
-        uint32_t vertexOffset;
+        glm::mat4 modelToWorld = glm::mat4(0);
+        uint32_t meshIndex = 0xffffffff;
+        uint32_t visibilityMask = 0;
+        uint32_t vertexOffset = 0;
         uint32_t jointPosesOffset = 0xffffffff;
         uint32_t opticID = 0;
         float emissiveScale = 0;
         int32_t baseColorOverrideID = -1;
         int32_t metallicRoughnessOverrideID = -1;
+
+        bool operator==(const GPURenderableEntity &) const = default;
     };
     static_assert(sizeof(GPURenderableEntity) % sizeof(glm::vec4) == 0, "std430 alignment");
 
@@ -107,6 +117,13 @@ namespace sp::vulkan {
             bool reverseSort = false,
             uint32 instanceCount = 1);
 
+        // Same as above, but primitives outside the view's frustum are culled.
+        DrawBufferIDs GenerateSortedDrawsForView(rg::RenderGraph &graph,
+            const ecs::View &view,
+            ecs::VisibilityMask viewMask,
+            bool reverseSort = false,
+            uint32 instanceCount = 1);
+
         void DrawSceneIndirect(CommandContext &cmd,
             BufferPtr vertexBuffer,
             BufferPtr drawCommandsBuffer,
@@ -114,11 +131,13 @@ namespace sp::vulkan {
 
         void AddGeometryWarp(rg::RenderGraph &graph);
 
-        BufferPtr indexBuffer;
-        BufferPtr vertexBuffer;
-        BufferPtr jointsBuffer;
-        BufferPtr primitiveLists;
-        BufferPtr models;
+        // Mesh data buffers, these grow as meshes are loaded and may be replaced when they are compacted.
+        PagedBuffer indexBuffer;
+        PagedBuffer vertexBuffer;
+        PagedBuffer jointsBuffer;
+        PagedBuffer primitiveLists;
+        PagedBuffer models;
+        BufferPtr renderableEntities; // Persistent renderable slots, only dirty slots are uploaded each frame
 
         struct OpticInstance {
             ecs::Entity ent;
@@ -130,11 +149,11 @@ namespace sp::vulkan {
             bool operator==(const OpticInstance &) const = default;
         };
 
-        uint32 renderableCount = 0;
+        uint32 renderableCount = 0; // Number of renderable slots in use, including free slots
         std::vector<OpticInstance> opticEntities;
         std::vector<glm::mat4> jointPoses;
 
-        uint32 vertexCount = 0;
+        uint32 vertexCount = 0; // Size of the warped vertex buffer, including free vertex ranges
         uint32 primitiveCount = 0;
         uint32 primitiveCountPowerOfTwo = 1; // Always at least 1. Used to size draw command buffers.
 
@@ -142,6 +161,11 @@ namespace sp::vulkan {
 
     private:
         void FlushMeshes();
+        bool ReserveMeshSpace(const sp::Gltf &model, size_t meshIndex);
+        std::array<PagedBuffer *, 5> MeshBuffers();
+        void ReallocateMeshBuffers();
+        void CopyMeshBuffers(rg::Resources &resources, CommandContext &cmd);
+        void LogMeshBufferStats();
         struct MeshKey {
             std::string modelName;
             size_t meshIndex;
@@ -179,9 +203,102 @@ namespace sp::vulkan {
             }
         };
 
+        struct SortedDraw {
+            uint64 key; // depth in the upper 32 bits, material texture IDs in the lower 32 bits
+            VkDrawIndexedIndirectCommand command;
+        };
+
+        struct SortedDrawChunk {
+            vector<SortedDraw> draws;
+            vector<GPUDrawParams> params;
+        };
+
+        struct SortedDrawView {
+            glm::vec3 position;
+            bool cull = false;
+            std::array<glm::vec4, 4> frustumPlanes; // left, right, bottom, top
+        };
+
+        DrawBufferIDs AddSortedDrawsPass(rg::RenderGraph &graph,
+            const SortedDrawView &view,
+            ecs::VisibilityMask viewMask,
+            bool reverseSort,
+            uint32 instanceCount);
+        void GenerateSortedDrawChunk(SortedDrawChunk &chunk,
+            size_t begin,
+            size_t end,
+            const SortedDrawView &view,
+            ecs::VisibilityMask viewMask,
+            bool reverseSort,
+            uint32 instanceCount) const;
+
+        unique_ptr<DispatchQueue> drawQueue;
+        size_t drawWorkerCount = 0;
+        vector<SortedDrawChunk> sortedDrawChunks;
+        vector<SortedDraw> sortedDraws, sortedDrawScratch;
+
+        robin_hood::unordered_flat_set<Mesh *> liveMeshes; // Every mesh with data in the mesh buffers
+
+        struct MeshBufferCopy {
+            BufferPtr src, dst;
+            vector<vk::BufferCopy> regions;
+        };
+
+        // Set while the mesh buffers need to grow or be compacted, which pauses mesh loading
+        bool meshBuffersWaiting = false;
+        AsyncPtr<void> meshBuffersMoved; // Resolves once the last reallocation's copies have completed
+        vector<MeshBufferCopy> meshBufferCopies;
+        vector<GPUMeshPrimitive> primitiveTableUploads;
+        vector<GPUMeshModel> modelTableUploads;
+
+        CFuncCollection funcs;
+        bool printMeshBufferStats = false;
+
         PreservingMap<MeshKey, Mesh, 10000, MeshKeyHash, MeshKeyEqual> activeMeshes;
         vector<std::pair<std::shared_ptr<const sp::Gltf>, size_t>> meshesToLoad;
-        vector<GPURenderableEntity> renderables;
-        vector<std::weak_ptr<Mesh>> meshes;
+        vector<shared_ptr<Mesh>> pendingMeshUploads; // Meshes waiting to be decoded or to fit in the upload budget
+        vector<shared_ptr<Mesh>> inFlightMeshUploads; // Meshes with transfers that haven't completed yet
+        // Declared after the mesh lists so in-flight decodes are stopped before they are destroyed
+        DispatchQueue meshDecodeQueue;
+
+        struct RenderableSlot {
+            ecs::Entity ent;
+            sp::AsyncPtr<sp::Gltf> model;
+            size_t meshIndex = 0;
+            shared_ptr<Mesh> mesh; // Only set once the mesh is ready to draw
+
+            uint32 vertexOffset = 0, vertexCount = 0;
+
+            glm::vec4 colorOverride = glm::vec4(-1);
+            glm::vec2 metallicRoughnessOverride = glm::vec2(-1);
+            int32_t baseColorOverrideID = -1;
+            int32_t metallicRoughnessOverrideID = -1;
+        };
+
+        void AllocateSlot(ecs::Entity ent);
+        void FreeSlot(uint32 slotIndex);
+        void ReleaseSlotMesh(RenderableSlot &slot);
+        void AllocateVertices(RenderableSlot &slot);
+        void CompactVertices();
+        void UpdateSlot(
+            const ecs::Lock<ecs::Read<ecs::Renderable, ecs::OpticalElement, ecs::TransformSnapshot, ecs::Name>> &lock,
+            uint32 slotIndex);
+        void UploadRenderables(rg::RenderGraph &graph);
+
+        ecs::ComponentObserver<ecs::Renderable> renderableObserver;
+        EntityMap<uint32> slotIndexes;
+        vector<RenderableSlot> slots;
+        vector<GPURenderableEntity> renderables; // CPU copy of the renderableEntities buffer
+        vector<uint32> freeSlots;
+        vector<uint32> dirtySlots;
+
+        // Free vertex ranges in the warped vertex buffer, keyed by vertex count
+        std::map<uint32, vector<uint32>> freeVertexRanges;
+        uint32 liveVertexCount = 0;
+
+        vector<GPURenderableEntity> renderableUploads;
+        vector<vk::BufferCopy> renderableUploadRegions;
+
+        friend class Mesh;
     };
 } // namespace sp::vulkan
@@ -18,7 +18,7 @@
 
 namespace sp::vulkan {
     Mesh::Mesh(std::shared_ptr<const sp::Gltf> source, size_t meshIndex, GPUScene &scene, DeviceContext &device)
-        : modelName(source->name), asset(source) {
+        : modelName(source->name), asset(source), scene(scene) {
         ZoneScoped;
         ZonePrintf("%s.%u", modelName, meshIndex);
 
@@ -31,38 +31,37 @@ namespace sp::vulkan {
             jointsCount += assetPrimitive.jointsBuffer.Count();
         }
 
-        indexBuffer = scene.indexBuffer->ArrayAllocate(indexCount);
+        // GPUScene reserves space in each of its mesh buffers before constructing a mesh
+        indexBuffer = scene.indexBuffer.ArrayAllocate(indexCount);
+        vertexBuffer = scene.vertexBuffer.ArrayAllocate(vertexCount);
+        if (jointsCount > 0) jointsBuffer = scene.jointsBuffer.ArrayAllocate(jointsCount);
+        primitiveList = scene.primitiveLists.ArrayAllocate(mesh->primitives.size());
+        modelEntry = scene.models.ArrayAllocate(1);
+        Assertf(indexBuffer && vertexBuffer && (jointsCount == 0 || jointsBuffer) && primitiveList && modelEntry,
+            "Mesh buffers were not reserved: %s.%u",
+            modelName,
+            meshIndex);
+        scene.liveMeshes.emplace(this);
+
         staging.indexBuffer = device.AllocateBuffer({sizeof(uint32), indexCount},
             vk::BufferUsageFlagBits::eTransferSrc,
             VMA_MEMORY_USAGE_CPU_ONLY);
         Assertf(indexBuffer->ByteSize() == staging.indexBuffer->ByteSize(), "index staging buffer size mismatch");
 
-        auto indexData = (uint32 *)staging.indexBuffer->Mapped();
-        auto indexDataStart = indexData;
-
-        vertexBuffer = scene.vertexBuffer->ArrayAllocate(vertexCount);
         staging.vertexBuffer = device.AllocateBuffer({sizeof(SceneVertex), vertexCount},
             vk::BufferUsageFlagBits::eTransferSrc,
             VMA_MEMORY_USAGE_CPU_ONLY);
         Assertf(vertexBuffer->ByteSize() == staging.vertexBuffer->ByteSize(), "vertex staging buffer size mismatch");
 
-        auto vertexData = (SceneVertex *)staging.vertexBuffer->Mapped();
-        auto vertexDataStart = vertexData;
-
-        JointVertex *jointsData = nullptr, *jointsDataStart = nullptr;
-
         if (jointsCount > 0) {
-            jointsBuffer = scene.jointsBuffer->ArrayAllocate(jointsCount);
             staging.jointsBuffer = device.AllocateBuffer({sizeof(JointVertex), jointsCount},
                 vk::BufferUsageFlagBits::eTransferSrc,
                 VMA_MEMORY_USAGE_CPU_ONLY);
             Assertf(jointsBuffer->ByteSize() == staging.jointsBuffer->ByteSize(),
                 "joints staging buffer size mismatch");
-
-            jointsData = (JointVertex *)staging.jointsBuffer->Mapped();
-            jointsDataStart = jointsData;
         }
 
+        size_t indexOffset = 0, vertexOffset = 0, jointsOffset = 0;
         for (auto &assetPrimitive : mesh->primitives) {
             ZoneScopedN("CreatePrimitive");
             // TODO: this implementation assumes a lot about the model format,
@@ -73,36 +72,16 @@ namespace sp::vulkan {
             auto &vkPrimitive = primitives.emplace_back();
 
             vkPrimitive.indexCount = assetPrimitive.indexBuffer.Count();
-            vkPrimitive.indexOffset = indexData - indexDataStart;
-
-            for (size_t i = 0; i < vkPrimitive.indexCount; i++) {
-                *indexData++ = assetPrimitive.indexBuffer.Read(i);
-            }
+            vkPrimitive.indexOffset = indexOffset;
+            indexOffset += vkPrimitive.indexCount;
 
             vkPrimitive.vertexCount = assetPrimitive.positionBuffer.Count();
-            vkPrimitive.vertexOffset = vertexData - vertexDataStart;
+            vkPrimitive.vertexOffset = vertexOffset;
+            vertexOffset += vkPrimitive.vertexCount;
 
             vkPrimitive.jointsVertexCount = assetPrimitive.jointsBuffer.Count();
-            vkPrimitive.jointsVertexOffset = jointsData - jointsDataStart;
-
-            vkPrimitive.center = glm::vec3(0);
-            for (size_t i = 0; i < vkPrimitive.vertexCount; i++) {
-                SceneVertex &vertex = *vertexData++;
-
-                vertex.position = assetPrimitive.positionBuffer.Read(i);
-                if (i < assetPrimitive.normalBuffer.Count()) vertex.normal = assetPrimitive.normalBuffer.Read(i);
-                if (i < assetPrimitive.texcoordBuffer.Count()) vertex.uv = assetPrimitive.texcoordBuffer.Read(i);
-
-                if (jointsData && i < assetPrimitive.jointsBuffer.Count()) {
-                    Assert(i < assetPrimitive.weightsBuffer.Count(), "must have one weight per joint index");
-                    JointVertex &joints = *jointsData++;
-                    joints.jointIndexes = assetPrimitive.jointsBuffer.Read(i);
-                    joints.jointWeights = assetPrimitive.weightsBuffer.Read(i);
-                }
-
-                vkPrimitive.center += vertex.position;
-            }
-            vkPrimitive.center /= vkPrimitive.vertexCount;
+            vkPrimitive.jointsVertexOffset = jointsOffset;
+            if (jointsCount > 0) jointsOffset += std::min(vkPrimitive.vertexCount, vkPrimitive.jointsVertexCount);
 
             vkPrimitive.baseColor = scene.textures.LoadGltfMaterial(source,
                 assetPrimitive.materialIndex,
@@ -113,41 +92,107 @@ namespace sp::vulkan {
                 TextureType::MetallicRoughness);
         }
 
-        primitiveList = scene.primitiveLists->ArrayAllocate(primitives.size());
         staging.primitiveList = device.AllocateBuffer({sizeof(GPUMeshPrimitive), primitives.size()},
             vk::BufferUsageFlagBits::eTransferSrc,
             VMA_MEMORY_USAGE_CPU_ONLY);
         Assertf(primitiveList->ByteSize() == staging.primitiveList->ByteSize(),
             "primitive staging buffer size mismatch");
 
-        modelEntry = scene.models->ArrayAllocate(1);
         staging.modelEntry = device.AllocateBuffer({sizeof(GPUMeshModel)},
             vk::BufferUsageFlagBits::eTransferSrc,
             VMA_MEMORY_USAGE_CPU_ONLY);
         Assertf(modelEntry->ByteSize() == staging.modelEntry->ByteSize(), "model staging buffer size mismatch");
+    }
 
-        auto meshModel = (GPUMeshModel *)staging.modelEntry->Mapped();
-        auto gpuPrimitives = (GPUMeshPrimitive *)staging.primitiveList->Mapped();
-        {
-            ZoneScopedN("CopyPrimitives");
-            auto gpuPrim = gpuPrimitives;
-            for (auto &p : primitives) {
-                gpuPrim->indexCount = p.indexCount;
-                gpuPrim->vertexCount = p.vertexCount;
-                gpuPrim->firstIndex = p.indexOffset;
-                gpuPrim->vertexOffset = p.vertexOffset;
-                gpuPrim->jointsVertexOffset = p.jointsVertexCount > 0
-                                                  ? jointsBuffer->ArrayOffset() + p.jointsVertexOffset
-                                                  : 0xffffffff;
-                gpuPrim->baseColorTexID = p.baseColor.index;
-                gpuPrim->metallicRoughnessTexID = p.metallicRoughness.index;
-                gpuPrim++;
+    void Mesh::Decode(size_t meshIndex) {
+        ZoneScoped;
+        ZonePrintf("%s.%u", modelName, meshIndex);
+        auto &mesh = asset->meshes[meshIndex];
+
+        auto indexDataStart = (uint32 *)staging.indexBuffer->Mapped();
+        auto vertexDataStart = (SceneVertex *)staging.vertexBuffer->Mapped();
+        auto jointsDataStart = staging.jointsBuffer ? (JointVertex *)staging.jointsBuffer->Mapped() : nullptr;
+
+        for (size_t p = 0; p < primitives.size(); p++) {
+            auto &assetPrimitive = mesh->primitives[p];
+            auto &vkPrimitive = primitives[p];
+
+            assetPrimitive.indexBuffer.ReadRange(0, vkPrimitive.indexCount, indexDataStart + vkPrimitive.indexOffset);
+
+            // Each attribute is converted straight into the interleaved staging buffer
+            auto vertexData = vertexDataStart + vkPrimitive.vertexOffset;
+            size_t primitiveVertexCount = vkPrimitive.vertexCount;
+            assetPrimitive.positionBuffer.ReadRange(0,
+                primitiveVertexCount,
+                &vertexData->position,
+                sizeof(SceneVertex));
+            assetPrimitive.normalBuffer.ReadRange(0,
+                std::min(primitiveVertexCount, assetPrimitive.normalBuffer.Count()),
+                &vertexData->normal,
+                sizeof(SceneVertex));
+            assetPrimitive.texcoordBuffer.ReadRange(0,
+                std::min(primitiveVertexCount, assetPrimitive.texcoordBuffer.Count()),
+                &vertexData->uv,
+                sizeof(SceneVertex));
+
+            if (jointsDataStart) {
+                auto jointsData = jointsDataStart + vkPrimitive.jointsVertexOffset;
+                size_t jointsVertexCount = std::min(primitiveVertexCount, assetPrimitive.jointsBuffer.Count());
+                Assert(jointsVertexCount <= assetPrimitive.weightsBuffer.Count(),
+                    "must have one weight per joint index");
+                assetPrimitive.jointsBuffer.ReadRange(0,
+                    jointsVertexCount,
+                    &jointsData->jointIndexes,
+                    sizeof(JointVertex));
+                assetPrimitive.weightsBuffer.ReadRange(0,
+                    jointsVertexCount,
+                    &jointsData->jointWeights,
+                    sizeof(JointVertex));
+            }
+
+            vkPrimitive.center = glm::vec3(0);
+            for (size_t i = 0; i < primitiveVertexCount; i++) {
+                vkPrimitive.center += vertexData[i].position;
+            }
+            vkPrimitive.center /= vkPrimitive.vertexCount;
+
+            vkPrimitive.radius = 0.0f;
+            for (size_t i = 0; i < primitiveVertexCount; i++) {
+                vkPrimitive.radius = std::max(vkPrimitive.radius,
+                    glm::length(vertexData[i].position - vkPrimitive.center));
             }
-            meshModel->primitiveCount = primitives.size();
-            meshModel->primitiveOffset = primitiveList->ArrayOffset();
-            meshModel->indexOffset = indexBuffer->ArrayOffset();
-            meshModel->vertexOffset = vertexBuffer->ArrayOffset();
         }
+    }
+
+    size_t Mesh::StagingBytes() const {
+        size_t bytes = staging.indexBuffer->ByteSize() + staging.vertexBuffer->ByteSize() +
+                       staging.primitiveList->ByteSize() + staging.modelEntry->ByteSize();
+        if (staging.jointsBuffer) bytes += staging.jointsBuffer->ByteSize();
+        return bytes;
+    }
+
+    void Mesh::WriteTables(GPUMeshPrimitive *gpuPrimitives, GPUMeshModel *meshModel) const {
+        auto gpuPrim = gpuPrimitives;
+        for (auto &p : primitives) {
+            gpuPrim->indexCount = p.indexCount;
+            gpuPrim->vertexCount = p.vertexCount;
+            gpuPrim->firstIndex = p.indexOffset;
+            gpuPrim->vertexOffset = p.vertexOffset;
+            gpuPrim->jointsVertexOffset = p.jointsVertexCount > 0 ? jointsBuffer->ArrayOffset() + p.jointsVertexOffset
+                                                                  : 0xffffffff;
+            gpuPrim->baseColorTexID = p.baseColor.index;
+            gpuPrim->metallicRoughnessTexID = p.metallicRoughness.index;
+            gpuPrim++;
+        }
+        meshModel->primitiveCount = primitives.size();
+        meshModel->primitiveOffset = primitiveList->ArrayOffset();
+        meshModel->indexOffset = indexBuffer->ArrayOffset();
+        meshModel->vertexOffset = vertexBuffer->ArrayOffset();
+    }
+
+    void Mesh::SubmitTransfer(DeviceContext &device) {
+        // The tables are written at submit time, since the mesh buffers may have been compacted since construction
+        WriteTables((GPUMeshPrimitive *)staging.primitiveList->Mapped(), (GPUMeshModel *)staging.modelEntry->Mapped());
 
         InlineVector<DeviceContext::BufferTransfer, 5> transfer;
         transfer.emplace_back(staging.indexBuffer, indexBuffer);
@@ -162,6 +207,7 @@ namespace sp::vulkan {
 
     Mesh::~Mesh() {
         Tracef("Destroying Vulkan model %s", modelName);
+        scene.liveMeshes.erase(this);
     }
 
     uint32 Mesh::SceneIndex() const {
@@ -34,11 +34,21 @@ namespace sp::vulkan {
             size_t jointsVertexOffset, jointsVertexCount;
             TextureHandle baseColor, metallicRoughness;
             glm::vec3 center;
+            float radius; // bounding sphere around center
         };
 
+        // Allocates the mesh's scene and staging buffers. Vertex data is filled in later by Decode().
         Mesh(shared_ptr<const sp::Gltf> source, size_t meshIndex, GPUScene &scene, DeviceContext &device);
         ~Mesh();
 
+        // Converts the gltf accessors into the staging buffers, safe to call from a worker thread.
+        void Decode(size_t meshIndex);
+        size_t StagingBytes() const;
+        void SubmitTransfer(DeviceContext &device);
+
+        // Writes this mesh's entries of the scene's primitive list and model tables, using its current offsets.
+        void WriteTables(GPUMeshPrimitive *gpuPrimitives, GPUMeshModel *meshModel) const;
+
         uint32 SceneIndex() const;
         uint32 PrimitiveCount() const {
             return primitives.size();
@@ -58,22 +68,28 @@ namespace sp::vulkan {
                 if (!prim.metallicRoughness.Ready()) return false;
             }
 
-            if (!staging.transferComplete->Ready()) return false;
+            if (!staging.transferComplete || !staging.transferComplete->Ready()) return false;
 
             ready = true;
+            staging.indexBuffer.reset();
+            staging.vertexBuffer.reset();
+            staging.jointsBuffer.reset();
+            staging.primitiveList.reset();
+            staging.modelEntry.reset();
             return true;
         }
 
     private:
         string modelName;
         shared_ptr<const sp::Gltf> asset;
+        GPUScene &scene;
 
         vector<Primitive> primitives;
 
         uint32 vertexCount = 0, indexCount = 0, jointsCount = 0;
         struct {
             BufferPtr indexBuffer, vertexBuffer, jointsBuffer, primitiveList, modelEntry;
-            AsyncPtr<void> transferComplete;
+            AsyncPtr<void> decodeComplete, transferComplete;
         } staging;
 
         SubBufferPtr indexBuffer, vertexBuffer, jointsBuffer, primitiveList, modelEntry;
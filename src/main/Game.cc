@@ -13,6 +13,7 @@
 #include "core/Common.hh"
 #include "core/Logging.hh"
 #include "core/RegisteredThread.hh"
+#include "core/ThreadTelemetry.hh"
 #include "core/Tracing.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EcsImpl.hh"
@@ -29,6 +30,7 @@
 #include <atomic>
 #include <cxxopts.hpp>
 #include <filesystem>
+#include <fstream>
 #include <glm/glm.hpp>
 #include <strayphotons.h>
 #include <wasm.rs.h>
@@ -212,6 +214,24 @@ namespace sp {
             exitTriggered.wait(false);
         }
 #endif
+
+#ifdef SP_GRAPHICS_SUPPORT
+        if (options.count("headless")) {
+#endif
+            PrintThreadTelemetry();
+#ifdef SP_GRAPHICS_SUPPORT
+        }
+#endif
+        if (options.count("thread-telemetry")) {
+            auto path = options["thread-telemetry"].as<string>();
+            std::ofstream file(path);
+            if (file) {
+                SaveThreadTelemetryCsv(file);
+                Logf("Saved thread telemetry to %s", path);
+            } else {
+                Errorf("Failed to open thread telemetry file: %s", path);
+            }
+        }
         return GameExitCode;
     }
 
@@ -267,6 +287,7 @@ namespace sp {
 #ifdef SP_GRAPHICS_SUPPORT_VK
                 ("with-validation-layers", "Enable Vulkan validation layers")
 #endif
+                ("thread-telemetry", "Save recent thread frame timings to a CSV file on exit", value<string>())
                 ("c,command", "Run a console command on init", value<vector<string>>());
             // clang-format on
 
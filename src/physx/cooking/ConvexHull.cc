@@ -7,11 +7,14 @@
 
 #include "ConvexHull.hh"
 
+#include "HullCachePack.hh"
 #include "assets/Asset.hh"
 #include "assets/AssetManager.hh"
 #include "assets/Gltf.hh"
 #include "assets/GltfImpl.hh"
+#include "assets/MappedFile.hh"
 #include "assets/PhysicsInfo.hh"
+#include "core/DispatchQueue.hh"
 #include "core/Hashing.hh"
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
@@ -19,6 +22,7 @@
 #include <PxPhysicsAPI.h>
 #include <cstdlib>
 #include <fstream>
+#include <mutex>
 #include <unordered_set>
 
 #define ENABLE_VHACD_IMPLEMENTATION 1
@@ -70,9 +74,8 @@ namespace sp {
         });
     }
 
-    void decomposeConvexHullsForPrimitive(physx::PxCooking &cooking,
+    std::vector<ConvexHull> decomposeConvexHullsForPrimitive(physx::PxCooking &cooking,
         physx::PxPhysics &physics,
-        ConvexHullSet *set,
         const gltf::Mesh::Primitive &prim,
         const HullSettings &settings) {
         ZoneScoped;
@@ -80,12 +83,8 @@ namespace sp {
         std::vector<glm::vec3> points(prim.positionBuffer.Count());
         std::vector<uint32_t> indices(prim.indexBuffer.Count());
 
-        for (size_t i = 0; i < prim.positionBuffer.Count(); i++) {
-            points[i] = prim.positionBuffer.Read(i);
-        }
-        for (size_t i = 0; i < prim.indexBuffer.Count(); i++) {
-            indices[i] = prim.indexBuffer.Read(i);
-        }
+        prim.positionBuffer.ReadRange(0, points.size(), points.data());
+        prim.indexBuffer.ReadRange(0, indices.size(), indices.data());
 
         static VHACDCallback vhacdCallback;
 
@@ -106,6 +105,7 @@ namespace sp {
             params);
         Assert(res, "building convex decomposition");
 
+        std::vector<ConvexHull> hulls;
         for (uint32 i = 0; i < interfaceVHACD->GetNConvexHulls(); i++) {
             VHACD::IVHACD::ConvexHull ihull;
             interfaceVHACD->GetConvexHull(i, ihull);
@@ -114,17 +114,17 @@ namespace sp {
             auto pxMesh = createPhysxMesh(cooking, physics, ihull.m_points);
             if (pxMesh) {
                 Logf("Adding VHACD hull, %d points, %d triangles", ihull.m_points.size(), ihull.m_triangles.size());
-                set->hulls.emplace_back(pxMesh);
+                hulls.emplace_back(pxMesh);
             }
         }
 
         interfaceVHACD->Clean();
         interfaceVHACD->Release();
+        return hulls;
     }
 
-    void buildConvexHullForPrimitive(physx::PxCooking &cooking,
+    std::vector<ConvexHull> buildConvexHullForPrimitive(physx::PxCooking &cooking,
         physx::PxPhysics &physics,
-        ConvexHullSet *set,
         const gltf::Mesh::Primitive &prim,
         const HullSettings &settings) {
         ZoneScoped;
@@ -144,19 +144,20 @@ namespace sp {
         VHACD::QuickHullImpl hullImpl;
         hullImpl.computeConvexHull(points, settings.hull.maxVertices);
         auto &vertices = hullImpl.getVertices();
-        if (vertices.size() < 3) return;
+        if (vertices.size() < 3) return {};
 
         auto pxMesh = createPhysxMesh(cooking, physics, vertices);
-        if (pxMesh) {
-            Logf("Adding simple hull, %d points, %d triangles", vertices.size(), hullImpl.getIndices().size());
-            set->hulls.emplace_back(pxMesh);
-        }
+        if (!pxMesh) return {};
+
+        Logf("Adding simple hull, %d points, %d triangles", vertices.size(), hullImpl.getIndices().size());
+        return {pxMesh};
     }
 
     std::shared_ptr<ConvexHullSet> hullgen::BuildConvexHulls(physx::PxCooking &cooking,
         physx::PxPhysics &physics,
         const AsyncPtr<Gltf> &modelPtr,
-        const AsyncPtr<HullSettings> &settingsPtr) {
+        const AsyncPtr<HullSettings> &settingsPtr,
+        DispatchQueue *workQueue) {
         ZoneScoped;
         Assertf(modelPtr, "BuildConvexHulls called with null model ptr");
         Assertf(settingsPtr, "BuildConvexHulls called with null hull settings ptr");
@@ -177,14 +178,34 @@ namespace sp {
         }
         auto &mesh = *meshOption;
 
-        auto set = make_shared<ConvexHullSet>();
-        for (auto &prim : mesh.primitives) {
+        auto cookPrimitive = [&cooking, &physics, &settings](const gltf::Mesh::Primitive &prim) {
             if (settings->hull.decompose) {
                 // Break primitive into one or more convex hulls.
-                decomposeConvexHullsForPrimitive(cooking, physics, set.get(), prim, *settings);
+                return decomposeConvexHullsForPrimitive(cooking, physics, prim, *settings);
             } else {
                 // Use points for a single hull without decomposing.
-                buildConvexHullForPrimitive(cooking, physics, set.get(), prim, *settings);
+                return buildConvexHullForPrimitive(cooking, physics, prim, *settings);
+            }
+        };
+
+        auto set = make_shared<ConvexHullSet>();
+        if (workQueue && mesh.primitives.size() > 1) {
+            std::vector<AsyncPtr<std::vector<ConvexHull>>> primitiveHulls;
+            primitiveHulls.reserve(mesh.primitives.size());
+            for (auto &prim : mesh.primitives) {
+                primitiveHulls.emplace_back(workQueue->Dispatch<std::vector<ConvexHull>>([&cookPrimitive, &prim]() {
+                    return make_shared<std::vector<ConvexHull>>(cookPrimitive(prim));
+                }));
+            }
+            // Hulls are added in primitive order so the set matches one cooked serially
+            for (auto &future : primitiveHulls) {
+                auto hulls = future->Get();
+                if (hulls) set->hulls.insert(set->hulls.end(), hulls->begin(), hulls->end());
+            }
+        } else {
+            for (auto &prim : mesh.primitives) {
+                auto hulls = cookPrimitive(prim);
+                set->hulls.insert(set->hulls.end(), hulls.begin(), hulls.end());
             }
         }
         set->sourceModel = modelPtr;
@@ -207,6 +228,105 @@ namespace sp {
 
     static_assert(sizeof(hullCacheHeader) == 40, "Hull cache header size changed unexpectedly");
 
+    // PxSerializationRegistry is not safe to use from multiple threads at once
+    static std::mutex serializationMutex;
+
+    Hash128 hullgen::HashHullSettings(const HullSettings &settings) {
+        HashKey<HullSettings::Fields> settingsHash = {};
+        settingsHash.input = settings.hull;
+        return settingsHash.Hash_128();
+    }
+
+    std::vector<uint8_t> hullgen::SerializeConvexHulls(physx::PxSerializationRegistry &registry,
+        const ConvexHullSet &set,
+        const std::string &name) {
+        ZoneScoped;
+        ZoneStr(name);
+        std::lock_guard lock(serializationMutex);
+        auto *collection = PxCreateCollection();
+        for (auto hull : set.hulls) {
+            if (!hull) continue;
+            collection->add(*hull);
+        }
+        physx::PxSerialization::complete(*collection, registry);
+
+        physx::PxDefaultMemoryOutputStream buf;
+        bool success = physx::PxSerialization::serializeCollectionToBinary(buf, *collection, registry);
+        collection->release();
+        if (!success) {
+            Errorf("Failed to serialize convex hull set: %s", name);
+            return {};
+        }
+        return std::vector<uint8_t>(buf.getData(), buf.getData() + buf.getSize());
+    }
+
+    std::shared_ptr<ConvexHullSet> hullgen::DeserializeConvexHulls(physx::PxSerializationRegistry &registry,
+        std::span<const uint8_t> data,
+        const AsyncPtr<Gltf> &modelPtr,
+        const AsyncPtr<HullSettings> &settingsPtr) {
+        ZoneScoped;
+        auto settings = settingsPtr->Get();
+        Assertf(settings, "DeserializeConvexHulls called with null hull settings");
+        ZoneStr(settings->name);
+
+        auto hullSet = make_shared<ConvexHullSet>();
+        hullSet->collectionBuffer.resize(data.size() + 128);
+
+        // Copy the serialization data into 128-byte aligned memory for PhysX
+        size_t remaining = hullSet->collectionBuffer.size();
+        void *alignedMemory = hullSet->collectionBuffer.data();
+        std::align(128, data.size(), alignedMemory, remaining);
+        std::memcpy(alignedMemory, data.data(), data.size());
+
+        physx::PxCollection *collection;
+        {
+            std::lock_guard lock(serializationMutex);
+            collection = physx::PxSerialization::createCollectionFromBinary(alignedMemory, registry);
+        }
+        if (!collection) {
+            Errorf("Failed to load physx serialization: %s", settings->name);
+            return nullptr;
+        }
+        hullSet->collection = std::shared_ptr<physx::PxCollection>(collection, [](physx::PxCollection *ptr) {
+            ptr->release();
+        });
+
+        hullSet->hulls.reserve(collection->getNbObjects());
+        for (uint32_t i = 0; i < collection->getNbObjects(); i++) {
+            physx::PxBase &object = collection->getObject(i);
+            auto pxMesh = object.is<physx::PxConvexMesh>();
+            if (!pxMesh) {
+                object.release();
+                continue;
+            }
+
+            hullSet->hulls.emplace_back(pxMesh, [name = settings->name](physx::PxConvexMesh *ptr) {
+                Assertf(ptr->getReferenceCount() == 1, "ConvexHullSet destroyed while shapes still in use: %s", name);
+                ptr->release();
+            });
+        }
+
+        hullSet->sourceModel = modelPtr;
+        hullSet->sourceSettings = settingsPtr;
+        return hullSet;
+    }
+
+    static std::shared_ptr<const HullCachePack> openCollisionCachePack() {
+        ZoneScoped;
+        if (auto mapping = Assets().MapFile(hull_cache::PACK_PATH)) {
+            return HullCachePack::Open(mapping, mapping->Data(), mapping->Size());
+        }
+
+        // Packaged builds read the pack in place from the mapped asset bundle
+        std::ifstream in;
+        if (!Assets().InputStream(hull_cache::PACK_PATH, AssetType::Bundled, in)) return nullptr;
+        in.close();
+
+        auto asset = Assets().Load(hull_cache::PACK_PATH)->Get();
+        if (!asset) return nullptr;
+        return HullCachePack::Open(asset, asset->BufferPtr(), asset->BufferSize());
+    }
+
     std::shared_ptr<ConvexHullSet> hullgen::LoadCollisionCache(physx::PxSerializationRegistry &registry,
         const AsyncPtr<Gltf> &modelPtr,
         const AsyncPtr<HullSettings> &settingsPtr) {
@@ -225,7 +345,29 @@ namespace sp {
         auto &mesh = model->meshes[settings->hull.meshIndex];
         Assertf(mesh, "Physics mesh is undefined: %s index %u", settings->name, settings->hull.meshIndex);
 
-        auto asset = Assets().Load("cache/collision/" + settings->name)->Get();
+        if (!model->asset) {
+            Logf("Ignoring collision cache for model without a source asset: %s", settings->name);
+            return nullptr;
+        }
+        auto modelHash = model->asset->Hash();
+        auto settingsHash = HashHullSettings(*settings);
+
+        // The pack is opened once, hulls cooked after that are found in their own cache files
+        static auto pack = openCollisionCachePack();
+        if (pack) {
+            auto data = pack->Find(modelHash, settingsHash);
+            if (!data.empty()) return DeserializeConvexHulls(registry, data, modelPtr, settingsPtr);
+        }
+
+        auto path = "cache/collision/" + settings->name;
+        std::ifstream in;
+        if (!Assets().InputStream(path, AssetType::Bundled, in)) {
+            Logf("Physics collision cache missing for hull: %s", settings->name);
+            return nullptr;
+        }
+        in.close();
+
+        auto asset = Assets().Load(path)->Get();
         if (!asset) {
             Errorf("Physics collision cache missing for hull: %s", settings->name);
             return nullptr;
@@ -243,14 +385,7 @@ namespace sp {
             return nullptr;
         }
 
-        if (!model->asset || header->modelHash != model->asset->Hash()) {
-            Logf("Ignoring outdated collision cache for %s", settings->name);
-            return nullptr;
-        }
-
-        HashKey<HullSettings::Fields> settingsHash;
-        settingsHash.input = settings->hull;
-        if (header->settingsHash != settingsHash.Hash_128()) {
+        if (header->modelHash != modelHash || header->settingsHash != settingsHash) {
             Logf("Ignoring outdated collision cache for %s", settings->name);
             return nullptr;
         }
@@ -260,42 +395,10 @@ namespace sp {
             return nullptr;
         }
 
-        auto hullSet = make_shared<ConvexHullSet>();
-        hullSet->collectionBuffer.resize(header->bufferSize + 128);
-
-        // Copy the serialization data into 128-byte aligned memory for PhysX
-        size_t remaining = hullSet->collectionBuffer.size();
-        void *alignedMemory = hullSet->collectionBuffer.data();
-        std::align(128, header->bufferSize, alignedMemory, remaining);
-        std::memcpy(alignedMemory, buf.data() + sizeof(hullCacheHeader), header->bufferSize);
-
-        auto *collection = physx::PxSerialization::createCollectionFromBinary(alignedMemory, registry);
-        if (!collection) {
-            Errorf("Failed to load physx serialization: %s", settings->name);
-            return nullptr;
-        }
-        hullSet->collection = std::shared_ptr<physx::PxCollection>(collection, [](physx::PxCollection *ptr) {
-            ptr->release();
-        });
-
-        hullSet->hulls.reserve(collection->getNbObjects());
-        for (uint32_t i = 0; i < collection->getNbObjects(); i++) {
-            physx::PxBase &object = collection->getObject(i);
-            auto pxMesh = object.is<physx::PxConvexMesh>();
-            if (!pxMesh) {
-                object.release();
-                continue;
-            }
-
-            hullSet->hulls.emplace_back(pxMesh, [name = settings->name](physx::PxConvexMesh *ptr) {
-                Assertf(ptr->getReferenceCount() == 1, "ConvexHullSet destroyed while shapes still in use: %s", name);
-                ptr->release();
-            });
-        }
-
-        hullSet->sourceModel = modelPtr;
-        hullSet->sourceSettings = settingsPtr;
-        return hullSet;
+        return DeserializeConvexHulls(registry,
+            buf.subspan(sizeof(hullCacheHeader), header->bufferSize),
+            modelPtr,
+            settingsPtr);
     }
 
     void hullgen::SaveCollisionCache(physx::PxSerializationRegistry &registry,
@@ -317,30 +420,18 @@ namespace sp {
         auto &mesh = model->meshes[settings->hull.meshIndex];
         Assertf(mesh, "SaveCollisionCache mesh is undefined: %s index %u", settings->name, settings->hull.meshIndex);
 
-        auto *collection = PxCreateCollection();
-        for (auto hull : set.hulls) {
-            if (!hull) continue;
-            collection->add(*hull);
-        }
-        physx::PxSerialization::complete(*collection, registry);
-
-        physx::PxDefaultMemoryOutputStream buf;
-        if (!physx::PxSerialization::serializeCollectionToBinary(buf, *collection, registry)) {
-            Errorf("Failed to serialize convex hull set: %s", settings->name);
-            return;
-        }
+        auto buf = SerializeConvexHulls(registry, set, settings->name);
+        if (buf.empty()) return;
 
         std::ofstream out;
         if (Assets().OutputStream("cache/collision/" + settings->name, out)) {
             hullCacheHeader header = {};
             header.modelHash = model->asset->Hash();
-            HashKey<HullSettings::Fields> settingsHash = {};
-            settingsHash.input = settings->hull;
-            header.settingsHash = settingsHash.Hash_128();
-            header.bufferSize = buf.getSize();
+            header.settingsHash = HashHullSettings(*settings);
+            header.bufferSize = buf.size();
 
             out.write(reinterpret_cast<const char *>(&header), sizeof(header));
-            out.write(reinterpret_cast<const char *>(buf.getData()), buf.getSize());
+            out.write(reinterpret_cast<const char *>(buf.data()), buf.size());
 
             out.close();
         }
@@ -14,6 +14,7 @@
 #include <glm/glm.hpp>
 #include <memory>
 #include <robin_hood.h>
+#include <span>
 #include <vector>
 
 namespace physx {
@@ -30,6 +31,7 @@ namespace sp::gltf {
 
 namespace sp {
     class Asset;
+    class DispatchQueue;
     class Gltf;
     struct HullSettings;
 
@@ -47,15 +49,31 @@ namespace sp {
     };
 
     namespace hullgen {
-        // Builds convex hull set for a model without caching
+        // Builds convex hull set for a model without caching.
+        // If a work queue is provided, each mesh primitive is cooked as a separate work item. This blocks until all
+        // primitives are done, so it must not be called from one of the work queue's own threads.
         std::shared_ptr<ConvexHullSet> BuildConvexHulls(physx::PxCooking &cooking,
             physx::PxPhysics &physics,
             const AsyncPtr<Gltf> &model,
+            const AsyncPtr<HullSettings> &settings,
+            DispatchQueue *workQueue = nullptr);
+
+        Hash128 HashHullSettings(const HullSettings &settings);
+
+        // Returns a PhysX binary collection containing the hulls, or an empty buffer on failure.
+        std::vector<uint8_t> SerializeConvexHulls(physx::PxSerializationRegistry &registry,
+            const ConvexHullSet &set,
+            const std::string &name);
+        std::shared_ptr<ConvexHullSet> DeserializeConvexHulls(physx::PxSerializationRegistry &registry,
+            std::span<const uint8_t> data,
+            const AsyncPtr<Gltf> &model,
             const AsyncPtr<HullSettings> &settings);
 
+        // Looks for the hull set in the collision cache pack first, then in the hull's own cache file.
         std::shared_ptr<ConvexHullSet> LoadCollisionCache(physx::PxSerializationRegistry &registry,
             const AsyncPtr<Gltf> &model,
             const AsyncPtr<HullSettings> &settings);
+        // Saves the hull set to its own cache file. hull_compiler merges these into the collision cache pack.
         void SaveCollisionCache(physx::PxSerializationRegistry &registry,
             const AsyncPtr<Gltf> &model,
             const AsyncPtr<HullSettings> &settings,
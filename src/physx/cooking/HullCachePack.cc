@@ -0,0 +1,158 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "HullCachePack.hh"
+
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+
+#include <algorithm>
+#include <fstream>
+
+namespace sp {
+    using namespace hull_cache;
+
+    static uint64_t alignOffset(uint64_t offset, uint64_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static bool entryLess(const Entry &a, const Entry &b) {
+        if (a.modelHash != b.modelHash) return a.modelHash < b.modelHash;
+        return a.settingsHash < b.settingsHash;
+    }
+
+    std::shared_ptr<const HullCachePack> HullCachePack::Open(std::shared_ptr<const void> storage,
+        const uint8_t *data,
+        size_t size) {
+        ZoneScoped;
+        if (!data || size < sizeof(Header)) {
+            Errorf("Hull cache pack is truncated");
+            return nullptr;
+        }
+        Assertf(((uintptr_t)data & 7) == 0, "Hull cache pack data is not 8 byte aligned");
+
+        std::shared_ptr<HullCachePack> pack(new HullCachePack());
+        pack->storage = storage;
+        pack->data = data;
+        pack->header = reinterpret_cast<const Header *>(data);
+        if (pack->header->magic != MAGIC) {
+            Errorf("Hull cache pack has invalid header");
+            return nullptr;
+        } else if (pack->header->version != VERSION) {
+            Warnf("Hull cache pack has version %u, expected %u", pack->header->version, VERSION);
+            return nullptr;
+        }
+        if (!pack->validate(size)) {
+            Errorf("Hull cache pack is corrupt");
+            return nullptr;
+        }
+        return pack;
+    }
+
+    bool HullCachePack::validate(size_t size) {
+        if (header->entriesOffset % alignof(Entry) != 0) return false;
+        if (header->entriesOffset + (uint64_t)header->entryCount * sizeof(Entry) > size) return false;
+        entries = reinterpret_cast<const Entry *>(data + header->entriesOffset);
+
+        for (uint32_t i = 0; i < header->entryCount; i++) {
+            auto &entry = entries[i];
+            if (entry.offset % PAYLOAD_ALIGNMENT != 0) return false;
+            if (entry.offset > size || entry.size > size - entry.offset) return false;
+            // Lookups binary search the index, so it must be strictly sorted
+            if (i > 0 && !entryLess(entries[i - 1], entry)) return false;
+        }
+        return true;
+    }
+
+    std::span<const uint8_t> HullCachePack::Find(const Hash128 &modelHash, const Hash128 &settingsHash) const {
+        Entry key = {};
+        key.modelHash = modelHash;
+        key.settingsHash = settingsHash;
+        auto end = entries + header->entryCount;
+        auto it = std::lower_bound(entries, end, key, entryLess);
+        if (it == end || it->modelHash != modelHash || it->settingsHash != settingsHash) return {};
+        return Data(*it);
+    }
+
+    std::span<const uint8_t> HullCachePack::Data(const Entry &entry) const {
+        return {data + entry.offset, entry.size};
+    }
+
+    bool HullCachePack::Write(const std::filesystem::path &outputPath, const std::vector<SourceEntry> &sources) {
+        ZoneScoped;
+        std::vector<size_t> order(sources.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        auto sourceKey = [&](size_t i) {
+            Entry key = {};
+            key.modelHash = sources[i].modelHash;
+            key.settingsHash = sources[i].settingsHash;
+            return key;
+        };
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return entryLess(sourceKey(a), sourceKey(b));
+        });
+        // Identical hull settings on the same model cook to the same hulls, so only store them once
+        auto sameKey = [&](size_t a, size_t b) {
+            return !entryLess(sourceKey(a), sourceKey(b));
+        };
+        order.erase(std::unique(order.begin(), order.end(), sameKey), order.end());
+
+        Header header = {};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.entryCount = order.size();
+        header.entriesOffset = sizeof(Header);
+
+        std::vector<Entry> entries;
+        entries.reserve(order.size());
+        uint64_t offset = header.entriesOffset + sizeof(Entry) * order.size();
+        for (auto i : order) {
+            auto &entry = entries.emplace_back(sourceKey(i));
+            offset = alignOffset(offset, PAYLOAD_ALIGNMENT);
+            entry.offset = offset;
+            entry.size = sources[i].data.size();
+            offset += entry.size;
+        }
+
+        auto tempPath = outputPath;
+        tempPath += ".tmp";
+        std::error_code ec;
+        if (outputPath.has_parent_path()) std::filesystem::create_directories(outputPath.parent_path(), ec);
+        std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Errorf("Failed to open hull cache pack for writing: %s", tempPath.string());
+            return false;
+        }
+        out.write((const char *)&header, sizeof(header));
+        out.write((const char *)entries.data(), sizeof(Entry) * entries.size());
+
+        uint64_t written = header.entriesOffset + sizeof(Entry) * entries.size();
+        for (size_t i = 0; i < entries.size(); i++) {
+            static const char padding[PAYLOAD_ALIGNMENT] = {};
+            out.write(padding, entries[i].offset - written);
+
+            auto &data = sources[order[i]].data;
+            out.write((const char *)data.data(), data.size());
+            written = entries[i].offset + entries[i].size;
+        }
+        out.close();
+        if (!out) {
+            Errorf("Failed to write hull cache pack: %s", tempPath.string());
+            return false;
+        }
+
+        // Renaming over the old pack leaves any existing mappings of it intact
+        std::filesystem::rename(tempPath, outputPath, ec);
+        if (ec) {
+            Errorf("Failed to replace hull cache pack %s: %s", outputPath.string(), ec.message());
+            return false;
+        }
+        return true;
+    }
+} // namespace sp
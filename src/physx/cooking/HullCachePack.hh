@@ -0,0 +1,89 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sp {
+    /**
+     * The hull cache pack (cache/collision.sphulls) stores the serialized PhysX collections for every convex hull set
+     * in the asset tree. It is generated by hull_compiler and mapped into memory once instead of opening a cache file
+     * per hull. Entries are keyed by the model asset hash and hull settings hash, so outdated entries are never found.
+     *
+     * Layout (all offsets are in bytes from the start of the file, little endian):
+     *   Header
+     *   Entry[entryCount]      Sorted by model hash, then by settings hash
+     *   Payloads               Each payload starts on a PAYLOAD_ALIGNMENT boundary
+     */
+    namespace hull_cache {
+        static const uint32_t MAGIC = 0x48435053; // "SPCH"
+        static const uint32_t VERSION = 1;
+        static const size_t PAYLOAD_ALIGNMENT = 16;
+        static const char *const PACK_PATH = "cache/collision.sphulls";
+
+        struct Header {
+            uint32_t magic, version;
+            uint32_t entryCount, _padding;
+            uint64_t entriesOffset;
+        };
+
+        struct Entry {
+            Hash128 modelHash;
+            Hash128 settingsHash;
+            uint64_t offset, size;
+        };
+
+        static_assert(sizeof(Header) % 8 == 0, "Hull cache header must be 8 byte aligned");
+        static_assert(sizeof(Entry) == 48, "Unexpected hull cache entry size");
+    } // namespace hull_cache
+
+    class HullCachePack : public NonCopyable {
+    public:
+        struct SourceEntry {
+            Hash128 modelHash;
+            Hash128 settingsHash;
+            std::vector<uint8_t> data;
+        };
+
+        // Validates the index, returning nullptr if anything is out of bounds.
+        // The storage pointer keeps the underlying file mapping or buffer alive.
+        static std::shared_ptr<const HullCachePack> Open(std::shared_ptr<const void> storage,
+            const uint8_t *data,
+            size_t size);
+
+        // Replaces the pack at outputPath with one containing only the provided entries.
+        // The new pack is written next to the old one and renamed over it so existing mappings stay valid.
+        static bool Write(const std::filesystem::path &outputPath, const std::vector<SourceEntry> &sources);
+
+        // Returns an empty span if the hull set isn't in the pack.
+        std::span<const uint8_t> Find(const Hash128 &modelHash, const Hash128 &settingsHash) const;
+
+        std::span<const uint8_t> Data(const hull_cache::Entry &entry) const;
+
+        std::span<const hull_cache::Entry> Entries() const {
+            return {entries, header->entryCount};
+        }
+
+    private:
+        HullCachePack() {}
+
+        bool validate(size_t size);
+
+        std::shared_ptr<const void> storage;
+        const uint8_t *data = nullptr;
+        const hull_cache::Header *header = nullptr;
+        const hull_cache::Entry *entries = nullptr;
+    };
+} // namespace sp
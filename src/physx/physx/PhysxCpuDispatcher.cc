@@ -0,0 +1,28 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "PhysxCpuDispatcher.hh"
+
+#include "core/Tracing.hh"
+
+namespace sp {
+    PhysxCpuDispatcher::PhysxCpuDispatcher(uint32_t workerCount)
+        : workerCount(workerCount),
+          workQueue("PhysXWorker", workerCount, std::chrono::milliseconds(5), DispatchScheduler::WorkStealing) {
+        Assertf(workerCount > 0, "PhysxCpuDispatcher requires at least 1 worker thread");
+    }
+
+    void PhysxCpuDispatcher::submitTask(physx::PxBaseTask &task) {
+        workQueue.Dispatch<void>([&task]() {
+            ZoneScopedN("PhysxTask");
+            ZoneStr(task.getName());
+            task.run();
+            // Releasing a task may submit its continuation
+            task.release();
+        });
+    }
+} // namespace sp
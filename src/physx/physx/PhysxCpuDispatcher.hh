@@ -0,0 +1,34 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
+
+#include <PxPhysicsAPI.h>
+
+namespace sp {
+    /**
+     * Runs PhysX simulation tasks on an engine DispatchQueue instead of PhysX's default thread pool,
+     * so worker threads are named and traced like the rest of the engine's threads.
+     */
+    class PhysxCpuDispatcher final : public physx::PxCpuDispatcher, public NonCopyable {
+    public:
+        PhysxCpuDispatcher(uint32_t workerCount);
+
+        void submitTask(physx::PxBaseTask &task) override;
+
+        uint32_t getWorkerCount() const override {
+            return workerCount;
+        }
+
+    private:
+        const uint32_t workerCount;
+        DispatchQueue workQueue;
+    };
+} // namespace sp
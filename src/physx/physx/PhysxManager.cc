@@ -36,11 +36,26 @@ namespace sp {
 
     CVar<bool> CVarPhysxDebugCollision("x.DebugColliders", false, "Show physx colliders");
     CVar<bool> CVarPhysxDebugJoints("x.DebugJoints", false, "Show physx joints");
+    static CVar<uint32_t> CVarPhysxWorkerThreads("x.WorkerThreads",
+        4,
+        "Number of worker threads used by the PhysX simulation (takes effect on restart)");
+    static CVar<uint32_t> CVarHullCookingThreads("x.HullCookingThreads",
+        4,
+        "Number of threads used to cook convex hull primitives (takes effect on restart)");
+    static CVar<uint32_t> CVarTransformThreads("x.TransformThreads",
+        2,
+        "Number of extra threads used to update transform snapshots (takes effect on restart)");
 
     PhysxManager::PhysxManager(LockFreeEventQueue<ecs::Event> &windowInputQueue, bool stepMode)
-        : RegisteredThread("PhysX", 120.0, true), windowInputQueue(windowInputQueue), scenes(GetSceneManager()),
+        : RegisteredThread("PhysX", 120.0, true), stepMode(stepMode), windowInputQueue(windowInputQueue),
+          scenes(GetSceneManager()),
           characterControlSystem(*this), constraintSystem(*this), physicsQuerySystem(*this), laserSystem(*this),
-          animationSystem(*this), workQueue("PhysXHullLoading") {
+          animationSystem(*this), workQueue("PhysXHullLoading"),
+          cookingQueue("PhysXHullCooking",
+              std::max(1u, CVarHullCookingThreads.Get()),
+              std::chrono::milliseconds(5),
+              DispatchScheduler::WorkStealing),
+          transformHierarchy("PhysXTransforms", CVarTransformThreads.Get()) {
         Logf("PhysX %d.%d.%d starting up",
             PX_PHYSICS_VERSION_MAJOR,
             PX_PHYSICS_VERSION_MINOR,
@@ -95,8 +110,10 @@ namespace sp {
 
     PhysxManager::~PhysxManager() {
         StopThread();
+        FetchSimulationResults();
 
         workQueue.Shutdown();
+        cookingQueue.Shutdown();
 
         controllerManager.reset();
         for (auto &entry : joints) {
@@ -114,10 +131,7 @@ namespace sp {
         scene.reset();
         cache.DropAll();
 
-        if (dispatcher) {
-            dispatcher->release();
-            dispatcher = nullptr;
-        }
+        dispatcher.reset();
 
         if (pxSerialization) {
             pxSerialization->release();
@@ -173,8 +187,27 @@ namespace sp {
         });
     }
 
+    void PhysxManager::FetchSimulationResults() {
+        if (!simulationInFlight) return;
+        ZoneScoped;
+        scene->fetchResults(true);
+        simulationInFlight = false;
+    }
+
     void PhysxManager::Frame() {
         ZoneScoped;
+        characterControlSystem.RegisterEvents();
+
+        { // Input events don't touch the PhysX scene, so they're handled while the previous step may still be running
+            ZoneScopedN("UpdateInputEvents");
+            auto lock = ecs::StartTransaction<ecs::SendEventsLock, ecs::Write<ecs::Signals>>();
+            GameLogic::UpdateInputEvents(lock, windowInputQueue);
+        }
+
+        // The ECS sync below reads stepped actor poses and runs scene queries, neither of which PhysX allows
+        // while the scene is simulating, so the previous step must be complete before continuing.
+        FetchSimulationResults();
+
         if (CVarPhysxDebugCollision.Changed() || CVarPhysxDebugJoints.Changed()) {
             bool collision = CVarPhysxDebugCollision.Get(true);
             bool joints = CVarPhysxDebugJoints.Get(true);
@@ -184,8 +217,6 @@ namespace sp {
             scene->setVisualizationParameter(PxVisualizationParameter::eJOINT_LIMITS, joints);
         }
 
-        characterControlSystem.RegisterEvents();
-
         { // Sync ECS state to physx
             ZoneScopedN("Sync ECS");
             auto lock = ecs::StartTransaction<ecs::ReadSignalsLock,
@@ -211,8 +242,6 @@ namespace sp {
                     ecs::Signals>,
                 ecs::PhysicsUpdateLock>();
 
-            GameLogic::UpdateInputEvents(lock, windowInputQueue);
-
             characterControlSystem.Frame(lock);
 
             {
@@ -242,40 +271,16 @@ namespace sp {
 
             {
                 ZoneScopedN("UpdateSnapshots(NonDynamic)");
-                for (auto &ent : lock.EntitiesWith<ecs::TransformTree>()) {
-                    if (!ent.Has<ecs::TransformTree, ecs::TransformSnapshot>(lock)) continue;
-
-                    // Only recalculate the transform snapshot for entities that moved.
-                    auto treeEnt = ent;
-                    bool dirty = false;
-                    while (treeEnt.Has<ecs::TransformTree>(lock)) {
-                        auto &tree = treeEnt.Get<const ecs::TransformTree>(lock);
-                        auto &cache = transformCache[treeEnt];
-                        treeEnt = tree.parent.Get(lock);
-
-                        if (cache.dirty < 0) {
-                            dirty = tree.pose != cache.pose || treeEnt != cache.parent;
-                            if (dirty) {
-                                cache.pose = tree.pose;
-                                cache.parent = treeEnt;
-                                cache.dirty = 1;
-                                break;
-                            } else {
-                                cache.dirty = 0;
-                            }
-                        } else if (cache.dirty > 0) {
-                            dirty = true;
-                            break;
-                        }
-                    }
-                    if (!dirty) continue;
-
-                    auto transform = ent.Get<const ecs::TransformTree>(lock).GetGlobalTransform(lock);
+                // Only recalculate the transform snapshot for entities that moved.
+                transformHierarchy.Sync(lock);
+                transformHierarchy.Update();
+                transformHierarchy.ForEachUpdated([&](ecs::Entity ent, const ecs::Transform &transform) {
+                    if (!ent.Has<ecs::TransformSnapshot>(lock)) return;
                     ent.Set<ecs::TransformSnapshot>(lock, transform);
 
                     if (ent.Has<ecs::Physics>(lock)) {
                         auto &ph = ent.Get<ecs::Physics>(lock);
-                        if (ph.type == ecs::PhysicsActorType::Dynamic) continue;
+                        if (ph.type == ecs::PhysicsActorType::Dynamic) return;
 
                         if (actors.count(ent) > 0) {
                             auto const &actor = actors[ent];
@@ -299,7 +304,7 @@ namespace sp {
                             }
                         }
                     }
-                }
+                });
             }
 
             animationSystem.Frame(lock);
@@ -348,24 +353,23 @@ namespace sp {
             ecs::GetScriptManager().RunOnPhysicsUpdate(lock, interval);
         }
 
-        { // Simulate 1 physics frame (blocking)
+        { // Start simulating 1 physics frame on the worker threads
             ZoneScopedN("Simulate");
             scene->simulate(PxReal(std::chrono::nanoseconds(this->interval).count() / 1e9),
                 nullptr,
                 scratchBlock.data(),
                 scratchBlock.size());
-            scene->fetchResults(true);
+            simulationInFlight = true;
         }
 
         cache.Tick(interval);
 
-        {
-            ZoneScopedN("TransformCache Reset");
-            // Reset dirty flags in transform cache outside of the transaction
-            for (auto &[generation, cache] : transformCache) {
-                if (generation != 0) cache.dirty = -1;
-            }
+        if (stepMode) {
+            FetchSimulationResults();
+        } else if (scene->fetchResults(false)) {
+            simulationInFlight = false;
         }
+        // Otherwise the simulation keeps running while this thread waits for its next frame
     }
 
     void PhysxManager::CreatePhysxScene() {
@@ -399,8 +403,8 @@ namespace sp {
         PxSetGroupCollisionFlag((uint16_t)Group::NoClip, (uint16_t)Group::PlayerRightHand, false);
         PxSetGroupCollisionFlag((uint16_t)Group::NoClip, (uint16_t)Group::UserInterface, false);
 
-        dispatcher = PxDefaultCpuDispatcherCreate(1);
-        sceneDesc.cpuDispatcher = dispatcher;
+        dispatcher = make_unique<PhysxCpuDispatcher>(std::max(1u, CVarPhysxWorkerThreads.Get()));
+        sceneDesc.cpuDispatcher = dispatcher.get();
 
         auto pxScene = pxPhysics->createScene(sceneDesc);
         Assert(pxScene, "Failed to create PhysX scene");
@@ -452,7 +456,7 @@ namespace sp {
                     auto set = hullgen::LoadCollisionCache(*pxSerialization, modelPtr, settingsPtr);
                     if (set) return set;
 
-                    set = hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, modelPtr, settingsPtr);
+                    set = hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, modelPtr, settingsPtr, &cookingQueue);
                     hullgen::SaveCollisionCache(*pxSerialization, modelPtr, settingsPtr, *set);
 
                     return set;
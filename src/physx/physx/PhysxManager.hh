@@ -19,6 +19,7 @@
 #include "core/RegisteredThread.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EntityRef.hh"
+#include "ecs/TransformHierarchy.hh"
 #include "ecs/components/Physics.hh"
 #include "ecs/components/PhysicsJoints.hh"
 #include "ecs/components/Transform.h"
@@ -27,6 +28,7 @@
 #include "physx/ConstraintSystem.hh"
 #include "physx/LaserSystem.hh"
 #include "physx/PhysicsQuerySystem.hh"
+#include "physx/PhysxCpuDispatcher.hh"
 #include "physx/SimulationCallbackHandler.hh"
 #include "physx/TriggerSystem.hh"
 
@@ -138,10 +140,16 @@ namespace sp {
         physx::PxGeometryHolder GeometryFromShape(const ecs::PhysicsShape &shape,
             glm::vec3 parentScale = glm::vec3(1)) const;
 
+        void FetchSimulationResults();
+
         std::atomic_bool simulate = false;
         std::atomic_bool exiting = false;
         std::vector<uint8_t> scratchBlock;
 
+        // In step mode each Step() waits for its simulation, otherwise results are fetched by the next frame
+        const bool stepMode;
+        bool simulationInFlight = false;
+
         LockFreeEventQueue<ecs::Event> &windowInputQueue;
 
         SceneManager &scenes;
@@ -153,7 +161,7 @@ namespace sp {
 
         physx::PxFoundation *pxFoundation = nullptr;
         physx::PxPhysics *pxPhysics = nullptr;
-        physx::PxDefaultCpuDispatcher *dispatcher = nullptr;
+        std::unique_ptr<PhysxCpuDispatcher> dispatcher;
         physx::PxDefaultErrorCallback defaultErrorCallback;
         physx::PxDefaultAllocator defaultAllocatorCallback;
         physx::PxCooking *pxCooking = nullptr;
@@ -182,13 +190,10 @@ namespace sp {
         std::mutex cacheMutex;
         PreservingMap<string, Async<ConvexHullSet>> cache;
         DispatchQueue workQueue;
+        // Primitives of a hull set are cooked in parallel while workQueue waits on them
+        DispatchQueue cookingQueue;
 
-        struct TransformCacheEntry {
-            ecs::Entity parent;
-            ecs::Transform pose;
-            int dirty = -1;
-        };
-        EntityMap<TransformCacheEntry> transformCache;
+        ecs::TransformHierarchy transformHierarchy;
 
         friend class CharacterControlSystem;
         friend class ConstraintSystem;
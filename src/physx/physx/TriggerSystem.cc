@@ -8,15 +8,41 @@
 #include "TriggerSystem.hh"
 
 #include "console/Console.hh"
+#include "console/CVar.hh"
 #include "core/Common.hh"
 #include "core/Logging.hh"
 #include "core/Tracing.hh"
 #include "ecs/EcsImpl.hh"
 
+#include <algorithm>
 #include <glm/gtx/norm.hpp>
 
 namespace sp {
+    static CVar<float> CVarTriggerCellSize("x.TriggerCellSize",
+        4.0f,
+        "Size of the grid cells used to find trigger areas near an entity");
+
+    // Areas overlapping more cells than this are stored in a separate list instead of the grid
+    const size_t MAX_TRIGGER_AREA_CELLS = 64;
+
+    static bool containsPoint(ecs::TriggerShape shape, const ecs::Transform &invTransform, const glm::vec3 &point) {
+        auto relativePos = invTransform * glm::vec4(point, 1.0);
+        switch (shape) {
+        case ecs::TriggerShape::Box:
+            return glm::all(glm::greaterThan(relativePos, glm::vec3(-0.5))) &&
+                   glm::all(glm::lessThan(relativePos, glm::vec3(0.5)));
+        case ecs::TriggerShape::Sphere:
+            return glm::length2(relativePos) < 0.25;
+        }
+        return false;
+    }
+
     TriggerSystem::TriggerSystem() {
+        for (auto &group : magic_enum::enum_values<ecs::TriggerGroup>()) {
+            eventNames[group] = std::make_pair(ecs::EventName(ecs::TriggerGroupEventNames[group].first),
+                ecs::EventName(ecs::TriggerGroupEventNames[group].second));
+        }
+
         auto lock = ecs::StartTransaction<ecs::AddRemove>();
         triggerGroupObserver = lock.Watch<ecs::ComponentEvent<ecs::TriggerGroup>>();
     }
@@ -26,79 +52,248 @@ namespace sp {
         triggerGroupObserver.Stop(lock);
     }
 
+    glm::ivec3 TriggerSystem::GetCell(const glm::vec3 &position) const {
+        return glm::ivec3(glm::floor(position / cellSize));
+    }
+
+    TriggerSystem::CellKey TriggerSystem::GetCellKey(const glm::ivec3 &cell) const {
+        // 21 bits per axis, coordinates outside this range wrap around and share cells
+        const uint64_t mask = (1 << 21) - 1;
+        return ((uint64_t)cell.x & mask) << 42 | ((uint64_t)cell.y & mask) << 21 | ((uint64_t)cell.z & mask);
+    }
+
+    void TriggerSystem::MarkDirty(const AreaState &state) {
+        if (state.oversized) {
+            allCellsDirty = true;
+            return;
+        }
+        for (int x = state.minCell.x; x <= state.maxCell.x; x++) {
+            for (int y = state.minCell.y; y <= state.maxCell.y; y++) {
+                for (int z = state.minCell.z; z <= state.maxCell.z; z++) {
+                    dirtyCells.insert(GetCellKey(glm::ivec3(x, y, z)));
+                }
+            }
+        }
+    }
+
+    void TriggerSystem::RemoveArea(const AreaState &state) {
+        MarkDirty(state);
+        if (state.oversized) {
+            std::erase(oversizedAreas, state.ent);
+            return;
+        }
+        for (int x = state.minCell.x; x <= state.maxCell.x; x++) {
+            for (int y = state.minCell.y; y <= state.maxCell.y; y++) {
+                for (int z = state.minCell.z; z <= state.maxCell.z; z++) {
+                    auto it = grid.find(GetCellKey(glm::ivec3(x, y, z)));
+                    if (it == grid.end()) continue;
+                    std::erase(it->second, state.ent);
+                    if (it->second.empty()) grid.erase(it);
+                }
+            }
+        }
+    }
+
+    void TriggerSystem::UpdateArea(ecs::Entity ent, const ecs::TriggerArea &area, const ecs::Transform &transform) {
+        auto *state = areas.find(ent);
+        if (state) {
+            state->lastSeenFrame = frameCount;
+            if (state->transform == transform && state->shape == area.shape) return;
+            RemoveArea(*state);
+        } else {
+            state = &areas[ent];
+            state->ent = ent;
+            state->lastSeenFrame = frameCount;
+            for (auto &group : magic_enum::enum_values<ecs::TriggerGroup>()) {
+                state->signals[group] = ecs::SignalRef(ent, ecs::TriggerGroupSignalNames[group]);
+            }
+            changedAreas.insert(ent);
+        }
+
+        state->transform = transform;
+        state->invTransform = transform.GetInverse();
+        state->shape = area.shape;
+        state->center = transform.GetPosition();
+        state->boundingRadiusSquared = glm::length2(transform * glm::vec4(glm::vec3(0.5f), 0.0f));
+
+        float radius = std::sqrt(state->boundingRadiusSquared);
+        state->minCell = GetCell(state->center - radius);
+        state->maxCell = GetCell(state->center + radius);
+        auto cellCount = glm::ivec3(1) + state->maxCell - state->minCell;
+        state->oversized = (size_t)cellCount.x * cellCount.y * cellCount.z > MAX_TRIGGER_AREA_CELLS;
+
+        if (state->oversized) {
+            oversizedAreas.emplace_back(ent);
+        } else {
+            for (int x = state->minCell.x; x <= state->maxCell.x; x++) {
+                for (int y = state->minCell.y; y <= state->maxCell.y; y++) {
+                    for (int z = state->minCell.z; z <= state->maxCell.z; z++) {
+                        grid[GetCellKey(glm::ivec3(x, y, z))].emplace_back(ent);
+                    }
+                }
+            }
+        }
+        MarkDirty(*state);
+    }
+
+    void TriggerSystem::LeaveArea(const FrameLock &lock, TriggerEntityState &state, ecs::Entity areaEnt) {
+        if (areaEnt.Has<ecs::TriggerArea>(lock)) {
+            auto &area = areaEnt.Get<ecs::TriggerArea>(lock);
+            area.containedEntities[state.group].erase(state.ent);
+            changedAreas.insert(areaEnt);
+        }
+        // Removed areas don't receive leave events
+        if (!areas.count(areaEnt)) return;
+
+        Tracef("%s leaving TriggerArea %s at: %f %f %f",
+            ecs::ToString(lock, state.ent),
+            ecs::ToString(lock, areaEnt),
+            state.position.x,
+            state.position.y,
+            state.position.z);
+        ecs::EventBindings::SendEvent(lock, areaEnt, ecs::Event{eventNames[state.group].second, areaEnt, state.ent});
+    }
+
+    void TriggerSystem::UpdateEntity(const FrameLock &lock, TriggerEntityState &state) {
+        candidateAreas = oversizedAreas;
+        auto it = grid.find(state.cell);
+        if (it != grid.end()) {
+            candidateAreas.insert(candidateAreas.end(), it->second.begin(), it->second.end());
+        }
+
+        insideAreas.clear();
+        for (auto &areaEnt : candidateAreas) {
+            auto *area = areas.find(areaEnt);
+            if (!area) continue;
+            if (glm::length2(state.position - area->center) > area->boundingRadiusSquared) continue;
+            if (containsPoint(area->shape, area->invTransform, state.position)) insideAreas.emplace_back(areaEnt);
+        }
+
+        for (auto &areaEnt : state.containingAreas) {
+            if (std::find(insideAreas.begin(), insideAreas.end(), areaEnt) != insideAreas.end()) continue;
+            LeaveArea(lock, state, areaEnt);
+        }
+
+        for (auto &areaEnt : insideAreas) {
+            auto &containing = state.containingAreas;
+            if (std::find(containing.begin(), containing.end(), areaEnt) != containing.end()) continue;
+
+            auto &area = areaEnt.Get<ecs::TriggerArea>(lock);
+            area.containedEntities[state.group].insert(state.ent);
+            changedAreas.insert(areaEnt);
+
+            Tracef("%s entered TriggerArea %s at: %f %f %f",
+                ecs::ToString(lock, state.ent),
+                ecs::ToString(lock, areaEnt),
+                state.position.x,
+                state.position.y,
+                state.position.z);
+            ecs::EventBindings::SendEvent(lock,
+                areaEnt,
+                ecs::Event{eventNames[state.group].first, areaEnt, state.ent});
+        }
+
+        state.containingAreas.swap(insideAreas);
+    }
+
     void TriggerSystem::Frame(ecs::Lock<ecs::Read<ecs::Name, ecs::TriggerGroup, ecs::TransformSnapshot>,
         ecs::Write<ecs::TriggerArea, ecs::Signals>,
         ecs::SendEventsLock> lock) {
         ZoneScoped;
+        frameCount++;
 
-        for (auto &entity : lock.EntitiesWith<ecs::TriggerArea>()) {
-            if (!entity.Has<ecs::TriggerArea, ecs::TransformSnapshot>(lock)) continue;
-            auto &area = entity.Get<ecs::TriggerArea>(lock);
-            auto &areaTransform = entity.Get<ecs::TransformSnapshot>(lock).globalPose;
-            auto areaCenter = areaTransform.GetPosition();
-            auto boundingRadiusSquared = glm::length2(areaTransform * glm::vec4(glm::vec3(0.5f), 0.0f));
-            auto invAreaTransform = areaTransform.GetInverse();
-
-            ecs::ComponentEvent<ecs::TriggerGroup> triggerEvent;
-            while (triggerGroupObserver.Poll(lock, triggerEvent)) {
-                if (triggerEvent.type == Tecs::EventType::REMOVED) {
-                    for (auto &containedEntities : area.containedEntities) {
-                        containedEntities.erase(triggerEvent.entity);
-                    }
-                }
+        float newCellSize = std::max(0.01f, CVarTriggerCellSize.Get());
+        if (cellSize != newCellSize) {
+            cellSize = newCellSize;
+            areas.clear();
+            grid.clear();
+            oversizedAreas.clear();
+            allCellsDirty = true;
+        }
+
+        ecs::ComponentEvent<ecs::TriggerGroup> triggerEvent;
+        while (triggerGroupObserver.Poll(lock, triggerEvent)) {
+            if (triggerEvent.type != Tecs::EventType::REMOVED) continue;
+            auto *state = triggerEntities.find(triggerEvent.entity);
+            if (!state) continue;
+            // Entities that stop being triggers are removed silently, without leave events
+            for (auto &areaEnt : state->containingAreas) {
+                if (!areaEnt.Has<ecs::TriggerArea>(lock)) continue;
+                areaEnt.Get<ecs::TriggerArea>(lock).containedEntities[state->group].erase(state->ent);
+                changedAreas.insert(areaEnt);
+            }
+            triggerEntities.erase(triggerEvent.entity);
+        }
+
+        {
+            ZoneScopedN("UpdateAreas");
+            for (auto &entity : lock.EntitiesWith<ecs::TriggerArea>()) {
+                if (!entity.Has<ecs::TriggerArea, ecs::TransformSnapshot>(lock)) continue;
+                UpdateArea(entity,
+                    entity.Get<const ecs::TriggerArea>(lock),
+                    entity.Get<ecs::TransformSnapshot>(lock).globalPose);
+            }
+            for (auto &entry : areas) {
+                if (entry.first == 0 || entry.second.lastSeenFrame == frameCount) continue;
+                RemoveArea(entry.second);
+                areas.erase(entry.second.ent);
             }
+        }
 
+        {
+            ZoneScopedN("UpdateTriggerEntities");
             for (auto &triggerEnt : lock.EntitiesWith<ecs::TriggerGroup>()) {
                 if (!triggerEnt.Has<ecs::TriggerGroup, ecs::TransformSnapshot>(lock)) continue;
-                auto &transform = triggerEnt.Get<ecs::TransformSnapshot>(lock).globalPose;
-                auto entityPos = transform.GetPosition();
-                bool inArea = false;
-                if (glm::length2(entityPos - areaCenter) <= boundingRadiusSquared) {
-                    auto relativePos = invAreaTransform * glm::vec4(transform.GetPosition(), 1.0);
-                    switch (area.shape) {
-                    case ecs::TriggerShape::Box:
-                        inArea = glm::all(glm::greaterThan(relativePos, glm::vec3(-0.5))) &&
-                                 glm::all(glm::lessThan(relativePos, glm::vec3(0.5)));
-                        break;
-                    case ecs::TriggerShape::Sphere:
-                        inArea = glm::length2(relativePos) < 0.25;
-                        break;
+                auto &position = triggerEnt.Get<ecs::TransformSnapshot>(lock).globalPose.GetPosition();
+                auto &group = triggerEnt.Get<ecs::TriggerGroup>(lock);
+
+                bool isNew = !triggerEntities.count(triggerEnt);
+                auto &state = triggerEntities[triggerEnt];
+                state.lastSeenFrame = frameCount;
+                if (isNew) {
+                    state.ent = triggerEnt;
+                    state.group = group;
+                } else if (state.group != group) {
+                    // Leave all areas as the old group before entering them as the new group
+                    for (auto &areaEnt : state.containingAreas) {
+                        LeaveArea(lock, state, areaEnt);
                     }
+                    state.containingAreas.clear();
+                    state.group = group;
+                    isNew = true;
                 }
 
-                auto &triggerGroup = triggerEnt.Get<ecs::TriggerGroup>(lock);
-                auto &containedEntities = area.containedEntities[triggerGroup];
-                if (containedEntities.contains(triggerEnt) == inArea) continue;
-
-                std::string *eventName;
-
-                if (inArea) {
-                    eventName = &ecs::TriggerGroupEventNames[triggerGroup].first;
-                    containedEntities.insert(triggerEnt);
-                    Tracef("%s entered TriggerArea %s at: %f %f %f",
-                        ecs::ToString(lock, triggerEnt),
-                        ecs::ToString(lock, entity),
-                        entityPos.x,
-                        entityPos.y,
-                        entityPos.z);
-                } else {
-                    eventName = &ecs::TriggerGroupEventNames[triggerGroup].second;
-                    containedEntities.erase(triggerEnt);
-                    Tracef("%s leaving TriggerArea %s at: %f %f %f",
-                        ecs::ToString(lock, triggerEnt),
-                        ecs::ToString(lock, entity),
-                        entityPos.x,
-                        entityPos.y,
-                        entityPos.z);
-                }
+                auto cell = GetCellKey(GetCell(position));
+                bool moved = position != state.position;
+                if (!isNew && !moved && !allCellsDirty && !dirtyCells.contains(cell)) continue;
+
+                state.position = position;
+                state.cell = cell;
+                UpdateEntity(lock, state);
+            }
 
-                ecs::EventBindings::SendEvent(lock, entity, ecs::Event{*eventName, entity, triggerEnt});
+            // Entities without a transform no longer have a position, so they leave all areas
+            for (auto &entry : triggerEntities) {
+                if (entry.first == 0 || entry.second.lastSeenFrame == frameCount) continue;
+                auto &state = entry.second;
+                for (auto &areaEnt : state.containingAreas) {
+                    LeaveArea(lock, state, areaEnt);
+                }
+                triggerEntities.erase(state.ent);
             }
+        }
 
+        for (auto &areaEnt : changedAreas) {
+            auto *state = areas.find(areaEnt);
+            if (!state || !areaEnt.Has<ecs::TriggerArea>(lock)) continue;
+            auto &area = areaEnt.Get<const ecs::TriggerArea>(lock);
             for (auto &triggerGroup : magic_enum::enum_values<ecs::TriggerGroup>()) {
-                auto entityCount = area.containedEntities[triggerGroup].size();
-                ecs::SignalRef(entity, ecs::TriggerGroupSignalNames[triggerGroup]).SetValue(lock, (double)entityCount);
+                state->signals[triggerGroup].SetValue(lock, (double)area.containedEntities[triggerGroup].size());
             }
         }
+
+        changedAreas.clear();
+        dirtyCells.clear();
+        allCellsDirty = false;
     }
 } // namespace sp
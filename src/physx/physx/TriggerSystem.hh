@@ -7,12 +7,24 @@
 
 #pragma once
 
+#include "core/EntityMap.hh"
 #include "ecs/Ecs.hh"
+#include "ecs/SignalRef.hh"
 #include "ecs/components/Events.hh"
 
+#include <glm/glm.hpp>
+#include <robin_hood.h>
+#include <vector>
+
 namespace sp {
     class PhysxManager;
 
+    /**
+     * Trigger areas are stored in a uniform grid, keyed by the cells their bounding sphere overlaps.
+     * Each frame only entities that moved, or that are in a cell where an area was added, moved, or removed,
+     * are tested against the areas in their cell. Events and signals are only written when an entity enters
+     * or leaves an area.
+     */
     class TriggerSystem {
     public:
         TriggerSystem();
@@ -23,5 +35,58 @@ namespace sp {
             ecs::SendEventsLock> lock);
 
         ecs::ComponentObserver<ecs::TriggerGroup> triggerGroupObserver;
+
+    private:
+        using CellKey = uint64_t;
+
+        struct AreaState {
+            ecs::Entity ent;
+            ecs::Transform transform, invTransform;
+            ecs::TriggerShape shape;
+            glm::vec3 center;
+            float boundingRadiusSquared;
+            glm::ivec3 minCell, maxCell;
+            bool oversized;
+            sp::EnumArray<ecs::SignalRef, ecs::TriggerGroup> signals;
+            uint32_t lastSeenFrame;
+        };
+
+        struct TriggerEntityState {
+            ecs::Entity ent;
+            ecs::TriggerGroup group;
+            glm::vec3 position;
+            CellKey cell;
+            std::vector<ecs::Entity> containingAreas;
+            uint32_t lastSeenFrame;
+        };
+
+        using FrameLock = ecs::Lock<ecs::Read<ecs::Name, ecs::TriggerGroup, ecs::TransformSnapshot>,
+            ecs::Write<ecs::TriggerArea, ecs::Signals>,
+            ecs::SendEventsLock>;
+
+        glm::ivec3 GetCell(const glm::vec3 &position) const;
+        CellKey GetCellKey(const glm::ivec3 &cell) const;
+
+        void UpdateArea(ecs::Entity ent, const ecs::TriggerArea &area, const ecs::Transform &transform);
+        void RemoveArea(const AreaState &state);
+        void MarkDirty(const AreaState &state);
+
+        void UpdateEntity(const FrameLock &lock, TriggerEntityState &state);
+        void LeaveArea(const FrameLock &lock, TriggerEntityState &state, ecs::Entity areaEnt);
+
+        float cellSize = 0.0f;
+        uint32_t frameCount = 0;
+        bool allCellsDirty = false;
+
+        EntityMap<AreaState> areas;
+        EntityMap<TriggerEntityState> triggerEntities;
+        robin_hood::unordered_map<CellKey, std::vector<ecs::Entity>> grid;
+        // Areas spanning too many cells are tested against every entity that needs an update
+        std::vector<ecs::Entity> oversizedAreas;
+        robin_hood::unordered_flat_set<CellKey> dirtyCells;
+        robin_hood::unordered_flat_set<ecs::Entity> changedAreas;
+        std::vector<ecs::Entity> candidateAreas, insideAreas;
+
+        sp::EnumArray<std::pair<ecs::EventName, ecs::EventName>, ecs::TriggerGroup> eventNames;
     };
 } // namespace sp
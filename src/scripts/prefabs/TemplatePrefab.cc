@@ -7,6 +7,7 @@
 
 #include "assets/Asset.hh"
 #include "assets/AssetManager.hh"
+#include "assets/BinaryHelpers.hh"
 #include "core/Common.hh"
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
@@ -14,9 +15,23 @@
 #include "game/Scene.hh"
 #include "game/SceneManager.hh"
 
+#include <mutex>
 #include <picojson/picojson.h>
+#include <robin_hood.h>
 
 namespace ecs {
+    /**
+     * Parsed templates are cached in the binary component format, keyed by template name and source hash.
+     * Templates instantiated many times in a scene, or again on scene reload, skip parsing json after the first time.
+     * Each load from the cache creates new FlatEntity copies, so script state isn't shared between instances.
+     */
+    struct CachedTemplate {
+        sp::Hash128 sourceHash;
+        std::vector<uint8_t> data;
+    };
+
+    static std::mutex templateCacheMutex;
+    static robin_hood::unordered_flat_map<std::string, std::shared_ptr<const CachedTemplate>> templateCache;
     struct TemplateParser {
         std::shared_ptr<sp::Scene> scene;
         Entity rootEnt;
@@ -51,6 +66,7 @@ namespace ecs {
                 Errorf("Template not found: %s", sourceName);
                 return false;
             }
+            if (loadCached(*asset)) return true;
 
             picojson::value rootValue;
             string err = picojson::parse(rootValue, asset->String());
@@ -142,9 +158,57 @@ namespace ecs {
                     }
                 }
             }
+            saveCached(*asset);
             return true;
         }
 
+        bool loadCached(const sp::Asset &asset) {
+            ZoneScoped;
+            std::shared_ptr<const CachedTemplate> cached;
+            {
+                std::lock_guard lock(templateCacheMutex);
+                auto it = templateCache.find(sourceName);
+                if (it != templateCache.end()) cached = it->second;
+            }
+            if (!cached || cached->sourceHash != asset.Hash()) return false;
+
+            sp::binary::Reader reader(cached->data);
+            uint64_t entityCount = 0;
+            bool success = reader.ReadHeader() && sp::binary::Load(hasRootOverride, reader) &&
+                           ecs::LoadEntityBinary(rootComponents, reader) && reader.ReadVarint(entityCount) &&
+                           entityCount <= reader.Remaining();
+            for (uint64_t i = 0; success && i < entityCount; i++) {
+                auto &entDst = entityList.emplace_back();
+                success = reader.ReadString(entDst.first) && ecs::LoadEntityBinary(entDst.second, reader);
+            }
+            if (!success) {
+                Errorf("Failed to load cached template, parsing json instead: %s", sourceName);
+                hasRootOverride = false;
+                rootComponents = {};
+                entityList.clear();
+            }
+            return success;
+        }
+
+        void saveCached(const sp::Asset &asset) const {
+            ZoneScoped;
+            auto cached = std::make_shared<CachedTemplate>();
+            cached->sourceHash = asset.Hash();
+
+            sp::binary::Writer writer(cached->data);
+            writer.WriteHeader();
+            sp::binary::Save(writer, hasRootOverride);
+            ecs::SaveEntityBinary(writer, rootComponents);
+            writer.WriteVarint(entityList.size());
+            for (auto &[relativeName, flatEnt] : entityList) {
+                writer.WriteString(relativeName);
+                ecs::SaveEntityBinary(writer, flatEnt);
+            }
+
+            std::lock_guard lock(templateCacheMutex);
+            templateCache[sourceName] = cached;
+        }
+
         // Add defined components to the template root entity with the given name
         Entity ApplyComponents(const Lock<AddRemove> &lock, EntityScope scope, Transform offset = {}) {
             ZoneScoped;
@@ -17,7 +17,10 @@ namespace sp::scripts {
     struct SoundOcclusion {
         PhysicsQuery::Handle<PhysicsQuery::Raycast> raycastQuery;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<Read<TransformSnapshot>, Write<Audio, PhysicsQuery>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<Audio, PhysicsQuery, TransformSnapshot>(lock)) return;
 
             auto &constAudio = ent.Get<const Audio>(lock);
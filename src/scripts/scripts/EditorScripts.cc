@@ -27,7 +27,10 @@ namespace sp::scripts {
     struct TraySpawner {
         std::string templateSource;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<Read<Name, TransformTree, EventInput, ActiveScene>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             Event event;
             while (EventInput::Poll(lock, state.eventQueue, event)) {
                 if (event.name != INTERACT_EVENT_INTERACT_GRAB) continue;
@@ -85,6 +88,7 @@ namespace sp::scripts {
                         auto &prefab = scripts.AddPrefab(scope, "template");
                         prefab.SetParam("source", source);
                         ecs::GetScriptManager().RunPrefabs(lock, newEntity);
+                        scene->MarkStagingChanged(newEntity);
 
                         *sharedEntity = newEntity;
                     });
@@ -110,7 +114,10 @@ namespace sp::scripts {
         glm::vec3 lastToolPosition, faceNormal;
         PhysicsQuery::Handle<PhysicsQuery::Raycast> raycastQuery;
 
-        bool performUpdate(Lock<WriteAll> lock, float toolDepth, int editMode, bool snapToFace) {
+        bool performUpdate(Lock<Write<TransformTree, TransformSnapshot>> lock,
+            float toolDepth,
+            int editMode,
+            bool snapToFace) {
             auto deltaDepth = toolDepth;
             if (!snapToFace) {
                 deltaDepth = std::round(toolDepth / CVarEditTranslateSnap.Get()) * CVarEditTranslateSnap.Get();
@@ -154,7 +161,7 @@ namespace sp::scripts {
             return true;
         }
 
-        void performRotateToFace(Lock<WriteAll> lock, glm::vec3 targetNormal) {
+        void performRotateToFace(Lock<Write<TransformTree, TransformSnapshot>> lock, glm::vec3 targetNormal) {
             auto &targetTree = selectedEntity.Get<TransformTree>(lock);
             auto worldToLocalRotation = glm::inverse(targetTree.GetGlobalRotation(lock));
             auto deltaRotation = glm::rotation(worldToLocalRotation * faceNormal, worldToLocalRotation * -targetNormal);
@@ -162,7 +169,12 @@ namespace sp::scripts {
             selectedEntity.Set<TransformSnapshot>(lock, targetTree.GetGlobalTransform(lock));
         }
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<ReadSignalsLock,
+                Read<EventInput>,
+                Write<Signals, TransformTree, TransformSnapshot, PhysicsQuery, LaserLine>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<TransformTree, PhysicsQuery>(lock)) return;
             auto &query = ent.Get<PhysicsQuery>(lock);
             auto &transform = ent.Get<TransformTree>(lock);
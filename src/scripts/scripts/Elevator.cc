@@ -24,7 +24,10 @@ namespace sp::scripts {
         int frames = 0;
         float avgSpeed = 0.0f;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<SendEventsLock, Read<TransformSnapshot>, Write<Audio>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<TransformSnapshot, Audio>(lock)) return;
             auto &transform = ent.Get<TransformSnapshot>(lock).globalPose;
             auto &audio = ent.Get<Audio>(lock);
@@ -16,7 +16,7 @@ namespace sp::scripts {
     struct InitEvent {
         std::vector<std::string> outputs;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, SendEventsLock lock, Entity ent, chrono_clock::duration interval) {
             state.definition.events.clear();
             state.definition.filterOnEvent = true; // Effective next tick, only executes once on first frame.
 
@@ -41,7 +41,7 @@ namespace sp::scripts {
             state.definition.filterOnEvent = true;
         }
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, Lock<ReadAll> lock, Entity ent, chrono_clock::duration interval) {
             Event event;
             while (EventInput::Poll(lock, state.eventQueue, event)) {
                 if (outputEvent.empty()) continue;
@@ -91,7 +91,7 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             updateEvents(state, lock, ent, interval);
         }
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, SendEventsLock lock, Entity ent, chrono_clock::duration interval) {
             updateEvents(state, lock, ent, interval);
         }
     };
@@ -117,7 +117,10 @@ namespace sp::scripts {
             state.definition.filterOnEvent = true;
         }
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<Read<EventInput>, Write<Signals>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             Event event;
             while (EventInput::Poll(lock, state.eventQueue, event)) {
                 Assertf(sp::starts_with(event.name, "/signal/"), "Event name should be /signal/<action>/<signal>");
@@ -135,7 +138,7 @@ namespace sp::scripts {
                     },
                     event.data);
 
-                auto eventName = std::string_view(event.name).substr("/signal/"s.size());
+                auto eventName = std::string_view(event.name.String()).substr("/signal/"s.size());
                 auto delimiter = eventName.find('/');
                 Assertf(delimiter != std::string_view::npos, "Event name should be /signal/<action>/<signal>");
                 auto action = eventName.substr(0, delimiter);
@@ -186,7 +189,7 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             sendOutputEvents(state, lock, ent, interval);
         }
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, Lock<ReadAll> lock, Entity ent, chrono_clock::duration interval) {
             sendOutputEvents(state, lock, ent, interval);
         }
     };
@@ -224,7 +227,7 @@ namespace sp::scripts {
                     continue;
                 }
 
-                auto fieldPath = std::string_view(event.name).substr("/set/"s.size());
+                auto fieldPath = std::string_view(event.name.String()).substr("/set/"s.size());
                 size_t delimiter = fieldPath.find('.');
                 if (delimiter == std::string_view::npos) {
                     Errorf("Unexpected event received by component_from_event: %s", event.name);
@@ -292,6 +295,7 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             updateComponentFromEvent(state, lock, ent);
         }
+        // Event names select which component is written, so this script needs access to every component
         void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
             updateComponentFromEvent(state, lock, ent);
         }
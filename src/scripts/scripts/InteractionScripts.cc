@@ -29,7 +29,11 @@ namespace sp::scripts {
         bool renderOutline = false;
         PhysicsQuery::Handle<PhysicsQuery::Mass> massQuery;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<Read<TransformTree, TransformSnapshot, EventInput>,
+                Write<Physics, PhysicsJoints, PhysicsQuery, Renderable>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<TransformSnapshot, Physics, PhysicsJoints>(lock)) return;
 
             auto &ph = ent.Get<Physics>(lock);
@@ -213,7 +217,10 @@ namespace sp::scripts {
             }
         }
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<SendEventsLock, ReadSignalsLock, Read<TransformSnapshot>, Write<PhysicsJoints, PhysicsQuery>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (ent.Has<TransformSnapshot, PhysicsQuery>(lock)) {
                 auto &query = ent.Get<PhysicsQuery>(lock);
                 auto &transform = ent.Get<TransformSnapshot>(lock).globalPose;
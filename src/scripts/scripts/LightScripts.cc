@@ -16,7 +16,10 @@ namespace sp::scripts {
     struct Flashlight {
         EntityRef parentEntity;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<ReadSignalsLock, Read<EventInput>, Write<Signals, Light, TransformTree>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<Light, TransformTree>(lock)) return;
 
             auto &light = ent.Get<Light>(lock);
@@ -60,7 +63,10 @@ namespace sp::scripts {
         "/action/flashlight/grab");
 
     struct SunScript {
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<ReadSignalsLock, Write<Signals, TransformTree>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<TransformTree>(lock)) return;
 
             auto &transform = ent.Get<TransformTree>(lock);
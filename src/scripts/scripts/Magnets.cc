@@ -38,7 +38,10 @@ namespace sp::scripts {
             }
         }
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<ReadSignalsLock, Read<EventInput, TransformSnapshot>, Write<PhysicsJoints>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<PhysicsJoints, TransformSnapshot>(lock)) return;
             auto &joints = ent.Get<PhysicsJoints>(lock);
             auto &plugTransform = ent.Get<const TransformSnapshot>(lock).globalPose;
@@ -126,7 +129,10 @@ namespace sp::scripts {
     struct MagneticSocket {
         robin_hood::unordered_flat_set<Entity> disabledEntities;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<SendEventsLock, Read<TriggerArea>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             if (!ent.Has<TriggerArea>(lock)) return;
 
             EntityRef enableTriggerEntity = ecs::Name("enable_trigger", state.scope);
@@ -63,7 +63,7 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             updateEdgeTrigger(state, lock, ent);
         }
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, Lock<ReadAll> lock, Entity ent, chrono_clock::duration interval) {
             updateEdgeTrigger(state, lock, ent);
         }
     };
@@ -84,7 +84,10 @@ namespace sp::scripts {
         glm::vec3 position;
         std::string modelName;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<Read<TransformSnapshot, EventInput>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             Transform relativeTransform;
             auto target = targetEntity.Get(lock);
             if (target.Has<TransformSnapshot>(lock)) {
@@ -133,7 +136,7 @@ namespace sp::scripts {
         glm::vec3 rotationAxis;
         float rotationSpeedRpm;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, Lock<Write<TransformTree>> lock, Entity ent, chrono_clock::duration interval) {
             if (!ent.Has<TransformTree>(lock) || rotationAxis == glm::vec3(0) || rotationSpeedRpm == 0.0f) return;
 
             auto &transform = ent.Get<TransformTree>(lock);
@@ -153,7 +156,7 @@ namespace sp::scripts {
     struct RotateToEntity {
         EntityRef targetEntityRef, upEntityRef;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, Lock<Write<TransformTree>> lock, Entity ent, chrono_clock::duration interval) {
             if (!ent.Has<TransformTree>(lock)) return;
 
             auto targetEnt = targetEntityRef.Get(lock);
@@ -295,6 +298,7 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             updateComponentFromSignal(lock, ent);
         }
+        // The mapping may name any component, so this script can't run alongside others
         void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
             updateComponentFromSignal(lock, ent);
         }
@@ -340,7 +344,10 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             updateSignal(lock, ent, interval);
         }
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<ReadAll, Write<Signals>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             updateSignal(lock, ent, interval);
         }
     };
@@ -410,7 +417,10 @@ namespace sp::scripts {
         void OnPhysicsUpdate(ScriptState &state, PhysicsUpdateLock lock, Entity ent, chrono_clock::duration interval) {
             updateTimer(state, lock, ent, interval);
         }
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state,
+            Lock<ReadSignalsLock, Read<EventInput>, Write<Signals>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
             updateTimer(state, lock, ent, interval);
         }
     };
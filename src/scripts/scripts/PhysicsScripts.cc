@@ -108,7 +108,7 @@ namespace sp::scripts {
             while (EventInput::Poll(lock, state.eventQueue, event)) {
                 Assertf(sp::starts_with(event.name, "/physics_joint/"),
                     "Event name should be /physics_joint/<name>/<action>");
-                auto eventName = std::string_view(event.name).substr("/physics_joint/"s.size());
+                auto eventName = std::string_view(event.name.String()).substr("/physics_joint/"s.size());
                 auto delimiter = eventName.find('/');
                 Assertf(delimiter != std::string_view::npos, "Event name should be /physics_joint/<name>/<action>");
                 std::string jointName(eventName.substr(0, delimiter));
@@ -0,0 +1,137 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/AssetBundle.hh"
+#include "core/Common.hh"
+#include "core/Logging.hh"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <murmurhash/MurmurHash3.h>
+#include <tests.hh>
+#include <vector>
+
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+namespace AssetBundleBenchmarks {
+    using namespace testing;
+
+    const size_t ITERATIONS = 10;
+
+    // Returns 0 on platforms where the resident set size isn't available
+    size_t residentSetBytes() {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        size_t totalPages = 0, residentPages = 0;
+        if (statm >> totalPages >> residentPages) return residentPages * sysconf(_SC_PAGESIZE);
+#endif
+        return 0;
+    }
+
+    // Hashing every byte makes sure mapped pages are actually faulted in
+    uint64_t hashBytes(const uint8_t *data, size_t size) {
+        Hash128 output;
+        MurmurHash3_x86_128(data, (int)size, 0, output.data());
+        return output[0];
+    }
+
+    // Mirrors the loose file path in AssetManager::Load
+    uint64_t loadLoose(const std::vector<sp::AssetBundle::SourceFile> &files,
+        std::vector<std::vector<uint8_t>> &buffers) {
+        uint64_t hash = 0;
+        for (auto &file : files) {
+            std::ifstream in(file.source, std::ios::in | std::ios::binary);
+            in.seekg(0, std::ios::end);
+            auto &buffer = buffers.emplace_back((size_t)in.tellg());
+            in.seekg(0, std::ios::beg);
+            in.read((char *)buffer.data(), buffer.size());
+            hash ^= hashBytes(buffer.data(), buffer.size());
+        }
+        return hash;
+    }
+
+    uint64_t loadBundled(const sp::AssetBundle &bundle, const std::vector<sp::AssetBundle::SourceFile> &files) {
+        uint64_t hash = 0;
+        for (auto &file : files) {
+            auto *entry = bundle.Find(file.path);
+            Assertf(entry, "Asset missing from bundle: %s", file.path);
+            auto data = bundle.Data(*entry);
+            hash ^= hashBytes(data.data(), data.size());
+        }
+        return hash;
+    }
+
+    void BenchmarkAssetBundle() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/scenes", ec)) {
+            Logf("Skipping asset bundle benchmark, bundled assets not found");
+            return;
+        }
+
+        std::vector<sp::AssetBundle::SourceFile> files;
+        size_t totalBytes = 0;
+        for (auto dir : {"scenes", "models", "shaders", "textures", "cache/scenes"}) {
+            auto root = std::filesystem::path("../assets") / dir;
+            if (!std::filesystem::is_directory(root, ec)) continue;
+            for (auto &entry : std::filesystem::recursive_directory_iterator(root)) {
+                if (!entry.is_regular_file()) continue;
+                auto &file = files.emplace_back();
+                file.path = std::filesystem::relative(entry.path(), "../assets").generic_string();
+                file.source = entry.path();
+                totalBytes += entry.file_size();
+            }
+        }
+
+        auto bundlePath = (std::filesystem::temp_directory_path() / "sp-bench-assets.spdata").string();
+        {
+            Timer t("Write asset bundle with " + std::to_string(files.size()) + " files");
+            AssertTrue(sp::AssetBundle::Write(bundlePath, files), "Failed to write asset bundle");
+        }
+        Logf("Bundled %u files, %u bytes", files.size(), totalBytes);
+
+        uint64_t looseHash = 0, bundleHash = 0;
+        {
+            MultiTimer timer("Load " + std::to_string(files.size()) + " loose asset files (ifstream)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                std::vector<std::vector<uint8_t>> buffers;
+                Timer t(timer);
+                looseHash = loadLoose(files, buffers);
+            }
+        }
+        {
+            std::vector<std::vector<uint8_t>> buffers;
+            size_t rssBefore = residentSetBytes();
+            loadLoose(files, buffers);
+            Logf("Loose assets RSS increase: %u KiB", (std::max(residentSetBytes(), rssBefore) - rssBefore) / 1024);
+        }
+        {
+            MultiTimer timer("Open bundle and load " + std::to_string(files.size()) + " assets (mapped)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                auto bundle = sp::AssetBundle::Open(bundlePath);
+                Assert(bundle, "Failed to open asset bundle");
+                bundleHash = loadBundled(*bundle, files);
+            }
+        }
+        {
+            size_t rssBefore = residentSetBytes();
+            auto bundle = sp::AssetBundle::Open(bundlePath);
+            Assert(bundle, "Failed to open asset bundle");
+            loadBundled(*bundle, files);
+            // Mapped pages are shared with the page cache and can be dropped by the OS under memory pressure
+            Logf("Mapped bundle RSS increase: %u KiB", (std::max(residentSetBytes(), rssBefore) - rssBefore) / 1024);
+        }
+        AssertEqual(bundleHash, looseHash, "Expected bundled assets to match loose files");
+
+        std::filesystem::remove(bundlePath, ec);
+    }
+
+    Test test(&BenchmarkAssetBundle);
+} // namespace AssetBundleBenchmarks
@@ -0,0 +1,215 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/BinaryHelpers.hh"
+#include "core/Common.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <component-randomizer.hh>
+#include <picojson/picojson.h>
+#include <random>
+#include <sstream>
+#include <tests.hh>
+#include <vector>
+
+namespace ComponentBinaryBenchmarks {
+    using namespace testing;
+
+    const size_t ENTITY_COUNT = 2000;
+    const size_t ITERATIONS = 20;
+    const size_t VALUES_PER_COMPONENT = 2000;
+
+    // The same synthetic scene as the json-load benchmark
+    std::string generateSceneJson() {
+        std::stringstream ss;
+        ss << R"({"entities": [)";
+        for (size_t i = 0; i < ENTITY_COUNT; i++) {
+            if (i > 0) ss << ",";
+            ss << R"({"name": "ent)" << i << R"(",)";
+            ss << R"("transform": {"translate": [)" << i << R"(, 1.5, -2], "rotate": [90, 0, 1, 0], "scale": 0.5},)";
+            ss << R"("signal_output": {"value": )" << i << R"(, "enabled": 1},)";
+            ss << R"("signal_bindings": {"sum": "ent)" << i << R"(/value + 1", "gate": "ent)" << i
+               << R"(/enabled && ent0/value > 0.5"},)";
+            ss << R"("event_bindings": {"/action/press": "ent)" << ((i + 1) % ENTITY_COUNT) << R"(/action/notify"}})";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    void saveEntityJson(ECSType<AllComponentTypes...> *, picojson::object &dst, const ecs::FlatEntity &src) {
+        ecs::EntityScope scope("bench", "");
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                if constexpr (std::is_same_v<T, ecs::Name>) {
+                    auto &name = std::get<std::optional<T>>(src);
+                    if (name) dst["name"] = picojson::value(name->String());
+                } else if constexpr (!std::is_same_v<T, ecs::SceneInfo> && !Tecs::is_global_component<T>()) {
+                    auto &opt = std::get<std::optional<T>>(src);
+                    if (!opt) return;
+
+                    auto &comp = ecs::LookupComponent<T>();
+                    auto &value = dst[comp.name];
+                    for (auto &field : comp.metadata.fields) {
+                        field.Save(scope, value, &*opt, &comp.StagingDefault());
+                    }
+                    ecs::StructMetadata::Save<T>(scope, value, *opt, &comp.StagingDefault());
+                }
+            }(),
+            ...);
+    }
+
+    size_t loadEntitiesJson(const std::string &source, std::vector<ecs::FlatEntity> &entities) {
+        picojson::value root;
+        std::string err = picojson::parse(root, source);
+        Assertf(err.empty(), "Failed to parse json: %s", err);
+
+        ecs::EntityScope scope("bench", "");
+        for (auto &value : root.get<picojson::object>().at("entities").get<picojson::array>()) {
+            auto &entSrc = value.get<picojson::object>();
+            auto &entDst = entities.emplace_back();
+            ecs::Name name(entSrc.at("name").get<std::string>(), scope);
+            if (name) std::get<std::optional<ecs::Name>>(entDst) = name;
+            for (auto &comp : entSrc) {
+                if (comp.first == "name") continue;
+                auto componentType = ecs::LookupComponent(comp.first);
+                if (componentType) componentType->LoadEntity(entDst, comp.second);
+            }
+        }
+        return entities.size();
+    }
+
+    std::string saveEntitiesJson(const std::vector<ecs::FlatEntity> &entities) {
+        picojson::array entityList;
+        for (auto &ent : entities) {
+            picojson::object entityObj;
+            saveEntityJson((ecs::ECS *)nullptr, entityObj, ent);
+            entityList.emplace_back(entityObj);
+        }
+        picojson::object root;
+        root["entities"] = picojson::value(entityList);
+        return picojson::value(root).serialize();
+    }
+
+    size_t loadEntitiesBinary(const std::vector<uint8_t> &source, std::vector<ecs::FlatEntity> &entities) {
+        sp::binary::Reader reader(source);
+        uint64_t count;
+        Assertf(reader.ReadHeader() && reader.ReadVarint(count), "Failed to read binary entity header");
+        entities.resize(count);
+        for (auto &ent : entities) {
+            Assertf(ecs::LoadEntityBinary(ent, reader), "Failed to load binary entity");
+        }
+        return entities.size();
+    }
+
+    std::vector<uint8_t> saveEntitiesBinary(const std::vector<ecs::FlatEntity> &entities) {
+        std::vector<uint8_t> buffer;
+        sp::binary::Writer writer(buffer);
+        writer.WriteHeader();
+        writer.WriteVarint(entities.size());
+        for (auto &ent : entities) {
+            ecs::SaveEntityBinary(writer, ent);
+        }
+        return buffer;
+    }
+
+    // Times saving and loading random values of a single component, reported per iteration
+    template<typename T>
+    void benchmarkComponent(std::mt19937 &rng) {
+        auto &comp = ecs::LookupComponent<T>();
+        std::vector<T> values(VALUES_PER_COMPONENT, comp.StagingDefault());
+        for (auto &value : values) {
+            ComponentRandomizer::randomize(rng, value);
+        }
+
+        std::string valuesName = std::to_string(values.size()) + " " + comp.name + " values";
+        MultiTimer saveTimer("Save " + valuesName + " to binary");
+        MultiTimer loadTimer("Load " + valuesName + " from binary");
+        std::vector<uint8_t> buffer;
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            buffer.clear();
+            {
+                Timer t(saveTimer);
+                sp::binary::Writer writer(buffer);
+                for (auto &value : values) {
+                    comp.SaveBinary(writer, &value);
+                }
+            }
+
+            std::vector<ecs::FlatEntity> loaded(values.size());
+            sp::binary::Reader reader(buffer);
+            {
+                Timer t(loadTimer);
+                for (auto &ent : loaded) {
+                    Assertf(comp.LoadBinary(ent, reader), "Failed to load binary component: %s", comp.name);
+                }
+            }
+            AssertEqual(reader.Remaining(), 0u, std::string("Binary components were not fully read: ") + comp.name);
+        }
+    }
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    void benchmarkAllComponents(ECSType<AllComponentTypes...> *, std::mt19937 &rng) {
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                if constexpr (!std::is_same_v<T, ecs::SceneInfo> && !Tecs::is_global_component<T>()) {
+                    benchmarkComponent<T>(rng);
+                }
+            }(),
+            ...);
+    }
+
+    void BenchmarkComponentBinary() {
+        std::vector<ecs::FlatEntity> entities;
+        AssertEqual(loadEntitiesJson(generateSceneJson(), entities), ENTITY_COUNT, "Expected every entity to load");
+
+        std::string jsonSource;
+        {
+            MultiTimer timer("Save 2000 entities to json");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                jsonSource = saveEntitiesJson(entities);
+            }
+        }
+        {
+            MultiTimer timer("Load 2000 entities from json");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                std::vector<ecs::FlatEntity> loaded;
+                Timer t(timer);
+                AssertEqual(loadEntitiesJson(jsonSource, loaded), ENTITY_COUNT, "Expected every entity to load");
+            }
+        }
+
+        std::vector<uint8_t> binarySource;
+        {
+            MultiTimer timer("Save 2000 entities to binary");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                binarySource = saveEntitiesBinary(entities);
+            }
+        }
+        {
+            MultiTimer timer("Load 2000 entities from binary");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                std::vector<ecs::FlatEntity> loaded;
+                Timer t(timer);
+                AssertEqual(loadEntitiesBinary(binarySource, loaded), ENTITY_COUNT, "Expected every entity to load");
+            }
+        }
+
+        // Every registered component, filled with the same random values as the binary fuzz test
+        Timer t("Save and load " + std::to_string(VALUES_PER_COMPONENT) + " random values of every component");
+        std::mt19937 rng(42);
+        benchmarkAllComponents((ecs::ECS *)nullptr, rng);
+    }
+
+    Test test(&BenchmarkComponentBinary);
+} // namespace ComponentBinaryBenchmarks
@@ -0,0 +1,87 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
+
+#include <atomic>
+#include <magic_enum.hpp>
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace DispatchQueueBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t WORKER_COUNT = 4;
+    const size_t ITEM_COUNT = 100000;
+    const size_t PRODUCER_COUNT = 8;
+    const size_t ITERATIONS = 10;
+
+    // Many tiny work items dispatched from a single thread
+    void BenchmarkThroughput(DispatchScheduler scheduler) {
+        std::string name = "DispatchQueue throughput (" + std::string(magic_enum::enum_name(scheduler)) + ")";
+        MultiTimer timer(name);
+        for (size_t iteration = 0; iteration < ITERATIONS; iteration++) {
+            DispatchQueue queue("BenchmarkThroughput", WORKER_COUNT, std::chrono::milliseconds(1), scheduler);
+            std::atomic_size_t count = 0;
+
+            Timer t(timer);
+            std::vector<AsyncPtr<void>> results(ITEM_COUNT);
+            for (auto &result : results) {
+                result = queue.Dispatch<void>([&count] {
+                    count++;
+                });
+            }
+            for (auto &result : results) {
+                result->Get();
+            }
+            AssertEqual(count.load(), ITEM_COUNT, "Expected every work item to run");
+        }
+    }
+
+    // Many producer threads dispatching with mixed priorities at the same time
+    void BenchmarkContention(DispatchScheduler scheduler) {
+        std::string name = "DispatchQueue contention (" + std::string(magic_enum::enum_name(scheduler)) + ")";
+        MultiTimer timer(name);
+        for (size_t iteration = 0; iteration < ITERATIONS; iteration++) {
+            DispatchQueue queue("BenchmarkContention", WORKER_COUNT, std::chrono::milliseconds(1), scheduler);
+            std::atomic_size_t count = 0;
+
+            Timer t(timer);
+            std::vector<std::thread> producers;
+            for (size_t p = 0; p < PRODUCER_COUNT; p++) {
+                producers.emplace_back([&queue, &count, p] {
+                    auto priority = (DispatchPriority)(p % DISPATCH_PRIORITY_COUNT);
+                    std::vector<AsyncPtr<void>> results(ITEM_COUNT / PRODUCER_COUNT);
+                    for (auto &result : results) {
+                        result = queue.Dispatch<void>(DispatchOptions{priority}, [&count] {
+                            count++;
+                        });
+                    }
+                    for (auto &result : results) {
+                        result->Get();
+                    }
+                });
+            }
+            for (auto &producer : producers) {
+                producer.join();
+            }
+            AssertEqual(count.load(), ITEM_COUNT, "Expected every work item to run");
+        }
+    }
+
+    void BenchmarkDispatchQueue() {
+        for (auto scheduler : {DispatchScheduler::Shared, DispatchScheduler::WorkStealing}) {
+            BenchmarkThroughput(scheduler);
+            BenchmarkContention(scheduler);
+        }
+    }
+
+    Test test(&BenchmarkDispatchQueue);
+} // namespace DispatchQueueBenchmarks
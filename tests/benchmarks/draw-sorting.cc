@@ -0,0 +1,219 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
+#include "core/Logging.hh"
+#include "core/RadixSort.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <random>
+#include <tests.hh>
+#include <vector>
+
+namespace DrawSortingBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t ITERATIONS = 20;
+    const size_t WORKER_COUNT = 4;
+    const size_t MIN_CHUNK = 1024;
+
+    // Same layout as VkDrawIndexedIndirectCommand and the vulkan GPUDrawParams
+    struct DrawCommand {
+        uint32 indexCount, instanceCount, firstIndex;
+        int32 vertexOffset;
+        uint32 firstInstance;
+    };
+
+    struct DrawParams {
+        uint16 baseColorTexID, metallicRoughnessTexID;
+        uint16 opticID, emissiveScale;
+    };
+
+    struct SortedDraw {
+        uint64 key;
+        DrawCommand command;
+    };
+
+    // One single-primitive renderable per draw, matching the inputs of GPUScene::GenerateSortedDrawsForView
+    struct BenchRenderable {
+        glm::mat4 modelToWorld;
+        glm::vec3 center;
+        uint16 baseColorTexID, metallicRoughnessTexID;
+        uint32 vertexOffset, indexCount;
+    };
+
+    std::vector<BenchRenderable> generateRenderables(size_t count) {
+        std::mt19937 rand(42);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_int_distribution<uint16> texture(0, 63);
+
+        std::vector<BenchRenderable> renderables(count);
+        for (size_t i = 0; i < count; i++) {
+            auto &renderable = renderables[i];
+            renderable.modelToWorld = glm::mat4(1);
+            renderable.modelToWorld[3] = glm::vec4(position(rand), position(rand), position(rand), 1);
+            renderable.center = glm::vec3(0, 0.5f, 0);
+            renderable.baseColorTexID = texture(rand);
+            renderable.metallicRoughnessTexID = texture(rand);
+            renderable.vertexOffset = i * 24;
+            renderable.indexCount = 36;
+        }
+        return renderables;
+    }
+
+    DrawCommand makeCommand(const BenchRenderable &renderable, uint32 firstInstance) {
+        DrawCommand cmd;
+        cmd.indexCount = renderable.indexCount;
+        cmd.instanceCount = 1;
+        cmd.firstIndex = 0;
+        cmd.vertexOffset = renderable.vertexOffset;
+        cmd.firstInstance = firstInstance;
+        return cmd;
+    }
+
+    DrawParams makeParams(const BenchRenderable &renderable) {
+        return {renderable.baseColorTexID, renderable.metallicRoughnessTexID, 0, 0};
+    }
+
+    float viewDepth(const BenchRenderable &renderable, glm::vec3 viewPosition) {
+        auto worldPos = renderable.modelToWorld * glm::vec4(renderable.center, 1);
+        return glm::length(glm::vec3(worldPos) / worldPos.w - viewPosition);
+    }
+
+    // The render thread path GPUScene used before radix sorting
+    void generateStdSort(const std::vector<BenchRenderable> &renderables,
+        glm::vec3 viewPosition,
+        std::vector<DrawCommand> &commands,
+        std::vector<DrawParams> &params) {
+        std::vector<float> depths;
+        commands.clear();
+        params.clear();
+        for (auto &renderable : renderables) {
+            commands.emplace_back(makeCommand(renderable, params.size()));
+            params.emplace_back(makeParams(renderable));
+            depths.emplace_back(viewDepth(renderable, viewPosition));
+        }
+        std::sort(commands.begin(), commands.end(), [&](auto a, auto b) {
+            return depths[a.firstInstance] < depths[b.firstInstance];
+        });
+    }
+
+    void generateRadixSort(const std::vector<BenchRenderable> &renderables,
+        glm::vec3 viewPosition,
+        DispatchQueue &queue,
+        size_t workerCount,
+        std::vector<DrawCommand> &commands,
+        std::vector<DrawParams> &params) {
+        struct Chunk {
+            std::vector<SortedDraw> draws;
+            std::vector<DrawParams> params;
+        };
+        size_t chunkCount = std::clamp(renderables.size() / MIN_CHUNK, size_t(1), workerCount + 1);
+        size_t chunkSize = (renderables.size() + chunkCount - 1) / chunkCount;
+        std::vector<Chunk> chunks(chunkCount);
+
+        auto generateChunk = [&](size_t chunkIndex) {
+            auto &chunk = chunks[chunkIndex];
+            size_t end = std::min((chunkIndex + 1) * chunkSize, renderables.size());
+            for (size_t i = chunkIndex * chunkSize; i < end; i++) {
+                auto &renderable = renderables[i];
+                auto &draw = chunk.draws.emplace_back();
+                draw.command = makeCommand(renderable, chunk.params.size());
+                auto &param = chunk.params.emplace_back(makeParams(renderable));
+                uint32 materialBits = ((uint32)param.baseColorTexID << 16) | param.metallicRoughnessTexID;
+                draw.key = ((uint64)OrderedFloatBits(viewDepth(renderable, viewPosition)) << 32) | materialBits;
+            }
+        };
+
+        std::vector<AsyncPtr<void>> pending;
+        for (size_t i = 1; i < chunkCount; i++) {
+            pending.emplace_back(queue.Dispatch<void>([&generateChunk, i] {
+                generateChunk(i);
+            }));
+        }
+        generateChunk(0);
+        for (auto &future : pending) {
+            future->Get();
+        }
+
+        std::vector<SortedDraw> draws, scratch;
+        params.clear();
+        for (auto &chunk : chunks) {
+            uint32 paramsOffset = params.size();
+            params.insert(params.end(), chunk.params.begin(), chunk.params.end());
+            for (auto &draw : chunk.draws) {
+                draws.emplace_back(draw).command.firstInstance += paramsOffset;
+            }
+        }
+        RadixSort(draws, scratch, [](const SortedDraw &draw) {
+            return draw.key;
+        });
+
+        commands.resize(draws.size());
+        for (size_t i = 0; i < draws.size(); i++) {
+            commands[i] = draws[i].command;
+        }
+    }
+
+    void BenchmarkDrawSorting() {
+        {
+            std::vector<uint64> keys = {5, 1ull << 40, 3, 0, ~0ull, 1ull << 40, 7};
+            std::vector<uint64> scratch;
+            auto expected = keys;
+            std::sort(expected.begin(), expected.end());
+            RadixSort(keys, scratch, [](uint64 key) {
+                return key;
+            });
+            AssertTrue(keys == expected, "Expected RadixSort to sort keys");
+            AssertTrue(OrderedFloatBits(-1.0f) < OrderedFloatBits(0.0f), "Expected ordered negative floats");
+            AssertTrue(OrderedFloatBits(0.5f) < OrderedFloatBits(2.0f), "Expected ordered positive floats");
+        }
+
+        DispatchQueue queue("BenchSortedDraws",
+            WORKER_COUNT,
+            std::chrono::milliseconds(5),
+            DispatchScheduler::WorkStealing);
+        glm::vec3 viewPosition(3, 1, -2);
+
+        for (size_t drawCount : {10000, 100000, 250000}) {
+            auto renderables = generateRenderables(drawCount);
+            std::vector<DrawCommand> stdCommands, radixCommands, serialCommands;
+            std::vector<DrawParams> stdParams, radixParams, serialParams;
+            {
+                MultiTimer timer("Generate " + std::to_string(drawCount) + " sorted draws (std::sort)");
+                for (size_t i = 0; i < ITERATIONS; i++) {
+                    Timer t(timer);
+                    generateStdSort(renderables, viewPosition, stdCommands, stdParams);
+                }
+            }
+            {
+                MultiTimer timer("Generate " + std::to_string(drawCount) + " sorted draws (radix sort, " +
+                                 std::to_string(WORKER_COUNT + 1) + " threads)");
+                for (size_t i = 0; i < ITERATIONS; i++) {
+                    Timer t(timer);
+                    generateRadixSort(renderables, viewPosition, queue, WORKER_COUNT, radixCommands, radixParams);
+                }
+            }
+
+            generateRadixSort(renderables, viewPosition, queue, 0, serialCommands, serialParams);
+            AssertEqual(radixCommands.size(), drawCount, "Expected a draw per renderable");
+            AssertTrue(std::memcmp(radixCommands.data(), serialCommands.data(), drawCount * sizeof(DrawCommand)) == 0,
+                "Expected sorted draws to be independent of the thread count");
+            for (size_t i = 1; i < drawCount; i++) {
+                float prevDepth = viewDepth(renderables[radixCommands[i - 1].firstInstance], viewPosition);
+                float depth = viewDepth(renderables[radixCommands[i].firstInstance], viewPosition);
+                AssertTrue(prevDepth <= depth, "Expected draws to be sorted nearest first");
+            }
+        }
+    }
+
+    Test test(&BenchmarkDrawSorting);
+} // namespace DrawSortingBenchmarks
@@ -0,0 +1,89 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/EntityMap.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <robin_hood.h>
+#include <tests.hh>
+#include <type_traits>
+#include <vector>
+
+namespace EntityMapBenchmarks {
+    using namespace testing;
+
+    const size_t ENTITY_COUNT = 50000;
+    const size_t ITERATIONS = 50;
+
+    struct Payload {
+        glm::vec3 position;
+        uint32_t counter;
+    };
+
+    // Inserts, looks up every entity, then erases every other entity
+    template<typename MapType>
+    size_t runOperations(MapType &map, const std::vector<Tecs::Entity> &entities) {
+        for (size_t i = 0; i < entities.size(); i++) {
+            map[entities[i]] = Payload{glm::vec3(i), (uint32_t)i};
+        }
+        size_t found = 0;
+        for (auto &ent : entities) {
+            auto it = map.find(ent);
+            if constexpr (std::is_pointer_v<decltype(it)>) {
+                if (it) found += it->counter;
+            } else {
+                if (it != map.end()) found += it->second.counter;
+            }
+        }
+        for (size_t i = 0; i < entities.size(); i += 2) {
+            map.erase(entities[i]);
+        }
+        for (auto &ent : entities) {
+            found += map.count(ent);
+        }
+        return found;
+    }
+
+    void BenchmarkEntityMap() {
+        std::vector<Tecs::Entity> entities;
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            for (size_t i = 0; i < ENTITY_COUNT; i++) {
+                entities.emplace_back(lock.NewEntity());
+            }
+        }
+
+        size_t entityMapResult = 0, hashMapResult = 0;
+        {
+            MultiTimer timer("EntityMap insert/find/erase 50000 entities");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                sp::EntityMap<Payload> map;
+                Timer t(timer);
+                entityMapResult = runOperations(map, entities);
+            }
+        }
+        {
+            MultiTimer timer("robin_hood::unordered_flat_map insert/find/erase 50000 entities");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                robin_hood::unordered_flat_map<Tecs::Entity, Payload> map;
+                Timer t(timer);
+                hashMapResult = runOperations(map, entities);
+            }
+        }
+        AssertEqual(entityMapResult, hashMapResult, "Expected EntityMap to match hash map results");
+
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            for (auto &ent : entities) {
+                ent.Destroy(lock);
+            }
+        }
+    }
+
+    Test test(&BenchmarkEntityMap);
+} // namespace EntityMapBenchmarks
@@ -0,0 +1,158 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/EntityMap.hh"
+#include "core/LockFreeMutex.hh"
+#include "core/PreservingMap.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/EntityReferenceManager.hh"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace EntityRefBenchmarks {
+    using namespace testing;
+    using namespace ecs;
+
+    const size_t NAME_COUNT = 10000;
+    const size_t THREAD_COUNT = 16;
+    const size_t OPS_PER_THREAD = 100000;
+    const size_t ITERATIONS = 5;
+
+    // The previous design: one lock around a PreservingMap and EntityMaps, with placeholder values instead of Refs
+    class SingleLockRefs {
+    public:
+        std::shared_ptr<Entity> Get(const Name &name) {
+            auto ref = refs.Load(name);
+            if (!ref) {
+                std::lock_guard lock(mutex);
+                ref = refs.Load(name);
+                if (ref) return ref;
+
+                ref = make_shared<Entity>();
+                refs.Register(name, ref);
+            }
+            return ref;
+        }
+
+        std::shared_ptr<Entity> Get(const Entity &entity) {
+            std::shared_lock lock(mutex);
+            if (liveRefs.count(entity) == 0) return nullptr;
+            return liveRefs[entity].lock();
+        }
+
+        void Set(const Name &name, const Entity &entity) {
+            auto ref = Get(name);
+            std::lock_guard lock(mutex);
+            *ref = entity;
+            liveRefs[entity] = ref;
+        }
+
+    private:
+        sp::LockFreeMutex mutex;
+        sp::PreservingMap<Name, Entity, 1000> refs;
+        sp::EntityMap<std::weak_ptr<Entity>> liveRefs;
+    };
+
+    // Each thread does 80% Get(name), 10% Get(entity), and 10% Set(name, entity)
+    void runMixed(const std::string &name, std::function<void(size_t, size_t)> operation) {
+        MultiTimer timer(name);
+        for (size_t iteration = 0; iteration < ITERATIONS; iteration++) {
+            Timer t(timer);
+            std::vector<std::thread> threads;
+            for (size_t thread = 0; thread < THREAD_COUNT; thread++) {
+                threads.emplace_back([&operation, thread] {
+                    uint32_t state = (uint32_t)thread * 7919 + 1;
+                    for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+                        state = state * 1664525u + 1013904223u;
+                        operation((state >> 8) % NAME_COUNT, (state >> 4) % 10);
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+    }
+
+    void BenchmarkEntityRefs() {
+        std::vector<Name> names;
+        std::vector<Entity> entities;
+        {
+            auto lock = StartTransaction<AddRemove>();
+            for (size_t i = 0; i < NAME_COUNT; i++) {
+                names.emplace_back("bench_refs", "bench_ref_" + std::to_string(i));
+                entities.emplace_back(lock.NewEntity());
+            }
+        }
+
+        SingleLockRefs singleLockRefs;
+        for (size_t i = 0; i < NAME_COUNT; i++) {
+            singleLockRefs.Set(names[i], entities[i]);
+        }
+        std::atomic_size_t singleLockMisses = 0;
+        runMixed("Single lock refs, 16 threads x 100000 mixed ops", [&](size_t index, size_t op) {
+            if (op == 0) {
+                singleLockRefs.Set(names[index], entities[index]);
+            } else if (op == 1) {
+                if (!singleLockRefs.Get(entities[index])) singleLockMisses++;
+            } else if (!singleLockRefs.Get(names[index])) {
+                singleLockMisses++;
+            }
+        });
+        AssertEqual(singleLockMisses.load(), 0u, "Expected every single lock lookup to succeed");
+
+        // Hold a reference to every name so none of them expire during the benchmark
+        std::vector<EntityRef> held;
+        {
+            Timer t("EntityReferenceManager Set 10000 names");
+            for (size_t i = 0; i < NAME_COUNT; i++) {
+                held.emplace_back(GetEntityRefs().Set(names[i], entities[i]));
+            }
+        }
+        std::atomic_size_t misses = 0;
+        runMixed("Sharded EntityReferenceManager, 16 threads x 100000 mixed ops", [&](size_t index, size_t op) {
+            if (op == 0) {
+                GetEntityRefs().Set(names[index], entities[index]);
+            } else if (op == 1) {
+                if (GetEntityRefs().Get(entities[index]) != held[index]) misses++;
+            } else if (GetEntityRefs().Get(names[index]) != held[index]) {
+                misses++;
+            }
+        });
+        AssertEqual(misses.load(), 0u, "Expected every lookup to return the held EntityRef");
+
+        for (size_t i = 0; i < NAME_COUNT; i++) {
+            AssertEqual(held[i].GetLive(), entities[i], "Expected EntityRef to point to its entity");
+        }
+        {
+            Timer t("EntityReferenceManager GetNames prefix search");
+            AssertEqual(GetEntityRefs().GetNames("bench_refs:bench_ref_999").size(),
+                11u,
+                "Expected a match for bench_ref_999 and bench_ref_9990-9999");
+            AssertEqual(GetEntityRefs().GetNames("bench_ref_123").size(),
+                11u,
+                "Expected a match for bench_ref_123 and bench_ref_1230-1239");
+        }
+
+        {
+            auto lock = StartTransaction<AddRemove>();
+            for (auto &ent : entities) {
+                ent.Destroy(lock);
+            }
+        }
+    }
+
+    Test test(&BenchmarkEntityRefs);
+} // namespace EntityRefBenchmarks
@@ -0,0 +1,140 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <tests.hh>
+
+// Count heap allocations made by the whole benchmark binary
+static std::atomic_size_t allocationCount = 0;
+
+void *operator new(size_t size) {
+    allocationCount++;
+    if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    std::free(ptr);
+}
+
+namespace EventQueueBenchmarks {
+    using namespace testing;
+
+    const size_t EVENTS_PER_FRAME = 500;
+    const size_t FRAME_COUNT = 1000;
+
+    const std::string INPUT_EVENT = "/bench/input/key";
+    const std::string OUTPUT_EVENT = "/bench/action/press";
+
+    void logRate(const std::string &name, size_t eventCount, size_t allocations, chrono_clock::duration elapsed) {
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+        Logf("%s: %.0f events/sec, %.3f allocations/event",
+            name,
+            eventCount / seconds,
+            allocations / (double)eventCount);
+    }
+
+    void BenchmarkQueueAddPoll() {
+        ecs::EventQueueRef queue = ecs::NewEventQueue();
+        ecs::EventName name(OUTPUT_EVENT);
+        ecs::Event event;
+
+        size_t allocations = 0;
+        chrono_clock::duration elapsed(0);
+        {
+            MultiTimer timer("EventQueue Add/Poll 500 events per frame");
+            for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                Timer t(timer);
+                auto start = chrono_clock::now();
+                size_t startAllocations = allocationCount.load();
+                for (size_t i = 0; i < EVENTS_PER_FRAME; i++) {
+                    queue->Add(ecs::Event{name, Tecs::Entity(), glm::vec2(frame, i)});
+                }
+                size_t polled = 0;
+                while (queue->Poll(event)) {
+                    polled++;
+                }
+                // Skip the first frame so only steady state allocations are counted
+                if (frame > 0) {
+                    allocations += allocationCount.load() - startAllocations;
+                    elapsed += chrono_clock::now() - start;
+                }
+                AssertEqual(polled, EVENTS_PER_FRAME, "Expected to poll every event");
+            }
+        }
+        logRate("EventQueue Add/Poll", (FRAME_COUNT - 1) * EVENTS_PER_FRAME, allocations, elapsed);
+        AssertEqual(allocations, 0u, "Expected EventQueue Add/Poll to not allocate");
+    }
+
+    void BenchmarkSendEvent() {
+        Tecs::Entity source, target;
+        ecs::EventQueueRef queue = ecs::NewEventQueue();
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            source = lock.NewEntity();
+            ecs::EntityRef sourceRef(ecs::Name("bench", "source"), source);
+            source.Set<ecs::Name>(lock, "bench", "source");
+
+            target = lock.NewEntity();
+            ecs::EntityRef targetRef(ecs::Name("bench", "target"), target);
+            target.Set<ecs::Name>(lock, "bench", "target");
+            auto &eventInput = target.Set<ecs::EventInput>(lock);
+            eventInput.Register(lock, queue, OUTPUT_EVENT);
+
+            auto &bindings = source.Set<ecs::EventBindings>(lock);
+            bindings.Bind(INPUT_EVENT, target, OUTPUT_EVENT);
+        }
+
+        // Resolve the target and name once up front, as systems sending events every frame would
+        ecs::EntityRef sourceRef(source);
+        ecs::EventName name(INPUT_EVENT);
+        ecs::Event event;
+        size_t allocations = 0;
+        chrono_clock::duration elapsed(0);
+        {
+            MultiTimer timer("EventBindings::SendEvent 500 events per frame");
+            for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                {
+                    auto lock = ecs::StartTransaction<ecs::SendEventsLock>();
+                    Timer t(timer);
+                    auto start = chrono_clock::now();
+                    size_t startAllocations = allocationCount.load();
+                    for (size_t i = 0; i < EVENTS_PER_FRAME; i++) {
+                        ecs::EventBindings::SendEvent(lock, sourceRef, ecs::Event{name, source, (int)i});
+                    }
+                    if (frame > 0) {
+                        allocations += allocationCount.load() - startAllocations;
+                        elapsed += chrono_clock::now() - start;
+                    }
+                }
+                {
+                    auto lock = ecs::StartTransaction<ecs::Read<ecs::EventInput>>();
+                    size_t polled = 0;
+                    while (ecs::EventInput::Poll(lock, queue, event)) {
+                        polled++;
+                    }
+                    AssertEqual(polled, EVENTS_PER_FRAME, "Expected to poll every event");
+                }
+            }
+        }
+        logRate("EventBindings::SendEvent", (FRAME_COUNT - 1) * EVENTS_PER_FRAME, allocations, elapsed);
+    }
+
+    Test test1(&BenchmarkQueueAddPoll);
+    Test test2(&BenchmarkSendEvent);
+} // namespace EventQueueBenchmarks
@@ -0,0 +1,94 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/LockFreeEventQueue.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/ScriptManager.hh"
+#include "game/GameLogic.hh"
+#include "input/BindingNames.hh"
+
+#include <glm/glm.hpp>
+#include <tests.hh>
+#include <vector>
+
+namespace GameLogicBenchmarks {
+    using namespace testing;
+    using namespace ecs;
+
+    const size_t ENTITY_COUNT = 2000;
+    const size_t BINDINGS_PER_ENTITY = 4;
+    const size_t INPUT_EVENTS_PER_TICK = 20;
+    const size_t TICK_COUNT = 500;
+
+    void BenchmarkGameLogicTick() {
+        Entity keyboard;
+        std::vector<Entity> entities;
+        {
+            Timer t("Create 2000 entities with rotate scripts and signal bindings");
+            auto lock = StartTransaction<AddRemove>();
+            Name keyboardName("input", "keyboard");
+            keyboard = lock.NewEntity();
+            EntityRef keyboardRef(keyboardName, keyboard);
+            keyboard.Set<Name>(lock, keyboardName);
+            keyboard.Set<EventBindings>(lock);
+
+            for (size_t i = 0; i < ENTITY_COUNT; i++) {
+                Entity ent = lock.NewEntity();
+                Name name("bench", "logic" + std::to_string(i));
+                EntityRef ref(name, ent);
+                ent.Set<Name>(lock, name);
+                ent.Set<TransformTree>(lock, glm::vec3(i * 0.01f, 0, 0));
+                auto &state = ent.Set<Scripts>(lock).AddOnTick(name, "rotate");
+                state.SetParam<glm::vec3>("axis", glm::vec3(0, 1, 0));
+                state.SetParam<float>("speed", 1.0f + (i % 10));
+
+                for (size_t b = 0; b < BINDINGS_PER_ENTITY; b++) {
+                    SignalRef(ent, "binding" + std::to_string(b))
+                        .SetBinding(lock, "input:keyboard/key_w + input:keyboard/key_s * " + std::to_string(b), name);
+                }
+                entities.emplace_back(ent);
+            }
+            GetScriptManager().RegisterEvents(lock);
+        }
+
+        sp::LockFreeEventQueue<Event> inputQueue;
+        {
+            sp::GameLogic logic(inputQueue, true);
+            // Run each step as soon as it is requested rather than waiting for the next frame interval
+            logic.interval = chrono_clock::duration(0);
+            logic.StartThread();
+
+            MultiTimer timer("GameLogic tick 2000 scripted entities, 20 input events");
+            for (size_t tick = 0; tick < TICK_COUNT; tick++) {
+                for (size_t i = 0; i < INPUT_EVENTS_PER_TICK; i++) {
+                    auto eventName = i % 2 == 0 ? INPUT_EVENT_KEYBOARD_KEY_DOWN : INPUT_EVENT_KEYBOARD_KEY_UP;
+                    inputQueue.PushEvent(Event{eventName, keyboard, std::string(i % 4 < 2 ? "w" : "s")});
+                }
+                Timer t(timer);
+                logic.Step(1);
+            }
+        }
+
+        {
+            auto lock = StartTransaction<Read<TransformTree>>();
+            for (auto &ent : entities) {
+                auto rotation = ent.Get<TransformTree>(lock).pose.GetRotation();
+                AssertTrue(rotation != glm::identity<glm::quat>(), "Expected rotate script to run");
+            }
+        }
+        {
+            auto lock = StartTransaction<AddRemove>();
+            keyboard.Destroy(lock);
+            for (auto &ent : entities) {
+                ent.Destroy(lock);
+            }
+        }
+    }
+
+    Test test(&BenchmarkGameLogicTick);
+} // namespace GameLogicBenchmarks
@@ -0,0 +1,248 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/AssetManager.hh"
+#include "assets/Gltf.hh"
+#include "assets/GltfImpl.hh"
+#include "core/Common.hh"
+#include "core/Logging.hh"
+
+#include <cstring>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <tests.hh>
+#include <vector>
+
+namespace GltfAccessorBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t VERTEX_COUNT = 1000000;
+    const size_t ITERATIONS = 10;
+
+    // Same layout as the vulkan SceneVertex and JointVertex
+    struct BenchVertex {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 uv;
+    };
+
+    struct BenchJoints {
+        glm::vec4 jointWeights;
+        glm::u16vec4 jointIndexes;
+        float _padding[2];
+    };
+
+    struct ConvertedMesh {
+        std::vector<uint32_t> indices;
+        std::vector<BenchVertex> vertices;
+        std::vector<BenchJoints> joints;
+
+        bool operator==(const ConvertedMesh &other) const {
+            return indices == other.indices &&
+                   std::memcmp(vertices.data(), other.vertices.data(), vertices.size() * sizeof(BenchVertex)) == 0 &&
+                   std::memcmp(joints.data(), other.joints.data(), joints.size() * sizeof(BenchJoints)) == 0;
+        }
+    };
+
+    template<typename T>
+    int addAccessor(tinygltf::Model &model, int bufferView, size_t offset, size_t count, bool normalized) {
+        auto &accessor = model.accessors.emplace_back();
+        accessor.bufferView = bufferView;
+        accessor.byteOffset = offset;
+        accessor.count = count;
+        accessor.type = gltf::detail::gltfType<T>();
+        accessor.componentType = gltf::detail::gltfComponentType<T>();
+        accessor.normalized = normalized;
+        return model.accessors.size() - 1;
+    }
+
+    template<typename T>
+    int addBufferView(tinygltf::Model &model, const std::vector<T> &data, size_t byteStride = 0) {
+        auto &buffer = model.buffers[0].data;
+        size_t offset = buffer.size();
+        buffer.resize(offset + data.size() * sizeof(T));
+        std::memcpy(buffer.data() + offset, data.data(), data.size() * sizeof(T));
+
+        auto &view = model.bufferViews.emplace_back();
+        view.buffer = 0;
+        view.byteOffset = offset;
+        view.byteLength = data.size() * sizeof(T);
+        view.byteStride = byteStride;
+        return model.bufferViews.size() - 1;
+    }
+
+    // A quantized mesh as produced by KHR_mesh_quantization exporters, with interleaved positions and normals
+    tinygltf::Model generateModel() {
+        tinygltf::Model model;
+        model.buffers.emplace_back();
+
+        std::vector<glm::vec3> positionsAndNormals(VERTEX_COUNT * 2);
+        std::vector<glm::u16vec2> uvs(VERTEX_COUNT);
+        std::vector<glm::u8vec4> joints(VERTEX_COUNT), weights(VERTEX_COUNT);
+        std::vector<uint16_t> indices(VERTEX_COUNT);
+        for (size_t i = 0; i < VERTEX_COUNT; i++) {
+            positionsAndNormals[i * 2] = glm::vec3(i * 0.001f, std::sin(i * 0.01f), std::cos(i * 0.01f));
+            positionsAndNormals[i * 2 + 1] = glm::normalize(glm::vec3(1, i % 7, i % 13));
+            uvs[i] = glm::u16vec2(i * 31, i * 17);
+            joints[i] = glm::u8vec4(i % 64, (i + 1) % 64, (i + 2) % 64, (i + 3) % 64);
+            weights[i] = glm::u8vec4(128, 64, 32, 31);
+            indices[i] = (uint16_t)((i * 3) % 65536);
+        }
+
+        int interleavedView = addBufferView(model, positionsAndNormals, sizeof(glm::vec3) * 2);
+        auto &primitive = model.meshes.emplace_back().primitives.emplace_back();
+        primitive.mode = TINYGLTF_MODE_TRIANGLES;
+        primitive.attributes["POSITION"] = addAccessor<glm::vec3>(model, interleavedView, 0, VERTEX_COUNT, false);
+        primitive.attributes["NORMAL"] = addAccessor<glm::vec3>(model,
+            interleavedView,
+            sizeof(glm::vec3),
+            VERTEX_COUNT,
+            false);
+        primitive.attributes["TEXCOORD_0"] = addAccessor<glm::u16vec2>(model,
+            addBufferView(model, uvs),
+            0,
+            VERTEX_COUNT,
+            true);
+        primitive.attributes["JOINTS_0"] = addAccessor<glm::u8vec4>(model,
+            addBufferView(model, joints),
+            0,
+            VERTEX_COUNT,
+            false);
+        primitive.attributes["WEIGHTS_0"] = addAccessor<glm::u8vec4>(model,
+            addBufferView(model, weights),
+            0,
+            VERTEX_COUNT,
+            true);
+        primitive.indices = addAccessor<uint16_t>(model, addBufferView(model, indices), 0, VERTEX_COUNT, false);
+        return model;
+    }
+
+    // Matches the per-vertex loop Mesh.cc used before ReadRange was added
+    void convertPerElement(const gltf::Mesh::Primitive &prim, ConvertedMesh &output) {
+        output.indices.resize(prim.indexBuffer.Count());
+        for (size_t i = 0; i < output.indices.size(); i++) {
+            output.indices[i] = prim.indexBuffer.Read(i);
+        }
+        output.vertices.resize(prim.positionBuffer.Count());
+        output.joints.resize(std::min(prim.jointsBuffer.Count(), output.vertices.size()));
+        for (size_t i = 0; i < output.vertices.size(); i++) {
+            auto &vertex = output.vertices[i];
+            vertex.position = prim.positionBuffer.Read(i);
+            if (i < prim.normalBuffer.Count()) vertex.normal = prim.normalBuffer.Read(i);
+            if (i < prim.texcoordBuffer.Count()) vertex.uv = prim.texcoordBuffer.Read(i);
+            if (i < output.joints.size()) {
+                output.joints[i].jointIndexes = prim.jointsBuffer.Read(i);
+                output.joints[i].jointWeights = prim.weightsBuffer.Read(i);
+            }
+        }
+    }
+
+    void convertRange(const gltf::Mesh::Primitive &prim, ConvertedMesh &output) {
+        output.indices.resize(prim.indexBuffer.Count());
+        prim.indexBuffer.ReadRange(0, output.indices.size(), output.indices.data());
+
+        size_t vertexCount = prim.positionBuffer.Count();
+        output.vertices.resize(vertexCount);
+        auto *vertices = output.vertices.data();
+        prim.positionBuffer.ReadRange(0, vertexCount, &vertices->position, sizeof(BenchVertex));
+        prim.normalBuffer.ReadRange(0,
+            std::min(vertexCount, prim.normalBuffer.Count()),
+            &vertices->normal,
+            sizeof(BenchVertex));
+        prim.texcoordBuffer.ReadRange(0,
+            std::min(vertexCount, prim.texcoordBuffer.Count()),
+            &vertices->uv,
+            sizeof(BenchVertex));
+
+        output.joints.resize(std::min(prim.jointsBuffer.Count(), vertexCount));
+        prim.jointsBuffer.ReadRange(0, output.joints.size(), &output.joints.data()->jointIndexes, sizeof(BenchJoints));
+        prim.weightsBuffer.ReadRange(0, output.joints.size(), &output.joints.data()->jointWeights, sizeof(BenchJoints));
+    }
+
+    void benchmarkPrimitives(const std::string &name, const std::vector<const gltf::Mesh::Primitive *> &primitives) {
+        size_t vertexCount = 0;
+        for (auto *prim : primitives) {
+            vertexCount += prim->positionBuffer.Count();
+        }
+        if (vertexCount == 0) return;
+
+        std::vector<ConvertedMesh> perElement(primitives.size()), range(primitives.size());
+        chrono_clock::duration perElementTime(0), rangeTime(0);
+        {
+            MultiTimer timer("Read " + name + " per element (" + std::to_string(vertexCount) + " vertices)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                auto start = chrono_clock::now();
+                for (size_t p = 0; p < primitives.size(); p++) {
+                    convertPerElement(*primitives[p], perElement[p]);
+                }
+                perElementTime += chrono_clock::now() - start;
+            }
+        }
+        {
+            MultiTimer timer("ReadRange " + name + " (" + std::to_string(vertexCount) + " vertices)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                auto start = chrono_clock::now();
+                for (size_t p = 0; p < primitives.size(); p++) {
+                    convertRange(*primitives[p], range[p]);
+                }
+                rangeTime += chrono_clock::now() - start;
+            }
+        }
+        for (size_t p = 0; p < primitives.size(); p++) {
+            AssertTrue(perElement[p] == range[p], "Expected ReadRange to match per element reads: " + name);
+        }
+
+        auto verticesPerSecond = [&](chrono_clock::duration time) {
+            double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(time).count();
+            return vertexCount * ITERATIONS / seconds / 1e6;
+        };
+        Logf("%s: %.1fM vertices/sec per element, %.1fM vertices/sec ReadRange",
+            name,
+            verticesPerSecond(perElementTime),
+            verticesPerSecond(rangeTime));
+    }
+
+    void BenchmarkGltfAccessor() {
+        {
+            auto model = generateModel();
+            gltf::Mesh mesh(model, model.meshes[0]);
+            AssertTrue((bool)mesh.primitives[0].texcoordBuffer, "Expected normalized texcoords to be supported");
+            AssertTrue((bool)mesh.primitives[0].weightsBuffer, "Expected normalized weights to be supported");
+            AssertEqual(mesh.primitives[0].weightsBuffer.Read(0).x, 128.0f / 255.0f, "Expected normalized weight");
+
+            benchmarkPrimitives("quantized mesh", {&mesh.primitives[0]});
+        }
+
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/models", ec)) {
+            Logf("Skipping bundled model accessor benchmark, bundled models not found");
+            return;
+        }
+
+        std::vector<std::shared_ptr<const Gltf>> models;
+        for (auto &entry : std::filesystem::recursive_directory_iterator("../assets/models")) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".glb") continue;
+            auto model = Assets().LoadGltf(entry.path().stem().string())->Get();
+            if (model) models.emplace_back(model);
+        }
+        std::vector<const gltf::Mesh::Primitive *> primitives;
+        for (auto &model : models) {
+            for (auto &mesh : model->meshes) {
+                if (!mesh) continue;
+                for (auto &prim : mesh->primitives) {
+                    primitives.emplace_back(&prim);
+                }
+            }
+        }
+        benchmarkPrimitives(std::to_string(models.size()) + " bundled models", primitives);
+    }
+
+    Test test(&BenchmarkGltfAccessor);
+} // namespace GltfAccessorBenchmarks
@@ -0,0 +1,162 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "assets/Gltf.hh"
+#include "assets/MappedFile.hh"
+#include "assets/PhysicsInfo.hh"
+#include "cooking/ConvexHull.hh"
+#include "cooking/HullCachePack.hh"
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
+#include "core/Logging.hh"
+
+#include <PxPhysicsAPI.h>
+#include <extensions/PxDefaultAllocator.h>
+#include <extensions/PxDefaultErrorCallback.h>
+#include <filesystem>
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace HullCookingBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t WARM_ITERATIONS = 10;
+
+    struct HullJob {
+        AsyncPtr<Gltf> model;
+        AsyncPtr<HullSettings> settings;
+        Hash128 modelHash;
+    };
+
+    std::vector<HullJob> findBundledHulls(size_t &modelCount) {
+        std::vector<HullJob> jobs;
+        for (auto &entry : std::filesystem::recursive_directory_iterator("../assets/models")) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".glb") continue;
+            auto modelName = entry.path().stem().string();
+            auto modelPtr = Assets().LoadGltf(modelName);
+            auto model = modelPtr->Get();
+            if (!model || !model->asset) continue;
+            modelCount++;
+
+            std::vector<std::string> meshNames;
+            auto physicsInfo = Assets().LoadPhysicsInfo(modelName)->Get();
+            if (physicsInfo) {
+                for (auto &[meshName, settings] : physicsInfo->GetHulls()) {
+                    meshNames.emplace_back(meshName);
+                }
+            }
+            for (size_t i = 0; i < model->meshes.size(); i++) {
+                meshNames.emplace_back("convex" + std::to_string(i));
+            }
+            for (auto &meshName : meshNames) {
+                auto settingsPtr = Assets().LoadHullSettings(modelName, meshName);
+                if (settingsPtr->Get()) jobs.push_back({modelPtr, settingsPtr, model->asset->Hash()});
+            }
+        }
+        return jobs;
+    }
+
+    void BenchmarkHullCooking() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/models", ec)) {
+            Logf("Skipping hull cooking benchmark, bundled models not found");
+            return;
+        }
+
+        physx::PxDefaultErrorCallback errorCallback;
+        physx::PxDefaultAllocator allocator;
+        auto *foundation = PxCreateFoundation(PX_PHYSICS_VERSION, allocator, errorCallback);
+        Assert(foundation, "PxCreateFoundation");
+        physx::PxTolerancesScale scale;
+        auto *physics = PxCreatePhysics(PX_PHYSICS_VERSION, *foundation, scale);
+        Assert(physics, "PxCreatePhysics");
+        auto *cooking = PxCreateCooking(PX_PHYSICS_VERSION, *foundation, physx::PxCookingParams(scale));
+        Assert(cooking, "PxCreateCooking");
+        auto *registry = physx::PxSerialization::createSerializationRegistry(*physics);
+        Assert(registry, "PxSerialization::createSerializationRegistry");
+
+        {
+            size_t modelCount = 0;
+            auto jobs = findBundledHulls(modelCount);
+            auto jobsName = std::to_string(jobs.size()) + " hull sets from " + std::to_string(modelCount) + " models";
+
+            std::vector<std::shared_ptr<ConvexHullSet>> serialSets(jobs.size()), parallelSets(jobs.size());
+            {
+                Timer t("Cold cook " + jobsName + " (serial)");
+                for (size_t i = 0; i < jobs.size(); i++) {
+                    serialSets[i] = hullgen::BuildConvexHulls(*cooking, *physics, jobs[i].model, jobs[i].settings);
+                }
+            }
+
+            uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+            {
+                DispatchQueue hullQueue("BenchHulls", threadCount);
+                DispatchQueue cookingQueue("BenchHullCooking",
+                    threadCount,
+                    std::chrono::milliseconds(5),
+                    DispatchScheduler::WorkStealing);
+
+                Timer t("Cold cook " + jobsName + " (" + std::to_string(threadCount) + " threads)");
+                std::vector<AsyncPtr<ConvexHullSet>> futures;
+                for (auto &job : jobs) {
+                    futures.emplace_back(hullQueue.Dispatch<ConvexHullSet>([&, job]() {
+                        return hullgen::BuildConvexHulls(*cooking, *physics, job.model, job.settings, &cookingQueue);
+                    }));
+                }
+                for (size_t i = 0; i < jobs.size(); i++) {
+                    parallelSets[i] = futures[i]->Get();
+                }
+            }
+
+            std::vector<HullCachePack::SourceEntry> entries;
+            for (size_t i = 0; i < jobs.size(); i++) {
+                AssertTrue(serialSets[i] && parallelSets[i], "Expected hull sets to be cooked");
+                AssertEqual(parallelSets[i]->hulls.size(),
+                    serialSets[i]->hulls.size(),
+                    "Expected parallel cooking to match serial cooking");
+
+                auto &entry = entries.emplace_back();
+                entry.modelHash = jobs[i].modelHash;
+                entry.settingsHash = hullgen::HashHullSettings(*jobs[i].settings->Get());
+                entry.data = hullgen::SerializeConvexHulls(*registry, *parallelSets[i], jobs[i].settings->Get()->name);
+            }
+
+            auto packPath = std::filesystem::temp_directory_path() / "sp-bench-collision.sphulls";
+            AssertTrue(HullCachePack::Write(packPath, entries), "Failed to write hull cache pack");
+
+            {
+                MultiTimer timer("Warm load " + jobsName + " (mapped cache pack)");
+                for (size_t iteration = 0; iteration < WARM_ITERATIONS; iteration++) {
+                    Timer t(timer);
+                    auto mapping = MappedFile::Open(packPath.string());
+                    Assert(mapping, "Failed to map hull cache pack");
+                    auto pack = HullCachePack::Open(mapping, mapping->Data(), mapping->Size());
+                    Assert(pack, "Failed to open hull cache pack");
+                    for (size_t i = 0; i < jobs.size(); i++) {
+                        auto data = pack->Find(entries[i].modelHash, entries[i].settingsHash);
+                        AssertTrue(!data.empty(), "Expected hull set in cache pack");
+                        auto set = hullgen::DeserializeConvexHulls(*registry, data, jobs[i].model, jobs[i].settings);
+                        AssertTrue(set && set->hulls.size() == serialSets[i]->hulls.size(),
+                            "Expected cached hulls to match cooked hulls");
+                    }
+                }
+            }
+            std::filesystem::remove(packPath, ec);
+        }
+
+        registry->release();
+        cooking->release();
+        physics->release();
+        foundation->release();
+    }
+
+    Test test(&BenchmarkHullCooking);
+} // namespace HullCookingBenchmarks
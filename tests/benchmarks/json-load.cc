@@ -0,0 +1,79 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <picojson/picojson.h>
+#include <sstream>
+#include <tests.hh>
+#include <vector>
+
+namespace JsonLoadBenchmarks {
+    using namespace testing;
+
+    const size_t ENTITY_COUNT = 2000;
+    const size_t ITERATIONS = 20;
+
+    // A synthetic scene exercising the most common component loaders
+    std::string generateSceneJson() {
+        std::stringstream ss;
+        ss << R"({"entities": [)";
+        for (size_t i = 0; i < ENTITY_COUNT; i++) {
+            if (i > 0) ss << ",";
+            ss << R"({"name": "ent)" << i << R"(",)";
+            ss << R"("transform": {"translate": [)" << i << R"(, 1.5, -2], "rotate": [90, 0, 1, 0], "scale": 0.5},)";
+            ss << R"("signal_output": {"value": )" << i << R"(, "enabled": 1},)";
+            ss << R"("signal_bindings": {"sum": "ent)" << i << R"(/value + 1", "gate": "ent)" << i
+               << R"(/enabled && ent0/value > 0.5"},)";
+            ss << R"("event_bindings": {"/action/press": "ent)" << ((i + 1) % ENTITY_COUNT) << R"(/action/notify"}})";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    size_t loadEntities(const picojson::value &root, std::vector<ecs::FlatEntity> &entities) {
+        ecs::EntityScope scope("bench", "");
+        auto &sceneObj = root.get<picojson::object>();
+        for (auto &value : sceneObj.at("entities").get<picojson::array>()) {
+            auto &entSrc = value.get<picojson::object>();
+            auto &entDst = entities.emplace_back();
+            ecs::Name name(entSrc.at("name").get<std::string>(), scope);
+            if (name) std::get<std::optional<ecs::Name>>(entDst) = name;
+            for (auto &comp : entSrc) {
+                if (comp.first == "name") continue;
+                auto componentType = ecs::LookupComponent(comp.first);
+                if (componentType) componentType->LoadEntity(entDst, comp.second);
+            }
+        }
+        return entities.size();
+    }
+
+    void BenchmarkJsonLoad() {
+        std::string source = generateSceneJson();
+
+        picojson::value root;
+        {
+            MultiTimer timer("Parse 2000 entity json document");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                std::string err = picojson::parse(root, source);
+                Assertf(err.empty(), "Failed to parse json: %s", err);
+            }
+        }
+        {
+            MultiTimer timer("Load components for 2000 json entities");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                std::vector<ecs::FlatEntity> entities;
+                Timer t(timer);
+                AssertEqual(loadEntities(root, entities), ENTITY_COUNT, "Expected every entity to load");
+            }
+        }
+    }
+
+    Test test(&BenchmarkJsonLoad);
+} // namespace JsonLoadBenchmarks
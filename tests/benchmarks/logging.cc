@@ -0,0 +1,111 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace LoggingBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t PRODUCER_COUNT = 8;
+    const size_t MESSAGES_PER_PRODUCER = 20000;
+
+    // Discards everything written to it, so the benchmark measures logging rather than the terminal
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override {
+            return c;
+        }
+
+        std::streamsize xsputn(const char *, std::streamsize count) override {
+            return count;
+        }
+    };
+
+    // The logging path before messages were buffered: format, write, and append to the console on the caller
+    std::mutex syncLinesMutex;
+    std::vector<std::string> syncLines;
+
+    template<typename... T>
+    void syncLog(const std::string &fmt, T... t) {
+        std::string format = "%.3f [log] " + fmt + "\n";
+        int size = std::snprintf(nullptr, 0, format.c_str(), logging::LogTime(), t...);
+        std::unique_ptr<char[]> buf(new char[size + 1]);
+        std::snprintf(buf.get(), size + 1, format.c_str(), logging::LogTime(), t...);
+        std::cerr << buf.get();
+        std::lock_guard lock(syncLinesMutex);
+        syncLines.emplace_back(buf.get(), buf.get() + size);
+    }
+
+    // Logs from every producer at once, recording the latency of each call
+    void runProducers(const std::string &name, std::function<void(size_t, size_t)> logMessage) {
+        std::vector<std::vector<std::chrono::nanoseconds>> latencies(PRODUCER_COUNT);
+        {
+            // Total time for every producer, which the per-call latencies below don't capture
+            Timer t(name + " total");
+            std::vector<std::thread> producers;
+            for (size_t p = 0; p < PRODUCER_COUNT; p++) {
+                producers.emplace_back([&, p] {
+                    auto &producerLatencies = latencies[p];
+                    producerLatencies.reserve(MESSAGES_PER_PRODUCER);
+                    for (size_t i = 0; i < MESSAGES_PER_PRODUCER; i++) {
+                        auto callStart = chrono_clock::now();
+                        logMessage(p, i);
+                        producerLatencies.emplace_back(chrono_clock::now() - callStart);
+                    }
+                });
+            }
+            for (auto &producer : producers) {
+                producer.join();
+            }
+        }
+
+        MultiTimer timer(name + " call latency");
+        for (auto &producerLatencies : latencies) {
+            for (auto latency : producerLatencies) {
+                timer.AddValue(latency);
+            }
+        }
+    }
+
+    void BenchmarkLogging() {
+        NullBuffer nullBuffer;
+        auto *stderrBuffer = std::cerr.rdbuf(&nullBuffer);
+        size_t messageCount = PRODUCER_COUNT * MESSAGES_PER_PRODUCER;
+
+        runProducers("Synchronous logging, 8 producers", [](size_t producer, size_t i) {
+            syncLog("Producer %u loaded asset %u: %s (%.2f ms)", producer, i, "models/duck.glb", i * 0.01f);
+        });
+        AssertEqual(syncLines.size(), messageCount, "Expected every synchronous message to be stored");
+        syncLines.clear();
+
+        auto before = logging::GetLogStats();
+        runProducers("Buffered logging, 8 producers", [](size_t producer, size_t i) {
+            Logf("Producer %u loaded asset %u: %s (%.2f ms)", producer, i, "models/duck.glb", i * 0.01f);
+        });
+        logging::Flush();
+        auto after = logging::GetLogStats();
+
+        std::cerr.rdbuf(stderrBuffer);
+
+        size_t written = after.written - before.written;
+        size_t dropped = after.dropped - before.dropped;
+        Logf("Buffered logging wrote %u messages and dropped %u", written, dropped);
+        AssertTrue(written + dropped >= messageCount, "Expected every buffered message to be written or dropped");
+        AssertTrue(written > 0, "Expected buffered messages to be written");
+    }
+
+    Test test(&BenchmarkLogging);
+} // namespace LoggingBenchmarks
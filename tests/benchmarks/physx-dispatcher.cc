@@ -0,0 +1,125 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "physx/PhysxCpuDispatcher.hh"
+
+#include <PxPhysicsAPI.h>
+#include <chrono>
+#include <cmath>
+#include <extensions/PxDefaultAllocator.h>
+#include <foundation/PxErrorCallback.h>
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace PhysxDispatcherBenchmarks {
+    using namespace testing;
+    using namespace physx;
+
+    const size_t STACK_GRID_SIZE = 16;
+    const size_t STACK_HEIGHT = 16; // 16 x 16 x 16 = 4096 dynamic actors
+    const size_t STEP_COUNT = 300;
+    const float STEP_INTERVAL = 1.0f / 120.0f;
+
+    class BenchErrorCallback : public PxErrorCallback {
+    public:
+        void reportError(PxErrorCode::Enum code, const char *message, const char *file, int line) override {
+            Errorf("PhysX error %d: %s (%s:%d)", (int)code, message, file, line);
+        }
+    };
+
+    PxFilterFlags benchFilterShader(PxFilterObjectAttributes attributes0,
+        PxFilterData filterData0,
+        PxFilterObjectAttributes attributes1,
+        PxFilterData filterData1,
+        PxPairFlags &pairFlags,
+        const void *constantBlock,
+        PxU32 constantBlockSize) {
+        pairFlags = PxPairFlag::eCONTACT_DEFAULT;
+        return PxFilterFlag::eDEFAULT;
+    }
+
+    void runSimulation(PxPhysics &physics, uint32_t workerCount) {
+        sp::PhysxCpuDispatcher dispatcher(workerCount);
+
+        PxSceneDesc sceneDesc(physics.getTolerancesScale());
+        sceneDesc.gravity = PxVec3(0, -9.81f, 0);
+        sceneDesc.cpuDispatcher = &dispatcher;
+        sceneDesc.filterShader = &benchFilterShader;
+        PxScene *scene = physics.createScene(sceneDesc);
+        Assert(scene, "Failed to create PhysX scene");
+
+        PxMaterial *material = physics.createMaterial(0.6f, 0.5f, 0.1f);
+        PxShape *groundShape = physics.createShape(PxBoxGeometry(100, 1, 100), *material, true);
+        PxRigidStatic *ground = physics.createRigidStatic(PxTransform(PxVec3(0, -1, 0)));
+        ground->attachShape(*groundShape);
+        scene->addActor(*ground);
+        groundShape->release();
+
+        PxShape *boxShape = physics.createShape(PxBoxGeometry(0.25f, 0.25f, 0.25f), *material, true);
+        for (size_t x = 0; x < STACK_GRID_SIZE; x++) {
+            for (size_t z = 0; z < STACK_GRID_SIZE; z++) {
+                for (size_t y = 0; y < STACK_HEIGHT; y++) {
+                    // Offset each layer slightly so the stacks topple and keep colliding
+                    PxVec3 position(x * 1.5f + y * 0.05f, 0.25f + y * 0.55f, z * 1.5f);
+                    PxRigidDynamic *actor = physics.createRigidDynamic(PxTransform(position));
+                    actor->attachShape(*boxShape);
+                    actor->setMass(1.0f);
+                    actor->setMassSpaceInertiaTensor(PxVec3(1.0f / 24.0f));
+                    scene->addActor(*actor);
+                }
+            }
+        }
+        boxShape->release();
+
+        chrono_clock::duration elapsed(0);
+        {
+            MultiTimer timer("PhysX step 4096 dynamic actors (" + std::to_string(workerCount) + " worker threads)");
+            for (size_t step = 0; step < STEP_COUNT; step++) {
+                Timer t(timer);
+                auto start = chrono_clock::now();
+                scene->simulate(STEP_INTERVAL);
+                scene->fetchResults(true);
+                elapsed += chrono_clock::now() - start;
+            }
+        }
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+        Logf("PhysX %u worker threads: %.1f steps/sec", workerCount, STEP_COUNT / seconds);
+
+        PxActorTypeFlags dynamicFlag = PxActorTypeFlag::eRIGID_DYNAMIC;
+        std::vector<PxActor *> actors(scene->getNbActors(dynamicFlag));
+        scene->getActors(dynamicFlag, actors.data(), actors.size());
+        AssertEqual(actors.size(), STACK_GRID_SIZE * STACK_GRID_SIZE * STACK_HEIGHT, "Expected all actors in scene");
+        for (auto *actor : actors) {
+            AssertTrue(actor->is<PxRigidDynamic>()->getGlobalPose().isSane(), "Expected simulated poses to be valid");
+        }
+
+        scene->release();
+        material->release();
+    }
+
+    void BenchmarkPhysxDispatcher() {
+        PxDefaultAllocator allocator;
+        BenchErrorCallback errorCallback;
+        PxFoundation *foundation = PxCreateFoundation(PX_PHYSICS_VERSION, allocator, errorCallback);
+        Assert(foundation, "PxCreateFoundation");
+        PxPhysics *physics = PxCreatePhysics(PX_PHYSICS_VERSION, *foundation, PxTolerancesScale(), false, nullptr);
+        Assert(physics, "PxCreatePhysics");
+
+        uint32_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t workerCount = 1; workerCount <= 8 && workerCount <= maxWorkers; workerCount *= 2) {
+            runSimulation(*physics, workerCount);
+        }
+
+        physics->release();
+        foundation->release();
+    }
+
+    Test test(&BenchmarkPhysxDispatcher);
+} // namespace PhysxDispatcherBenchmarks
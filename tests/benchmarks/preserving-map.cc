@@ -0,0 +1,84 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/PreservingMap.hh"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace PreservingMapBenchmarks {
+    using namespace testing;
+
+    const size_t KEY_COUNT = 10000;
+    const size_t READER_COUNT = 4;
+    const size_t LOADS_PER_READER = 100000;
+    const size_t TICK_COUNT = 100;
+
+    using BenchMap = sp::PreservingMap<std::string, size_t>;
+
+    std::string keyName(size_t index) {
+        return "assets/models/bench_" + std::to_string(index) + ".glb";
+    }
+
+    void BenchmarkPreservingMap() {
+        BenchMap map;
+        std::vector<std::string> keys;
+        {
+            MultiTimer timer("PreservingMap Register 10000 keys");
+            for (size_t i = 0; i < KEY_COUNT; i++) {
+                auto &key = keys.emplace_back(keyName(i));
+                Timer t(timer);
+                map.Register(key, std::make_shared<size_t>(i));
+            }
+        }
+        {
+            MultiTimer timer("PreservingMap Load 100000 keys from 4 threads");
+            for (size_t iteration = 0; iteration < 10; iteration++) {
+                std::atomic_size_t total = 0;
+                Timer t(timer);
+                std::vector<std::thread> readers;
+                for (size_t r = 0; r < READER_COUNT; r++) {
+                    readers.emplace_back([&map, &keys, &total, r] {
+                        size_t sum = 0;
+                        for (size_t i = 0; i < LOADS_PER_READER; i++) {
+                            auto value = map.Load(keys[(i * 31 + r) % keys.size()]);
+                            if (value) sum += *value;
+                        }
+                        total += sum;
+                    });
+                }
+                for (auto &reader : readers) {
+                    reader.join();
+                }
+                AssertTrue(total > 0, "Expected loads to find values");
+            }
+        }
+        {
+            // Hold references to half the values so each tick visits both referenced and unreferenced entries
+            std::vector<std::shared_ptr<size_t>> held;
+            for (size_t i = 0; i < KEY_COUNT; i += 2) {
+                held.emplace_back(map.Load(keys[i]));
+            }
+            MultiTimer timer("PreservingMap Tick 10000 keys");
+            for (size_t tick = 0; tick < TICK_COUNT; tick++) {
+                Timer t(timer);
+                map.Tick(std::chrono::milliseconds(1));
+            }
+        }
+        {
+            Timer t("PreservingMap DropAll 10000 keys");
+            AssertEqual(map.DropAll(), KEY_COUNT, "Expected every unreferenced value to be dropped");
+        }
+    }
+
+    Test test(&BenchmarkPreservingMap);
+} // namespace PreservingMapBenchmarks
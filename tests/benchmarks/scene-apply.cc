@@ -0,0 +1,117 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "game/Scene.hh"
+#include "game/SceneManager.hh"
+
+#include <tests.hh>
+#include <vector>
+
+namespace SceneApplyBenchmarks {
+    using namespace testing;
+    using namespace ecs;
+
+    const std::string SCENE_NAME = "bench_scene_apply";
+    const size_t ROOT_COUNT = 5000;
+    const size_t CHILDREN_PER_ROOT = 9; // 5000 roots x 10 = 50k entities
+    const size_t ITERATIONS = 10;
+
+    sp::SceneManager &Scenes() {
+        static sp::SceneManager scenes;
+        scenes.DisableGraphicsPreload();
+        scenes.DisablePhysicsPreload();
+        return scenes;
+    }
+
+    Name rootName(size_t root) {
+        return Name(SCENE_NAME, "root_" + std::to_string(root));
+    }
+
+    Name childName(size_t root, size_t child) {
+        return Name(SCENE_NAME, "child_" + std::to_string(root) + "_" + std::to_string(child));
+    }
+
+    // Moves one root entity in the staging scene, optionally reporting the edit so only it is reapplied
+    void moveRoot(size_t root, float x, bool report) {
+        Scenes().QueueActionAndBlock(sp::SceneAction::ApplySystemScene,
+            SCENE_NAME,
+            [root, x, report](Lock<AddRemove> lock, std::shared_ptr<sp::Scene> scene) {
+                auto ent = scene->GetStagingEntity(rootName(root));
+                Assertf(ent.Has<TransformTree>(lock), "Expected staging root to exist: %s", rootName(root).String());
+                ent.Get<TransformTree>(lock).pose.SetPosition(glm::vec3(x, 0, 0));
+                if (report) scene->MarkStagingChanged(ent);
+            });
+    }
+
+    void assertLivePositions(size_t root, float x, const std::string &message) {
+        auto lock = StartTransaction<Read<Name, TransformSnapshot>>();
+        auto liveRoot = EntityRef(rootName(root)).Get(lock);
+        Assertf(liveRoot.Has<TransformSnapshot>(lock), "Expected live root to exist: %s", rootName(root).String());
+        AssertEqual(liveRoot.Get<TransformSnapshot>(lock).globalPose.GetPosition(), glm::vec3(x, 0, 0), message);
+        for (size_t child = 0; child < CHILDREN_PER_ROOT; child++) {
+            auto liveChild = EntityRef(childName(root, child)).Get(lock);
+            Assertf(liveChild.Has<TransformSnapshot>(lock),
+                "Expected live child to exist: %s",
+                childName(root, child).String());
+            AssertEqual(liveChild.Get<TransformSnapshot>(lock).globalPose.GetPosition(),
+                glm::vec3(x, child + 1, 0),
+                message);
+        }
+    }
+
+    void BenchmarkSceneApply() {
+        {
+            Timer t("Apply 50k entity system scene");
+            Scenes().QueueActionAndBlock(sp::SceneAction::ApplySystemScene,
+                SCENE_NAME,
+                [](Lock<AddRemove> lock, std::shared_ptr<sp::Scene> scene) {
+                    for (size_t root = 0; root < ROOT_COUNT; root++) {
+                        auto ent = scene->NewSystemEntity(lock, scene, rootName(root));
+                        ent.Set<TransformTree>(lock, glm::vec3(0));
+                        // Each child is parented to the previous one, forming a chain below the root
+                        EntityRef parent = ent;
+                        for (size_t child = 0; child < CHILDREN_PER_ROOT; child++) {
+                            auto childEnt = scene->NewSystemEntity(lock, scene, childName(root, child));
+                            childEnt.Set<TransformTree>(lock, Transform(glm::vec3(0, 1, 0)), parent);
+                            parent = childEnt;
+                        }
+                    }
+                });
+        }
+        assertLivePositions(ROOT_COUNT / 2, 0.0f, "Initial scene apply mismatch");
+
+        {
+            MultiTimer timer("Apply 1 reported entity edit (incremental)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                moveRoot(ROOT_COUNT / 2, i + 1, true);
+            }
+        }
+        assertLivePositions(ROOT_COUNT / 2, ITERATIONS, "Incremental scene apply mismatch");
+
+        {
+            MultiTimer timer("Apply 1 unreported entity edit (full reapply)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                moveRoot(ROOT_COUNT / 2, -(float)(i + 1), false);
+            }
+        }
+        assertLivePositions(ROOT_COUNT / 2, -(float)ITERATIONS, "Full scene apply mismatch");
+        assertLivePositions(0, 0.0f, "Unedited entities changed");
+
+        Scenes().QueueActionAndBlock(sp::SceneAction::RemoveScene, SCENE_NAME);
+        {
+            auto lock = StartTransaction<Read<Name>>();
+            AssertTrue(!EntityRef(rootName(0)).Get(lock).Exists(lock), "Expected scene entities to be removed");
+        }
+    }
+
+    Test test(&BenchmarkSceneApply);
+} // namespace SceneApplyBenchmarks
@@ -0,0 +1,154 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "assets/MappedFile.hh"
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "game/CompiledScene.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <picojson/picojson.h>
+#include <tests.hh>
+#include <vector>
+
+namespace SceneLoadBenchmarks {
+    using namespace testing;
+
+    const size_t ITERATIONS = 20;
+
+    struct BundledScene {
+        std::string name;
+        std::shared_ptr<const sp::Asset> source;
+        std::string compiledPath;
+    };
+
+    // Mirrors the json path in SceneManager::LoadSceneJson, minus creating the staging entities
+    size_t loadJson(const BundledScene &scene, std::vector<ecs::FlatEntity> &entities) {
+        picojson::value root;
+        std::string err = picojson::parse(root, scene.source->String());
+        Assertf(err.empty(), "Failed to parse scene (%s): %s", scene.name, err);
+
+        ecs::EntityScope scope(scene.name, "");
+        auto &sceneObj = root.get<picojson::object>();
+        if (!sceneObj.count("entities")) return 0;
+        for (auto &value : sceneObj["entities"].get<picojson::array>()) {
+            auto &entSrc = value.get<picojson::object>();
+            auto &entDst = entities.emplace_back();
+            if (entSrc.count("name") && entSrc["name"].is<std::string>()) {
+                ecs::Name name(entSrc["name"].get<std::string>(), scope);
+                if (name) std::get<std::optional<ecs::Name>>(entDst) = name;
+            }
+            for (auto &comp : entSrc) {
+                if (comp.first.empty() || comp.first[0] == '_' || comp.first == "name") continue;
+                auto componentType = ecs::LookupComponent(comp.first);
+                if (componentType) componentType->LoadEntity(entDst, comp.second);
+            }
+        }
+        return entities.size();
+    }
+
+    size_t loadCompiled(const BundledScene &scene, std::vector<ecs::FlatEntity> &entities) {
+        auto mapping = sp::MappedFile::Open(scene.compiledPath);
+        Assertf(mapping, "Failed to map compiled scene: %s", scene.compiledPath);
+        auto compiled = sp::CompiledScene::Open(scene.name, mapping, mapping->Data(), mapping->Size());
+        Assertf(compiled, "Failed to open compiled scene: %s", scene.name);
+        compiled->LoadEntities(ecs::EntityScope(scene.name, ""), entities);
+        return entities.size();
+    }
+
+    size_t countComponents(const std::vector<ecs::FlatEntity> &entities) {
+        size_t count = 0;
+        for (auto &ent : entities) {
+            ecs::ForEachComponent([&](const std::string &name, const ecs::ComponentBase &comp) {
+                if (comp.HasComponent(ent)) count++;
+            });
+        }
+        return count;
+    }
+
+    void BenchmarkSceneLoad() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/scenes", ec)) {
+            Logf("Skipping scene load benchmark, bundled scenes not found");
+            return;
+        }
+
+        auto outputDir = std::filesystem::temp_directory_path() / "sp-bench-scenes";
+        std::filesystem::create_directories(outputDir);
+
+        std::vector<BundledScene> scenes;
+        size_t sourceBytes = 0, compiledBytes = 0;
+        {
+            Timer t("Compile bundled scenes");
+            for (auto &entry : std::filesystem::directory_iterator("../assets/scenes")) {
+                if (!entry.is_regular_file() || entry.path().extension() != ".json") continue;
+
+                auto &scene = scenes.emplace_back();
+                scene.name = entry.path().stem().string();
+                scene.source = sp::Assets().Load("scenes/" + scene.name + ".json")->Get();
+                Assertf(scene.source, "Failed to load scene: %s", scene.name);
+
+                picojson::value root;
+                std::string err = picojson::parse(root, scene.source->String());
+                Assertf(err.empty(), "Failed to parse scene (%s): %s", scene.name, err);
+                sp::AssetFileInfo sourceInfo;
+                AssertTrue(sp::Assets().GetFileInfo("scenes/" + scene.name + ".json", sourceInfo),
+                    "Failed to stat scene: " + scene.name);
+                auto compiled = sp::CompileScene(scene.name, root, scene.source->Hash(), sourceInfo);
+                AssertTrue(!compiled.empty(), "Failed to compile scene: " + scene.name);
+
+                scene.compiledPath = (outputDir / (scene.name + ".spscene")).string();
+                std::ofstream out(scene.compiledPath, std::ios::binary);
+                out.write((const char *)compiled.data(), compiled.size());
+                sourceBytes += scene.source->BufferSize();
+                compiledBytes += compiled.size();
+            }
+        }
+        Logf("Bundled scenes: %u json bytes, %u compiled bytes", sourceBytes, compiledBytes);
+
+        size_t jsonEntities = 0, compiledEntities = 0;
+        {
+            // The first iteration also warms up any assets requested by component loaders
+            MultiTimer timer("Load " + std::to_string(scenes.size()) + " bundled scenes (json)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                for (auto &scene : scenes) {
+                    std::vector<ecs::FlatEntity> entities;
+                    jsonEntities += loadJson(scene, entities);
+                }
+            }
+        }
+        {
+            MultiTimer timer("Load " + std::to_string(scenes.size()) + " bundled scenes (compiled)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                for (auto &scene : scenes) {
+                    std::vector<ecs::FlatEntity> entities;
+                    compiledEntities += loadCompiled(scene, entities);
+                }
+            }
+        }
+        AssertEqual(compiledEntities, jsonEntities, "Expected compiled scenes to load the same entities");
+
+        for (auto &scene : scenes) {
+            std::vector<ecs::FlatEntity> jsonResult, compiledResult;
+            loadJson(scene, jsonResult);
+            loadCompiled(scene, compiledResult);
+            AssertEqual(countComponents(compiledResult),
+                countComponents(jsonResult),
+                "Expected compiled scene to load the same components: " + scene.name);
+        }
+
+        std::filesystem::remove_all(outputDir, ec);
+    }
+
+    Test test(&BenchmarkSceneLoad);
+} // namespace SceneLoadBenchmarks
@@ -0,0 +1,159 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "console/Console.hh"
+#include "core/Common.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/ScriptManager.hh"
+
+#include <cmath>
+#include <glm/glm.hpp>
+#include <tests.hh>
+#include <vector>
+
+namespace ScriptTickBenchmarks {
+    using namespace testing;
+    using namespace ecs;
+
+    const size_t ENTITY_COUNT = 5000;
+    // Every Nth entity also gets a script that needs exclusive access, forcing a serial batch
+    const size_t EXCLUSIVE_SCRIPT_INTERVAL = 500;
+    // Every Nth entity also sends an event to a shared receiver, which must arrive in script order
+    const size_t SEND_SCRIPT_INTERVAL = 250;
+    const std::string ORDER_EVENT = "/bench/order";
+    const size_t TICK_COUNT = 100;
+    const size_t WORK_ITERATIONS = 200;
+
+    // Only reads its own transform, so every instance can run in parallel
+    struct BenchParallelScript {
+        double value = 0.0;
+
+        void OnTick(ScriptState &state,
+            Lock<Read<TransformSnapshot>> lock,
+            Entity ent,
+            chrono_clock::duration interval) {
+            auto &pos = ent.Get<TransformSnapshot>(lock).globalPose.GetPosition();
+            double x = pos.x;
+            for (size_t i = 0; i < WORK_ITERATIONS; i++) {
+                x = std::sin(x) * 0.5 + std::cos(x + i) * 0.5;
+            }
+            value = x;
+        }
+    };
+    StructMetadata MetadataBenchParallelScript(typeid(BenchParallelScript),
+        "BenchParallelScript",
+        "",
+        StructField::New("value", &BenchParallelScript::value));
+    InternalScript<BenchParallelScript> benchParallelScript("bench_parallel_script", MetadataBenchParallelScript);
+
+    struct BenchExclusiveScript {
+        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+            SignalRef ref(ent, "ticks");
+            ref.SetValue(lock, ref.GetSignal(lock) + 1.0);
+        }
+    };
+    StructMetadata MetadataBenchExclusiveScript(typeid(BenchExclusiveScript), "BenchExclusiveScript", "");
+    InternalScript<BenchExclusiveScript> benchExclusiveScript("bench_exclusive_script", MetadataBenchExclusiveScript);
+
+    // Only sends events, which is scheduled as a write so senders stay in script order
+    struct BenchSendScript {
+        void OnTick(ScriptState &state, Lock<SendEventsLock> lock, Entity ent, chrono_clock::duration interval) {
+            EventBindings::SendEvent(lock, EntityRef(Name("bench", "receiver")), Event{ORDER_EVENT, ent, true});
+        }
+    };
+    StructMetadata MetadataBenchSendScript(typeid(BenchSendScript), "BenchSendScript", "");
+    InternalScript<BenchSendScript> benchSendScript("bench_send_script", MetadataBenchSendScript);
+
+    double runTicks(const std::vector<Entity> &entities,
+        uint32_t workerThreads,
+        const EventQueueRef &receiverQueue,
+        std::vector<Entity> &eventOrder) {
+        sp::GetConsoleManager().GetCVar<uint32_t>("s.ScriptWorkerThreads").Set(workerThreads);
+        {
+            auto lock = StartTransaction<Read<Scripts>>();
+            for (auto &ent : entities) {
+                ent.Get<Scripts>(lock).scripts.front().state->SetParam<double>("value", 0.0);
+            }
+        }
+
+        MultiTimer timer("Tick 5000 scripted entities (" + std::to_string(workerThreads) + " worker threads)");
+        for (size_t tick = 0; tick < TICK_COUNT; tick++) {
+            {
+                auto lock = StartTransaction<WriteAll>();
+                Timer t(timer);
+                GetScriptManager().RunOnTick(lock, std::chrono::milliseconds(8));
+            }
+            auto lock = StartTransaction<Read<EventInput>>();
+            Event event;
+            while (EventInput::Poll(lock, receiverQueue, event)) {
+                eventOrder.emplace_back(event.source);
+            }
+        }
+
+        auto lock = StartTransaction<Read<Scripts>>();
+        double total = 0.0;
+        for (auto &ent : entities) {
+            auto &scripts = ent.Get<Scripts>(lock).scripts;
+            total += scripts.front().state->GetParam<double>("value");
+        }
+        return total;
+    }
+
+    void BenchmarkScriptTick() {
+        auto &workerThreadsCVar = sp::GetConsoleManager().GetCVar<uint32_t>("s.ScriptWorkerThreads");
+        uint32_t defaultWorkerThreads = workerThreadsCVar.Get();
+        std::vector<Entity> entities;
+        Entity receiver;
+        EventQueueRef receiverQueue = NewEventQueue();
+        {
+            Timer t("Create 5000 scripted entities");
+            auto lock = StartTransaction<AddRemove>();
+            receiver = lock.NewEntity();
+            receiver.Set<Name>(lock, "bench", "receiver");
+            receiver.Set<EventInput>(lock).Register(lock, receiverQueue, ORDER_EVENT);
+            for (size_t i = 0; i < ENTITY_COUNT; i++) {
+                Entity ent = lock.NewEntity();
+                Name name("bench", "script" + std::to_string(i));
+                EntityRef ref(name, ent);
+                ent.Set<Name>(lock, name);
+                ent.Set<TransformSnapshot>(lock, Transform(glm::vec3(i * 0.01f, 0, 0)));
+                auto &scripts = ent.Set<Scripts>(lock);
+                scripts.AddOnTick(name, "bench_parallel_script");
+                if (i % EXCLUSIVE_SCRIPT_INTERVAL == 0) scripts.AddOnTick(name, "bench_exclusive_script");
+                if (i % SEND_SCRIPT_INTERVAL == 0) scripts.AddOnTick(name, "bench_send_script");
+                entities.emplace_back(ent);
+            }
+            GetScriptManager().RegisterEvents(lock);
+        }
+
+        std::vector<Entity> serialOrder, parallelOrder;
+        double serialTotal = runTicks(entities, 0, receiverQueue, serialOrder);
+        double parallelTotal = runTicks(entities, 4, receiverQueue, parallelOrder);
+        AssertEqual(parallelTotal, serialTotal, "Expected parallel script results to match serial");
+        AssertEqual(serialOrder.size(),
+            TICK_COUNT * (ENTITY_COUNT / SEND_SCRIPT_INTERVAL),
+            "Expected every send script to deliver an event each tick");
+        AssertTrue(parallelOrder == serialOrder, "Expected parallel events to arrive in the same order as serial");
+
+        {
+            auto lock = StartTransaction<ReadSignalsLock>();
+            AssertEqual(SignalRef(entities.front(), "ticks").GetSignal(lock),
+                (double)TICK_COUNT * 2,
+                "Expected exclusive scripts to run every tick");
+        }
+        {
+            auto lock = StartTransaction<AddRemove>();
+            for (auto &ent : entities) {
+                ent.Destroy(lock);
+            }
+            receiver.Destroy(lock);
+        }
+        workerThreadsCVar.Set(defaultWorkerThreads);
+    }
+
+    Test test(&BenchmarkScriptTick);
+} // namespace ScriptTickBenchmarks
@@ -0,0 +1,119 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "console/Console.hh"
+#include "core/Common.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/SignalExpression.hh"
+
+#include <tests.hh>
+#include <vector>
+
+namespace SignalExpressionBenchmarks {
+    using namespace testing;
+
+    const size_t EXPRESSION_COUNT = 1000;
+    const size_t ITERATIONS = 100;
+
+    // A mix of typical game logic bindings
+    const std::array expressionTemplates = {
+        "bench:input/a + bench:input/b * 2 > 3 ? sin(bench:input/a) : cos(bench:input/b) + 1",
+        "max(bench:input/a, bench:input/b) - min(bench:input/a * 0.5, 2) + abs(-bench:input/c)",
+        "(bench:input/a + 1) * (bench:input/a + 1) / (bench:input/c + 1) + (bench:input/a + 1)",
+        "bench:input/a >= 0.5 && bench:input/b < 3 || !bench:input/c",
+        "if_focused(Game, bench:input/a * 3.14159265359 / 180) + 0.5 * 2 - 1",
+    };
+
+    std::vector<std::string> generateExpressions() {
+        std::vector<std::string> result;
+        result.reserve(EXPRESSION_COUNT);
+        for (size_t i = 0; i < EXPRESSION_COUNT; i++) {
+            // Vary the constants so each expression is distinct
+            result.emplace_back(std::string(expressionTemplates[i % expressionTemplates.size()]) + " + " +
+                                std::to_string(i));
+        }
+        return result;
+    }
+
+    void BenchmarkSignalExpressions() {
+        auto &bytecodeCVar = sp::GetConsoleManager().GetCVar<bool>("s.SignalBytecode");
+        auto strings = generateExpressions();
+
+        std::vector<ecs::SignalExpression> expressions;
+        {
+            MultiTimer timer("Parse and compile 1000 signal expressions");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                expressions.clear();
+                for (auto &str : strings) {
+                    expressions.emplace_back(str);
+                }
+            }
+        }
+        {
+            // Stresses node deduplication. Each term adds a constant, a multiply, and an add node.
+            std::string longExpr = "bench:input/a";
+            for (size_t i = 1; i < (ecs::MAX_SIGNAL_EXPRESSION_NODES - 2) / 3; i++) {
+                longExpr += " + " + std::to_string(i) + " * bench:input/b";
+            }
+            MultiTimer timer("Parse and compile a long signal expression");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                ecs::SignalExpression expr(longExpr);
+                Assert((bool)expr, "Expected long expression to be valid");
+            }
+        }
+
+        Tecs::Entity input;
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            input = lock.NewEntity();
+            ecs::EntityRef inputRef(ecs::Name("bench", "input"), input);
+            input.Set<ecs::Name>(lock, "bench", "input");
+            ecs::SignalRef(input, "a").SetValue(lock, 0.75);
+            ecs::SignalRef(input, "b").SetValue(lock, 2.0);
+            ecs::SignalRef(input, "c").SetValue(lock, 0.0);
+        }
+
+        auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+        double treeTotal = 0.0, bytecodeTotal = 0.0, batchTotal = 0.0;
+        for (bool bytecode : {false, true}) {
+            bytecodeCVar.Set(bytecode);
+            MultiTimer timer(std::string("Evaluate 1000 signal expressions (") + (bytecode ? "bytecode" : "tree") +
+                             ")");
+            double &total = bytecode ? bytecodeTotal : treeTotal;
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                for (auto &expr : expressions) {
+                    total += expr.Evaluate(lock);
+                }
+            }
+        }
+        bytecodeCVar.Set(true);
+
+        ecs::SignalExpressionBatch batch;
+        {
+            Timer t("Compile batch of 1000 signal expressions");
+            batch = ecs::SignalExpressionBatch(std::vector<ecs::SignalExpression>(expressions));
+        }
+        {
+            std::vector<double> results(batch.Size());
+            MultiTimer timer("Evaluate 1000 signal expressions (batch)");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                batch.Evaluate(lock, results);
+                for (auto &result : results) {
+                    batchTotal += result;
+                }
+            }
+        }
+        AssertEqual(bytecodeTotal, treeTotal, "Expected bytecode and tree evaluation to match");
+        AssertEqual(batchTotal, treeTotal, "Expected batch and tree evaluation to match");
+    }
+
+    Test test(&BenchmarkSignalExpressions);
+} // namespace SignalExpressionBenchmarks
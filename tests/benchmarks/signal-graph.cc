@@ -0,0 +1,113 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "console/Console.hh"
+#include "core/Common.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <tests.hh>
+#include <vector>
+
+namespace SignalGraphBenchmarks {
+    using namespace testing;
+
+    const size_t ENTITY_COUNT = 100;
+    const size_t SIGNALS_PER_ENTITY = 100;
+    const size_t VALUES_PER_ENTITY = 20;
+    const size_t WRITES_PER_FRAME = 10;
+    const size_t FRAME_COUNT = 100;
+
+    std::string signalName(size_t index) {
+        return "s" + std::to_string(index);
+    }
+
+    // Builds 10k signals: each entity has a set of value signals followed by bindings that read
+    // earlier signals on the same entity, forming chains a few levels deep.
+    std::vector<ecs::SignalRef> buildSignalGraph() {
+        std::vector<ecs::SignalRef> refs;
+        auto lock = ecs::StartTransaction<ecs::AddRemove>();
+        for (size_t e = 0; e < ENTITY_COUNT; e++) {
+            ecs::Name name("bench", "e" + std::to_string(e));
+            Tecs::Entity ent = lock.NewEntity();
+            ecs::EntityRef entRef(name, ent);
+            ent.Set<ecs::Name>(lock, name);
+
+            std::string prefix = name.String() + "/";
+            for (size_t i = 0; i < SIGNALS_PER_ENTITY; i++) {
+                auto &ref = refs.emplace_back(ent, signalName(i));
+                if (i < VALUES_PER_ENTITY) {
+                    ref.SetValue(lock, (double)i);
+                } else {
+                    size_t a = i - VALUES_PER_ENTITY;
+                    size_t b = a / 2;
+                    ref.SetBinding(lock,
+                        prefix + signalName(a) + " + max(" + prefix + signalName(b) + ", 0.5) * 0.5",
+                        name);
+                }
+            }
+        }
+        return refs;
+    }
+
+    void runFrames(const std::vector<ecs::SignalRef> &refs, bool memoize) {
+        sp::GetConsoleManager().GetCVar<bool>("s.MemoizeSignals").Set(memoize);
+
+        MultiTimer timer(std::string("Read 10k signals per frame (memoize ") + (memoize ? "on" : "off") + ")");
+        double total = 0.0;
+        for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+            {
+                // Change a few inputs each frame, like a typical game tick would
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::Signals>>();
+                for (size_t i = 0; i < WRITES_PER_FRAME; i++) {
+                    size_t e = (frame * WRITES_PER_FRAME + i) % ENTITY_COUNT;
+                    auto &ref = refs[e * SIGNALS_PER_ENTITY + (frame + i) % VALUES_PER_ENTITY];
+                    ref.SetValue(lock, (double)frame);
+                }
+            }
+            {
+                auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+                Timer t(timer);
+                // Read everything twice, as several systems reading the same signals would
+                for (size_t pass = 0; pass < 2; pass++) {
+                    for (auto &ref : refs) {
+                        total += ref.GetSignal(lock);
+                    }
+                }
+            }
+        }
+        Assert(std::isfinite(total), "Expected signal values to be finite");
+    }
+
+    void BenchmarkSignalGraph() {
+        std::vector<ecs::SignalRef> refs;
+        {
+            Timer t("Build 10k signal graph");
+            refs = buildSignalGraph();
+        }
+        AssertEqual(refs.size(), ENTITY_COUNT * SIGNALS_PER_ENTITY, "Expected 10k signals");
+
+        runFrames(refs, false);
+        runFrames(refs, true);
+
+        {
+            // Both modes should agree on every value
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+            std::vector<double> memoized;
+            memoized.reserve(refs.size());
+            for (auto &ref : refs) {
+                memoized.emplace_back(ref.GetSignal(lock));
+            }
+            sp::GetConsoleManager().GetCVar<bool>("s.MemoizeSignals").Set(false);
+            for (size_t i = 0; i < refs.size(); i++) {
+                AssertEqual(refs[i].GetSignal(lock), memoized[i], "Memoized signal doesn't match evaluation");
+            }
+            sp::GetConsoleManager().GetCVar<bool>("s.MemoizeSignals").Set(true);
+        }
+    }
+
+    Test test(&BenchmarkSignalGraph);
+} // namespace SignalGraphBenchmarks
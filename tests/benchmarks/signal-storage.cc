@@ -0,0 +1,103 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/SignalManager.hh"
+
+#include <tests.hh>
+#include <vector>
+
+namespace SignalStorageBenchmarks {
+    using namespace testing;
+
+    const size_t ENTITY_COUNT = 100;
+    const size_t SIGNALS_PER_ENTITY = 1000;
+    const size_t SIGNAL_COUNT = ENTITY_COUNT * SIGNALS_PER_ENTITY;
+    const size_t ITERATIONS = 10;
+
+    void BenchmarkSignalStorage() {
+        std::vector<ecs::EntityRef> entities;
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            for (size_t e = 0; e < ENTITY_COUNT; e++) {
+                ecs::Name name("bench", "e" + std::to_string(e));
+                Tecs::Entity ent = lock.NewEntity();
+                ent.Set<ecs::Name>(lock, name);
+                entities.emplace_back(name, ent);
+            }
+        }
+        std::vector<std::string> signalNames;
+        for (size_t i = 0; i < SIGNALS_PER_ENTITY; i++) {
+            signalNames.emplace_back("s" + std::to_string(i));
+        }
+
+        auto &manager = ecs::GetSignalManager();
+        std::vector<ecs::SignalRef> refs;
+        refs.reserve(SIGNAL_COUNT);
+        {
+            Timer t("Create 100k signal refs");
+            for (auto &ent : entities) {
+                for (auto &signalName : signalNames) {
+                    refs.emplace_back(manager.GetRef(ent, signalName));
+                }
+            }
+        }
+        {
+            MultiTimer timer("Lookup 100k existing signal refs");
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                size_t found = 0;
+                for (auto &ent : entities) {
+                    for (auto &signalName : signalNames) {
+                        if (manager.GetRef(ent, signalName)) found++;
+                    }
+                }
+                AssertEqual(found, SIGNAL_COUNT, "Expected every signal ref to exist");
+            }
+        }
+
+        MultiTimer createTimer("Create 100k signal values");
+        MultiTimer readTimer("Read 100k signal values");
+        MultiTimer destroyTimer("Destroy 100k signal values");
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            {
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::Signals>>();
+                Timer t(createTimer);
+                for (size_t j = 0; j < refs.size(); j++) {
+                    refs[j].SetValue(lock, (double)(i + j));
+                }
+            }
+            {
+                auto lock = ecs::StartTransaction<ecs::Read<ecs::Signals>>();
+                Timer t(readTimer);
+                double total = 0.0;
+                for (auto &ref : refs) {
+                    total += ref.GetValue(lock);
+                }
+                Assertf(total > 0.0, "Expected signal values to be set");
+            }
+            {
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::Signals>>();
+                auto &signals = lock.Get<ecs::Signals>();
+                Timer t(destroyTimer);
+                for (auto &ref : refs) {
+                    auto &slot = ref.GetLiveSlot();
+                    signals.FreeSignal(slot);
+                    slot = {};
+                }
+            }
+        }
+
+        auto lock = ecs::StartTransaction<ecs::Read<ecs::Signals>>();
+        auto &signals = lock.Get<ecs::Signals>();
+        AssertEqual(signals.Size(), SIGNAL_COUNT, "Expected freed signal slots to be reused");
+        AssertEqual(signals.freeIndexes.size(), SIGNAL_COUNT, "Expected every signal slot to be freed");
+    }
+
+    Test test(&BenchmarkSignalStorage);
+} // namespace SignalStorageBenchmarks
@@ -0,0 +1,50 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/ThreadTelemetry.hh"
+
+#include <atomic>
+#include <memory>
+#include <tests.hh>
+#include <thread>
+
+namespace ThreadTelemetryBenchmarks {
+    using namespace testing;
+
+    const size_t FRAME_COUNT = 1000000;
+
+    void BenchmarkThreadTelemetry() {
+        auto telemetry = std::make_unique<sp::ThreadTelemetry>("bench");
+
+        // Read the ring continuously, like the threadstats console command would while the thread runs
+        std::atomic_bool done = false;
+        std::thread reader([&] {
+            while (!done) {
+                telemetry->GetFrames(16);
+                telemetry->workTimes.GetPercentile(99);
+            }
+        });
+
+        auto start = chrono_clock::now();
+        {
+            Timer t("Record 1M frames while reading concurrently");
+            for (size_t i = 0; i < FRAME_COUNT; i++) {
+                auto frameStart = start + std::chrono::microseconds(i * 100);
+                auto workEnd = frameStart + std::chrono::microseconds(i % 90);
+                auto sleepTarget = frameStart + std::chrono::microseconds(100);
+                telemetry->AddFrame(frameStart, workEnd, sleepTarget, sleepTarget, false);
+            }
+        }
+        done = true;
+        reader.join();
+
+        AssertEqual(telemetry->FrameCount(), FRAME_COUNT, "Expected every frame to be recorded");
+    }
+
+    Test test(&BenchmarkThreadTelemetry);
+} // namespace ThreadTelemetryBenchmarks
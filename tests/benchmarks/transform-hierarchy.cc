@@ -0,0 +1,202 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/TransformHierarchy.hh"
+
+#include <glm/glm.hpp>
+#include <random>
+#include <tests.hh>
+#include <vector>
+
+namespace TransformHierarchyBenchmarks {
+    using namespace testing;
+    using namespace ecs;
+
+    const size_t LEVEL_COUNT = 10;
+    const size_t NODES_PER_LEVEL = 10000; // 10 levels x 10000 = 100k nodes
+    const size_t ITERATIONS = 10;
+    const size_t MOVED_COUNT = 100;
+    const size_t WORKER_COUNT = 4;
+
+    // Matches the snapshot loop ApplyScene ran before the hierarchy cache
+    void recursiveSnapshots(Lock<Read<TransformTree>, Write<TransformSnapshot>> lock) {
+        for (auto &e : lock.EntitiesWith<TransformTree>()) {
+            if (!e.Has<TransformTree, TransformSnapshot>(lock)) continue;
+            e.Get<TransformSnapshot>(lock).globalPose = e.Get<TransformTree>(lock).GetGlobalTransform(lock);
+        }
+    }
+
+    size_t hierarchySnapshots(TransformHierarchy &hierarchy,
+        Lock<Read<TransformTree>, Write<TransformSnapshot>> lock) {
+        hierarchy.Sync(lock);
+        hierarchy.Update();
+        hierarchy.ForEachUpdated([&](Entity e, const Transform &transform) {
+            if (e.Has<TransformSnapshot>(lock)) e.Get<TransformSnapshot>(lock).globalPose = transform;
+        });
+        return hierarchy.UpdatedCount();
+    }
+
+    void assertSnapshots(Lock<Read<TransformTree, TransformSnapshot>> lock, const std::string &message) {
+        for (auto &e : lock.EntitiesWith<TransformTree>()) {
+            if (!e.Has<TransformTree, TransformSnapshot>(lock)) continue;
+            auto expected = e.Get<TransformTree>(lock).GetGlobalTransform(lock);
+            auto &snapshot = e.Get<TransformSnapshot>(lock).globalPose;
+            AssertEqual(snapshot.GetPosition(), expected.GetPosition(), message);
+            AssertEqual(snapshot.GetRotation(), expected.GetRotation(), message);
+        }
+    }
+
+    void BenchmarkTransformHierarchy() {
+        std::mt19937 rand(42);
+        std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+        // Each level's nodes are parented to random nodes in the level above
+        std::vector<std::vector<Entity>> levels(LEVEL_COUNT);
+        {
+            Timer t("Create 100k entity, 10 level transform hierarchy");
+            auto lock = StartTransaction<AddRemove>();
+            for (size_t depth = 0; depth < LEVEL_COUNT; depth++) {
+                std::uniform_int_distribution<size_t> parentIndex(0, NODES_PER_LEVEL - 1);
+                for (size_t i = 0; i < NODES_PER_LEVEL; i++) {
+                    Entity ent = lock.NewEntity();
+                    auto &tree = ent.Set<TransformTree>(lock, glm::vec3(offset(rand), offset(rand), offset(rand)));
+                    tree.pose.Rotate(offset(rand), glm::vec3(0, 1, 0));
+                    if (depth > 0) tree.parent = levels[depth - 1][parentIndex(rand)];
+                    ent.Set<TransformSnapshot>(lock);
+                    levels[depth].emplace_back(ent);
+                }
+            }
+        }
+        size_t nodeCount = LEVEL_COUNT * NODES_PER_LEVEL;
+
+        {
+            MultiTimer timer("Recursive GetGlobalTransform for 100k entities");
+            auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                recursiveSnapshots(lock);
+            }
+        }
+
+        TransformHierarchy serialHierarchy("BenchTransformsSerial", 0);
+        TransformHierarchy hierarchy("BenchTransforms", WORKER_COUNT);
+        {
+            auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+            {
+                Timer t("Initial hierarchy update for 100k entities (1 thread)");
+                AssertTrue(hierarchySnapshots(serialHierarchy, lock) >= nodeCount, "Expected every node to update");
+            }
+            {
+                Timer t("Initial hierarchy update for 100k entities (" + std::to_string(WORKER_COUNT + 1) +
+                        " threads)");
+                AssertTrue(hierarchySnapshots(hierarchy, lock) >= nodeCount, "Expected every node to update");
+            }
+            AssertEqual(hierarchy.UpdatedCount(), hierarchy.NodeCount(), "Expected a node per TransformTree");
+            AssertTrue(hierarchy.LevelCount() >= LEVEL_COUNT, "Expected a level per tree depth");
+        }
+        assertSnapshots(StartTransaction<Read<TransformTree, TransformSnapshot>>(), "Initial snapshot mismatch");
+
+        {
+            MultiTimer timer("Unchanged hierarchy update for 100k entities");
+            auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                Timer t(timer);
+                AssertEqual(hierarchySnapshots(hierarchy, lock), 0u, "Expected no nodes to update");
+            }
+        }
+
+        {
+            MultiTimer timer("Move 100 entities at depth 5");
+            std::uniform_int_distribution<size_t> moveIndex(0, NODES_PER_LEVEL - 1);
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                {
+                    auto lock = StartTransaction<Write<TransformTree>>();
+                    for (size_t j = 0; j < MOVED_COUNT; j++) {
+                        levels[5][moveIndex(rand)].Get<TransformTree>(lock).pose.Translate(glm::vec3(0, 1, 0));
+                    }
+                }
+                auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+                Timer t(timer);
+                size_t updated = hierarchySnapshots(hierarchy, lock);
+                AssertTrue(updated >= MOVED_COUNT / 2 && updated < nodeCount / 2, "Expected only moved subtrees");
+            }
+        }
+        assertSnapshots(StartTransaction<Read<TransformTree, TransformSnapshot>>(), "Moved snapshot mismatch");
+
+        {
+            MultiTimer timer("Reparent 100 entities from depth 8 to depth 2");
+            std::uniform_int_distribution<size_t> nodeIndex(0, NODES_PER_LEVEL - 1);
+            for (size_t i = 0; i < ITERATIONS; i++) {
+                {
+                    auto lock = StartTransaction<Write<TransformTree>>();
+                    for (size_t j = 0; j < MOVED_COUNT; j++) {
+                        auto &tree = levels[8][nodeIndex(rand)].Get<TransformTree>(lock);
+                        tree.parent = levels[1][nodeIndex(rand)];
+                    }
+                }
+                auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+                Timer t(timer);
+                hierarchySnapshots(hierarchy, lock);
+            }
+        }
+        assertSnapshots(StartTransaction<Read<TransformTree, TransformSnapshot>>(), "Reparented snapshot mismatch");
+
+        {
+            // Snapshots added to unchanged trees still need to be initialized
+            {
+                auto lock = StartTransaction<AddRemove>();
+                for (size_t i = 0; i < MOVED_COUNT; i++) {
+                    levels[4][i].Unset<TransformSnapshot>(lock);
+                }
+            }
+            {
+                auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+                AssertEqual(hierarchySnapshots(hierarchy, lock), 0u, "Expected no nodes to update");
+            }
+            {
+                auto lock = StartTransaction<AddRemove>();
+                for (size_t i = 0; i < MOVED_COUNT; i++) {
+                    levels[4][i].Set<TransformSnapshot>(lock);
+                }
+            }
+            auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+            size_t updated = hierarchySnapshots(hierarchy, lock);
+            AssertTrue(updated >= MOVED_COUNT && updated < nodeCount / 2, "Expected only added snapshot subtrees");
+        }
+        assertSnapshots(StartTransaction<Read<TransformTree, TransformSnapshot>>(), "Added snapshot mismatch");
+
+        {
+            Timer t("Remove 10000 entities at depth 3");
+            size_t previousCount = hierarchy.NodeCount();
+            {
+                auto lock = StartTransaction<AddRemove>();
+                for (auto &ent : levels[3]) {
+                    ent.Destroy(lock);
+                }
+                levels[3].clear();
+            }
+            auto lock = StartTransaction<Read<TransformTree>, Write<TransformSnapshot>>();
+            hierarchySnapshots(hierarchy, lock);
+            AssertEqual(hierarchy.NodeCount(), previousCount - NODES_PER_LEVEL, "Expected removed nodes to be freed");
+        }
+        assertSnapshots(StartTransaction<Read<TransformTree, TransformSnapshot>>(), "Orphaned snapshot mismatch");
+
+        {
+            auto lock = StartTransaction<AddRemove>();
+            for (auto &level : levels) {
+                for (auto &ent : level) {
+                    ent.Destroy(lock);
+                }
+            }
+        }
+    }
+
+    Test test(&BenchmarkTransformHierarchy);
+} // namespace TransformHierarchyBenchmarks
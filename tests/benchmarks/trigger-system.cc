@@ -0,0 +1,142 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "physx/TriggerSystem.hh"
+
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <tests.hh>
+#include <vector>
+
+namespace TriggerSystemBenchmarks {
+    using namespace testing;
+    using namespace ecs;
+
+    const size_t AREA_GRID_SIZE = 32; // 32 x 32 = 1024 areas
+    const float AREA_SPACING = 6.0f;
+    const float AREA_SIZE = 4.0f;
+    const size_t ENTITY_COUNT = 10000;
+    const size_t FRAME_COUNT = 100;
+    const size_t BRUTE_FORCE_FRAME_COUNT = 5;
+
+    glm::vec3 entityPosition(size_t index, size_t frame) {
+        float worldSize = AREA_GRID_SIZE * AREA_SPACING;
+        float t = frame * 0.05f + index;
+        return glm::vec3(std::fmod(index * 7.31f, worldSize) + std::sin(t) * AREA_SPACING,
+            std::cos(t * 0.5f),
+            std::fmod(index * 3.17f, worldSize) + std::cos(t) * AREA_SPACING);
+    }
+
+    void moveEntities(const std::vector<Entity> &entities, size_t frame) {
+        auto lock = StartTransaction<Write<TransformSnapshot>>();
+        for (size_t i = 0; i < entities.size(); i++) {
+            entities[i].Get<TransformSnapshot>(lock).globalPose.SetPosition(entityPosition(i, frame));
+        }
+    }
+
+    // Reference implementation matching the original per-frame O(areas * entities) check
+    size_t bruteForceCount(Lock<Read<TriggerArea, TriggerGroup, TransformSnapshot>> lock, Entity areaEnt) {
+        auto &areaTransform = areaEnt.Get<TransformSnapshot>(lock).globalPose;
+        auto &area = areaEnt.Get<TriggerArea>(lock);
+        auto areaCenter = areaTransform.GetPosition();
+        auto boundingRadiusSquared = glm::length2(areaTransform * glm::vec4(glm::vec3(0.5f), 0.0f));
+        auto invAreaTransform = areaTransform.GetInverse();
+
+        size_t count = 0;
+        for (auto &ent : lock.EntitiesWith<TriggerGroup>()) {
+            if (!ent.Has<TriggerGroup, TransformSnapshot>(lock)) continue;
+            auto entityPos = ent.Get<TransformSnapshot>(lock).globalPose.GetPosition();
+            if (glm::length2(entityPos - areaCenter) > boundingRadiusSquared) continue;
+            auto relativePos = invAreaTransform * glm::vec4(entityPos, 1.0);
+            if (area.shape == TriggerShape::Box) {
+                if (glm::all(glm::greaterThan(relativePos, glm::vec3(-0.5))) &&
+                    glm::all(glm::lessThan(relativePos, glm::vec3(0.5)))) {
+                    count++;
+                }
+            } else if (glm::length2(relativePos) < 0.25) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void BenchmarkTriggerSystem() {
+        sp::TriggerSystem triggerSystem;
+
+        std::vector<Entity> areas, entities;
+        {
+            Timer t("Create 1024 trigger areas and 10000 trigger entities");
+            auto lock = StartTransaction<AddRemove>();
+            for (size_t x = 0; x < AREA_GRID_SIZE; x++) {
+                for (size_t z = 0; z < AREA_GRID_SIZE; z++) {
+                    Entity ent = lock.NewEntity();
+                    Transform transform(glm::vec3(x * AREA_SPACING, 0, z * AREA_SPACING));
+                    transform.SetScale(glm::vec3(AREA_SIZE));
+                    ent.Set<TransformSnapshot>(lock, transform);
+                    ent.Set<TriggerArea>(lock).shape = (x + z) % 2 ? TriggerShape::Sphere : TriggerShape::Box;
+                    areas.emplace_back(ent);
+                }
+            }
+            for (size_t i = 0; i < ENTITY_COUNT; i++) {
+                Entity ent = lock.NewEntity();
+                ent.Set<TransformSnapshot>(lock, Transform(entityPosition(i, 0)));
+                ent.Set<TriggerGroup>(lock, TriggerGroup::Object);
+                entities.emplace_back(ent);
+            }
+        }
+
+        {
+            MultiTimer timer("TriggerSystem::Frame 1024 areas, 10000 moving entities");
+            for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                moveEntities(entities, frame);
+                auto lock = StartTransaction<WriteAll>();
+                Timer t(timer);
+                triggerSystem.Frame(lock);
+            }
+        }
+        {
+            MultiTimer timer("Brute force reference 1024 areas, 10000 entities");
+            auto lock = StartTransaction<Read<TriggerArea, TriggerGroup, TransformSnapshot>>();
+            for (size_t frame = 0; frame < BRUTE_FORCE_FRAME_COUNT; frame++) {
+                Timer t(timer);
+                for (auto &areaEnt : areas) {
+                    bruteForceCount(lock, areaEnt);
+                }
+            }
+        }
+
+        {
+            auto lock = StartTransaction<WriteAll>();
+            size_t totalContained = 0;
+            for (auto &areaEnt : areas) {
+                size_t expected = bruteForceCount(lock, areaEnt);
+                auto &contained = areaEnt.Get<TriggerArea>(lock).containedEntities[TriggerGroup::Object];
+                AssertEqual(contained.size(), expected, "Expected trigger area to match brute force count");
+                AssertEqual(SignalRef(areaEnt, TriggerGroupSignalNames[TriggerGroup::Object]).GetSignal(lock),
+                    (double)expected,
+                    "Expected trigger signal to match contained entity count");
+                totalContained += expected;
+            }
+            Logf("%u entities inside trigger areas after %u frames", totalContained, FRAME_COUNT);
+        }
+        {
+            auto lock = StartTransaction<AddRemove>();
+            for (auto &ent : areas) {
+                ent.Destroy(lock);
+            }
+            for (auto &ent : entities) {
+                ent.Destroy(lock);
+            }
+        }
+    }
+
+    Test test(&BenchmarkTriggerSystem);
+} // namespace TriggerSystemBenchmarks
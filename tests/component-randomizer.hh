@@ -0,0 +1,217 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/ScriptManager.hh"
+#include "ecs/StructFieldTypes.hh"
+
+#include <glm/gtc/quaternion.hpp>
+#include <iterator>
+#include <random>
+
+/**
+ * Fills components with random values for the binary serialization tests and benchmarks.
+ * Values are limited to what json can represent, so results can be compared through their json encoding.
+ */
+namespace ComponentRandomizer {
+    using namespace ecs;
+
+    static const size_t MAX_DEPTH = 3;
+
+    static const std::array fuzzNames = {"", "fuzz:a", "fuzz:b.child", "other:c"};
+    static const std::array fuzzStrings = {"", "a", "hello world", "fuzz:a/x", "key_1", "unicode \xc3\xa9"};
+    static const std::array fuzzExprs =
+        {"", "fuzz:a/x + 1", "fuzz:b/y * 2 > 0.5", "is_focused(Game)", "max(fuzz:a/x, 3)"};
+    static const std::array fuzzEvents = {"/action/press", "/trigger/object/enter", "/signal/set/value"};
+
+    template<typename T>
+    const char *pick(std::mt19937 &rng, const T &options) {
+        return options[rng() % options.size()];
+    }
+
+    inline float randomFloat(std::mt19937 &rng) {
+        // Values must stay finite, picojson can't serialize inf or nan
+        return std::uniform_real_distribution<float>(-100.0f, 100.0f)(rng);
+    }
+
+    inline glm::quat randomRotation(std::mt19937 &rng) {
+        glm::vec3 axis(randomFloat(rng), randomFloat(rng), randomFloat(rng));
+        if (glm::length(axis) < 0.001f) axis = glm::vec3(0, 1, 0);
+        return glm::angleAxis(glm::radians(randomFloat(rng)), glm::normalize(axis));
+    }
+
+    template<typename T>
+    void randomize(std::mt19937 &rng, T &value, size_t depth = 0);
+
+    template<typename T>
+    void randomizeStruct(std::mt19937 &rng, T &value, size_t depth) {
+        auto &metadata = StructMetadata::Get<T>();
+        for (auto &field : metadata.fields) {
+            if (field.name.empty() && field.type == metadata.type) continue;
+            GetFieldType(field.type, field.Access(&value), [&](auto &fieldValue) {
+                randomize(rng, fieldValue, depth + 1);
+            });
+        }
+
+        // Leave asset names empty so loading doesn't try to read files
+        if constexpr (std::is_same_v<T, Renderable>) {
+            value.modelName.clear();
+        } else if constexpr (std::is_same_v<T, Sound>) {
+            value.filePath.clear();
+        }
+    }
+
+    template<typename T>
+    void randomize(std::mt19937 &rng, T &value, size_t depth) {
+        if constexpr (std::is_same_v<T, bool>) {
+            value = rng() % 2;
+        } else if constexpr (std::is_enum<T>()) {
+            auto values = magic_enum::enum_values<T>();
+            if constexpr (is_flags_enum<T>()) {
+                value = {};
+                for (auto &flag : values) {
+                    if (rng() % 2) value |= flag;
+                }
+            } else {
+                value = values[rng() % values.size()];
+            }
+        } else if constexpr (std::is_floating_point<T>()) {
+            value = randomFloat(rng);
+        } else if constexpr (std::is_arithmetic<T>()) {
+            value = (T)rng();
+        } else if constexpr (std::is_same_v<T, sp::angle_t>) {
+            value = glm::radians(randomFloat(rng));
+        } else if constexpr (std::is_same_v<T, sp::color_t> || std::is_same_v<T, sp::color_alpha_t>) {
+            randomize(rng, value.color, depth);
+        } else if constexpr (sp::is_glm_vec<T>()) {
+            for (glm::length_t i = 0; i < T::length(); i++) {
+                randomize(rng, value[i], depth);
+            }
+        } else if constexpr (std::is_same_v<T, glm::quat>) {
+            value = randomRotation(rng);
+        } else if constexpr (std::is_same_v<T, glm::mat3>) {
+            value = glm::mat3_cast(randomRotation(rng));
+        } else if constexpr (std::is_same_v<T, Transform>) {
+            value = Transform(glm::vec3(randomFloat(rng), randomFloat(rng), randomFloat(rng)), randomRotation(rng));
+            value.SetScale(glm::vec3(std::uniform_real_distribution<float>(0.1f, 10.0f)(rng)));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            value = pick(rng, fuzzStrings);
+        } else if constexpr (std::is_same_v<T, Name>) {
+            value = Name(pick(rng, fuzzNames), Name());
+        } else if constexpr (std::is_same_v<T, EntityRef>) {
+            value = Name(pick(rng, fuzzNames), Name());
+        } else if constexpr (std::is_same_v<T, SignalExpression>) {
+            std::string expr = pick(rng, fuzzExprs);
+            value = expr.empty() ? SignalExpression() : SignalExpression(expr);
+        } else if constexpr (std::is_same_v<T, EventDest>) {
+            // Event targets can't be empty
+            value.target = Name(pick(rng, fuzzNames), Name());
+            if (!value.target) value.target = Name("fuzz", "target");
+            value.queueName = pick(rng, fuzzEvents);
+        } else if constexpr (std::is_same_v<T, EventData>) {
+            // Only the EventData types supported by JSON
+            switch (rng() % 6) {
+            case 0:
+                value = (bool)(rng() % 2);
+                break;
+            case 1:
+                value = (double)randomFloat(rng);
+                break;
+            case 2:
+                value = glm::vec2(randomFloat(rng), randomFloat(rng));
+                break;
+            case 3:
+                value = glm::vec3(randomFloat(rng), randomFloat(rng), randomFloat(rng));
+                break;
+            case 4:
+                value = glm::vec4(randomFloat(rng), randomFloat(rng), randomFloat(rng), randomFloat(rng));
+                break;
+            default:
+                value = std::string(pick(rng, fuzzStrings));
+                break;
+            }
+        } else if constexpr (std::is_same_v<T, PhysicsShape>) {
+            randomizeStruct(rng, value, depth);
+            switch (rng() % 5) {
+            case 0:
+                value.shape = std::monostate();
+                break;
+            case 1:
+                value.shape = PhysicsShape::Sphere(randomFloat(rng));
+                break;
+            case 2:
+                value.shape = PhysicsShape::Capsule(randomFloat(rng), randomFloat(rng));
+                break;
+            case 3:
+                value.shape = PhysicsShape::Box(glm::vec3(randomFloat(rng), randomFloat(rng), randomFloat(rng)));
+                break;
+            default:
+                value.shape = PhysicsShape::Plane();
+                break;
+            }
+        } else if constexpr (std::is_same_v<T, LaserLine>) {
+            randomizeStruct(rng, value, depth);
+            if (rng() % 2) {
+                LaserLine::Line line;
+                randomize(rng, line.points, depth + 1);
+                randomize(rng, line.color, depth + 1);
+                value.line = line;
+            } else {
+                LaserLine::Segments segments(rng() % 3);
+                for (auto &segment : segments) {
+                    randomize(rng, segment.start, depth + 1);
+                    randomize(rng, segment.end, depth + 1);
+                    randomize(rng, segment.color, depth + 1);
+                }
+                value.line = segments;
+            }
+        } else if constexpr (std::is_same_v<T, ScriptInstance>) {
+            // Picks any registered script, each test binary registers a different set of scripts
+            auto &definitions = GetScriptDefinitions();
+            auto &list = rng() % 2 ? definitions.scripts : definitions.prefabs;
+            Assertf(!list.empty(), "No scripts are registered to randomize");
+            auto it = list.begin();
+            std::advance(it, rng() % list.size());
+            auto &definition = it->second;
+            value = std::make_shared<ScriptState>(definition);
+            if (!definition.context) return;
+
+            // Leave some instances with default parameters, which are saved differently in json
+            if (rng() % 4 == 0) return;
+            void *dataPtr = definition.context->Access(*value.state);
+            for (auto &field : definition.context->metadata.fields) {
+                GetFieldType(field.type, field.Access(dataPtr), [&](auto &fieldValue) {
+                    randomize(rng, fieldValue, depth + 1);
+                });
+            }
+        } else if constexpr (sp::binary::detail::is_optional<T>()) {
+            if (depth >= MAX_DEPTH || rng() % 2) {
+                value.reset();
+            } else {
+                typename T::value_type item = {};
+                randomize(rng, item, depth + 1);
+                value = item;
+            }
+        } else if constexpr (sp::is_vector<T>()) {
+            value.resize(depth >= MAX_DEPTH ? 0 : rng() % 4);
+            for (auto &item : value) {
+                randomize(rng, item, depth + 1);
+            }
+        } else if constexpr (sp::binary::detail::is_unordered_map<T>()) {
+            value.clear();
+            size_t count = depth >= MAX_DEPTH ? 0 : rng() % 4;
+            for (size_t i = 0; i < count; i++) {
+                randomize(rng, value["key_" + std::to_string(rng() % 8)], depth + 1);
+            }
+        } else {
+            randomizeStruct(rng, value, depth);
+        }
+    }
+} // namespace ComponentRandomizer
@@ -9,7 +9,11 @@
 
 #include "ecs/EcsImpl.hh"
 
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <picojson/picojson.h>
+#include <string>
 #include <vector>
 
 #ifndef TEST_TYPE
@@ -18,11 +22,86 @@
 
 namespace testing {
     std::vector<std::function<void()>> registeredTests;
+
+    std::mutex resultsMutex;
+    std::vector<BenchmarkResult> benchmarkResults;
+
+    void RecordBenchmarkResult(const BenchmarkResult &result) {
+        std::lock_guard lock(resultsMutex);
+        benchmarkResults.emplace_back(result);
+    }
 } // namespace testing
 
 using namespace testing;
 
+static std::string csvEscape(const std::string &str) {
+    std::string escaped = "\"";
+    for (char ch : str) {
+        if (ch == '"') escaped += '"';
+        escaped += ch;
+    }
+    return escaped + "\"";
+}
+
+static bool writeJsonResults(const std::string &path, const std::string &label) {
+    picojson::array results;
+    for (auto &result : benchmarkResults) {
+        picojson::object obj;
+        obj["name"] = picojson::value(result.name);
+        obj["samples"] = picojson::value((double)result.samples);
+        obj["min_ns"] = picojson::value(result.min);
+        obj["mean_ns"] = picojson::value(result.mean);
+        obj["p50_ns"] = picojson::value(result.p50);
+        obj["p90_ns"] = picojson::value(result.p90);
+        obj["p95_ns"] = picojson::value(result.p95);
+        obj["p99_ns"] = picojson::value(result.p99);
+        obj["max_ns"] = picojson::value(result.max);
+        obj["total_ns"] = picojson::value(result.total);
+        results.emplace_back(obj);
+    }
+    picojson::object root;
+    root["type"] = picojson::value(TEST_TYPE);
+    root["label"] = picojson::value(label);
+    root["results"] = picojson::value(results);
+
+    std::ofstream out(path);
+    if (!out) return false;
+    out << picojson::value(root).serialize(true);
+    return out.good();
+}
+
+static bool writeCsvResults(const std::string &path, const std::string &label) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "label,name,samples,min_ns,mean_ns,p50_ns,p90_ns,p95_ns,p99_ns,max_ns,total_ns" << std::endl;
+    out << std::fixed;
+    out.precision(0);
+    for (auto &result : benchmarkResults) {
+        out << csvEscape(label) << "," << csvEscape(result.name) << "," << result.samples << "," << result.min << ","
+            << result.mean << "," << result.p50 << "," << result.p90 << "," << result.p95 << "," << result.p99 << ","
+            << result.max << "," << result.total << std::endl;
+    }
+    return out.good();
+}
+
 int main(int argc, char **argv) {
+    // Usage: sp-bench [--json <path>] [--csv <path>] [--label <commit or run name>]
+    std::string jsonPath, csvPath, label;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--json") {
+            jsonPath = argv[++i];
+        } else if (i + 1 < argc && arg == "--csv") {
+            csvPath = argv[++i];
+        } else if (i + 1 < argc && arg == "--label") {
+            label = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--json <path>] [--csv <path>] [--label <name>]" << std::endl;
+            return 1;
+        }
+    }
+
     std::cout << "Running " << registeredTests.size() << " " << TEST_TYPE << " tests" << std::endl;
     {
         auto stagingLock = ecs::StartStagingTransaction<ecs::AddRemove>();
@@ -51,6 +130,24 @@ int main(int argc, char **argv) {
     }
 
     std::cout << "Tests complete" << std::endl << std::flush;
+
+    int exitCode = 0;
+    if (!jsonPath.empty()) {
+        if (writeJsonResults(jsonPath, label)) {
+            std::cout << "Wrote " << benchmarkResults.size() << " results to " << jsonPath << std::endl;
+        } else {
+            std::cerr << "Failed to write results to " << jsonPath << std::endl;
+            exitCode = 1;
+        }
+    }
+    if (!csvPath.empty()) {
+        if (writeCsvResults(csvPath, label)) {
+            std::cout << "Wrote " << benchmarkResults.size() << " results to " << csvPath << std::endl;
+        } else {
+            std::cerr << "Failed to write results to " << csvPath << std::endl;
+            exitCode = 1;
+        }
+    }
     std::cerr << std::flush;
-    return 0;
+    return exitCode;
 }
@@ -101,6 +101,16 @@ namespace testing {
         }
     }
 
+    struct BenchmarkResult {
+        std::string name;
+        size_t samples = 0;
+        // All durations are in nanoseconds
+        double min = 0, mean = 0, p50 = 0, p90 = 0, p95 = 0, p99 = 0, max = 0, total = 0;
+    };
+
+    // Collected results are written to the --json and --csv outputs when the test binary exits.
+    void RecordBenchmarkResult(const BenchmarkResult &result);
+
     class MultiTimer {
     public:
         MultiTimer(const MultiTimer &) = delete;
@@ -128,19 +138,32 @@ namespace testing {
             if (print) {
                 std::stringstream ss;
                 if (values.size() > 1) {
-                    std::chrono::nanoseconds total(0);
-                    for (auto value : values) {
-                        total += value;
-                    }
                     std::sort(values.begin(), values.end(), std::less<std::chrono::nanoseconds>());
 
-                    ss << "[" << name << "] Min: " << (values[0].count() / 1000.0)
-                       << " usec, Avg: " << (total.count() / values.size() / 1000.0)
-                       << " usec, P95: " << (values[(size_t)((double)values.size() * 0.95) - 1].count() / 1000.0)
-                       << " usec, P99: " << (values[(size_t)((double)values.size() * 0.99) - 1].count() / 1000.0)
-                       << " usec, Total: " << (total.count() / 1000000.0) << " ms" << std::endl;
+                    BenchmarkResult result;
+                    result.name = name;
+                    result.samples = values.size();
+                    for (auto value : values) {
+                        result.total += value.count();
+                    }
+                    result.min = values.front().count();
+                    result.max = values.back().count();
+                    result.mean = result.total / values.size();
+                    result.p50 = Percentile(0.50);
+                    result.p90 = Percentile(0.90);
+                    result.p95 = Percentile(0.95);
+                    result.p99 = Percentile(0.99);
+                    RecordBenchmarkResult(result);
+
+                    ss << "[" << name << "] Min: " << (result.min / 1000.0) << " usec, Avg: " << (result.mean / 1000.0)
+                       << " usec, P95: " << (result.p95 / 1000.0) << " usec, P99: " << (result.p99 / 1000.0)
+                       << " usec, Total: " << (result.total / 1000000.0) << " ms, P50: " << (result.p50 / 1000.0)
+                       << " usec, P90: " << (result.p90 / 1000.0) << " usec" << std::endl;
                 } else if (values.size() == 1) {
-                    ss << "[" << name << "] End: " << (values[0].count() / 1000000.0) << " ms" << std::endl;
+                    double value = values[0].count();
+                    RecordBenchmarkResult(
+                        BenchmarkResult{name, 1, value, value, value, value, value, value, value, value});
+                    ss << "[" << name << "] End: " << (value / 1000000.0) << " ms" << std::endl;
                 } else {
                     ss << "[" << name << "] No timers completed" << std::endl;
                 }
@@ -149,6 +172,13 @@ namespace testing {
         }
 
     private:
+        // Nearest-rank percentile, values must already be sorted
+        double Percentile(double fraction) const {
+            // Same rank as the original P95/P99 output so numbers stay comparable across versions
+            size_t rank = (size_t)(fraction * values.size());
+            return values[std::clamp<size_t>(rank, 1, values.size()) - 1].count();
+        }
+
         std::string name;
         bool print;
         std::vector<std::chrono::nanoseconds> values;
@@ -173,8 +203,11 @@ namespace testing {
             if (parent != nullptr) {
                 parent->AddValue(end - start);
             } else if (!name.empty()) {
+                double value = std::chrono::nanoseconds(end - start).count();
+                RecordBenchmarkResult(BenchmarkResult{name, 1, value, value, value, value, value, value, value, value});
+
                 std::stringstream ss;
-                ss << "[" << name << "] End: " << ((end - start).count() / 1000000.0) << " ms" << std::endl;
+                ss << "[" << name << "] End: " << (value / 1000000.0) << " ms" << std::endl;
                 std::cout << ss.str();
             }
         }
@@ -0,0 +1,244 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/BinaryHelpers.hh"
+#include "assets/JsonHelpers.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/ScriptManager.hh"
+
+#include <component-randomizer.hh>
+#include <picojson/picojson.h>
+#include <random>
+#include <tests.hh>
+
+namespace ComponentBinaryFuzzTests {
+    using namespace testing;
+    using namespace ecs;
+    using namespace ComponentRandomizer;
+
+    const size_t VALUES_PER_COMPONENT = 100;
+
+    // Registered so script lists with parameters can be round tripped without linking the game scripts.
+    // These are the only scripts in the unit test binary, so randomize() picks between them.
+    struct FuzzScript {
+        float speed = 1.0f;
+        bool enabled = true;
+        std::string target;
+        glm::vec3 axis = glm::vec3(0, 1, 0);
+        std::vector<std::string> names;
+
+        void OnTick(ScriptState &state, Lock<Read<Name>> lock, Entity ent, chrono_clock::duration interval) {}
+    };
+    StructMetadata MetadataFuzzScript(typeid(FuzzScript),
+        "FuzzScript",
+        "",
+        StructField::New("speed", &FuzzScript::speed),
+        StructField::New("enabled", &FuzzScript::enabled),
+        StructField::New("target", &FuzzScript::target),
+        StructField::New("axis", &FuzzScript::axis),
+        StructField::New("names", &FuzzScript::names));
+    InternalScript<FuzzScript> fuzzScript("fuzz_script", MetadataFuzzScript);
+
+    struct FuzzPrefab {
+        std::string source;
+        std::vector<glm::vec2> points;
+
+        void Prefab(const ScriptState &state,
+            const std::shared_ptr<sp::Scene> &scene,
+            Lock<AddRemove> lock,
+            Entity ent) {}
+    };
+    StructMetadata MetadataFuzzPrefab(typeid(FuzzPrefab),
+        "FuzzPrefab",
+        "",
+        StructField::New("source", &FuzzPrefab::source),
+        StructField::New("points", &FuzzPrefab::points));
+    PrefabScript<FuzzPrefab> fuzzPrefab("fuzz_prefab", MetadataFuzzPrefab);
+
+    // Saves every field like ComponentBase::SaveEntity() would, without skipping default values
+    template<typename T>
+    std::string saveJson(const ComponentBase &comp, const T &value) {
+        picojson::value dst;
+        for (auto &field : comp.metadata.fields) {
+            field.Save(Name(), dst, &value, nullptr);
+        }
+        StructMetadata::Save<T>(Name(), dst, value, nullptr);
+        return dst.serialize();
+    }
+
+    template<typename T>
+    void fuzzComponent(std::mt19937 &rng) {
+        auto &comp = LookupComponent<T>();
+        std::string message = "Binary round trip mismatch for component: "s + comp.name;
+
+        for (size_t i = 0; i < VALUES_PER_COMPONENT; i++) {
+            T original = comp.StagingDefault();
+            randomize(rng, original);
+
+            std::vector<uint8_t> buffer;
+            sp::binary::Writer writer(buffer);
+            comp.SaveBinary(writer, &original);
+
+            FlatEntity loaded;
+            sp::binary::Reader reader(buffer);
+            AssertTrue(comp.LoadBinary(loaded, reader), "Failed to load binary component: "s + comp.name);
+            AssertEqual(reader.Remaining(), 0u, "Binary component was not fully read: "s + comp.name);
+            auto &result = std::get<std::optional<T>>(loaded);
+            AssertTrue(result.has_value(), "Binary component was not set: "s + comp.name);
+
+            AssertEqual(saveJson(comp, *result), saveJson(comp, original), message);
+            if constexpr (std::equality_comparable<T>) {
+                AssertTrue(*result == original, message);
+            }
+
+            // Maps may be saved in a different order than the original, but their size and re-encoding must match
+            std::vector<uint8_t> resaved, resavedAgain;
+            sp::binary::Writer resaveWriter(resaved);
+            comp.SaveBinary(resaveWriter, &*result);
+            AssertEqual(resaved.size(), buffer.size(), message);
+            FlatEntity reloaded;
+            sp::binary::Reader resavedReader(resaved);
+            AssertTrue(comp.LoadBinary(reloaded, resavedReader), message);
+            sp::binary::Writer resaveAgainWriter(resavedAgain);
+            comp.SaveBinary(resaveAgainWriter, &*std::get<std::optional<T>>(reloaded));
+            AssertTrue(resaved == resavedAgain, "Binary encoding is unstable for component: "s + comp.name);
+
+            // Every truncated prefix must fail to load instead of reading past the end
+            for (size_t size = 0; size < buffer.size(); size += 1 + size / 8) {
+                FlatEntity truncated;
+                sp::binary::Reader truncatedReader(buffer.data(), size);
+                AssertTrue(!comp.LoadBinary(truncated, truncatedReader),
+                    "Truncated binary component loaded successfully: "s + comp.name);
+            }
+        }
+    }
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    void fuzzAllComponents(ECSType<AllComponentTypes...> *, std::mt19937 &rng, FlatEntity &entity) {
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                if constexpr (std::is_same_v<T, SceneInfo>) {
+                    // Skip
+                } else if constexpr (!Tecs::is_global_component<T>()) {
+                    fuzzComponent<T>(rng);
+
+                    T value = LookupComponent<T>().StagingDefault();
+                    randomize(rng, value);
+                    std::get<std::optional<T>>(entity) = value;
+                }
+            }(),
+            ...);
+    }
+
+    template<typename... AllComponentTypes, template<typename...> typename ECSType>
+    void assertEntitiesEqual(ECSType<AllComponentTypes...> *, const FlatEntity &a, const FlatEntity &b) {
+        ( // For each component:
+            [&] {
+                using T = AllComponentTypes;
+
+                auto &optA = std::get<std::optional<T>>(a);
+                auto &optB = std::get<std::optional<T>>(b);
+                AssertEqual(optA.has_value(), optB.has_value(), "Binary entity component mismatch");
+                if constexpr (!std::is_same_v<T, SceneInfo> && !Tecs::is_global_component<T>()) {
+                    if (optA) {
+                        auto &comp = LookupComponent<T>();
+                        AssertEqual(saveJson(comp, *optA),
+                            saveJson(comp, *optB),
+                            "Binary entity mismatch: "s + comp.name);
+                    }
+                }
+            }(),
+            ...);
+    }
+
+    void TestBinaryMatchesJson() {
+        Timer t("Compare binary component round trips against json");
+        std::mt19937 rng(42);
+
+        FlatEntity entity;
+        fuzzAllComponents((ECS *)nullptr, rng, entity);
+
+        std::vector<uint8_t> buffer;
+        sp::binary::Writer writer(buffer);
+        writer.WriteHeader();
+        SaveEntityBinary(writer, entity);
+
+        FlatEntity loaded;
+        sp::binary::Reader reader(buffer);
+        AssertTrue(reader.ReadHeader(), "Failed to read binary header");
+        AssertTrue(LoadEntityBinary(loaded, reader), "Failed to load binary entity");
+        AssertEqual(reader.Remaining(), 0u, "Binary entity was not fully read");
+        assertEntitiesEqual((ECS *)nullptr, loaded, entity);
+
+        // The first component after the header and count is Name, an unknown schema hash should skip only it
+        size_t hashOffset = sizeof(uint32_t) * 3;
+        sp::Hash64 nameHash;
+        std::memcpy(&nameHash, buffer.data() + hashOffset, sizeof(nameHash));
+        AssertEqual(nameHash, LookupComponent<Name>().SchemaHash(), "Expected Name to be saved first");
+        buffer[hashOffset] ^= 0xff;
+
+        FlatEntity skipped;
+        sp::binary::Reader skippedReader(buffer);
+        AssertTrue(skippedReader.ReadHeader(), "Failed to read binary header");
+        AssertTrue(LoadEntityBinary(skipped, skippedReader), "Failed to load binary entity with unknown component");
+        AssertTrue(!std::get<std::optional<Name>>(skipped), "Expected unknown component to be skipped");
+        std::get<std::optional<Name>>(skipped) = std::get<std::optional<Name>>(entity);
+        assertEntitiesEqual((ECS *)nullptr, skipped, entity);
+
+        std::vector<uint8_t> badVersion;
+        sp::binary::Writer(badVersion).WriteRaw(sp::binary::MAGIC);
+        sp::binary::Writer(badVersion).WriteRaw(sp::binary::VERSION + 1);
+        sp::binary::Reader badVersionReader(badVersion);
+        AssertTrue(!badVersionReader.ReadHeader(), "Expected binary header with a newer version to be rejected");
+    }
+
+    void TestScriptsRoundTrip() {
+        Timer t("Round trip a script list with parameters");
+        auto &tickDefinition = GetScriptDefinitions().scripts.at("fuzz_script");
+        auto &prefabDefinition = GetScriptDefinitions().prefabs.at("fuzz_prefab");
+        auto &comp = LookupComponent<Scripts>();
+
+        Scripts scripts;
+        auto &tick = *scripts.scripts.emplace_back(std::make_shared<ScriptState>(tickDefinition)).state;
+        tick.SetParam<float>("speed", 4.5f);
+        tick.SetParam<std::string>("target", "fuzz:a");
+        tick.SetParam<std::vector<std::string>>("names", {"a", "b.child"});
+        auto &prefab = *scripts.scripts.emplace_back(std::make_shared<ScriptState>(prefabDefinition)).state;
+        prefab.SetParam<std::string>("source", "spotlight");
+        prefab.SetParam<std::vector<glm::vec2>>("points", {glm::vec2(1, 2), glm::vec2(-3, 0.5)});
+        // Scripts without parameter changes must also survive the round trip
+        scripts.scripts.emplace_back(std::make_shared<ScriptState>(tickDefinition));
+
+        std::vector<uint8_t> buffer;
+        sp::binary::Writer writer(buffer);
+        comp.SaveBinary(writer, &scripts);
+
+        FlatEntity loaded;
+        sp::binary::Reader reader(buffer);
+        AssertTrue(comp.LoadBinary(loaded, reader), "Failed to load binary scripts");
+        AssertEqual(reader.Remaining(), 0u, "Binary scripts were not fully read");
+        auto &result = std::get<std::optional<Scripts>>(loaded);
+        AssertTrue(result.has_value(), "Binary scripts were not set");
+        AssertEqual(result->scripts.size(), scripts.scripts.size(), "Binary script count mismatch");
+        for (size_t i = 0; i < scripts.scripts.size(); i++) {
+            auto &state = result->scripts[i].state;
+            AssertTrue(state != nullptr, "Binary script has no state");
+            AssertEqual(state->definition.name,
+                scripts.scripts[i].state->definition.name,
+                "Script definition mismatch");
+            AssertTrue(result->scripts[i] == scripts.scripts[i],
+                "Script parameters mismatch: " + state->definition.name);
+        }
+        AssertEqual(saveJson(comp, *result), saveJson(comp, scripts), "Binary scripts don't match json");
+    }
+
+    Test test1(&TestBinaryMatchesJson);
+    Test test2(&TestScriptsRoundTrip);
+} // namespace ComponentBinaryFuzzTests
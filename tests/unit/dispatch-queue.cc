@@ -0,0 +1,127 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
+
+#include <atomic>
+#include <tests.hh>
+#include <vector>
+
+namespace DispatchQueueTests {
+    using namespace testing;
+    using namespace sp;
+
+    void TestDispatchQueueFutures(DispatchScheduler scheduler) {
+        DispatchQueue queue("TestDispatchQueue", 4, std::chrono::milliseconds(1), scheduler);
+
+        std::atomic_int count = 0;
+        std::vector<AsyncPtr<int>> results;
+        for (int i = 0; i < 1000; i++) {
+            results.emplace_back(queue.Dispatch<int>([i, &count] {
+                count++;
+                return std::make_shared<int>(i);
+            }));
+        }
+
+        AsyncPtr<int> a = results[5], b = results[7];
+        auto sum = queue.Dispatch<int>(a, b, [&queue](std::shared_ptr<int> a, std::shared_ptr<int> b) {
+            // Nested dispatches are forwarded to the outer future
+            return queue.Dispatch<int>([a, b] {
+                return std::make_shared<int>(*a + *b);
+            });
+        });
+
+        for (int i = 0; i < 1000; i++) {
+            AssertEqual(*results[i]->Get(), i, "Unexpected dispatch result");
+        }
+        AssertEqual(count.load(), 1000, "Expected every work item to run once");
+        AssertEqual(*sum->Get(), 12, "Unexpected nested dispatch result");
+    }
+
+    void TestDispatchQueueShared() {
+        Timer t("Test shared DispatchQueue");
+        TestDispatchQueueFutures(DispatchScheduler::Shared);
+    }
+
+    void TestDispatchQueueWorkStealing() {
+        Timer t("Test work-stealing DispatchQueue");
+        TestDispatchQueueFutures(DispatchScheduler::WorkStealing);
+    }
+
+    void TestDispatchQueuePriority() {
+        Timer t("Test DispatchQueue priority ordering");
+        for (auto scheduler : {DispatchScheduler::Shared, DispatchScheduler::WorkStealing}) {
+            // With no threads, work only runs during Flush(), so the order is deterministic
+            DispatchQueue queue("TestDispatchQueuePriority", 0, std::chrono::milliseconds(1), scheduler);
+
+            std::vector<DispatchPriority> order;
+            for (auto priority :
+                {DispatchPriority::Background, DispatchPriority::Normal, DispatchPriority::FrameCritical}) {
+                queue.Dispatch<void>(DispatchOptions{priority}, [&order, priority] {
+                    order.emplace_back(priority);
+                });
+            }
+            queue.Flush();
+
+            AssertEqual(order.size(), 3u, "Expected all work items to run");
+            AssertTrue(order[0] == DispatchPriority::FrameCritical, "Expected frame critical work to run first");
+            AssertTrue(order[1] == DispatchPriority::Normal, "Expected normal work to run second");
+            AssertTrue(order[2] == DispatchPriority::Background, "Expected background work to run last");
+        }
+    }
+
+    void TestDispatchQueueWorkerOrder() {
+        Timer t("Test work-stealing DispatchQueue runs a worker's newest work first");
+        DispatchQueue queue("TestDispatchQueueWorkerOrder",
+            0,
+            std::chrono::milliseconds(1),
+            DispatchScheduler::WorkStealing);
+
+        std::vector<int> order;
+        for (int i = 0; i < 3; i++) {
+            queue.Dispatch<void>([&order, i] {
+                order.emplace_back(i);
+            });
+        }
+        queue.Flush();
+
+        AssertEqual(order.size(), 3u, "Expected all work items to run");
+        AssertEqual(order[0], 2, "Expected the newest work item to run first");
+        AssertEqual(order[2], 0, "Expected the oldest work item to run last");
+    }
+
+    void TestDispatchQueueCancel() {
+        Timer t("Test DispatchQueue cancellation");
+        for (auto scheduler : {DispatchScheduler::Shared, DispatchScheduler::WorkStealing}) {
+            DispatchQueue queue("TestDispatchQueueCancel", 0, std::chrono::milliseconds(1), scheduler);
+
+            auto token = make_shared<DispatchCancelToken>();
+            bool ran = false;
+            auto result = queue.Dispatch<int>(DispatchOptions{DispatchPriority::Normal, token}, [&ran] {
+                ran = true;
+                return std::make_shared<int>(42);
+            });
+            auto other = queue.Dispatch<int>([] {
+                return std::make_shared<int>(7);
+            });
+            token->Cancel();
+            queue.Flush();
+
+            AssertTrue(result->Ready(), "Expected cancelled future to be resolved");
+            AssertTrue(result->Get() == nullptr, "Expected cancelled future to be resolved with nullptr");
+            AssertTrue(!ran, "Cancelled work item should not run");
+            AssertEqual(*other->Get(), 7, "Expected uncancelled work item to run");
+        }
+    }
+
+    Test test1(&TestDispatchQueueShared);
+    Test test2(&TestDispatchQueueWorkStealing);
+    Test test3(&TestDispatchQueuePriority);
+    Test test4(&TestDispatchQueueCancel);
+    Test test5(&TestDispatchQueueWorkerOrder);
+} // namespace DispatchQueueTests
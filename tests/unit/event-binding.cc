@@ -158,5 +158,45 @@ namespace EventBindingTests {
         }
     }
 
-    Test test(&TrySendEvent);
+    void TestEventNames() {
+        Timer t("Test interned event names");
+        ecs::EventName a(TEST_EVENT_ACTION1);
+        ecs::EventName b("/test/action1");
+        ecs::EventName c(TEST_EVENT_ACTION2);
+        ecs::EventName empty;
+
+        AssertEqual(a.Id(), b.Id(), "Expected equal names to share an id");
+        AssertTrue(a.Id() != c.Id(), "Expected different names to have different ids");
+        AssertTrue(&a.String() == &b.String(), "Expected equal names to share storage");
+        AssertEqual(a, b, "Expected equal names to compare equal");
+        AssertEqual(a, TEST_EVENT_ACTION1, "Expected name to compare equal to its string");
+        AssertTrue(a != c, "Expected different names to compare not equal");
+        AssertEqual(empty, "", "Expected default name to be empty");
+        AssertEqual(ecs::EventName("").Id(), empty.Id(), "Expected empty string to use the empty name");
+        AssertTrue(empty.empty(), "Expected default name to be empty");
+    }
+
+    void TestEventQueueInlineData() {
+        Timer t("Test event queue wrap around with inline data");
+        ecs::EventQueue queue(4);
+        ecs::Event event;
+        for (int i = 0; i < 10; i++) {
+            AssertTrue(queue.Add(ecs::Event{TEST_EVENT_ACTION1, Tecs::Entity(), i}), "Expected to queue an event");
+            AssertTrue(queue.Add(ecs::Event{TEST_EVENT_ACTION2, Tecs::Entity(), std::to_string(i)}),
+                "Expected to queue an event");
+            AssertEqual(queue.Size(), 2u, "Unexpected queue size");
+
+            AssertTrue(queue.Poll(event), "Expected to receive an event");
+            AssertEqual(event.name, TEST_EVENT_ACTION1, "Unexpected event name");
+            AssertEqual(event.data, ecs::EventData(i), "Unexpected event data");
+            AssertTrue(queue.Poll(event), "Expected to receive an event");
+            AssertEqual(event.name, TEST_EVENT_ACTION2, "Unexpected event name");
+            AssertEqual(event.data, ecs::EventData(std::to_string(i)), "Unexpected event data");
+            AssertTrue(!queue.Poll(event), "Unexpected extra event");
+        }
+    }
+
+    Test test1(&TrySendEvent);
+    Test test2(&TestEventNames);
+    Test test3(&TestEventQueueInlineData);
 } // namespace EventBindingTests
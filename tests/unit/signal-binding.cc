@@ -7,6 +7,7 @@
 
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
+#include "ecs/SignalBindingBatch.hh"
 
 #include <glm/glm.hpp>
 #include <tests.hh>
@@ -280,6 +281,94 @@ namespace SignalBindingTests {
             val = ecs::SignalRef(hand, TEST_SIGNAL_ACTION3).GetSignal(lock);
             AssertEqual(val, 5.0, "Expected binding to return signal value");
         }
+        {
+            Timer t("Test memoized bindings update when their inputs change");
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock, ecs::Write<ecs::Signals>>();
+
+            ecs::SignalRef buttonRef(player, TEST_SOURCE_BUTTON);
+            ecs::SignalRef action2Ref(player, TEST_SIGNAL_ACTION2);
+            ecs::SignalRef handRef(hand, TEST_SIGNAL_ACTION1);
+            AssertEqual(action2Ref.GetSignal(lock), 3.0, "Expected signal to match key source + button source");
+            AssertEqual(handRef.GetSignal(lock), 1.0, "Expected signal to match button source");
+
+            buttonRef.SetValue(lock, 4.0);
+            AssertEqual(action2Ref.GetSignal(lock), 6.0, "Expected cached signal to be invalidated");
+            AssertEqual(handRef.GetSignal(lock), 4.0, "Expected cached signal to be invalidated");
+
+            buttonRef.ClearValue(lock);
+            AssertEqual(action2Ref.GetSignal(lock), 2.0, "Expected cleared input to read as 0");
+
+            action2Ref.SetBinding(lock, "player/device2_key * 2", ecs::Name("player", ""));
+            AssertEqual(action2Ref.GetSignal(lock), 4.0, "Expected new binding to be evaluated");
+        }
+        {
+            Timer t("Test memoized bindings are committed");
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+
+            double val = ecs::SignalRef(player, TEST_SIGNAL_ACTION2).GetSignal(lock);
+            AssertEqual(val, 4.0, "Expected signal to match the new binding");
+            val = ecs::SignalRef(hand, TEST_SIGNAL_ACTION1).GetSignal(lock);
+            AssertEqual(val, 0.0, "Expected signal to match the cleared button source");
+        }
+        {
+            Timer t("Test batched bindings are stored in the memoized caches");
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock, ecs::Write<ecs::Signals>>();
+            auto &signals = lock.Get<ecs::Signals>();
+
+            ecs::SignalRef keyRef(player, TEST_SOURCE_KEY);
+            ecs::SignalRef action1Ref(player, TEST_SIGNAL_ACTION1);
+            ecs::SignalRef action2Ref(player, TEST_SIGNAL_ACTION2);
+            ecs::SignalBindingBatch batch;
+            batch.Add(action1Ref);
+            batch.Add(action2Ref);
+            batch.Add(keyRef);
+
+            keyRef.SetValue(lock, 3.0);
+            AssertEqual(batch.Evaluate(lock), 2u, "Expected both bindings to be evaluated");
+            AssertEqual(batch.Evaluate(lock), 0u, "Expected cached bindings not to be evaluated again");
+
+            double value;
+            ecs::SignalCacheability cacheability;
+            bool cached = signals.LoadCachedValue(action2Ref.GetLiveSlot().index,
+                lock.GetTransactionId(),
+                value,
+                cacheability);
+            AssertTrue(cached, "Expected batched binding to be cached");
+            AssertEqual(value, 6.0, "Expected cached value to match the binding");
+            AssertEqual(action1Ref.GetSignal(lock), 3.0, "Expected signal to match the batched value");
+
+            keyRef.SetValue(lock, 4.0);
+            AssertEqual(batch.Evaluate(lock), 2u, "Expected changed input to invalidate batched bindings");
+            AssertEqual(action2Ref.GetSignal(lock), 8.0, "Expected signal to match the updated input");
+
+            action2Ref.SetBinding(lock, "player/device2_key + 1", ecs::Name("player", ""));
+            AssertEqual(batch.Evaluate(lock), 2u, "Expected changed binding to recompile the batch");
+            AssertEqual(action2Ref.GetSignal(lock), 5.0, "Expected signal to match the new binding");
+
+            keyRef.SetValue(lock, 2.0);
+            action2Ref.SetBinding(lock, "player/device2_key * 2", ecs::Name("player", ""));
+        }
+        {
+            Timer t("Test freed signal slots are reused with a new generation");
+            auto lock = ecs::StartTransaction<ecs::Write<ecs::Signals>>();
+            auto &signals = lock.Get<ecs::Signals>();
+
+            ecs::SignalRef keyRef(player, TEST_SOURCE_KEY);
+            ecs::SignalSlot staleSlot = keyRef.GetLiveSlot();
+            AssertTrue(signals.Contains(staleSlot), "Expected signal slot to be allocated");
+            signals.FreeSignal(staleSlot);
+            keyRef.GetLiveSlot() = {};
+            AssertTrue(!signals.Contains(staleSlot), "Expected freed signal slot to be invalid");
+            AssertTrue(!keyRef.HasValue(lock), "Expected freed signal to have no value");
+
+            ecs::SignalRef newRef(player, "test_new");
+            newRef.SetValue(lock, 5.0);
+            auto &newSlot = newRef.GetLiveSlot();
+            AssertEqual(newSlot.index, staleSlot.index, "Expected freed signal slot to be reused");
+            AssertTrue(newSlot.generation != staleSlot.generation, "Expected reused slot to have a new generation");
+            AssertTrue(!signals.Contains(staleSlot), "Expected stale signal slot to stay invalid");
+            AssertEqual(newRef.GetValue(lock), 5.0, "Expected reused signal slot to have the new value");
+        }
     }
 
     Test test(&TrySetSignals);
@@ -0,0 +1,142 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "console/Console.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/SignalExpression.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <tests.hh>
+
+namespace SignalExpressionFuzzTests {
+    using namespace testing;
+
+    const size_t EXPRESSION_COUNT = 5000;
+    const size_t MAX_DEPTH = 5;
+
+    const std::array fuzzSignals = {"fuzz:a/x", "fuzz:a/y", "fuzz:b/z", "fuzz:b/missing"};
+    const std::array oneInputFunctions = {"sin", "cos", "tan", "floor", "ceil", "abs"};
+    const std::array operators = {"+", "-", "*", "/", "&&", "||", ">", ">=", "<", "<=", "==", "!="};
+    const std::array focusLayers = {"Game", "Menu", "Overlay"};
+
+    template<typename T>
+    const char *pick(std::mt19937 &rng, const T &options) {
+        return options[rng() % options.size()];
+    }
+
+    std::string generateExpression(std::mt19937 &rng, size_t depth = 0) {
+        // Only generate leaves once the max depth is reached
+        switch (rng() % (depth >= MAX_DEPTH ? 3 : 14)) {
+        case 0:
+            return std::to_string(std::uniform_real_distribution<double>(-3.0, 3.0)(rng));
+        case 1:
+            return std::to_string(rng() % 3);
+        case 2:
+            return pick(rng, fuzzSignals);
+        case 3:
+            return "( " + generateExpression(rng, depth + 1) + " )";
+        case 4:
+            return "-" + generateExpression(rng, depth + 1);
+        case 5:
+            return "!" + generateExpression(rng, depth + 1);
+        case 6:
+            return std::string(pick(rng, oneInputFunctions)) + "(" + generateExpression(rng, depth + 1) + ")";
+        case 7:
+            return std::string(rng() % 2 ? "min(" : "max(") + generateExpression(rng, depth + 1) + ", " +
+                   generateExpression(rng, depth + 1) + ")";
+        case 8:
+        case 9:
+        case 10:
+            return generateExpression(rng, depth + 1) + " " + pick(rng, operators) + " " +
+                   generateExpression(rng, depth + 1);
+        case 11:
+            return generateExpression(rng, depth + 1) + " ? " + generateExpression(rng, depth + 1) + " : " +
+                   generateExpression(rng, depth + 1);
+        case 12:
+            return std::string("is_focused(") + pick(rng, focusLayers) + ")";
+        default:
+            return std::string("if_focused(") + pick(rng, focusLayers) + ", " + generateExpression(rng, depth + 1) +
+                   ")";
+        }
+    }
+
+    bool identical(double a, double b) {
+        return std::memcmp(&a, &b, sizeof(double)) == 0 || a == b;
+    }
+
+    void TestBytecodeMatchesTree() {
+        Timer t("Compare bytecode and batch evaluation against the node tree");
+        auto &bytecodeCVar = sp::GetConsoleManager().GetCVar<bool>("s.SignalBytecode");
+        std::mt19937 rng(42);
+
+        std::vector<ecs::SignalExpression> expressions;
+        size_t invalidCount = 0;
+        for (size_t i = 0; i < EXPRESSION_COUNT; i++) {
+            ecs::SignalExpression expr(generateExpression(rng));
+            if (expr) {
+                expressions.emplace_back(expr);
+            } else {
+                invalidCount++;
+            }
+        }
+        AssertTrue(invalidCount < EXPRESSION_COUNT / 10, "Expected most generated expressions to be valid");
+        ecs::SignalExpressionBatch batch{std::vector<ecs::SignalExpression>(expressions)};
+
+        Tecs::Entity a, b;
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            a = lock.NewEntity();
+            b = lock.NewEntity();
+            ecs::EntityRef aRef(ecs::Name("fuzz", "a"), a);
+            ecs::EntityRef bRef(ecs::Name("fuzz", "b"), b);
+            a.Set<ecs::Name>(lock, "fuzz", "a");
+            b.Set<ecs::Name>(lock, "fuzz", "b");
+        }
+
+        std::vector<double> batchResults(expressions.size());
+        std::vector<ecs::SignalCacheability> batchCacheability(expressions.size());
+        for (size_t trial = 0; trial < 5; trial++) {
+            {
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::Signals, ecs::FocusLock>>();
+                ecs::SignalRef(a, "x").SetValue(lock, (double)(rng() % 5) - 2.0);
+                ecs::SignalRef(a, "y").SetValue(lock, (double)(rng() % 3) * 0.5);
+                ecs::SignalRef(b, "z").SetValue(lock, std::uniform_real_distribution<double>(-10.0, 10.0)(rng));
+                auto &focusLock = lock.Get<ecs::FocusLock>();
+                focusLock.ReleaseFocus(ecs::FocusLayer::Menu);
+                if (trial % 2) focusLock.AcquireFocus(ecs::FocusLayer::Menu);
+            }
+
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+            std::fill(batchCacheability.begin(), batchCacheability.end(), ecs::SignalCacheability::UntilChanged);
+            batch.Evaluate(lock, batchResults, 0, batchCacheability);
+            for (size_t i = 0; i < expressions.size(); i++) {
+                auto &expr = expressions[i];
+                bytecodeCVar.Set(false);
+                auto treeCacheability = ecs::SignalCacheability::UntilChanged;
+                double treeResult = expr.Evaluate(lock, 0, &treeCacheability);
+                bytecodeCVar.Set(true);
+                double bytecodeResult = expr.Evaluate(lock);
+
+                // Batches evaluate both sides of conditionals, so may depend on more than the node tree
+                AssertTrue(batchCacheability[i] >= treeCacheability,
+                    "Batch cacheability is less restrictive than node tree: " + expr.expr);
+
+                if (!identical(treeResult, bytecodeResult) || !identical(treeResult, batchResults[i])) {
+                    Errorf("Signal expression mismatch: %s", expr.expr);
+                    AssertEqual(bytecodeResult, treeResult, "Bytecode result doesn't match node tree");
+                    AssertEqual(batchResults[i], treeResult, "Batch result doesn't match node tree");
+                }
+            }
+        }
+        bytecodeCVar.Set(true);
+    }
+
+    Test test(&TestBytecodeMatchesTree);
+} // namespace SignalExpressionFuzzTests
@@ -0,0 +1,87 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/ThreadTelemetry.hh"
+
+#include <memory>
+#include <tests.hh>
+
+namespace ThreadTelemetryTests {
+    using namespace testing;
+
+    void TestLogHistogramPrecision() {
+        using Histogram = sp::LogHistogram<>;
+
+        const uint64 values[] = {0, 1, 31, 32, 63, 64, 1000, 123456789, Histogram::MaxValue};
+        for (uint64 value : values) {
+            size_t index = Histogram::BucketIndex(value);
+            AssertTrue(index < Histogram::BucketCount, "bucket index out of range: " + std::to_string(value));
+            uint64 bucketValue = Histogram::BucketValue(index);
+            AssertTrue(bucketValue >= value, "bucket value is less than sample: " + std::to_string(value));
+            AssertTrue(bucketValue - value <= value / Histogram::SubBucketCount,
+                "bucket value is not within relative precision: " + std::to_string(value));
+        }
+
+        auto histogram = std::make_unique<Histogram>();
+        for (uint64 i = 1; i <= 10000; i++) {
+            histogram->AddSample(i * 1000);
+        }
+        AssertEqual(histogram->count.load(), 10000u, "histogram count");
+        AssertEqual(histogram->max.load(), 10000000u, "histogram max");
+        AssertEqual(histogram->GetPercentile(100), 10000000u, "p100 should be the max sample");
+
+        for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+            double expected = percentile * 100000.0;
+            double actual = (double)histogram->GetPercentile(percentile);
+            AssertTrue(actual >= expected && actual <= expected * (1.0 + 1.0 / Histogram::SubBucketCount),
+                "p" + std::to_string(percentile) + " is not within relative precision");
+        }
+    }
+
+    void TestThreadTelemetryRing() {
+        using namespace std::chrono_literals;
+        const size_t frameCount = sp::ThreadTelemetry::RING_SIZE + 10;
+
+        auto telemetry = std::make_unique<sp::ThreadTelemetry>("test");
+        auto start = chrono_clock::now();
+        for (size_t i = 0; i < frameCount; i++) {
+            auto frameStart = start + std::chrono::milliseconds(i * 10);
+            bool missed = i % 4 == 0;
+            auto workEnd = frameStart + (missed ? 12ms : 2ms);
+            auto sleepTarget = missed ? workEnd : frameStart + 10ms;
+            telemetry->AddFrame(frameStart, workEnd, sleepTarget + 1ms, sleepTarget, missed);
+        }
+
+        AssertEqual(telemetry->FrameCount(), frameCount, "frame count");
+        AssertEqual(telemetry->missedDeadlines.load(), (frameCount + 3) / 4, "missed deadline count");
+
+        auto frames = telemetry->GetFrames();
+        AssertEqual(frames.size(), sp::ThreadTelemetry::RING_SIZE, "all frames in the ring should be returned");
+        for (size_t i = 0; i < frames.size(); i++) {
+            auto &frame = frames[i];
+            AssertEqual(frame.index, i + 10, "frames should be returned oldest first");
+            AssertTrue(frame.frameStart == start + std::chrono::milliseconds(frame.index * 10), "frame start time");
+            AssertTrue(frame.sleepOvershoot == 1ms, "sleep overshoot");
+            AssertEqual(frame.missedDeadline, frame.index % 4 == 0, "missed deadline");
+        }
+
+        auto recent = telemetry->GetFrames(5);
+        AssertEqual(recent.size(), 5u, "recent frame count");
+        AssertEqual(recent.front().index, frameCount - 5, "first recent frame");
+        AssertEqual(recent.back().index, frameCount - 1, "last recent frame");
+
+        AssertEqual(telemetry->workTimes.max.load(), 12000000u, "max work time");
+        uint64 medianWorkTime = telemetry->workTimes.GetPercentile(50);
+        uint64 maxMedianWorkTime = 2000000 + 2000000 / sp::LogHistogram<>::SubBucketCount;
+        AssertTrue(medianWorkTime >= 2000000 && medianWorkTime <= maxMedianWorkTime,
+            "median work time is not within relative precision");
+    }
+
+    Test test1(&TestLogHistogramPrecision);
+    Test test2(&TestThreadTelemetryRing);
+} // namespace ThreadTelemetryTests
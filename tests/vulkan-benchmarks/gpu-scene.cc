@@ -0,0 +1,129 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "graphics/vulkan/core/DeviceContext.hh"
+#include "graphics/vulkan/render_graph/RenderGraph.hh"
+#include "graphics/vulkan/scene/GPUScene.hh"
+
+#include <filesystem>
+#include <tests.hh>
+#include <vector>
+
+namespace GPUSceneBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t STATIC_RENDERABLES = 100000;
+    const size_t DYNAMIC_RENDERABLES = 1000;
+    const size_t FRAME_COUNT = 100;
+    const auto MESH_LOAD_TIMEOUT = std::chrono::seconds(60);
+
+    // Runs a frame containing only the scene state passes, timing the CPU side of GPUScene::LoadState
+    void renderFrame(vulkan::DeviceContext &device,
+        vulkan::rg::RenderGraph &graph,
+        vulkan::GPUScene &scene,
+        MultiTimer *timer = nullptr) {
+        device.BeginFrame();
+        {
+            auto lock = ecs::StartTransaction<
+                ecs::Read<ecs::Renderable, ecs::OpticalElement, ecs::TransformSnapshot, ecs::Name>>();
+            if (timer) {
+                Timer t(*timer);
+                scene.LoadState(graph, lock);
+            } else {
+                scene.LoadState(graph, lock);
+            }
+        }
+        graph.Execute();
+        scene.Flush();
+        device.EndFrame();
+    }
+
+    void BenchmarkGPUSceneLoadState() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/models/duck", ec)) {
+            Logf("Skipping GPUScene benchmark, bundled models not found");
+            return;
+        }
+
+        // Run with VK_ICD_FILENAMES pointing at lavapipe to benchmark without a GPU
+        vulkan::DeviceContext device(false, false);
+        vulkan::rg::RenderGraph graph(device);
+        std::vector<ecs::Entity> dynamicEntities;
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            for (size_t i = 0; i < STATIC_RENDERABLES + DYNAMIC_RENDERABLES; i++) {
+                auto ent = lock.NewEntity();
+                ent.Set<ecs::Renderable>(lock, "duck");
+                ent.Set<ecs::TransformSnapshot>(lock, ecs::Transform(glm::vec3(i % 1000, 0, i / 1000)));
+                if (i >= STATIC_RENDERABLES) dynamicEntities.emplace_back(ent);
+            }
+        }
+
+        {
+            // The scene must be created after the entities so the initial slots are allocated in its constructor
+            vulkan::GPUScene scene(device);
+
+            auto loadStart = chrono_clock::now();
+            while (scene.primitiveCount == 0) {
+                AssertTrue(chrono_clock::now() - loadStart < MESH_LOAD_TIMEOUT, "Timed out loading benchmark mesh");
+                renderFrame(device, graph, scene);
+            }
+            AssertEqual(scene.renderableCount,
+                (uint32)(STATIC_RENDERABLES + DYNAMIC_RENDERABLES),
+                "Expected a slot per renderable");
+
+            {
+                MultiTimer timer("LoadState " + std::to_string(STATIC_RENDERABLES + DYNAMIC_RENDERABLES) +
+                                 " static renderables");
+                for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                    renderFrame(device, graph, scene, &timer);
+                }
+            }
+            {
+                MultiTimer timer("LoadState " + std::to_string(STATIC_RENDERABLES) + " static, " +
+                                 std::to_string(DYNAMIC_RENDERABLES) + " dynamic renderables");
+                for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                    {
+                        auto lock = ecs::StartTransaction<ecs::Write<ecs::TransformSnapshot>>();
+                        for (auto &ent : dynamicEntities) {
+                            auto &transform = ent.Get<ecs::TransformSnapshot>(lock).globalPose;
+                            transform.Translate(glm::vec3(0, 0.01f, 0));
+                        }
+                    }
+                    renderFrame(device, graph, scene, &timer);
+                }
+            }
+            {
+                MultiTimer timer("LoadState " + std::to_string(DYNAMIC_RENDERABLES) + " renderables added and removed");
+                for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                    {
+                        auto lock = ecs::StartTransaction<ecs::AddRemove>();
+                        for (auto &ent : dynamicEntities) {
+                            if (frame % 2 == 0) {
+                                ent.Unset<ecs::Renderable>(lock);
+                            } else {
+                                ent.Set<ecs::Renderable>(lock, "duck");
+                            }
+                        }
+                    }
+                    renderFrame(device, graph, scene, &timer);
+                }
+            }
+            AssertEqual(scene.renderableCount,
+                (uint32)(STATIC_RENDERABLES + DYNAMIC_RENDERABLES),
+                "Expected removed renderable slots to be reused");
+
+            device.WaitIdle();
+        }
+    }
+
+    Test test(&BenchmarkGPUSceneLoadState);
+} // namespace GPUSceneBenchmarks
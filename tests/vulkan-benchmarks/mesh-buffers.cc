@@ -0,0 +1,133 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/AssetManager.hh"
+#include "assets/Gltf.hh"
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "graphics/vulkan/core/DeviceContext.hh"
+#include "graphics/vulkan/render_graph/RenderGraph.hh"
+#include "graphics/vulkan/scene/GPUScene.hh"
+#include "graphics/vulkan/scene/Mesh.hh"
+
+#include <filesystem>
+#include <functional>
+#include <tests.hh>
+#include <vector>
+
+namespace MeshBufferBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    // Enough copies of the duck to outgrow the initial 1M entry vertex buffer.
+    // Each copy also loads its own textures, which limits how many can be loaded under lavapipe.
+    const size_t MESH_COUNT = 480;
+    const auto PHASE_TIMEOUT = std::chrono::seconds(120);
+
+    void renderFrame(vulkan::DeviceContext &device, vulkan::rg::RenderGraph &graph, vulkan::GPUScene &scene) {
+        device.BeginFrame();
+        {
+            auto lock = ecs::StartTransaction<
+                ecs::Read<ecs::Renderable, ecs::OpticalElement, ecs::TransformSnapshot, ecs::Name>>();
+            scene.LoadState(graph, lock);
+        }
+        graph.Execute();
+        scene.Flush();
+        device.EndFrame();
+    }
+
+    // Renders frames until done() returns true, timing each frame
+    void renderUntil(const std::string &name,
+        vulkan::DeviceContext &device,
+        vulkan::rg::RenderGraph &graph,
+        vulkan::GPUScene &scene,
+        std::function<bool()> done) {
+        MultiTimer timer(name);
+        auto start = chrono_clock::now();
+        while (!done()) {
+            AssertTrue(chrono_clock::now() - start < PHASE_TIMEOUT, "Timed out: " + name);
+            Timer t(timer);
+            renderFrame(device, graph, scene);
+        }
+    }
+
+    void BenchmarkMeshBuffers() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/models/duck", ec)) {
+            Logf("Skipping mesh buffer benchmark, bundled models not found");
+            return;
+        }
+
+        auto duck = Assets().LoadGltf("duck")->Get();
+        AssertTrue(duck && !duck->meshes.empty(), "Failed to load benchmark model");
+
+        std::vector<std::shared_ptr<const Gltf>> models;
+        for (size_t i = 0; i < MESH_COUNT; i++) {
+            models.emplace_back(make_shared<Gltf>("duck-buffers" + std::to_string(i), duck->asset));
+        }
+
+        // Run with VK_ICD_FILENAMES pointing at lavapipe to benchmark without a GPU
+        vulkan::DeviceContext device(false, false);
+        vulkan::rg::RenderGraph graph(device);
+        {
+            vulkan::GPUScene scene(device);
+            size_t initialVertexCapacity = scene.vertexBuffer.Capacity();
+            std::vector<shared_ptr<vulkan::Mesh>> meshes(models.size());
+
+            auto loadMeshes = [&]() {
+                bool ready = true;
+                for (size_t i = 0; i < models.size(); i++) {
+                    if (!meshes[i]) meshes[i] = scene.LoadMesh(models[i], 0);
+                    ready &= meshes[i] && meshes[i]->CheckReady();
+                }
+                return ready;
+            };
+
+            renderUntil("Load " + std::to_string(MESH_COUNT) + " meshes", device, graph, scene, loadMeshes);
+            size_t meshVertexCount = meshes[0]->VertexCount();
+            AssertEqual(scene.vertexBuffer.LiveCount(), MESH_COUNT * meshVertexCount, "Expected every mesh's vertices");
+            AssertTrue(scene.vertexBuffer.Capacity() > initialVertexCapacity, "Expected the vertex buffer to grow");
+
+            // Unload 2 of every 3 meshes, leaving holes throughout every buffer
+            size_t keptCount = 0;
+            for (size_t i = 0; i < meshes.size(); i++) {
+                if (i % 3 == 0) {
+                    keptCount++;
+                } else {
+                    meshes[i].reset();
+                }
+            }
+            size_t grownVertexCapacity = scene.vertexBuffer.Capacity();
+            renderUntil("Unload and compact " + std::to_string(MESH_COUNT - keptCount) + " meshes",
+                device,
+                graph,
+                scene,
+                [&]() {
+                    return scene.vertexBuffer.LiveCount() == keptCount * meshVertexCount &&
+                           scene.vertexBuffer.FragmentedCount() < scene.vertexBuffer.PageSize();
+                });
+            AssertTrue(scene.vertexBuffer.Capacity() < grownVertexCapacity, "Expected compaction to shrink the buffer");
+            for (size_t i = 0; i < meshes.size(); i += 3) {
+                AssertTrue(meshes[i]->CheckReady(), "Expected kept meshes to stay ready");
+                AssertTrue(meshes[i]->SceneIndex() < scene.models.LiveCount(), "Expected compacted model entries");
+            }
+
+            renderUntil("Reload " + std::to_string(MESH_COUNT - keptCount) + " meshes",
+                device,
+                graph,
+                scene,
+                loadMeshes);
+            AssertEqual(scene.vertexBuffer.LiveCount(), MESH_COUNT * meshVertexCount, "Expected every mesh's vertices");
+            AssertTrue(scene.vertexBuffer.Capacity() > initialVertexCapacity, "Expected the vertex buffer to regrow");
+
+            device.WaitIdle();
+        }
+    }
+
+    Test test(&BenchmarkMeshBuffers);
+} // namespace MeshBufferBenchmarks
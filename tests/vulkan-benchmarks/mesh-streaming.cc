@@ -0,0 +1,75 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/AssetManager.hh"
+#include "assets/Gltf.hh"
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "graphics/vulkan/core/DeviceContext.hh"
+#include "graphics/vulkan/scene/GPUScene.hh"
+#include "graphics/vulkan/scene/Mesh.hh"
+
+#include <filesystem>
+#include <tests.hh>
+#include <vector>
+
+namespace MeshStreamingBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const size_t STREAMED_MODELS = 200;
+    const auto MESH_LOAD_TIMEOUT = std::chrono::seconds(120);
+
+    void BenchmarkMeshStreaming() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory("../assets/models/duck", ec)) {
+            Logf("Skipping mesh streaming benchmark, bundled models not found");
+            return;
+        }
+
+        auto duck = Assets().LoadGltf("duck")->Get();
+        AssertTrue(duck && !duck->meshes.empty(), "Failed to load benchmark model");
+
+        // Each copy has its own name, so every model is decoded and uploaded as a separate mesh
+        std::vector<std::shared_ptr<const Gltf>> models;
+        for (size_t i = 0; i < STREAMED_MODELS; i++) {
+            models.emplace_back(make_shared<Gltf>("duck-stream" + std::to_string(i), duck->asset));
+        }
+
+        // Run with VK_ICD_FILENAMES pointing at lavapipe to benchmark without a GPU
+        vulkan::DeviceContext device(false, false);
+        {
+            vulkan::GPUScene scene(device);
+            std::vector<shared_ptr<vulkan::Mesh>> meshes(models.size());
+
+            size_t frameCount = 0;
+            auto loadStart = chrono_clock::now();
+            {
+                MultiTimer timer("Frame time streaming " + std::to_string(STREAMED_MODELS) + " models");
+                size_t readyCount = 0;
+                while (readyCount < models.size()) {
+                    AssertTrue(chrono_clock::now() - loadStart < MESH_LOAD_TIMEOUT, "Timed out streaming meshes");
+                    Timer t(timer);
+                    device.BeginFrame();
+                    readyCount = 0;
+                    for (size_t i = 0; i < models.size(); i++) {
+                        if (!meshes[i]) meshes[i] = scene.LoadMesh(models[i], 0);
+                        if (meshes[i] && meshes[i]->CheckReady()) readyCount++;
+                    }
+                    scene.Flush();
+                    device.EndFrame();
+                    frameCount++;
+                }
+            }
+            Logf("Streamed %u models in %u frames", models.size(), frameCount);
+
+            device.WaitIdle();
+        }
+    }
+
+    Test test(&BenchmarkMeshStreaming);
+} // namespace MeshStreamingBenchmarks
@@ -0,0 +1,140 @@
+/*
+ * Stray Photons - Copyright (C) 2023 Jacob Wirth & Justin Li
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "console/Console.hh"
+#include "core/Common.hh"
+#include "core/Logging.hh"
+#include "graphics/vulkan/core/DeviceContext.hh"
+#include "graphics/vulkan/core/Pipeline.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <tests.hh>
+#include <vector>
+
+namespace PipelineCacheBenchmarks {
+    using namespace testing;
+    using namespace sp;
+
+    const std::string CACHE_PATH = "cache/vulkan/pipelines.bin";
+    // offsetof(pipelineCacheHeader, pipelineCacheUUID) in Pipeline.cc
+    const size_t CACHE_UUID_OFFSET = 32;
+
+    const char *COMPUTE_SHADERS[] = {
+        "exposure_update.comp",
+        "generate_draws_for_view.comp",
+        "generate_warp_geometry_draws.comp",
+        "light_sensor.comp",
+        "lumi_histogram.comp",
+        "texture_factor.comp",
+        "voxel_fill_layer.comp",
+        "voxel_merge.comp",
+        "voxel_merge_layer.comp",
+        "voxel_mipmap.comp",
+        "voxel_mipmap_layer.comp",
+    };
+
+    std::vector<uint8_t> readCache() {
+        auto asset = Assets().Load(CACHE_PATH, AssetType::Bundled, true)->Get();
+        if (!asset) return {};
+        auto buf = asset->Buffer();
+        return std::vector<uint8_t>(buf.begin(), buf.end());
+    }
+
+    void writeCache(const std::vector<uint8_t> &data) {
+        std::ofstream out;
+        AssertTrue(Assets().OutputStream(CACHE_PATH, out), "Failed to open pipeline cache for writing");
+        out.write(reinterpret_cast<const char *>(data.data()), data.size());
+        out.close();
+    }
+
+    // Builds a compute pipeline for each shader, returning the number of pipelines the manager had to create
+    size_t createPipelines(vulkan::DeviceContext &device, const std::vector<std::string> &shaders) {
+        size_t createdBefore = device.Pipelines().PipelinesCreated();
+        for (auto &name : shaders) {
+            vulkan::PipelineCompileInput input;
+            input.state.shaders[vulkan::ShaderStage::Compute] = device.LoadShader(name);
+            AssertTrue(device.GetPipeline(input) != nullptr, "Failed to create pipeline: " + name);
+        }
+        return device.Pipelines().PipelinesCreated() - createdBefore;
+    }
+
+    void BenchmarkPipelineCache() {
+        std::vector<std::string> shaders;
+        std::error_code ec;
+        for (auto *name : COMPUTE_SHADERS) {
+            if (std::filesystem::is_regular_file("../assets/shaders/" + std::string(name) + ".spv", ec)) {
+                shaders.emplace_back(name);
+            }
+        }
+        if (shaders.empty()) {
+            Logf("Skipping pipeline cache benchmark, compiled shaders not found");
+            return;
+        }
+
+        auto &cacheCVar = GetConsoleManager().GetCVar<bool>("r.PipelineCache");
+        auto &prewarmCVar = GetConsoleManager().GetCVar<bool>("r.PipelinePrewarm");
+        bool cacheEnabled = cacheCVar.Get();
+        bool prewarmEnabled = prewarmCVar.Get();
+        cacheCVar.Set(true);
+        // Prewarming would build the cached pipelines before they are timed
+        prewarmCVar.Set(false);
+
+        // Keep the user's cache so running the benchmark doesn't throw it away
+        auto originalCache = readCache();
+        std::filesystem::remove("../assets/" + CACHE_PATH, ec);
+
+        // Run with VK_ICD_FILENAMES pointing at lavapipe to benchmark without a GPU
+        {
+            vulkan::DeviceContext device(false, false);
+            AssertTrue(!device.Pipelines().CacheLoaded(), "Expected no pipeline cache without a cache file");
+            {
+                Timer t("Create " + std::to_string(shaders.size()) + " pipelines with no cache file");
+                AssertEqual(createPipelines(device, shaders), shaders.size(), "Expected every pipeline to be built");
+            }
+        } // Saves the cache file
+
+        auto warmCache = readCache();
+        AssertTrue(!warmCache.empty(), "Expected the pipeline cache to be saved on shutdown");
+        {
+            vulkan::DeviceContext device(false, false);
+            AssertTrue(device.Pipelines().CacheLoaded(), "Expected the saved pipeline cache to load");
+            {
+                Timer t("Create " + std::to_string(shaders.size()) + " pipelines with a warm cache file");
+                AssertEqual(createPipelines(device, shaders), shaders.size(), "Expected every pipeline to be built");
+            }
+        }
+
+        std::vector<std::pair<std::string, std::vector<uint8_t>>> badCaches;
+        badCaches.emplace_back("truncated",
+            std::vector<uint8_t>(warmCache.begin(), warmCache.begin() + warmCache.size() / 2));
+        AssertTrue(warmCache.size() > CACHE_UUID_OFFSET, "Pipeline cache is smaller than its header");
+        badCaches.emplace_back("wrong UUID", warmCache);
+        badCaches.back().second[CACHE_UUID_OFFSET] ^= 0xff;
+
+        for (auto &[name, data] : badCaches) {
+            writeCache(data);
+            vulkan::DeviceContext device(false, false);
+            AssertTrue(!device.Pipelines().CacheLoaded(), "Expected a " + name + " pipeline cache to be ignored");
+            AssertEqual(createPipelines(device, shaders),
+                shaders.size(),
+                "Expected pipelines to build after ignoring a " + name + " cache");
+        }
+
+        if (originalCache.empty()) {
+            std::filesystem::remove("../assets/" + CACHE_PATH, ec);
+        } else {
+            writeCache(originalCache);
+        }
+        cacheCVar.Set(cacheEnabled);
+        prewarmCVar.Set(prewarmEnabled);
+    }
+
+    Test test(&BenchmarkPipelineCache);
+} // namespace PipelineCacheBenchmarks